@@ -0,0 +1,191 @@
+// Hollywood Wayland Compositor
+// SPDX-FileCopyrightText: 2024 Originull Software
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "benchwindow.h"
+
+#include <QPainter>
+#include <QTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include <time.h>
+
+static qint64 monotonicUs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return qint64(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+void paintScene(QPainter *p, const QSize &size, int frame, bool translucent)
+{
+    // a full-width gradient that shifts every frame keeps the whole buffer
+    // damaged, plus a moving bar so a stalled frame is visible on screen
+    const int alpha = translucent ? 160 : 255;
+    const int hue = (frame * 3) % 360;
+
+    if(translucent)
+    {
+        p->setCompositionMode(QPainter::CompositionMode_Source);
+        p->fillRect(QRect(QPoint(0,0), size), Qt::transparent);
+        p->setCompositionMode(QPainter::CompositionMode_SourceOver);
+    }
+
+    QLinearGradient grad(0, 0, size.width(), size.height());
+    grad.setColorAt(0, QColor::fromHsv(hue, 160, 220, alpha));
+    grad.setColorAt(1, QColor::fromHsv((hue + 120) % 360, 160, 120, alpha));
+    p->fillRect(QRect(QPoint(0,0), size), grad);
+
+    const int bar = qMax(8, size.width() / 16);
+    const int x = (frame * 4) % qMax(1, size.width() - bar);
+    p->fillRect(QRect(x, 0, bar, size.height()), QColor(255, 255, 255, alpha));
+}
+
+FramePacer::FramePacer(QWindow *window, const BenchOptions &opts)
+    : QObject(window)
+    , m_window(window)
+    , m_opts(opts)
+{
+    if(m_opts.fps > 0)
+    {
+        m_timer = new QTimer(this);
+        m_timer->setTimerType(Qt::PreciseTimer);
+        m_timer->setInterval(1000 / m_opts.fps);
+        connect(m_timer, &QTimer::timeout, this, &FramePacer::tick);
+    }
+}
+
+void FramePacer::start()
+{
+    if(m_timer)
+        m_timer->start();
+    else
+        request();
+}
+
+void FramePacer::tick()
+{
+    if(m_pending)
+    {
+        ++m_missed;
+        return;
+    }
+    request();
+}
+
+void FramePacer::request()
+{
+    m_pending = true;
+    m_requested = monotonicUs();
+    if(auto w = qobject_cast<QPaintDeviceWindow*>(m_window))
+        w->update();
+    else
+        m_window->requestUpdate();
+}
+
+void FramePacer::framePainted()
+{
+    ++m_frames;
+    for(auto w : std::as_const(m_dependents))
+    {
+        if(auto pdw = qobject_cast<QPaintDeviceWindow*>(w))
+            pdw->update();
+    }
+
+    if(!m_pending)
+        return; // expose or resize, not one of ours
+
+    m_latency.append(monotonicUs() - m_requested);
+    m_pending = false;
+
+    if(!m_timer)
+        request();
+}
+
+bool FramePacer::writeStats(const QString &path) const
+{
+    QJsonArray latency;
+    for(auto l : m_latency)
+        latency.append(l);
+
+    QJsonObject root;
+    root.insert("index", m_opts.index);
+    root.insert("buffer", m_opts.egl ? "egl" : "shm");
+    root.insert("frames", m_frames);
+    root.insert("missed", m_missed);
+    root.insert("latency_us", latency);
+
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly|QIODevice::Truncate))
+        return false;
+
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return true;
+}
+
+static void applyOptions(QWindow *window, const BenchOptions &opts)
+{
+    window->resize(opts.size);
+    window->setTitle(QString("hwcomp-bench-client #%1").arg(opts.index));
+    if(opts.frameless)
+        window->setFlag(Qt::FramelessWindowHint);
+
+    if(opts.translucent)
+    {
+        auto format = window->format();
+        format.setAlphaBufferSize(8);
+        window->setFormat(format);
+    }
+}
+
+ShmBenchWindow::ShmBenchWindow(const BenchOptions &opts, QWindow *parent)
+    : QRasterWindow(parent)
+    , m_opts(opts)
+    , m_pacer(new FramePacer(this, opts))
+{
+    applyOptions(this, opts);
+}
+
+void ShmBenchWindow::paintEvent(QPaintEvent *)
+{
+    QPainter p(this);
+    paintScene(&p, size(), m_pacer->frame(), m_opts.translucent);
+    p.end();
+    m_pacer->framePainted();
+}
+
+EglBenchWindow::EglBenchWindow(const BenchOptions &opts)
+    : QOpenGLWindow(QOpenGLWindow::NoPartialUpdate)
+    , m_opts(opts)
+    , m_pacer(new FramePacer(this, opts))
+{
+    applyOptions(this, opts);
+
+    // let the frame callback pace us, not eglSwapBuffers
+    auto format = this->format();
+    format.setSwapInterval(0);
+    setFormat(format);
+}
+
+void EglBenchWindow::paintGL()
+{
+    QPainter p(this);
+    paintScene(&p, size(), m_pacer->frame(), m_opts.translucent);
+    p.end();
+    m_pacer->framePainted();
+}
+
+SolidWindow::SolidWindow(FramePacer *pacer, QWindow *parent)
+    : QRasterWindow(parent)
+    , m_pacer(pacer)
+{
+}
+
+void SolidWindow::paintEvent(QPaintEvent *)
+{
+    QPainter p(this);
+    p.fillRect(rect(), QColor::fromHsv((m_pacer->frame() * 5) % 360, 200, 200));
+}
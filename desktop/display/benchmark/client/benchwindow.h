@@ -0,0 +1,104 @@
+// Hollywood Wayland Compositor
+// SPDX-FileCopyrightText: 2024 Originull Software
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BENCHWINDOW_H
+#define BENCHWINDOW_H
+
+#include <QObject>
+#include <QRasterWindow>
+#include <QOpenGLWindow>
+#include <QElapsedTimer>
+#include <QList>
+
+class QTimer;
+
+struct BenchOptions
+{
+    int index = 0;
+    QSize size = QSize(400, 300);
+    int fps = 60;             // 0 redraws as soon as a frame callback arrives
+    bool egl = false;
+    bool translucent = false;
+    bool frameless = false;
+    bool subsurface = false;
+    bool popup = false;
+};
+
+// Drives the redraws of one toplevel and keeps the numbers the runner
+// collects. Latency is the time between asking for a frame and painting it,
+// which on Wayland is the wait for the compositor's frame callback. A tick
+// of the animation clock that arrives while the previous frame is still
+// waiting on its callback counts as missed.
+class FramePacer : public QObject
+{
+    Q_OBJECT
+public:
+    FramePacer(QWindow *window, const BenchOptions &opts);
+
+    void start();
+    void framePainted();
+    int frame() const { return m_frames; }
+    void addDependent(QWindow *window) { m_dependents.append(window); }
+    bool writeStats(const QString &path) const;
+private slots:
+    void tick();
+private:
+    void request();
+
+    QWindow *m_window;
+    BenchOptions m_opts;
+    QTimer *m_timer = nullptr;
+    QElapsedTimer m_clock;
+    QList<QWindow*> m_dependents;
+    QList<qint64> m_latency;
+    qint64 m_requested = 0;
+    bool m_pending = false;
+    int m_frames = 0;
+    int m_missed = 0;
+};
+
+// wl_shm buffers
+class ShmBenchWindow : public QRasterWindow
+{
+    Q_OBJECT
+public:
+    explicit ShmBenchWindow(const BenchOptions &opts, QWindow *parent = nullptr);
+    FramePacer* pacer() { return m_pacer; }
+protected:
+    void paintEvent(QPaintEvent *) override;
+private:
+    BenchOptions m_opts;
+    FramePacer *m_pacer = nullptr;
+};
+
+// EGL buffers, which Mesa hands to the compositor through linux-dmabuf
+class EglBenchWindow : public QOpenGLWindow
+{
+    Q_OBJECT
+public:
+    explicit EglBenchWindow(const BenchOptions &opts);
+    FramePacer* pacer() { return m_pacer; }
+protected:
+    void paintGL() override;
+private:
+    BenchOptions m_opts;
+    FramePacer *m_pacer = nullptr;
+};
+
+// Subsurfaces and popups: a flat colour that changes with the parent's
+// frame counter, so each parent frame damages them too.
+class SolidWindow : public QRasterWindow
+{
+    Q_OBJECT
+public:
+    SolidWindow(FramePacer *pacer, QWindow *parent = nullptr);
+protected:
+    void paintEvent(QPaintEvent *) override;
+private:
+    FramePacer *m_pacer;
+};
+
+void paintScene(QPainter *p, const QSize &size, int frame, bool translucent);
+
+#endif // BENCHWINDOW_H
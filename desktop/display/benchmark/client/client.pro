@@ -0,0 +1,15 @@
+include(../../../include/global.pri)
+
+QT -= widgets
+TARGET = hwcomp-bench-client
+HEADERS = benchwindow.h
+SOURCES = main.cc benchwindow.cc
+
+contains( DEFINES, BUILD_HOLLYWOOD )
+{
+    DESTDIR=$${OBJECTS_DIR}../../../output/
+    INCLUDEPATH+=../../../libshell/include/
+    target.path = $$PREFIX/libexec/hollywood/
+}
+
+INSTALLS += target
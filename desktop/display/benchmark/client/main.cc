@@ -0,0 +1,110 @@
+// Hollywood Wayland Compositor
+// SPDX-FileCopyrightText: 2024 Originull Software
+// SPDX-License-Identifier: GPL-3.0-only
+
+// Synthetic Wayland client for hwcomp-bench. It opens one animated
+// toplevel and exits after --duration seconds, writing its frame pacing
+// numbers to the file given with --stats.
+
+#include <QGuiApplication>
+#include <QCommandLineParser>
+#include <QTimer>
+#include <hollywood/hollywood.h>
+
+#include "benchwindow.h"
+
+int main(int argc, char *argv[])
+{
+    // this is measuring the compositor, don't let the platform theme or
+    // client side decorations get in the way
+    qputenv("QT_QPA_PLATFORM", "wayland");
+    qputenv("QT_WAYLAND_DISABLE_WINDOWDECORATION", "1");
+
+    QGuiApplication a(argc, argv);
+    a.setApplicationVersion(HOLLYWOOD_OS_VERSION);
+    a.setOrganizationDomain(HOLLYWOOD_OS_DOMAIN);
+    a.setOrganizationName(HOLLYWOOD_OS_ORGNAME);
+    a.setApplicationName("hwcomp-bench-client");
+
+    QCommandLineParser p;
+    p.setApplicationDescription(QCoreApplication::translate("hwcomp-bench", "Compositor benchmark client"));
+    p.addHelpOption();
+    p.addOptions({
+        {"index", QCoreApplication::translate("hwcomp-bench", "Client number"), "n", "0"},
+        {"buffer", QCoreApplication::translate("hwcomp-bench", "Buffer type: shm or egl"), "type", "shm"},
+        {"size", QCoreApplication::translate("hwcomp-bench", "Window size"), "WxH", "400x300"},
+        {"fps", QCoreApplication::translate("hwcomp-bench", "Animation rate, 0 for unthrottled"), "fps", "60"},
+        {"duration", QCoreApplication::translate("hwcomp-bench", "Seconds to run"), "seconds", "10"},
+        {"translucent", QCoreApplication::translate("hwcomp-bench", "Use an alpha channel")},
+        {"frameless", QCoreApplication::translate("hwcomp-bench", "Don't ask for server side decorations")},
+        {"subsurface", QCoreApplication::translate("hwcomp-bench", "Add an animated subsurface")},
+        {"popup", QCoreApplication::translate("hwcomp-bench", "Add an animated popup")},
+        {"stats", QCoreApplication::translate("hwcomp-bench", "Write statistics to file"), "file"},
+    });
+    p.process(a);
+
+    BenchOptions opts;
+    opts.index = p.value("index").toInt();
+    opts.egl = p.value("buffer") == "egl";
+    opts.fps = p.value("fps").toInt();
+    opts.translucent = p.isSet("translucent");
+    opts.frameless = p.isSet("frameless");
+    opts.subsurface = p.isSet("subsurface");
+    opts.popup = p.isSet("popup");
+
+    auto size = p.value("size").split('x');
+    if(size.count() == 2)
+        opts.size = QSize(size[0].toInt(), size[1].toInt());
+
+    QWindow *window = nullptr;
+    FramePacer *pacer = nullptr;
+    if(opts.egl)
+    {
+        auto w = new EglBenchWindow(opts);
+        pacer = w->pacer();
+        window = w;
+    }
+    else
+    {
+        auto w = new ShmBenchWindow(opts);
+        pacer = w->pacer();
+        window = w;
+    }
+
+    // stagger the windows so they don't all stack on the same spot
+    window->setPosition(40 * (opts.index % 16), 30 * (opts.index % 16));
+    window->show();
+
+    if(opts.subsurface)
+    {
+        // child windows become wl_subsurfaces
+        auto sub = new SolidWindow(pacer, window);
+        sub->setGeometry(opts.size.width() / 4, opts.size.height() / 4,
+                         opts.size.width() / 2, opts.size.height() / 2);
+        sub->show();
+        pacer->addDependent(sub);
+    }
+
+    if(opts.popup)
+    {
+        // a ToolTip with a transient parent maps to an xdg_popup without
+        // needing an input serial for a grab
+        auto popup = new SolidWindow(pacer);
+        popup->setFlag(Qt::ToolTip);
+        popup->setTransientParent(window);
+        popup->setGeometry(window->x() + opts.size.width() / 2,
+                           window->y() + opts.size.height() / 2, 160, 120);
+        popup->show();
+        pacer->addDependent(popup);
+    }
+
+    pacer->start();
+
+    QTimer::singleShot(p.value("duration").toInt() * 1000, &a, [&]() {
+        if(p.isSet("stats") && !pacer->writeStats(p.value("stats")))
+            qWarning("hwcomp-bench-client: can't write %s", qPrintable(p.value("stats")));
+        a.quit();
+    });
+
+    return a.exec();
+}
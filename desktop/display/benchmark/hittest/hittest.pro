@@ -0,0 +1,16 @@
+include(../../../include/global.pri)
+
+QT -= gui widgets
+CONFIG += console
+TARGET = hwcomp-bench-hittest
+INCLUDEPATH += ../../compositor/include/core
+HEADERS = ../../compositor/include/core/hittest.h
+SOURCES = main.cc ../../compositor/src/core/hittest.cc
+
+contains( DEFINES, BUILD_HOLLYWOOD )
+{
+    DESTDIR=$${OBJECTS_DIR}../../../output/
+    target.path = $$PREFIX/libexec/hollywood/
+}
+
+INSTALLS += target
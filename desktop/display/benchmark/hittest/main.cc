@@ -0,0 +1,99 @@
+// Hollywood Wayland Compositor
+// SPDX-FileCopyrightText: 2024 Originull Software
+// SPDX-License-Identifier: GPL-3.0-only
+
+// Microbenchmark for the compositor's pointer hit testing: random windows
+// on a 1920x1080 output, queried at random pointer positions with the grid
+// and with the linear topmost-wins scan it replaced.
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QTextStream>
+
+#include "hittest.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    a.setApplicationName("hwcomp-bench-hittest");
+
+    QCommandLineParser p;
+    p.addHelpOption();
+    p.addOptions({
+        {"surfaces", "Number of surfaces", "n", "200"},
+        {"queries", "Number of pointer positions", "n", "1000000"},
+        {"seed", "Random seed", "n", "1"},
+    });
+    p.process(a);
+
+    const int surfaces = p.value("surfaces").toInt();
+    const int queries = p.value("queries").toInt();
+    QRandomGenerator rng(p.value("seed").toUInt());
+
+    // overlapping windows, partly off screen
+    QVector<QPair<Surface*, QRect>> scene;
+    for(int i = 0; i < surfaces; ++i)
+    {
+        QRect r(rng.bounded(-200, 1900), rng.bounded(-100, 1000),
+                rng.bounded(150, 900), rng.bounded(100, 700));
+        scene.append({ reinterpret_cast<Surface*>(quintptr(i + 1)), r });
+    }
+
+    QVector<QPoint> points;
+    points.reserve(queries);
+    for(int i = 0; i < queries; ++i)
+        points.append(QPoint(rng.bounded(1920), rng.bounded(1080)));
+
+    QElapsedTimer timer;
+    HitTestGrid grid;
+    timer.start();
+    for(const auto &s : std::as_const(scene))
+        grid.add(s.first, s.second);
+    const qint64 build = timer.nsecsElapsed();
+
+    // both loops store their answers so they do the same amount of work
+    QVector<Surface*> gridResults(queries);
+    timer.restart();
+    for(int i = 0; i < queries; ++i)
+        gridResults[i] = grid.topmost(points.at(i));
+    const qint64 gridNs = timer.nsecsElapsed();
+
+    QVector<Surface*> linearResults(queries);
+    timer.restart();
+    for(int i = 0; i < queries; ++i)
+    {
+        Surface *ret = nullptr;
+        for(const auto &s : std::as_const(scene))
+            if(s.second.contains(points.at(i)))
+                ret = s.first;
+        linearResults[i] = ret;
+    }
+    const qint64 linearNs = timer.nsecsElapsed();
+
+    QTextStream out(stdout);
+    out << "surfaces: " << surfaces << "  queries: " << queries << Qt::endl;
+    out << "grid build:   " << build / 1000.0 << " us" << Qt::endl;
+    out << "grid query:   " << double(gridNs) / queries << " ns" << Qt::endl;
+    out << "linear query: " << double(linearNs) / queries << " ns" << Qt::endl;
+
+    int mismatches = 0;
+    for(int i = 0; i < queries; ++i)
+    {
+        if(gridResults.at(i) == linearResults.at(i))
+            continue;
+
+        if(mismatches++ < 10)
+            out << "MISMATCH at " << points.at(i).x() << "," << points.at(i).y()
+                << ": grid " << quintptr(gridResults.at(i))
+                << " linear " << quintptr(linearResults.at(i)) << Qt::endl;
+    }
+
+    if(mismatches)
+    {
+        out << mismatches << " of " << queries << " queries differ between grid and linear results" << Qt::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,405 @@
+// Hollywood Wayland Compositor
+// SPDX-FileCopyrightText: 2024 Originull Software
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "benchrunner.h"
+
+#include <QProcess>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QSet>
+#include <QDateTime>
+#include <QTextStream>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QElapsedTimer>
+#include <hollywood/hollywood.h>
+
+#include <algorithm>
+#include <signal.h>
+#include <time.h>
+
+// clients take a moment to connect and map; frames from that period
+// measure start up, not steady state
+static const qint64 WarmupUs = 1000000;
+static const char *SocketName = "hwbench-0";
+
+static qint64 monotonicUs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return qint64(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+bool BenchScenario::parse(const QString &spec, BenchScenario *out)
+{
+    BenchScenario s;
+    auto sep = spec.indexOf(':');
+    s.name = sep < 0 ? spec : spec.left(sep);
+    if(s.name.isEmpty())
+        return false;
+
+    s.config.insert("buffer", "shm");
+    s.config.insert("size", "400x300");
+    s.config.insert("fps", 60);
+
+    const QStringList keys = sep < 0 ? QStringList() : spec.mid(sep+1).split(',', Qt::SkipEmptyParts);
+    for(const QString &key : keys)
+    {
+        auto eq = key.indexOf('=');
+        QString name = eq < 0 ? key : key.left(eq);
+        QString value = eq < 0 ? QString() : key.mid(eq+1);
+
+        if(name == "clients")
+            s.clients = value.toInt();
+        else if(name == "buffer" && (value == "shm" || value == "egl"))
+            s.config.insert(name, value);
+        else if(name == "size" && value.contains('x'))
+            s.config.insert(name, value);
+        else if(name == "fps")
+            s.config.insert(name, value.toInt());
+        else if(eq < 0 && (name == "translucent" || name == "frameless" ||
+                           name == "subsurface" || name == "popup"))
+        {
+            s.config.insert(name, true);
+            s.clientArgs << QString("--%1").arg(name);
+        }
+        else
+            return false;
+    }
+
+    s.config.insert("clients", s.clients);
+    s.clientArgs << "--buffer" << s.config.value("buffer").toString()
+                 << "--size" << s.config.value("size").toString()
+                 << "--fps" << QString::number(s.config.value("fps").toInt());
+
+    *out = s;
+    return true;
+}
+
+QList<BenchScenario> BenchScenario::defaults()
+{
+    static const char *specs[] = {
+        "idle:clients=0",
+        "shm-1:clients=1",
+        "shm-8:clients=8",
+        "shm-32:clients=32",
+        "egl-1:clients=1,buffer=egl",
+        "egl-8:clients=8,buffer=egl",
+        "egl-32:clients=32,buffer=egl",
+        "shm-large-4:clients=4,size=1600x900",
+        "egl-large-4:clients=4,buffer=egl,size=1600x900",
+        "translucent-8:clients=8,translucent",
+        "frameless-8:clients=8,frameless",
+        "subsurface-8:clients=8,subsurface",
+        "popup-8:clients=8,popup",
+        "unthrottled-8:clients=8,fps=0",
+    };
+
+    QList<BenchScenario> list;
+    for(auto spec : specs)
+    {
+        BenchScenario s;
+        BenchScenario::parse(QString::fromLatin1(spec), &s);
+        list.append(s);
+    }
+    return list;
+}
+
+BenchRunner::BenchRunner()
+    : m_compositor("/usr/libexec/hollywood/compositor")
+    , m_outputs("1920x1080@60")
+{
+}
+
+QJsonObject BenchRunner::run(const QList<BenchScenario> &scenarios)
+{
+    QJsonArray results;
+    for(const BenchScenario &s : scenarios)
+    {
+        QTextStream(stderr) << "hwcomp-bench: running " << s.name << Qt::endl;
+        results.append(runScenario(s));
+    }
+
+    QJsonObject report;
+    report.insert("version", 1);
+    report.insert("label", m_label);
+    report.insert("date", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    report.insert("os_version", HOLLYWOOD_OS_VERSION);
+    report.insert("outputs", m_outputs);
+    report.insert("duration", m_duration);
+    report.insert("scenarios", results);
+    return report;
+}
+
+bool BenchRunner::startCompositor(QProcess *proc, const QString &runtime, const QString &stats)
+{
+    auto env = QProcessEnvironment::systemEnvironment();
+    env.insert("XDG_RUNTIME_DIR", runtime);
+    env.insert("HWC_FRAME_STATS", stats);
+    env.remove("WAYLAND_DISPLAY");
+    env.remove("WAYLAND_SOCKET_FD");
+
+    proc->setProcessEnvironment(env);
+    proc->setProgram(m_compositor);
+    proc->setArguments({ QString("--headless=%1").arg(m_outputs),
+                         "--wayland-socket-name", SocketName });
+    proc->setStandardErrorFile(runtime + "/compositor.log");
+    proc->start();
+    if(!proc->waitForStarted())
+        return false;
+
+    // same handshake the session manager uses
+    QElapsedTimer timeout;
+    timeout.start();
+    QByteArray out;
+    while(timeout.elapsed() < 30000)
+    {
+        if(!proc->waitForReadyRead(1000))
+        {
+            if(proc->state() != QProcess::Running)
+                return false;
+            continue;
+        }
+        out += proc->readAllStandardOutput();
+        if(out.contains(HOLLYWOOD_COMPOSITOR_READY))
+            return true;
+    }
+    return false;
+}
+
+void BenchRunner::stopProcess(QProcess *proc)
+{
+    if(proc->state() == QProcess::NotRunning)
+        return;
+
+    // a --headless compositor leaves its event loop on SIGINT, which
+    // writes out the frame statistics still pending
+    ::kill(proc->processId(), SIGINT);
+    if(!proc->waitForFinished(5000))
+    {
+        proc->kill();
+        proc->waitForFinished();
+    }
+}
+
+QJsonObject BenchRunner::runScenario(const BenchScenario &scenario)
+{
+    QJsonObject result;
+    result.insert("name", scenario.name);
+    result.insert("config", scenario.config);
+
+    QTemporaryDir runtime;
+    if(!runtime.isValid())
+    {
+        result.insert("error", "can't create runtime directory");
+        return result;
+    }
+
+    const QString frames = runtime.filePath("frames.jsonl");
+    QProcess compositor;
+    if(!startCompositor(&compositor, runtime.path(), frames))
+    {
+        stopProcess(&compositor);
+        QFile log(runtime.filePath("compositor.log"));
+        log.open(QIODevice::ReadOnly);
+        result.insert("error", "compositor did not start");
+        result.insert("log", QString::fromLocal8Bit(log.readAll().right(4096)));
+        return result;
+    }
+
+    auto env = QProcessEnvironment::systemEnvironment();
+    env.insert("XDG_RUNTIME_DIR", runtime.path());
+    env.insert("WAYLAND_DISPLAY", SocketName);
+
+    const qint64 start = monotonicUs();
+    QList<QProcess*> clients;
+    for(int i = 0; i < scenario.clients; ++i)
+    {
+        auto proc = new QProcess;
+        proc->setProcessEnvironment(env);
+        proc->setProgram(m_client);
+        proc->setArguments(QStringList(scenario.clientArgs)
+                           << "--index" << QString::number(i)
+                           << "--duration" << QString::number(m_duration)
+                           << "--stats" << runtime.filePath(QString("client-%1.json").arg(i)));
+        proc->setStandardOutputFile(QProcess::nullDevice());
+        proc->setStandardErrorFile(QProcess::nullDevice());
+        proc->start();
+        clients.append(proc);
+    }
+
+    if(clients.isEmpty())
+    {
+        // nothing to wait on, just watch the compositor idle
+        QElapsedTimer idle;
+        idle.start();
+        while(idle.elapsed() < m_duration * 1000)
+            compositor.waitForFinished(100);
+    }
+
+    for(auto proc : std::as_const(clients))
+    {
+        if(!proc->waitForFinished((m_duration + 30) * 1000))
+            stopProcess(proc);
+    }
+    const qint64 end = qMin(monotonicUs(), start + qint64(m_duration) * 1000000);
+
+    stopProcess(&compositor);
+
+    // compositor side
+    QList<qint64> cpu, gpu, swap;
+    QSet<QString> outputs;
+    qint64 dropped = 0;
+    QFile file(frames);
+    if(file.open(QIODevice::ReadOnly|QIODevice::Text))
+    {
+        while(!file.atEnd())
+        {
+            auto frame = QJsonDocument::fromJson(file.readLine()).object();
+            auto t = qint64(frame.value("t_us").toDouble());
+            if(t < start + WarmupUs || t > end)
+                continue;
+
+            outputs.insert(frame.value("output").toString());
+            cpu.append(qint64(frame.value("cpu_us").toDouble()));
+            swap.append(qint64(frame.value("swap_us").toDouble()));
+            dropped += frame.value("dropped").toInt();
+            auto g = qint64(frame.value("gpu_us").toDouble());
+            if(g >= 0)
+                gpu.append(g);
+        }
+    }
+
+    const double window = qMax<qint64>(1, end - start - WarmupUs) / 1000000.0;
+    QJsonObject comp;
+    comp.insert("outputs", outputs.count());
+    comp.insert("frames", cpu.count());
+    comp.insert("fps", outputs.isEmpty() ? 0.0 : cpu.count() / window / outputs.count());
+    comp.insert("dropped", dropped);
+    comp.insert("cpu_us", summarize(cpu));
+    comp.insert("gpu_us", gpu.isEmpty() ? QJsonValue() : QJsonValue(summarize(gpu)));
+    comp.insert("swap_us", summarize(swap));
+    result.insert("compositor", comp);
+
+    // client side
+    QList<qint64> latency;
+    int reported = 0, clientFrames = 0, missed = 0;
+    for(int i = 0; i < clients.count(); ++i)
+    {
+        QFile f(runtime.filePath(QString("client-%1.json").arg(i)));
+        if(!f.open(QIODevice::ReadOnly))
+            continue;
+
+        auto stats = QJsonDocument::fromJson(f.readAll()).object();
+        ++reported;
+        clientFrames += stats.value("frames").toInt();
+        missed += stats.value("missed").toInt();
+        for(const auto &l : stats.value("latency_us").toArray())
+            latency.append(qint64(l.toDouble()));
+    }
+    qDeleteAll(clients);
+
+    QJsonObject cl;
+    cl.insert("started", scenario.clients);
+    cl.insert("reported", reported);
+    cl.insert("frames", clientFrames);
+    cl.insert("missed", missed);
+    cl.insert("latency_us", summarize(latency));
+    result.insert("clients", cl);
+
+    return result;
+}
+
+QJsonObject BenchRunner::summarize(QList<qint64> samples)
+{
+    QJsonObject s;
+    s.insert("count", samples.count());
+    if(samples.isEmpty())
+        return s;
+
+    std::sort(samples.begin(), samples.end());
+    auto pct = [&samples](double p) {
+        return samples.at(qMin<qsizetype>(samples.count() - 1, qsizetype(p * samples.count())));
+    };
+
+    double total = 0;
+    for(auto v : std::as_const(samples))
+        total += v;
+
+    s.insert("mean", total / samples.count());
+    s.insert("p50", pct(0.50));
+    s.insert("p95", pct(0.95));
+    s.insert("p99", pct(0.99));
+    s.insert("max", samples.last());
+    return s;
+}
+
+static double metric(const QJsonObject &scenario, const QString &path)
+{
+    QJsonValue v = scenario;
+    for(const QString &key : path.split('.'))
+        v = v.toObject().value(key);
+    return v.isDouble() ? v.toDouble() : -1;
+}
+
+bool BenchRunner::compare(const QJsonObject &baseline, const QJsonObject &current,
+                          double threshold, QTextStream &out)
+{
+    static const char *metrics[] = {
+        "compositor.cpu_us.p50",
+        "compositor.cpu_us.p95",
+        "compositor.gpu_us.p95",
+        "compositor.swap_us.p95",
+        "compositor.dropped",
+        "clients.latency_us.p95",
+        "clients.missed",
+    };
+
+    QHash<QString, QJsonObject> base;
+    for(const auto &s : baseline.value("scenarios").toArray())
+        base.insert(s.toObject().value("name").toString(), s.toObject());
+
+    out << "baseline: " << baseline.value("label").toString()
+        << "  current: " << current.value("label").toString() << Qt::endl;
+
+    bool ok = true;
+    for(const auto &v : current.value("scenarios").toArray())
+    {
+        const auto cur = v.toObject();
+        const auto name = cur.value("name").toString();
+        if(!base.contains(name))
+            continue;
+
+        out << name << Qt::endl;
+        for(auto m : metrics)
+        {
+            const double before = metric(base.value(name), m);
+            const double after = metric(cur, m);
+            if(before < 0 || after < 0)
+                continue;
+
+            QString change;
+            if(before > 0)
+            {
+                const double pct = (after - before) * 100.0 / before;
+                change = QString::asprintf("%+.1f%%", pct);
+                if(pct > threshold)
+                {
+                    change += "  REGRESSION";
+                    ok = false;
+                }
+            }
+            else if(after > 0)
+            {
+                change = "new";
+                ok = false;
+            }
+
+            out << QString("    %1 %2 -> %3  %4")
+                   .arg(QLatin1String(m), -24).arg(before, 10, 'f', 0)
+                   .arg(after, 10, 'f', 0).arg(change) << Qt::endl;
+        }
+    }
+    return ok;
+}
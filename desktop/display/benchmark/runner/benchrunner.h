@@ -0,0 +1,63 @@
+// Hollywood Wayland Compositor
+// SPDX-FileCopyrightText: 2024 Originull Software
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BENCHRUNNER_H
+#define BENCHRUNNER_H
+
+#include <QString>
+#include <QStringList>
+#include <QJsonObject>
+#include <QList>
+
+class QProcess;
+class QTextStream;
+
+// One compositor run: a number of identical synthetic clients.
+//
+// Written as NAME:KEY=VALUE,FLAG,... where the keys are clients, buffer
+// (shm or egl), size (WxH) and fps, and the flags are translucent,
+// frameless, subsurface and popup. eg. "shm-8:clients=8,buffer=shm"
+struct BenchScenario
+{
+    QString name;
+    int clients = 1;
+    QStringList clientArgs;
+    QJsonObject config;
+
+    static bool parse(const QString &spec, BenchScenario *out);
+    static QList<BenchScenario> defaults();
+};
+
+class BenchRunner
+{
+public:
+    BenchRunner();
+
+    void setCompositor(const QString &path) { m_compositor = path; }
+    void setClient(const QString &path) { m_client = path; }
+    void setOutputs(const QString &outputs) { m_outputs = outputs; }
+    void setDuration(int seconds) { m_duration = seconds; }
+    void setLabel(const QString &label) { m_label = label; }
+
+    QJsonObject run(const QList<BenchScenario> &scenarios);
+
+    // prints the change of the headline numbers of each scenario found in
+    // both reports; returns false if anything got worse by more than
+    // threshold percent
+    static bool compare(const QJsonObject &baseline, const QJsonObject &current,
+                        double threshold, QTextStream &out);
+private:
+    QJsonObject runScenario(const BenchScenario &scenario);
+    bool startCompositor(QProcess *proc, const QString &runtime, const QString &stats);
+    static void stopProcess(QProcess *proc);
+    static QJsonObject summarize(QList<qint64> samples);
+
+    QString m_compositor;
+    QString m_client;
+    QString m_outputs;
+    QString m_label;
+    int m_duration = 10;
+};
+
+#endif // BENCHRUNNER_H
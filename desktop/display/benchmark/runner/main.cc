@@ -0,0 +1,128 @@
+// Hollywood Wayland Compositor
+// SPDX-FileCopyrightText: 2024 Originull Software
+// SPDX-License-Identifier: GPL-3.0-only
+
+// hwcomp-bench: runs the compositor on headless outputs against a matrix
+// of synthetic clients and reports frame timing as JSON, so runs from
+// different commits can be compared with --compare.
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QTextStream>
+#include <QJsonDocument>
+#include <hollywood/hollywood.h>
+
+#include <algorithm>
+
+#include "benchrunner.h"
+
+static QJsonObject readReport(const QString &path)
+{
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly))
+        return QJsonObject();
+    return QJsonDocument::fromJson(file.readAll()).object();
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    a.setApplicationVersion(HOLLYWOOD_OS_VERSION);
+    a.setOrganizationDomain(HOLLYWOOD_OS_DOMAIN);
+    a.setOrganizationName(HOLLYWOOD_OS_ORGNAME);
+    a.setApplicationName("hwcomp-bench");
+
+    QCommandLineParser p;
+    p.setApplicationDescription(QCoreApplication::translate("hwcomp-bench", "Hollywood Compositor Benchmark"));
+    p.addHelpOption();
+    p.addVersionOption();
+    p.addOptions({
+        {"compositor", QCoreApplication::translate("hwcomp-bench", "Compositor binary"), "path",
+            "/usr/libexec/hollywood/compositor"},
+        {"client", QCoreApplication::translate("hwcomp-bench", "Benchmark client binary"), "path",
+            QCoreApplication::applicationDirPath() + "/hwcomp-bench-client"},
+        {"outputs", QCoreApplication::translate("hwcomp-bench", "Headless outputs, see QT_QPA_EGLFS_HEADLESS_OUTPUTS"),
+            "spec", "1920x1080@60"},
+        {"duration", QCoreApplication::translate("hwcomp-bench", "Seconds per scenario"), "seconds", "10"},
+        {{"s", "scenario"}, QCoreApplication::translate("hwcomp-bench", "Scenario name or NAME:KEY=VALUE,... spec (repeatable)"),
+            "scenario"},
+        {"list", QCoreApplication::translate("hwcomp-bench", "List the built in scenarios")},
+        {"label", QCoreApplication::translate("hwcomp-bench", "Label stored in the report, eg. a commit hash"), "label"},
+        {{"o", "output"}, QCoreApplication::translate("hwcomp-bench", "Write the report to file instead of stdout"), "file"},
+        {"compare", QCoreApplication::translate("hwcomp-bench", "Compare against a previous report"), "file"},
+        {"threshold", QCoreApplication::translate("hwcomp-bench", "Percent change counted as a regression"),
+            "percent", "5"},
+    });
+    p.process(a);
+
+    QTextStream err(stderr);
+    const auto defaults = BenchScenario::defaults();
+
+    if(p.isSet("list"))
+    {
+        QTextStream out(stdout);
+        for(const auto &s : defaults)
+            out << s.name << "\t" << QJsonDocument(s.config).toJson(QJsonDocument::Compact) << Qt::endl;
+        return 0;
+    }
+
+    QList<BenchScenario> scenarios;
+    for(const QString &spec : p.values("scenario"))
+    {
+        auto it = std::find_if(defaults.begin(), defaults.end(),
+                               [&spec](const BenchScenario &s) { return s.name == spec; });
+        if(it != defaults.end())
+        {
+            scenarios.append(*it);
+            continue;
+        }
+
+        BenchScenario s;
+        if(!BenchScenario::parse(spec, &s))
+        {
+            err << "hwcomp-bench: invalid scenario " << spec << Qt::endl;
+            return 1;
+        }
+        scenarios.append(s);
+    }
+    if(scenarios.isEmpty())
+        scenarios = defaults;
+
+    BenchRunner runner;
+    runner.setCompositor(p.value("compositor"));
+    runner.setClient(p.value("client"));
+    runner.setOutputs(p.value("outputs"));
+    runner.setDuration(qMax(2, p.value("duration").toInt()));
+    runner.setLabel(p.value("label"));
+
+    const auto report = runner.run(scenarios);
+    const auto json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+
+    if(p.isSet("output"))
+    {
+        QFile file(p.value("output"));
+        if(!file.open(QIODevice::WriteOnly|QIODevice::Truncate))
+        {
+            err << "hwcomp-bench: can't write " << file.fileName() << Qt::endl;
+            return 1;
+        }
+        file.write(json);
+    }
+    else
+        QTextStream(stdout) << json;
+
+    if(p.isSet("compare"))
+    {
+        const auto baseline = readReport(p.value("compare"));
+        if(baseline.isEmpty())
+        {
+            err << "hwcomp-bench: can't read " << p.value("compare") << Qt::endl;
+            return 1;
+        }
+        if(!BenchRunner::compare(baseline, report, p.value("threshold").toDouble(), err))
+            return 2;
+    }
+
+    return 0;
+}
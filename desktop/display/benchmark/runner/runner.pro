@@ -0,0 +1,15 @@
+include(../../../include/global.pri)
+
+QT -= gui widgets
+TARGET = hwcomp-bench
+HEADERS = benchrunner.h
+SOURCES = main.cc benchrunner.cc
+
+contains( DEFINES, BUILD_HOLLYWOOD )
+{
+    DESTDIR=$${OBJECTS_DIR}../../../output/
+    INCLUDEPATH+=../../../libshell/include/
+    target.path = $$PREFIX/libexec/hollywood/
+}
+
+INSTALLS += target
@@ -1,4 +1,4 @@
-QT += waylandcompositor waylandcompositor-private gui-private
+QT += waylandcompositor waylandcompositor-private gui-private concurrent
 CONFIG += wayland-scanner
 CONFIG -= wayland_compositor_quick
 
@@ -13,6 +13,7 @@ INCLUDEPATH +=  include/core/ \
                 $$PWD/../driver/platformheaders
 
 WAYLANDSERVERSOURCES += protocols/originull-privateapi.xml
+WAYLANDSERVERSOURCES += protocols/originull-thumbnail.xml
 WAYLANDSERVERSOURCES += protocols/appmenu.xml
 WAYLANDSERVERSOURCES += protocols/plasma-window-management.xml
 WAYLANDSERVERSOURCES += protocols/fullscreen-shell-unstable-v1.xml
@@ -40,11 +41,16 @@ contains(QT_CONFIG, no-pkg-config) {
 HEADERS += \
     include/core/compositor.h \
     include/core/decoration.h \
+    include/core/decorationtitle.h \
     include/core/output.h \
     include/core/outputmanager.h \
     include/core/shortcuts.h \
     include/core/surfaceobject.h \
     include/core/outputwnd.h \
+    include/core/framestats.h \
+    include/core/hittest.h \
+    include/core/shadowatlas.h \
+    include/core/thumbnailrenderer.h \
     include/core/wallpaper.h \
     include/core/view.h \
     include/protocol/activation.h \
@@ -58,10 +64,12 @@ HEADERS += \
     include/protocol/relativepointer.h \
     include/protocol/pointerconstraints.h \
     include/protocol/screencopy.h \
+    include/protocol/thumbnail.h \
     include/protocol/wndmgmt.h \
     include/protocol/xdgdialog.h \
     include/protocol/xdgshell.h \
     include/protocol/xdgshell_p.h \
+    include/xwayland/sigwatch.h \
     include/xwayland/xcbatom.h \
     include/xwayland/xcbatoms.h \
     include/xwayland/xcbcursors.h \
@@ -75,6 +83,7 @@ HEADERS += \
 
 SOURCES += \
     src/core/decoration.cc \
+    src/core/decorationtitle.cc \
     src/core/outputmanager.cc \
     src/protocol/activation.cc \
     src/protocol/appmenu.cc \
@@ -88,15 +97,21 @@ SOURCES += \
     src/protocol/qtshell.cc \
     src/protocol/relativepointer.cc \
     src/protocol/screencopy.cc \
+    src/protocol/thumbnail.cc \
     src/core/shortcuts.cc \
     src/core/surfaceobject.cc \
     src/core/compositor.cc \
     src/core/outputwnd.cc \
+    src/core/framestats.cc \
+    src/core/hittest.cc \
+    src/core/shadowatlas.cc \
+    src/core/thumbnailrenderer.cc \
     src/core/view.cc \
     src/protocol/wndmgmt.cc \
     src/core/wallpaper.cc \
     src/protocol/xdgdialog.cc \
     src/protocol/xdgshell.cc \
+    src/xwayland/sigwatch.cc \
     src/xwayland/xcbatom.cc \
     src/xwayland/xcbatoms.cc \
     src/xwayland/xcbcursors.cc \
@@ -131,6 +146,7 @@ DISTFILES += \
     protocols/appmenu.xml \
     protocols/gtk.xml \
     protocols/originull-privateapi.xml \
+    protocols/originull-thumbnail.xml \
     protocols/plasma-window-management.xml \
     protocols/wlr-layer-shell-unstable-v1.xml \
     protocols/qt-shell-unstable-v1.xml \
@@ -138,6 +154,8 @@ DISTFILES += \
     shaders/surface.fsh \
     shaders/shadow.fsh \
     shaders/shadow.vsh \
+    shaders/shadowslice.fsh \
+    shaders/shadowslice.vsh \
     shaders/surface.vsh \
     shaders/transition.fsh \
     shaders/transition.vsh
@@ -5,6 +5,7 @@
 
 #include <QGuiApplication>
 #include <QObject>
+#include <QHash>
 #include <QWaylandCompositor>
 #include <QWaylandCompositor>
 #include <QWaylandSurface>
@@ -67,6 +68,7 @@ class QtSurface;
 class ShortcutManager;
 class XdgActivation;
 class WlrScreencopyManagerV1;
+class WindowThumbnailManager;
 class RelativePointerManagerV1;
 class PointerConstraintsV1;
 class OutputManager;
@@ -93,7 +95,9 @@ public:
 
     OutputManager* outputManager() { return m_console_output; }
     QList<Surface*> surfaceObjects() const { return m_surfaces; }
-    QVector<Surface*> surfaceByZOrder() { return m_zorder; }
+    QVector<Surface*> surfaceByZOrder() const;
+    // O(1); false for surfaces that were recycled or never registered
+    bool isSurfaceAlive(const Surface *obj) const { return m_liveSurfaces.contains(obj); }
     QList<SurfaceView*> views() const;
     QList<Surface*> surfaces() { return m_surfaces; }
 
@@ -149,6 +153,9 @@ signals:
     void settingsChanged();
 public slots:
     void triggerRender();
+    // the surface stacking or geometry changed
+    void invalidateHitTests();
+    void reportFirstFrame();
     void lockSession();
     void wake();
 protected slots:
@@ -196,6 +203,10 @@ private:
 
     SurfaceView* findView(const QWaylandSurface *s) const;
     Surface* findSurfaceObject(const QWaylandSurface *s) const;
+    void registerSurface(Surface *obj);
+    void unregisterSurface(Surface *obj);
+    void zorderAppend(Surface *obj);
+    void zorderRemove(Surface *obj);
 private:
     // metrics (stored in settings)
     uint m_decorationSize = 30;
@@ -208,9 +219,16 @@ private:
     uint m_id = 0;
     // Our list of surfaces
     QList<Surface*> m_surfaces;
+    QHash<const QWaylandSurface*, Surface*> m_surfaceIndex;
+    // live surfaces and the wl_surface they are indexed under
+    QHash<const Surface*, const QWaylandSurface*> m_liveSurfaces;
 
-    // Top level surfaces to worry about z-order
-    QList<Surface*> m_zorder;
+    // Top level surfaces to worry about z-order, linked through
+    // Surface::m_zprev/m_znext bottom to top
+    Surface *m_zorderHead = nullptr;
+    Surface *m_zorderTail = nullptr;
+    mutable QVector<Surface*> m_zorderCache;
+    mutable bool m_zorderDirty = false;
 
     // X11 support
     XWaylandManager *m_x11 = nullptr;
@@ -240,6 +258,8 @@ private:
     XdgActivation *m_activation = nullptr;
     // wlroots screencopy protocol
     WlrScreencopyManagerV1 *m_screencopy = nullptr;
+    // live window thumbnails for stage
+    WindowThumbnailManager *m_thumbnails = nullptr;
     // wp-viewporter protocol
     QWaylandViewporter *m_viewporter = nullptr;
     // wp-reative-pointer protocol
@@ -252,6 +272,8 @@ private:
     QWaylandXdgOutputManagerV1 *m_outputmgr = nullptr;
     // running under user 'sddm'
     bool m_sddm = false;
+    // told the session manager we are on screen
+    bool m_reported_frame = false;
 
     // Our cursor
     Surface *m_cursorObject = nullptr;
@@ -19,6 +19,7 @@ Q_DECLARE_LOGGING_CATEGORY(hwSSDRender)
 
 class Surface;
 class OutputWindow;
+class DecorationTitle;
 class ServerSideDecoration : public QObject
 {
     Q_OBJECT
@@ -37,7 +38,7 @@ private:
     void renderDecoration(OutputWindow *window);
     void renderGems(OutputWindow *window);
     void renderIcon(OutputWindow *window);
-    void renderTitle(QOpenGLFramebufferObject *fbo);
+    void renderTitle(OutputWindow *window);
     void scissorContentArea(OutputWindow *window);
     void createWindowGemTextures();
     void renderGem(QOpenGLFunctions *functions,
@@ -60,4 +61,5 @@ private:
     QOpenGLTexture *m_maximize_icon = nullptr;
     QOpenGLTexture *m_restore_icon = nullptr;
     QOpenGLTexture *m_window_icon = nullptr;
+    DecorationTitle *m_title = nullptr;
 };
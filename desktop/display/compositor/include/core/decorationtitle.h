@@ -0,0 +1,62 @@
+// Hollywood Wayland Compositor
+// SPDX-FileCopyrightText: 2024 Originull Software
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+#include <QObject>
+#include <QImage>
+#include <QFutureWatcher>
+
+class QOpenGLTexture;
+
+// The title of a server side decoration, kept as a texture so drawing it is
+// a single quad. The texture is rasterized on a worker thread, and only when
+// something that affects it changes; glyphs come from a cache shared by all
+// decorations, so most titles are assembled without rasterizing any text.
+class DecorationTitle : public QObject
+{
+    Q_OBJECT
+public:
+    struct Key {
+        QString text;
+        int pixelSize = 0;
+        int maxWidth = 0;
+        QRgb color = 0;
+        bool operator==(const Key &o) const {
+            return text == o.text && pixelSize == o.pixelSize
+                && maxWidth == o.maxWidth && color == o.color;
+        }
+        bool operator!=(const Key &o) const { return !(*this == o); }
+    };
+
+    explicit DecorationTitle(QObject *parent = nullptr);
+    ~DecorationTitle();
+
+    // queues a rasterization unless key is already shown or in flight
+    void update(const Key &key);
+    // uploads a finished rasterization; needs a current context. nullptr
+    // until the first title is ready, or when the title is empty
+    QOpenGLTexture* texture();
+    QSize size() const { return m_size; }
+    int ascent() const { return m_ascent; }
+signals:
+    void ready();
+private slots:
+    void rasterized();
+private:
+    struct Raster {
+        QImage image;
+        int ascent = 0;
+    };
+    static Raster rasterize(const Key &key);
+    void start();
+
+    QFutureWatcher<Raster> *m_watcher;
+    Key m_requested;
+    Key m_inflight;
+    Raster m_pending;
+    bool m_hasPending = false;
+    QOpenGLTexture *m_texture = nullptr;
+    QSize m_size;
+    int m_ascent = 0;
+};
@@ -0,0 +1,51 @@
+// Hollywood Wayland Compositor
+// SPDX-FileCopyrightText: 2024 Originull Software
+// SPDX-License-Identifier: GPL-3.0-only
+#pragma once
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QQueue>
+
+class QOpenGLTimerQuery;
+class OutputWindow;
+
+// Per-frame timing of an OutputWindow, appended as JSON lines to the file
+// named by HWC_FRAME_STATS (used by hwcomp-bench). Each record carries the
+// CPU time spent in paintGL, the GPU time of the same frame where timer
+// queries are available (-1 otherwise), the time from the start of the
+// paint until the swap completed, and how many vblanks were missed.
+class FrameStats : public QObject
+{
+    Q_OBJECT
+public:
+    // returns nullptr unless HWC_FRAME_STATS is set
+    static FrameStats* create(OutputWindow *window);
+    ~FrameStats();
+
+    void beginFrame();
+    void endFrame();
+private slots:
+    void frameSwapped();
+private:
+    struct Frame {
+        quint64 number = 0;
+        qint64 start = 0;
+        qint64 cpu = 0;
+        qint64 swap = 0;
+        int dropped = 0;
+        QOpenGLTimerQuery *query = nullptr;
+    };
+
+    explicit FrameStats(OutputWindow *window);
+    void collect(bool wait);
+    void write(const Frame &frame, qint64 gpu);
+
+    OutputWindow *m_window;
+    QElapsedTimer m_clock;
+    QQueue<Frame> m_pending;
+    QList<QOpenGLTimerQuery*> m_freeQueries;
+    Frame m_current;
+    quint64 m_frames = 0;
+    bool m_timerQueries = true;
+};
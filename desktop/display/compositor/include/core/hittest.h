@@ -0,0 +1,47 @@
+// Hollywood Wayland Compositor
+// SPDX-FileCopyrightText: 2024 Originull Software
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+#include <QHash>
+#include <QRect>
+#include <QVarLengthArray>
+#include <QVector>
+#include <functional>
+
+class Surface;
+
+// Uniform grid over the global compositor space for pointer hit testing.
+// Each cell lists the entries overlapping it in stacking order, so finding
+// the topmost surface under the pointer only looks at the few entries in
+// one cell instead of walking every layer and popup.
+class HitTestGrid
+{
+public:
+    using Accept = std::function<bool(Surface *surface, const QPoint &pos)>;
+
+    explicit HitTestGrid(int cellSize = 128);
+
+    void clear();
+    // entries have to be added bottom-most first
+    void add(Surface *surface, const QRect &rect);
+    int count() const { return m_entries.count(); }
+
+    // topmost entry containing pos that accept (if given) agrees to,
+    // eg. because pos is inside the client's input region
+    Surface* topmost(const QPoint &pos, const Accept &accept = Accept()) const;
+
+private:
+    struct Entry {
+        Surface *surface;
+        QRect rect;
+    };
+    using Cell = QVarLengthArray<int, 8>;
+
+    static qint64 cellKey(int x, int y) { return (qint64(x) << 32) | quint32(y); }
+    int cellCoord(int v) const;
+
+    int m_cellSize;
+    QVector<Entry> m_entries;
+    QHash<qint64, Cell> m_cells;
+};
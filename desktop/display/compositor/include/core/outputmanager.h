@@ -21,6 +21,7 @@ public:
     explicit OutputManager(Compositor *parent, bool console = true);
     void present();
     void triggerRender();
+    void invalidateHitTests();
     Output* primaryOutput();
     Output* outputAtPosition(const QPoint &pos);
     QList<Output*> outputs();
@@ -13,6 +13,11 @@
 #include <QOpenGLTextureBlitter>
 
 #include <QLoggingCategory>
+
+#include "shadowatlas.h"
+#include "hittest.h"
+#include "thumbnailrenderer.h"
+
 Q_DECLARE_LOGGING_CATEGORY(hwRender)
 
 class QOpenGLTexture;
@@ -22,7 +27,9 @@ class Surface;
 class Output;
 class WallpaperManager;
 class WlrScreencopyFrameV1;
+class WindowThumbnail;
 class OutputManager;
+class FrameStats;
 class OutputWindow : public QOpenGLWindow
 {
     Q_OBJECT
@@ -32,7 +39,9 @@ public:
     int height();
     WallpaperManager* wallpaperManager();
     void setupScreenCopyFrame(WlrScreencopyFrameV1 *frame);
+    void queueThumbnail(WindowThumbnail *thumbnail);
     void setOutput(Output *output);
+    void invalidateHitTest();
 protected:
     friend class OutputManager;
     friend class ServerSideDecoration;
@@ -58,6 +67,7 @@ private:
     enum GrabState { NoGrab, MoveGrab, ResizeGrab, DragGrab };
     SurfaceView *viewAt(const QPointF &point);
     Surface* surfaceAt(const QPointF &point);
+    void rebuildHitTest();
     bool mouseGrab() const { return m_grabState != NoGrab ;}
     void sendMouseEvent(QMouseEvent *e, SurfaceView *target);
     static QPointF getAnchoredPosition(const QPointF &anchorPosition, int resizeEdge, const QSize &windowSize);
@@ -68,11 +78,13 @@ private:
     void drawShadowForObject(uint shadowOffset, Surface *obj);
     void drawDesktopInfoString();
     void drawServerSideDecoration(Surface *obj);
+    void renderThumbnails();
 private:
     friend class WallpaperManager;
     Output *m_output;
     QOpenGLTextureBlitter m_textureBlitter;
-    QOpenGLShaderProgram *m_shadowShader;
+    ShadowAtlas m_shadowAtlas;
+    ThumbnailRenderer m_thumbnailRenderer;
     QOpenGLShaderProgram *m_rgbaShader;
     QOpenGLFramebufferObject *m_fbo = nullptr;
 
@@ -93,5 +105,9 @@ private:
 
     WlrScreencopyFrameV1 *m_copy_frame = nullptr;
     bool m_do_copy_frame = false;
+    QList<QPointer<WindowThumbnail>> m_thumbnails;
     bool m_blackout = false;
+    FrameStats *m_frameStats = nullptr;
+    HitTestGrid m_hitTest;
+    bool m_hitTestDirty = true;
 };
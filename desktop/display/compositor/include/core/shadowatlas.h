@@ -0,0 +1,62 @@
+// Hollywood Wayland Compositor
+// SPDX-FileCopyrightText: 2024 Originull Software
+// SPDX-License-Identifier: GPL-3.0-only
+#pragma once
+
+#include <QHash>
+#include <QRect>
+#include <QOpenGLBuffer>
+
+class QOpenGLShaderProgram;
+class QOpenGLFramebufferObject;
+
+// Window shadows are rendered with the blur shader once per style into a
+// nine-slice tile of a shared atlas texture. Drawing a shadow is then the
+// eight border quads of that tile stretched around the window frame in
+// one draw call, so the cost follows the perimeter, not the window area.
+// The frame interior is cut out of each tile, so nothing has to be cleared
+// afterwards.
+class ShadowAtlas
+{
+public:
+    enum Style { Active, Inactive, Popup };
+
+    ShadowAtlas();
+    ~ShadowAtlas();
+
+    // requires the output's context to be current
+    void initialize();
+
+    // draws into the currently bound framebuffer (of size target) around
+    // frame, both in GL coordinates; radius is the margin reserved for the
+    // shadow around the frame
+    void draw(const QSize &target, const QRect &frame, uint radius, Style style);
+
+private:
+    struct Key {
+        uint radius;
+        Style style;
+        bool operator==(const Key &o) const { return radius == o.radius && style == o.style; }
+    };
+    friend size_t qHash(const Key &key, size_t seed) { return qHashMulti(seed, key.radius, int(key.style)); }
+
+    struct Tile {
+        QRect rect;     // in the atlas
+        int pad = 0;    // blur extent outside the frame
+        int slice = 0;  // width of the fixed border of the nine-slice
+    };
+
+    const Tile* tile(const Key &key);
+    bool allocate(const QSize &size, QRect *rect);
+    void renderTile(const Key &key, const Tile &tile, float sigma, float corner);
+    void reset(int size);
+
+    QOpenGLFramebufferObject *m_atlas = nullptr;
+    QOpenGLShaderProgram *m_blurShader = nullptr;
+    QOpenGLShaderProgram *m_sliceShader = nullptr;
+    QOpenGLBuffer m_vertices;
+    QHash<Key, Tile> m_tiles;
+    int m_shelfX = 0;
+    int m_shelfY = 0;
+    int m_shelfHeight = 0;
+};
@@ -220,6 +220,10 @@ private:
     void createPlasmaWindowControl();
     void recalculateRenderPosition();
     QUuid m_uuid;
+    // z-order links, owned by Compositor
+    Surface *m_zprev = nullptr;
+    Surface *m_znext = nullptr;
+    bool m_inZOrder = false;
     uint m_id;
 
     bool m_surfaceInit = false;
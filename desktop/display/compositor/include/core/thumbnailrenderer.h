@@ -0,0 +1,38 @@
+// Hollywood Wayland Compositor
+// SPDX-FileCopyrightText: 2024 Originull Software
+// SPDX-License-Identifier: GPL-3.0-only
+#pragma once
+
+#include <QHash>
+#include <QImage>
+#include <QSize>
+#include <QOpenGLTextureBlitter>
+
+class QOpenGLTexture;
+class QOpenGLFramebufferObject;
+
+// Scales window textures down to thumbnail size on the GPU. The texture is
+// halved with linear filtering until the next step would undershoot the
+// target, which averages every source pixel like a mipmap chain would,
+// without touching the client's texture. Only the final, thumbnail sized
+// framebuffer is read back.
+class ThumbnailRenderer
+{
+public:
+    ThumbnailRenderer() = default;
+    ~ThumbnailRenderer();
+
+    // requires the output's context to be current
+    void initialize();
+
+    // source is the size of the texture in buffer pixels; the caller's
+    // framebuffer and viewport are restored afterwards
+    QImage render(QOpenGLTexture *texture, QOpenGLTextureBlitter::Origin origin,
+                  const QSize &source, const QSize &size);
+
+private:
+    QOpenGLFramebufferObject* framebuffer(const QSize &size);
+
+    QOpenGLTextureBlitter m_blitter;
+    QHash<quint64, QOpenGLFramebufferObject*> m_framebuffers;
+};
@@ -5,6 +5,8 @@
 
 #include <QObject>
 #include <QTimer>
+#include <QImage>
+#include <QFutureWatcher>
 #include <QOpenGLTexture>
 #include <QOpenGLShaderProgram>
 #include <QOpenGLFramebufferObject>
@@ -25,6 +27,16 @@ public:
     };
     explicit WallpaperManager(OutputWindow *parent = nullptr);
     void setup();
+
+    // an image decoded for one output, ready to become a texture
+    struct Decoded {
+        QString path;
+        QSize target;
+        Layout mode = FillScreen;
+        QImage image;   // flipped for the bottom left origin blit
+        QPoint start;
+        bool isNull() const { return image.isNull(); }
+    };
 public slots:
     void wallpaperChanged();
     void clearBackgroundColor();
@@ -34,16 +46,31 @@ public slots:
 signals:
 private:
     void querySettings();
-    QString findNextWallpaperInOrder();
+    static QString findNextWallpaperInOrder(const QString &folder, const QString &current);
     QString findNextWallpaperRandom();
+    static Decoded decode(const QString &path, const QSize &target, Layout mode);
+    void startDecode();
+    void uploadPending();
     void renderTransition();
     void completeTransition();
     void setNewWallpaperPath(const QString &wallpaper);
 private slots:
     void transitionWallpaper();
+    void startPrefetch();
+    void decoded();
+    void prefetched();
 private:
     OutputWindow *m_parent;
     QTimer *m_rotationTimer = nullptr;
+    QTimer *m_prefetchTimer = nullptr;
+    QFutureWatcher<Decoded> *m_decodeWatcher;
+    QFutureWatcher<Decoded> *m_prefetchWatcher;
+    Decoded m_pending;
+    bool m_hasPending = false;
+    bool m_pendingTransition = false;
+    bool m_decodeAgain = false;
+    Decoded m_prefetch;
+    bool m_transitionWaiting = false;
     QOpenGLTexture *m_texture = nullptr;
     const uchar *m_texturebits = nullptr;
 
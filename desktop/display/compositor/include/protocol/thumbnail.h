@@ -0,0 +1,80 @@
+// Hollywood Wayland Compositor
+// SPDX-FileCopyrightText: 2024 Originull Software
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QWaylandCompositorExtensionTemplate>
+#include <QWaylandCompositor>
+#include <wayland-server.h>
+#include "qwayland-server-originull-thumbnail.h"
+
+#include <QLoggingCategory>
+Q_DECLARE_LOGGING_CATEGORY(hwThumbnail)
+
+class Surface;
+class WindowThumbnail;
+class WindowThumbnailManager : public QWaylandCompositorExtensionTemplate<WindowThumbnailManager>
+        , public QtWaylandServer::org_originull_thumbnail_manager
+{
+    Q_OBJECT
+public:
+    WindowThumbnailManager(QWaylandCompositor *compositor);
+    void initialize() override;
+protected:
+    void org_originull_thumbnail_manager_get_thumbnail(Resource *resource, uint32_t id, const QString &uuid,
+                                                       int32_t max_width, int32_t max_height) override;
+    void org_originull_thumbnail_manager_destroy(Resource *resource) override;
+};
+
+// A live, downscaled copy of one toplevel. Nothing is rendered while the
+// client has no capture outstanding, and a capture is only served once the
+// window was damaged since the last one, at most every MinimumInterval.
+class WindowThumbnail : public QObject, public QtWaylandServer::org_originull_thumbnail
+{
+    Q_OBJECT
+public:
+    WindowThumbnail(Surface *surface, const QSize &maxSize,
+                    struct ::wl_client *client, uint32_t id, int version);
+    ~WindowThumbnail();
+
+    Surface* surface() const { return m_surface; }
+    QSize size() const { return m_size; }
+
+    // called by the output window from paintGL; prepare() returns whether
+    // the thumbnail should be rendered into a buffer of size() this frame
+    bool prepare();
+    void deliver(const QImage &image);
+protected:
+    void org_originull_thumbnail_capture(Resource *resource, struct ::wl_resource *buffer) override;
+    void org_originull_thumbnail_destroy(Resource *resource) override;
+    void org_originull_thumbnail_destroy_resource(Resource *resource) override;
+private slots:
+    void surfaceDamaged();
+    void schedule();
+private:
+    QSize targetSize() const;
+    void releaseBuffer();
+    void failCapture();
+    static void bufferDestroyed(struct wl_listener *listener, void *data);
+
+    QPointer<Surface> m_surface;
+    QSize m_maxSize;
+    QSize m_size;
+
+    struct ::wl_resource *m_buffer = nullptr;
+    struct BufferListener {
+        struct wl_listener listener;
+        WindowThumbnail *thumbnail;
+    } m_bufferListener;
+
+    QTimer m_throttle;
+    QElapsedTimer m_lastUpdate;
+    bool m_damaged = true;
+    bool m_queued = false;
+};
@@ -20,6 +20,8 @@ class Resources;
 }
 
 
+class QSocketNotifier;
+class QTimer;
 class XWayland;
 class XWaylandShellSurface;
 class XWaylandServer;
@@ -51,9 +53,11 @@ public:
     void setCompositor(Compositor *compositor);
 
     void start(int fd);
+    // drops the connection to an Xwayland that went away
+    void stop();
 
     void addWindow(xcb_window_t id, XWaylandShellSurface *shellSurface);
-    void removeWindow(xcb_window_t id);
+    void removeWindow(xcb_window_t id, XWaylandShellSurface *shellSurface);
 
     void setActiveWindow(xcb_window_t window);
     void setFocusWindow(xcb_window_t window);
@@ -66,9 +70,20 @@ Q_SIGNALS:
     void shellSurfaceRequested(quint32 window, const QRect &geometry,
                                bool overrideRedirect, XWaylandShellSurface *parentShellSurface);
     void shellSurfaceCreated(XWaylandShellSurface *shellSurface);
+    void windowCountChanged(int count);
 
 private:
     XWaylandServer *m_server;
+    QSocketNotifier *m_wmNotifier;
+    int m_windowCount;
+
+    struct PendingProperty {
+        xcb_window_t window;
+        xcb_atom_t atom;
+        xcb_get_property_cookie_t cookie;
+    };
+    QList<PendingProperty> m_pendingProperties;
+    QTimer *m_propertyTimer;
     xcb_visualid_t m_visualId;
     xcb_colormap_t m_colorMap;
 
@@ -87,6 +102,7 @@ private:
     XWaylandShellSurface *m_focusWindow;
 
     void setupVisualAndColormap();
+    void updateWindowCount();
     void wmSelection();
     void initializeDragAndDrop();
 
@@ -126,4 +142,5 @@ private:
 
 private Q_SLOTS:
     void wmEvents();
+    void processPropertyReplies();
 };
@@ -8,11 +8,14 @@
 
 #include <QtCore/QString>
 #include <QtCore/QProcess>
+#include <QtCore/QElapsedTimer>
 
 #include "compositor.h"
 
 struct wl_client;
 
+class QSocketNotifier;
+class QTimer;
 class ServerProcess;
 
 class XWaylandServer : public QObject
@@ -35,12 +38,21 @@ public:
     Compositor *compositor() const;
     QString displayName() const;
 
-    bool start();
+    // Claims a display and its sockets, and runs Xwayland right away or,
+    // with onDemand, only once the first X11 client connects to them.
+    // Either way DISPLAY is valid as soon as this returns.
+    bool start(bool onDemand = false);
     void shutdown();
 
+    // Stop Xwayland after it has had no X11 windows for msecs, the next
+    // client brings it back. 0 keeps it running.
+    void setIdleTimeout(int msecs);
+    void setIdle(bool idle);
+
 Q_SIGNALS:
     void displayNameChanged();
     void started(const QString &displayName);
+    void stopped();
     void failedToStart();
 
 private:
@@ -53,8 +65,24 @@ private:
     int m_serverPairFd[2];
     int m_wmPairFd[2];
 
+    // abstract and filesystem listening sockets for the display
+    int m_listenFd[2];
+    QSocketNotifier *m_listenNotifier[2];
+
+    QTimer *m_idleTimer;
+    QElapsedTimer m_startTimer;
+    bool m_shuttingDown;
+    bool m_failed;
+
     wl_client *m_client;
 
+    bool bindDisplay();
+    void unbindDisplay();
+    void armListeners(bool enabled);
+    void rejectClients();
+    void failStart();
+    bool spawn();
+
 private Q_SLOTS:
     void handleServerStarted();
 };
@@ -126,8 +126,12 @@ public:
 
     void setWorkspace(int workspace);
 
-    void dirtyProperties();
+    // reads every watched property at once, only the first time
     void readProperties();
+    bool propertiesRead() const;
+    bool watchesProperty(xcb_atom_t atom) const;
+    // reply of a single property that changed since readProperties()
+    void updateProperty(xcb_atom_t atom, xcb_get_property_reply_t *reply);
     void setProperties();
 
     QSize sizeForResize(const QSizeF &size, const QPointF &delta, ResizeEdge edge);
@@ -181,6 +185,8 @@ Q_SIGNALS:
     void startResize(XWaylandShellSurface::ResizeEdge edges);
 
 private:
+    void applyProperty(xcb_atom_t atom, xcb_atom_t type, xcb_get_property_reply_t *reply);
+
     XWaylandManager *m_wm;
     xcb_window_t m_window;
     QRect m_geometry;
@@ -22,6 +22,7 @@
 #include "fullscreen.h"
 #include "activation.h"
 #include "screencopy.h"
+#include "thumbnail.h"
 #include "relativepointer.h"
 #include "pointerconstraints.h"
 #include "shortcuts.h"
@@ -29,6 +30,7 @@
 #include "xwayland.h"
 #include "xwaylandserver.h"
 #include "xwaylandshellsurface.h"
+#include "sigwatch.h"
 
 #include <QSettings>
 #include <QPainter>
@@ -41,6 +43,7 @@
 #include <errno.h>
 #include <hollywood/hollywood.h>
 #include <stdlib.h>
+#include <stdio.h>
 #include <QMessageBox>
 
 Q_LOGGING_CATEGORY(hwCompositor, "compositor.core")
@@ -58,6 +61,7 @@ Compositor::Compositor(bool sddm)
     , m_fs(new FullscreenShell(this))
     , m_activation(new XdgActivation(this))
     , m_screencopy(new WlrScreencopyManagerV1(this))
+    , m_thumbnails(new WindowThumbnailManager(this))
     , m_viewporter(new QWaylandViewporter(this))
     , m_relative_pointer(new RelativePointerManagerV1(this))
     , m_pointer_constraints(new PointerConstraintsV1(this))
@@ -160,7 +164,22 @@ void Compositor::setupX11()
         m_x_display = displayName;
         m_x11->start(m_xserver->wmFd());
     });
-    m_xserver->start();
+    connect(m_xserver, &XWaylandServer::stopped, m_x11, &XWaylandManager::stop);
+    connect(m_x11, &XWaylandManager::windowCountChanged, m_xserver, [this](int count) {
+        m_xserver->setIdle(count == 0);
+    });
+
+    // Most sessions never run an X11 client, so by default Xwayland only
+    // starts when one connects to the display
+    QSettings settings("/etc/hollywood/compositor.conf", QSettings::IniFormat);
+    settings.beginGroup("Xwayland");
+    const bool onDemand = settings.value("OnDemand", true).toBool();
+    const int idle = settings.value("IdleTimeout", 0).toInt();
+    settings.endGroup();
+
+    m_xserver->setIdleTimeout(qMax(0, idle) * 1000);
+    if(m_xserver->start(onDemand))
+        m_x_display = m_xserver->displayName();
 
 }
 
@@ -192,7 +211,7 @@ void Compositor::resetLayerShellLayer(Surface *s)
     if(!s->layerSurface())
         return;
 
-    m_zorder.removeOne(s);
+    zorderRemove(s);
     m_layer_bg.removeOne(s);
     m_layer_bottom.removeOne(s);
     m_layer_top.removeOne(s);
@@ -226,16 +245,15 @@ void Compositor::resetLayerShellLayer(Surface *s)
         m_layer_overlay.prepend(s);
         break;
     }
+
+    invalidateHitTests();
 }
 
 QString Compositor::surfaceZOrderByUUID() const
 {
     QStringList uuids;
-    QListIterator i(m_zorder);
-    i.toBack();
-    while(i.hasPrevious())
+    for(Surface *obj = m_zorderTail; obj; obj = obj->m_zprev)
     {
-        auto obj = i.previous();
         if(obj->isSpecialShellObject())
             continue;
         if(obj->plasmaControl())
@@ -331,7 +349,7 @@ void Compositor::wake()
 QList<SurfaceView*> Compositor::views() const
 {
     QList<SurfaceView*> returnList;
-    for(auto *obj : m_zorder)
+    for(Surface *obj = m_zorderHead; obj; obj = obj->m_znext)
     {
         if(!obj->primaryView())
             returnList.append(obj->primaryView());
@@ -376,8 +394,8 @@ void Compositor::onSurfaceCreated(QWaylandSurface *surface)
             }
         }
     }
-    m_surfaces << (obj);
-    m_zorder << (obj);
+    registerSurface(obj);
+    zorderAppend(obj);
 }
 
 void Compositor::recycleSurfaceObject(Surface *obj)
@@ -388,8 +406,7 @@ void Compositor::recycleSurfaceObject(Surface *obj)
     if(obj->xdgTopLevelParent())
         obj->xdgTopLevelParent()->removeXdgTopLevelChild(obj);
 
-    m_surfaces.removeOne(obj);
-    m_zorder.removeOne(obj);
+    unregisterSurface(obj);
     m_layer_bg.removeOne(obj);
     m_layer_bottom.removeOne(obj);
     m_layer_top.removeOne(obj);
@@ -400,6 +417,9 @@ void Compositor::recycleSurfaceObject(Surface *obj)
     if(m_tl_raised == obj)
         raiseNextInLine();
 
+    // don't let the next pointer event find a deleted surface
+    invalidateHitTests();
+
     delete obj;
     obj = nullptr;
 }
@@ -417,26 +437,97 @@ void Compositor::surfaceHasContentChanged()
             defaultSeat()->setMouseFocus(surface->primaryView());
         }
     }
+    // mapped or unmapped
+    invalidateHitTests();
     // TODO: avoid this if surface is minimized?
     triggerRender();
 }
 
 SurfaceView * Compositor::findView(const QWaylandSurface *s) const
 {
-    for (auto* obj : m_surfaces) {
-        if (obj->surface() == s)
-            return obj->primaryView();
-    }
-    return nullptr;
+    auto obj = m_surfaceIndex.value(s);
+    return obj ? obj->primaryView() : nullptr;
 }
 
 Surface* Compositor::findSurfaceObject(const QWaylandSurface *s) const
 {
-    for (auto* obj : m_surfaces) {
-        if (obj->surface() == s)
-            return obj;
+    return m_surfaceIndex.value(s);
+}
+
+void Compositor::registerSurface(Surface *obj)
+{
+    if(m_liveSurfaces.contains(obj))
+        return;
+
+    m_surfaces.append(obj);
+    m_liveSurfaces.insert(obj, obj->surface());
+    if(obj->surface())
+        m_surfaceIndex.insert(obj->surface(), obj);
+}
+
+void Compositor::unregisterSurface(Surface *obj)
+{
+    zorderRemove(obj);
+
+    auto it = m_liveSurfaces.find(obj);
+    if(it == m_liveSurfaces.end())
+        return;
+
+    // the wl_surface may already be gone, so use the key we indexed under
+    if(it.value() && m_surfaceIndex.value(it.value()) == obj)
+        m_surfaceIndex.remove(it.value());
+    m_liveSurfaces.erase(it);
+    m_surfaces.removeOne(obj);
+}
+
+void Compositor::zorderAppend(Surface *obj)
+{
+    zorderRemove(obj);
+
+    obj->m_zprev = m_zorderTail;
+    obj->m_znext = nullptr;
+    if(m_zorderTail)
+        m_zorderTail->m_znext = obj;
+    else
+        m_zorderHead = obj;
+    m_zorderTail = obj;
+    obj->m_inZOrder = true;
+    m_zorderDirty = true;
+    invalidateHitTests();
+}
+
+void Compositor::zorderRemove(Surface *obj)
+{
+    if(!obj || !obj->m_inZOrder)
+        return;
+
+    if(obj->m_zprev)
+        obj->m_zprev->m_znext = obj->m_znext;
+    else
+        m_zorderHead = obj->m_znext;
+
+    if(obj->m_znext)
+        obj->m_znext->m_zprev = obj->m_zprev;
+    else
+        m_zorderTail = obj->m_zprev;
+
+    obj->m_zprev = obj->m_znext = nullptr;
+    obj->m_inZOrder = false;
+    m_zorderDirty = true;
+    invalidateHitTests();
+}
+
+QVector<Surface*> Compositor::surfaceByZOrder() const
+{
+    // painting and hit testing ask for this far more often than it changes
+    if(m_zorderDirty)
+    {
+        m_zorderCache.clear();
+        for(Surface *obj = m_zorderHead; obj; obj = obj->m_znext)
+            m_zorderCache.append(obj);
+        m_zorderDirty = false;
     }
-    return nullptr;
+    return m_zorderCache;
 }
 
 void Compositor::onMenuServerRequest(OriginullMenuServer *menu)
@@ -615,31 +706,20 @@ void Compositor::raiseNextInLine()
     m_tl_raised = nullptr;
     m_activated = nullptr;
 
-    int sc = m_zorder.count();
     bool raised = false;
-    if(m_zorder.count() > 0)
+    for(Surface *obj = m_zorderTail; obj; obj = obj->m_zprev)
     {
-        for(auto i = m_zorder.count()-1; i >= 0; --i)
+        if(obj->isInitialized())
         {
-            if(m_zorder.count() != sc)
-                return raiseNextInLine();
-
-            if(m_zorder.at(i))
+            if(obj->xdgTopLevel() != nullptr ||
+                obj->qtSurface() != nullptr ||
+                obj->gtkSurface() != nullptr)
             {
-                Surface* obj = m_zorder.at(i);
-                if(obj && obj->isInitialized())
+                if(!obj->isMinimized())
                 {
-                    if(obj->xdgTopLevel() != nullptr ||
-                        obj->qtSurface() != nullptr ||
-                        obj->gtkSurface() != nullptr)
-                    {
-                        if(obj->isInitialized() && !obj->isMinimized())
-                        {
-                            raise(obj);
-                            raised = true;
-                            break;
-                        }
-                    }
+                    raise(obj);
+                    raised = true;
+                    break;
                 }
             }
         }
@@ -665,7 +745,7 @@ void Compositor::onXdgPopupCreated(HWWaylandXdgPopup *popup, HWWaylandXdgSurface
 {
     Surface *mySurface = findSurfaceObject(surface->surface());
     Q_ASSERT(mySurface);
-    m_zorder.removeOne(mySurface);
+    zorderRemove(mySurface);
     auto uuid = mySurface->uuid().toString(QUuid::WithoutBraces).toUtf8().data();
     qCDebug(hwCompositor, "%s: xdg_popup created", uuid);
     mySurface->createXdgPopupSurface(popup);
@@ -770,7 +850,7 @@ void Compositor::onSubsurfaceChanged(QWaylandSurface *child, QWaylandSurface *pa
     obj->setParentSurfaceObject(objParent);
     obj->setSubsurface(true);
     obj->m_surfaceInit = true;
-    m_zorder.removeOne(obj);
+    zorderRemove(obj);
 }
 
 void Compositor::onSubsurfacePositionChanged(const QPoint &position)
@@ -803,6 +883,12 @@ void Compositor::triggerRender()
         m_console_output->triggerRender();
 }
 
+void Compositor::invalidateHitTests()
+{
+    if(m_console_output)
+        m_console_output->invalidateHitTests();
+}
+
 void Compositor::lockSession()
 {
 
@@ -887,10 +973,10 @@ void Compositor::adjustCursorSurface(QWaylandSurface *surface, int hotspotX, int
                     qCritical() << "Compositor::adjustCursorSurface: couldn't disconnect QWaylandSurface::redraw";
                 }
             }
-            if(m_surfaces.contains(m_cursorObject))
+            if(isSurfaceAlive(m_cursorObject))
             {
             qDebug() << "Compositor::adjustCursorSurface: removing old cursor from surface list";
-            m_surfaces.removeOne(m_cursorObject);
+            unregisterSurface(m_cursorObject);
             }
 
             if(m_cursorObject)
@@ -910,7 +996,7 @@ void Compositor::adjustCursorSurface(QWaylandSurface *surface, int hotspotX, int
             outputAt = m_console_output->primaryOutput();
 
         m_cursorObject->createViewForOutput(outputAt);
-        m_surfaces.append(m_cursorObject);
+        registerSurface(m_cursorObject);
         if(surface)
         {
             m_cursorObject->surface()->markAsCursorSurface(true);
@@ -975,6 +1061,7 @@ void Compositor::handleMouseEvent(QWaylandView *target, QMouseEvent *me)
 void Compositor::handleResize(SurfaceView *target, const QSize &initialSize, const QPoint &delta, int edge)
 {
     auto qedge = static_cast<Qt::Edges>(edge);
+    invalidateHitTests();
 
     // This function is handled on compositor level as it is triggered
     // From the QWindow of individual screens
@@ -1061,7 +1148,8 @@ void Compositor::handleDrag(SurfaceView *target, QMouseEvent *me)
         defaultSeat()->setMouseFocus(nullptr);
         surface->updateSelection();
         currentDrag->drop();
-        m_surfaces.removeOne(findSurfaceObject(currentDrag->icon()));
+        if(auto icon = findSurfaceObject(currentDrag->icon()))
+            unregisterSurface(icon);
     }
 }
 
@@ -1078,7 +1166,7 @@ void Compositor::raise(Surface *obj)
         return;
     }
 
-    if(!m_surfaces.contains(obj))
+    if(!isSurfaceAlive(obj))
     {
         qCDebug(hwCompositor, "request to raise recycled surface");
         return;
@@ -1093,14 +1181,13 @@ void Compositor::raise(Surface *obj)
 
     auto uuid = obj->uuid().toString(QUuid::WithoutBraces).toUtf8().data();
     qCDebug(hwCompositor, "%s: raise", uuid);
-    if(!m_zorder.contains(obj))
+    if(!obj->m_inZOrder)
     {
         activate(obj);
         return;
     }
 
-    m_zorder.removeOne(obj);
-    m_zorder.push_back(obj);
+    zorderAppend(obj);
     activate(obj);
     // Since the compositor is only tracking unparented objects
     // we leave the ordering of children to SurfaceObject
@@ -1178,6 +1265,19 @@ bool Compositor::useAnimations() const
     return true;
 }
 
+void Compositor::reportFirstFrame()
+{
+    if(m_reported_frame)
+        return;
+
+    // the session manager watches our stdout for this to release the
+    // processes that need a working display
+    m_reported_frame = true;
+    fprintf(stdout, "%s\n", HOLLYWOOD_COMPOSITOR_READY);
+    fflush(stdout);
+    qCInfo(hwCompositor, "First frame presented");
+}
+
 void Compositor::resetIdle()
 {
     return;
@@ -1249,8 +1349,25 @@ int main(int argc, char *argv[])
     }
 
     qputenv("QT_QPA_PLATFORM", "hwc-eglfs");
+
+    // --headless[=OUTPUTS] renders to virtual outputs without DRM or a
+    // logind session, see the eglfs_headless device integration
+    bool headless = false;
+    for(int i = 1; i < argc; ++i)
+    {
+        QByteArray arg(argv[i]);
+        if(arg != "--headless" && !arg.startsWith("--headless="))
+            continue;
+
+        headless = true;
+        qputenv("QT_QPA_EGLFS_INTEGRATION", "eglfs_headless");
+        if(arg.startsWith("--headless="))
+            qputenv("QT_QPA_EGLFS_HEADLESS_OUTPUTS", arg.mid(11));
+    }
+
     if(!is_sddm)
     {
+        // a stray SIGINT must not end the user's session
         struct sigaction sa;
         sa.sa_flags = 0;
         sigemptyset(&sa.sa_mask);
@@ -1267,5 +1384,14 @@ int main(int argc, char *argv[])
     CompositorApp app(is_sddm, argc, argv);
     app.doInit();
 
+    // headless runs (the benchmark runner) are stopped with SIGINT, quit
+    // through the event loop so the frame statistics get written out
+    UnixSignalWatcher sigwatch;
+    if(headless && !is_sddm)
+    {
+        sigwatch.watchForSignal(SIGINT);
+        QObject::connect(&sigwatch, &UnixSignalWatcher::unixSignal, &app, &QCoreApplication::quit);
+    }
+
     return app.exec();
 }
@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
 #include "decoration.h"
+#include "decorationtitle.h"
 #include "outputwnd.h"
 #include "surfaceobject.h"
 #include <hollywood/hollywood.h>
@@ -11,7 +12,6 @@
 #include <QVector>
 #include <cmath>
 #include <GLES3/gl3.h>
-#include <QStaticText>
 #include <QOpenGLFunctions>
 #include <QOpenGLShaderProgram>
 #include <QPainter>
@@ -24,6 +24,7 @@ ServerSideDecoration::ServerSideDecoration(Surface *parent)
     : QObject(nullptr)
     , m_parent(parent)
     , m_dark_mode(false)
+    , m_title(new DecorationTitle(this))
 {
     if(g_shader == nullptr)
     {
@@ -56,6 +57,7 @@ ServerSideDecoration::ServerSideDecoration(Surface *parent)
     createWindowIconTexture();
 
     connect(m_parent, &Surface::iconChanged, this, &ServerSideDecoration::iconChanged);
+    connect(m_title, &DecorationTitle::ready, hwComp, &Compositor::triggerRender);
 }
 
 ServerSideDecoration::~ServerSideDecoration()
@@ -73,7 +75,7 @@ void ServerSideDecoration::paintGL(OutputWindow *window, QOpenGLFramebufferObjec
     scissorContentArea(window);
     renderIcon(window);
     renderGems(window);
-    renderTitle(fbo);
+    renderTitle(window);
 }
 
 bool ServerSideDecoration::hasWindowIcon() const
@@ -226,39 +228,47 @@ void ServerSideDecoration::renderIcon(OutputWindow *window)
     renderGem(functions, start, QSize(is,is), m_window_icon);
 }
 
-void ServerSideDecoration::renderTitle(QOpenGLFramebufferObject *fbo)
+void ServerSideDecoration::renderTitle(OutputWindow *window)
 {
-    QString windowTitleText = m_parent->windowTitle();
-    if (!windowTitleText.isEmpty())
-    {
-        QStaticText m_windowTitle;
-        if (m_windowTitle.text() != windowTitleText) {
-            m_windowTitle.setText(windowTitleText);
-            m_windowTitle.prepare();
-        }
-
-        QOpenGLPaintDevice pd(fbo->size());
-        QPainter p(&pd);
-        QFont font = p.font();
-        font.setPixelSize(fontSize());
-        p.setFont(font);
-        QFontMetrics m(p.font());
-        auto start = decorationRenderStartPoint();
-        auto decoheight = hwComp->decorationSize();
-        auto is = iconSize();
-        auto start_y = (decoheight-is)/2;
-        start.setY(start.y()+start_y+15);
-        //start.setY(start.y()+((hwComp->decorationSize()-m.height())/2));
-        //qDebug() << m.height() << start.y();
-        start.setX(start.x()+paddingSize());
-        if(hasWindowIcon())
-            start.setX(start.x()+paddingSize()+iconSize());
-
-
-        p.setPen(QColor(Qt::black));
-        p.drawText(start, windowTitleText);
-        p.end();
-    }
+    auto is = iconSize();
+    auto padding = paddingSize();
+
+    // the title sits between the window icon and the gems
+    int reserved = padding*2;
+    if(hasWindowIcon())
+        reserved += padding+is;
+    if(hasCloseIcon())
+        reserved += padding+is;
+    if(hasMaximizeIcon() && m_parent->canMaximize())
+        reserved += padding+is;
+    if(hasMinimizeIcon() && m_parent->canMinimize())
+        reserved += padding+is;
+
+    QColor color = m_fg_color;
+    if(hwComp->activatedSurface() != m_parent)
+        color.setAlpha(160);
+
+    DecorationTitle::Key key;
+    key.text = m_parent->windowTitle();
+    key.pixelSize = fontSize();
+    key.maxWidth = m_parent->surfaceSize().width() - reserved;
+    key.color = color.rgba();
+    m_title->update(key);
+
+    auto texture = m_title->texture();
+    if(!texture)
+        return;
+
+    auto start = decorationRenderStartPoint();
+    auto decoheight = hwComp->decorationSize();
+    auto start_y = (decoheight-is)/2;
+    // baseline
+    start.setY(start.y()+start_y+15-m_title->ascent());
+    start.setX(start.x()+padding);
+    if(hasWindowIcon())
+        start.setX(start.x()+padding+is);
+
+    renderGem(window->context()->functions(), start, m_title->size(), texture);
 }
 
 void ServerSideDecoration::scissorContentArea(OutputWindow *window)
@@ -0,0 +1,223 @@
+// Hollywood Wayland Compositor
+// SPDX-FileCopyrightText: 2024 Originull Software
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "decorationtitle.h"
+#include "decoration.h"
+
+#include <QtConcurrent/QtConcurrentRun>
+#include <QOpenGLTexture>
+#include <QFontMetrics>
+#include <QTextLayout>
+#include <QRawFont>
+#include <QMutex>
+#include <QHash>
+#include <cmath>
+
+// Coverage masks of every glyph any decoration has drawn, shared between
+// the worker threads. Window titles reuse a small set of glyphs, so once
+// warm a new title is just a matter of copying masks around.
+class TitleGlyphCache
+{
+public:
+    struct Glyph {
+        QImage mask;    // Format_Alpha8
+        QPoint offset;  // from the pen position on the baseline
+    };
+
+    static TitleGlyphCache* instance()
+    {
+        static TitleGlyphCache cache;
+        return &cache;
+    }
+
+    Glyph glyph(const QRawFont &font, quint32 index)
+    {
+        const QString key = QString("%1/%2/%3/%4/%5").arg(font.familyName(), font.styleName())
+                                .arg(font.pixelSize()).arg(font.weight()).arg(index);
+
+        QMutexLocker lock(&m_lock);
+        auto it = m_glyphs.constFind(key);
+        if(it != m_glyphs.constEnd())
+            return it.value();
+        lock.unlock();
+
+        Glyph g;
+        QImage map = font.alphaMapForGlyph(index, QRawFont::PixelAntialiasing);
+        if(map.format() == QImage::Format_Indexed8)
+        {
+            // older engines hand back an index per coverage level
+            g.mask = QImage(map.size(), QImage::Format_Alpha8);
+            for(int y = 0; y < map.height(); ++y)
+                memcpy(g.mask.scanLine(y), map.constScanLine(y), map.width());
+        }
+        else
+            g.mask = map.convertToFormat(QImage::Format_Alpha8);
+
+        const QRectF br = font.boundingRect(index);
+        g.offset = QPoint(std::floor(br.x()), std::floor(br.y()));
+
+        lock.relock();
+        // titles don't need much, but a stream of CJK titles shouldn't grow
+        // this without bound
+        if(m_glyphs.size() > 4096)
+            m_glyphs.clear();
+        m_glyphs.insert(key, g);
+        return g;
+    }
+
+private:
+    QMutex m_lock;
+    QHash<QString, Glyph> m_glyphs;
+};
+
+DecorationTitle::DecorationTitle(QObject *parent)
+    : QObject(parent)
+    , m_watcher(new QFutureWatcher<Raster>(this))
+{
+    connect(m_watcher, &QFutureWatcher<Raster>::finished, this, &DecorationTitle::rasterized);
+}
+
+DecorationTitle::~DecorationTitle()
+{
+    if(m_texture)
+    {
+        m_texture->destroy();
+        delete m_texture;
+    }
+}
+
+void DecorationTitle::update(const Key &key)
+{
+    if(key == m_requested)
+        return;
+
+    m_requested = key;
+    // the result of the running job is stale, rasterized() starts over
+    if(m_watcher->isRunning())
+        return;
+
+    start();
+}
+
+void DecorationTitle::start()
+{
+    m_inflight = m_requested;
+    m_watcher->setFuture(QtConcurrent::run(&DecorationTitle::rasterize, m_inflight));
+}
+
+void DecorationTitle::rasterized()
+{
+    m_pending = m_watcher->result();
+    m_hasPending = true;
+
+    if(m_inflight != m_requested)
+        start();
+
+    emit ready();
+}
+
+QOpenGLTexture* DecorationTitle::texture()
+{
+    if(!m_hasPending)
+        return m_texture;
+
+    m_hasPending = false;
+    if(m_texture)
+    {
+        m_texture->destroy();
+        delete m_texture;
+        m_texture = nullptr;
+    }
+
+    m_size = m_pending.image.size();
+    m_ascent = m_pending.ascent;
+    if(m_pending.image.isNull())
+        return nullptr;
+
+    qCDebug(hwSSDRender, "DecorationTitle: uploading %ix%i title", m_size.width(), m_size.height());
+    m_texture = new QOpenGLTexture(QOpenGLTexture::Target2D);
+    m_texture->create();
+    m_texture->setSize(m_size.width(), m_size.height());
+    m_texture->setMagnificationFilter(QOpenGLTexture::Nearest);
+    m_texture->setMinificationFilter(QOpenGLTexture::Nearest);
+    m_texture->setWrapMode(QOpenGLTexture::ClampToEdge);
+    m_texture->setData(m_pending.image);
+    m_pending = Raster();
+    return m_texture;
+}
+
+// runs on a worker thread
+DecorationTitle::Raster DecorationTitle::rasterize(const Key &key)
+{
+    Raster r;
+    if(key.text.isEmpty() || key.maxWidth <= 0)
+        return r;
+
+    QFont font;
+    font.setPixelSize(key.pixelSize);
+    QFontMetrics fm(font);
+    const QString text = fm.elidedText(key.text, Qt::ElideRight, key.maxWidth);
+    if(text.isEmpty())
+        return r;
+
+    QTextLayout layout(text, font);
+    layout.beginLayout();
+    QTextLine line = layout.createLine();
+    line.setLineWidth(key.maxWidth);
+    layout.endLayout();
+
+    const int width = qMin(key.maxWidth, int(std::ceil(line.naturalTextWidth())) + 1);
+    const int height = int(std::ceil(line.ascent() + line.descent()));
+    if(width <= 0 || height <= 0)
+        return r;
+
+    r.ascent = int(std::ceil(line.ascent()));
+    r.image = QImage(width, height, QImage::Format_ARGB32_Premultiplied);
+    r.image.fill(Qt::transparent);
+
+    const uint ca = qAlpha(key.color);
+    const uint cr = qRed(key.color), cg = qGreen(key.color), cb = qBlue(key.color);
+
+    // composite the cached masks in the title colour (source over)
+    for(const QGlyphRun &run : layout.glyphRuns())
+    {
+        const QRawFont raw = run.rawFont();
+        const auto indexes = run.glyphIndexes();
+        const auto positions = run.positions();
+        for(int i = 0; i < indexes.count(); ++i)
+        {
+            const auto glyph = TitleGlyphCache::instance()->glyph(raw, indexes[i]);
+            const int gx = int(std::round(positions[i].x())) + glyph.offset.x();
+            const int gy = int(std::round(positions[i].y())) + glyph.offset.y();
+
+            for(int y = 0; y < glyph.mask.height(); ++y)
+            {
+                const int dy = gy + y;
+                if(dy < 0 || dy >= height)
+                    continue;
+
+                const uchar *src = glyph.mask.constScanLine(y);
+                QRgb *dst = reinterpret_cast<QRgb*>(r.image.scanLine(dy));
+                for(int x = 0; x < glyph.mask.width(); ++x)
+                {
+                    const int dx = gx + x;
+                    if(dx < 0 || dx >= width || src[x] == 0)
+                        continue;
+
+                    const uint a = src[x] * ca / 255;
+                    const uint inv = 255 - a;
+                    const QRgb d = dst[dx];
+                    dst[dx] = qRgba(cr * a / 255 + qRed(d) * inv / 255,
+                                    cg * a / 255 + qGreen(d) * inv / 255,
+                                    cb * a / 255 + qBlue(d) * inv / 255,
+                                    a + qAlpha(d) * inv / 255);
+                }
+            }
+        }
+    }
+
+    // QOpenGLTexture and the blitter want straight alpha
+    r.image = r.image.convertToFormat(QImage::Format_ARGB32);
+    return r;
+}
@@ -0,0 +1,175 @@
+// Hollywood Wayland Compositor
+// SPDX-FileCopyrightText: 2024 Originull Software
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "framestats.h"
+#include "outputwnd.h"
+#include "compositor.h"
+
+#include <QFile>
+#include <QGuiApplication>
+#include <QTimer>
+#include <QScreen>
+#include <QOpenGLContext>
+#include <QOpenGLTimerQuery>
+
+#include <time.h>
+
+// records from every output go to one file so lines never interleave
+static QFile* statsSink()
+{
+    static QFile *sink = nullptr;
+    if(sink)
+        return sink;
+
+    sink = new QFile(QString::fromLocal8Bit(qgetenv("HWC_FRAME_STATS")));
+    if(!sink->open(QIODevice::WriteOnly|QIODevice::Append|QIODevice::Text))
+        qCWarning(hwCompositor, "FrameStats: can't open %s: %s",
+                  qPrintable(sink->fileName()), qPrintable(sink->errorString()));
+    return sink;
+}
+
+// microseconds on CLOCK_MONOTONIC, the same clock the benchmark clients
+// stamp their own events with
+static qint64 monotonicUs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return qint64(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+FrameStats* FrameStats::create(OutputWindow *window)
+{
+    if(!qEnvironmentVariableIsSet("HWC_FRAME_STATS"))
+        return nullptr;
+
+    if(!statsSink()->isOpen())
+        return nullptr;
+
+    return new FrameStats(window);
+}
+
+FrameStats::FrameStats(OutputWindow *window)
+    : QObject(window)
+    , m_window(window)
+{
+    connect(window, &QOpenGLWindow::frameSwapped, this, &FrameStats::frameSwapped);
+
+    // pending queries have to be read back and released while the
+    // context still exists
+    connect(window->context(), &QOpenGLContext::aboutToBeDestroyed, this, [this]() {
+        collect(true);
+        qDeleteAll(m_freeQueries);
+        m_freeQueries.clear();
+        m_timerQueries = false;
+        statsSink()->flush();
+    });
+
+    // frames still waiting on their GPU timer would be lost on quit
+    connect(qApp, &QCoreApplication::aboutToQuit, this, [this]() {
+        if(m_window->context())
+        {
+            m_window->makeCurrent();
+            collect(true);
+            m_window->doneCurrent();
+        }
+        statsSink()->flush();
+    });
+
+    auto flush = new QTimer(this);
+    flush->setInterval(1000);
+    connect(flush, &QTimer::timeout, this, []() { statsSink()->flush(); });
+    flush->start();
+}
+
+FrameStats::~FrameStats()
+{
+    statsSink()->flush();
+}
+
+void FrameStats::beginFrame()
+{
+    m_current = Frame();
+    m_current.number = ++m_frames;
+    m_current.start = monotonicUs();
+
+    if(!m_timerQueries)
+        return;
+
+    QOpenGLTimerQuery *query = nullptr;
+    if(!m_freeQueries.isEmpty())
+        query = m_freeQueries.takeLast();
+    else
+    {
+        query = new QOpenGLTimerQuery(this);
+        if(!query->create())
+        {
+            // GLES drivers without EXT_disjoint_timer_query end up here
+            qCInfo(hwCompositor, "FrameStats: GPU timer queries unavailable");
+            delete query;
+            m_timerQueries = false;
+            return;
+        }
+    }
+
+    query->begin();
+    m_current.query = query;
+}
+
+void FrameStats::endFrame()
+{
+    m_current.cpu = monotonicUs() - m_current.start;
+    if(m_current.query)
+        m_current.query->end();
+}
+
+void FrameStats::frameSwapped()
+{
+    // a frame that never went through beginFrame (eg. while asleep)
+    if(m_current.number == 0)
+        return;
+
+    m_current.swap = monotonicUs() - m_current.start;
+
+    // every full refresh interval spent between starting the paint and
+    // the swap completing is a vblank this output missed
+    const qreal refresh = m_window->screen() ? m_window->screen()->refreshRate() : 0;
+    if(refresh > 0)
+    {
+        const qint64 interval = qint64(1000000 / refresh);
+        m_current.dropped = int(m_current.swap / interval);
+    }
+
+    m_pending.enqueue(m_current);
+    m_current = Frame();
+    collect(false);
+}
+
+void FrameStats::collect(bool wait)
+{
+    while(!m_pending.isEmpty())
+    {
+        Frame &frame = m_pending.head();
+        qint64 gpu = -1;
+        if(frame.query)
+        {
+            if(!wait && !frame.query->isResultAvailable())
+                break;
+            gpu = qint64(frame.query->waitForResult() / 1000);
+            m_freeQueries.append(frame.query);
+        }
+        write(frame, gpu);
+        m_pending.dequeue();
+    }
+}
+
+void FrameStats::write(const Frame &frame, qint64 gpu)
+{
+    const QString output = m_window->screen() ? m_window->screen()->name() : QString();
+    const QByteArray line = QStringLiteral(
+        "{\"output\":\"%1\",\"frame\":%2,\"t_us\":%3,\"cpu_us\":%4,"
+        "\"gpu_us\":%5,\"swap_us\":%6,\"dropped\":%7}\n")
+        .arg(output).arg(frame.number).arg(frame.start).arg(frame.cpu)
+        .arg(gpu).arg(frame.swap).arg(frame.dropped).toUtf8();
+    statsSink()->write(line);
+}
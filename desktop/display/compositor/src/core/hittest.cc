@@ -0,0 +1,60 @@
+// Hollywood Wayland Compositor
+// SPDX-FileCopyrightText: 2024 Originull Software
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "hittest.h"
+
+HitTestGrid::HitTestGrid(int cellSize)
+    : m_cellSize(cellSize)
+{
+}
+
+void HitTestGrid::clear()
+{
+    m_entries.clear();
+    // keep the cells' storage around, the next rebuild mostly refills the
+    // same ones
+    for(auto it = m_cells.begin(); it != m_cells.end(); ++it)
+        it->clear();
+}
+
+int HitTestGrid::cellCoord(int v) const
+{
+    // round towards negative infinity, outputs left of or above the
+    // primary have negative coordinates
+    return v >= 0 ? v / m_cellSize : -((-v - 1) / m_cellSize) - 1;
+}
+
+void HitTestGrid::add(Surface *surface, const QRect &rect)
+{
+    if(!surface || rect.isEmpty())
+        return;
+
+    const int index = m_entries.count();
+    m_entries.append(Entry{surface, rect});
+
+    const int x0 = cellCoord(rect.left()), x1 = cellCoord(rect.right());
+    const int y0 = cellCoord(rect.top()), y1 = cellCoord(rect.bottom());
+    for(int y = y0; y <= y1; ++y)
+        for(int x = x0; x <= x1; ++x)
+            m_cells[cellKey(x, y)].append(index);
+}
+
+Surface* HitTestGrid::topmost(const QPoint &pos, const Accept &accept) const
+{
+    auto it = m_cells.constFind(cellKey(cellCoord(pos.x()), cellCoord(pos.y())));
+    if(it == m_cells.constEnd())
+        return nullptr;
+
+    const Cell &cell = it.value();
+    for(int i = cell.count() - 1; i >= 0; --i)
+    {
+        const Entry &e = m_entries.at(cell.at(i));
+        if(!e.rect.contains(pos))
+            continue;
+        if(accept && !accept(e.surface, pos))
+            continue;
+        return e.surface;
+    }
+    return nullptr;
+}
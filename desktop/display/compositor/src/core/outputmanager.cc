@@ -135,6 +135,12 @@ void OutputManager::triggerRender()
         out->window()->requestUpdate();
 }
 
+void OutputManager::invalidateHitTests()
+{
+    for(auto out : m_outputs)
+        out->window()->invalidateHitTest();
+}
+
 Output *OutputManager::primaryOutput()
 {
     for(auto out : m_outputs)
@@ -5,6 +5,8 @@
 #include "outputwnd.h"
 #include "compositor.h"
 #include "decoration.h"
+#include "framestats.h"
+#include "shadowatlas.h"
 
 // include gles for x64
 #include <GLES3/gl3.h>
@@ -38,11 +40,10 @@
 #include "shortcuts.h"
 #include "relativepointer.h"
 #include "screencopy.h"
+#include "thumbnail.h"
 
 Q_LOGGING_CATEGORY(hwRender, "compositor.render")
 
-unsigned int VBO;
-
 /*static const GLfloat vertex_buffer_data[] {
      -1,-1,0,
      -1,1,0,
@@ -63,7 +64,6 @@ static const GLfloat texture_buffer_data[] {
 
 OutputWindow::OutputWindow()
     : QOpenGLWindow(QOpenGLWindow::NoPartialUpdate)
-    , m_shadowShader(new QOpenGLShaderProgram(this))
     , m_wpm(new WallpaperManager(this))
 {
     QSurfaceFormat format;
@@ -75,6 +75,8 @@ OutputWindow::OutputWindow()
     connect(hwComp, &Compositor::startMove, this, &OutputWindow::startMove);
     connect(hwComp, &Compositor::startResize, this, &OutputWindow::startResize);
     connect(hwComp, &Compositor::dragStarted, this, &OutputWindow::startDrag);
+    connect(this, &QOpenGLWindow::frameSwapped, hwComp, &Compositor::reportFirstFrame,
+            Qt::SingleShotConnection);
 }
 
 int OutputWindow::width()
@@ -95,6 +97,12 @@ void OutputWindow::setupScreenCopyFrame(WlrScreencopyFrameV1 *frame)
     connect(frame, &WlrScreencopyFrameV1::ready, this, &OutputWindow::readyForScreenCopy);
 }
 
+void OutputWindow::queueThumbnail(WindowThumbnail *thumbnail)
+{
+    if(!m_thumbnails.contains(thumbnail))
+        m_thumbnails.append(thumbnail);
+}
+
 void OutputWindow::setOutput(Output *output)
 {
     m_output = output;
@@ -104,9 +112,9 @@ void OutputWindow::initializeGL()
 {
     m_textureBlitter.create();
     m_wpm->setup();
-    m_shadowShader->addCacheableShaderFromSourceFile(QOpenGLShader::Vertex, ":/Shaders/shadow.vsh");
-    m_shadowShader->addCacheableShaderFromSourceFile(QOpenGLShader::Fragment, ":/Shaders/shadow.fsh");
-    m_shadowShader->link();
+    m_shadowAtlas.initialize();
+    m_thumbnailRenderer.initialize();
+    m_frameStats = FrameStats::create(this);
 }
 
 void OutputWindow::paintGL()
@@ -119,6 +127,9 @@ void OutputWindow::paintGL()
         return;
     }
 
+    if(m_frameStats)
+        m_frameStats->beginFrame();
+
     hwComp->startRender();
     // render our background & wallpaper
     m_wpm->clearBackgroundColor();
@@ -164,7 +175,14 @@ void OutputWindow::paintGL()
             m_copy_frame = nullptr;
         }
     }
+
+    if(!m_thumbnails.isEmpty())
+        renderThumbnails();
+
     hwComp->endRender();
+
+    if(m_frameStats)
+        m_frameStats->endFrame();
 }
 
 QPointF OutputWindow::getAnchorPosition(const QPointF &position, int resizeEdge, const QSize &windowSize)
@@ -206,7 +224,7 @@ void OutputWindow::drawTextureForObject(Surface *obj)
     if(!obj->surfaceReadyToRender())
         return;
 
-    if(!hwComp->surfaceObjects().contains(obj))
+    if(!hwComp->isSurfaceAlive(obj))
     {
         qCDebug(hwRender, "drawTextureForObject: attempting to render recycled object");
         return;
@@ -333,6 +351,26 @@ void OutputWindow::drawTextureForObject(Surface *obj)
     }
 }
 
+void OutputWindow::renderThumbnails()
+{
+    // thumbnails are scaled from the window's own texture, not from the
+    // scene, so they don't need the window to be visible on this output
+    const auto thumbnails = m_thumbnails;
+    m_thumbnails.clear();
+    for(const auto &thumb : thumbnails)
+    {
+        if(!thumb || !thumb->prepare())
+            continue;
+
+        Surface *obj = thumb->surface();
+        auto view = obj->viewForOutput(m_output);
+        auto texture = view->getTexture();
+        QImage image = m_thumbnailRenderer.render(texture, view->textureOrigin(),
+                                                  obj->surface()->bufferSize(), thumb->size());
+        thumb->deliver(image);
+    }
+}
+
 void OutputWindow::drawPopupsForObject(Surface *obj)
 {
     if(obj->isCursor())
@@ -353,64 +391,18 @@ void OutputWindow::drawShadowForObject(uint shadowOffset, Surface *obj)
     if(obj == m_dragIconSurfaceObject)
         return;
 
-    uint sm = shadowOffset;
-
-    QOpenGLFunctions *functions = context()->functions();
-    functions->glEnable(GL_BLEND);
-    functions->glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-    auto angle = 95;
-    auto z = 1+sin(angle*4);
-    auto r = 28 + z;
-    float corner = r * (0.5 + 0.5 * cos(2*angle));
-    float sigma = z*10;
-
-    functions->glUseProgram(m_shadowShader->programId());
-    m_shadowShader->bind();
-    glGenBuffers(1,&VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    float data[] = {0,0,1,0,0,1,1,1};
-    glBufferData(GL_ARRAY_BUFFER, sizeof(data), data, GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 2, GL_FLOAT, false, 0, 0);
-
-    auto bs = hwComp->borderSize();
-    auto ds = hwComp->decorationSize();
-
-    uint hsm = sm/2;
-    // box: x, y, width, height
-    // opengl uses a bottom left point
-    //int starty = m_fbo->height() - hsm - obj->decoratedRect().height() - hsm;
-    int startx = hsm;
-    int starty = hsm;
-    int width = m_fbo->width() - hsm;
-    int height = m_fbo->height() - hsm;
-    // xmin ymin xmax ymax
-    m_shadowShader->setUniformValue("box", startx, starty,
-                                    height,width);
+    // the shadow surrounds the decorated window, which sits shadowOffset
+    // in from each edge of the FBO
+    const int sm = shadowOffset;
+    const QRect frame(sm, sm, m_fbo->width() - sm*2, m_fbo->height() - sm*2);
+
+    ShadowAtlas::Style style = ShadowAtlas::Inactive;
     if(obj->isXdgPopup())
-        m_shadowShader->setUniformValue("color", 0, 0, 0, 0.30);
-    else
-        m_shadowShader->setUniformValue("color", 0, 0, 0, 0.45);
-    m_shadowShader->setUniformValue("sigma", sigma);
-    m_shadowShader->setUniformValue("corner", corner);
-    m_shadowShader->setUniformValue("window", m_fbo->height(), m_fbo->width());
-    functions->glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-    glDeleteBuffers(1,&VBO);
-
-    m_shadowShader->release();
-
-    auto rect = QRect(sm+bs,sm+bs,obj->surfaceSize().width(),obj->surfaceSize().height());
-    // offset our rect start for titlebars
-    if(obj->serverDecorated())
-        rect.setHeight(rect.height()+ds);
-
-    functions->glEnable(GL_SCISSOR_TEST);
-    functions->glScissor(rect.x(), rect.y(), rect.width(), rect.height());
-    functions->glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-    functions->glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    functions->glDisable(GL_SCISSOR_TEST);
-    functions->glDisable(GL_BLEND);
+        style = ShadowAtlas::Popup;
+    else if(obj->activated())
+        style = ShadowAtlas::Active;
+
+    m_shadowAtlas.draw(m_fbo->size(), frame, shadowOffset, style);
 }
 
 void OutputWindow::drawDesktopInfoString()
@@ -447,122 +439,96 @@ SurfaceView *OutputWindow::viewAt(const QPointF &point)
 
 Surface* OutputWindow::surfaceAt(const QPointF &point)
 {
-    Surface *ret = nullptr;
+    if(m_hitTestDirty)
+        rebuildHitTest();
+
     QPoint adjustedPoint(m_output->position().x()+point.x(),
                  m_output->position().y()+point.y());
 
-    for(auto surf : hwComp->overlayLayerSurfaces())
-    {
-        QRectF geom(surf->surfacePosition(), surf->surface()->bufferSize()*surf->surface()->bufferScale());
-        if (geom.contains(point))
-            ret = surf;
+    return m_hitTest.topmost(adjustedPoint, [](Surface *surface, const QPoint &pos) {
+        if(!surface->surface() || surface->isMinimized())
+            return false;
 
-        // check children of the menuserver
-        for(auto *s : surf->childSurfaceObjects())
-        {
-            QRectF geom(s->surfacePosition(), s->surface()->bufferSize()*surf->surface()->bufferScale());
-            if (geom.contains(adjustedPoint))
-                ret = s;
-        }
-    }
+        // decorations and the resize margin are ours, the rest is up to
+        // the client's input region
+        QRect content(surface->surfacePosition().toPoint(), surface->surfaceSize());
+        if(!content.contains(pos))
+            return true;
 
-    for(auto surf : hwComp->topLayerSurfaces())
-    {
-        QRectF geom(surf->surfacePosition(), surf->surface()->bufferSize()*surf->surface()->bufferScale());
-        if (geom.contains(point))
-            ret = surf;
+        return surface->surface()->inputRegionContains(pos - content.topLeft());
+    });
+}
 
-        // check children of the tolayer surfaces
-        for(auto *s : surf->childSurfaceObjects())
-        {
-            QRectF geom(s->surfacePosition(), s->surface()->bufferSize()*surf->surface()->bufferScale());
-            if (geom.contains(adjustedPoint))
-                ret = s;
-        }
-    }
+void OutputWindow::invalidateHitTest()
+{
+    m_hitTestDirty = true;
+}
 
-    // we should check for children of the bottom layer surfaces
-    if(ret == nullptr)
-    {
-        const auto views = hwComp->bottomLayerSurfaces();
-        for (auto *s : views) {
-            for(auto *surface : s->childSurfaceObjects())
-            {
-                if (surface == m_dragIconSurfaceObject)
-                    continue;
-                QRectF geom(surface->surfacePosition(), surface->surface()->bufferSize()*surface->surface()->bufferScale());
-                if (geom.contains(adjustedPoint))
-                    ret = surface;
-            }
-        }
-    }
+void OutputWindow::rebuildHitTest()
+{
+    m_hitTestDirty = false;
+    m_hitTest.clear();
+
+    auto geometry = [](Surface *s) {
+        return QRect(s->surfacePosition().toPoint(),
+                     s->surface()->bufferSize()*s->surface()->bufferScale());
+    };
+    auto addPlain = [this, &geometry](Surface *s) {
+        if(s == m_dragIconSurfaceObject || !s->surface())
+            return;
+        m_hitTest.add(s, geometry(s));
+    };
 
-    // we should check for children of the background layer surfaces
-    if(ret == nullptr)
-    {
-        const auto views = hwComp->backgroundLayerSurfaces();
-        for (auto *s : views)
-        {
-            for(auto *surface : s->childSurfaceObjects())
-            {
-                if (surface == m_dragIconSurfaceObject)
-                    continue;
-                QRectF geom(surface->surfacePosition(), surface->surface()->bufferSize()*surface->surface()->bufferScale());
-                if (geom.contains(adjustedPoint))
-                    ret = surface;
-            }
-        }
-    }
+    // bottom-most first: the background and bottom layers, then normal
+    // windows with their popups by z-order, then the popups of the
+    // background and bottom layers (menus of the desktop and panels), then
+    // the top and overlay layers with their popups
+    for(auto *surface : hwComp->backgroundLayerSurfaces())
+        addPlain(surface);
 
-    // go through our standard surfaces by zorder
-    if(ret == nullptr)
+    for(auto *surface : hwComp->bottomLayerSurfaces())
+        addPlain(surface);
+
+    for(auto *surface : hwComp->surfaceByZOrder())
     {
-        const auto views = hwComp->surfaceByZOrder();
-        for (auto *surface : views) {
-            if (surface == m_dragIconSurfaceObject)
-                continue;
-            if(surface->isMinimized())
-                continue;
-            if(!surface->surface())
-                continue;
-
-            auto dr = surface->decoratedRect();
-            dr.adjust(-5,-5,5,5);
-            if (dr.contains(point))
-                ret = surface;
-            for(auto s : surface->childSurfaceObjects())
-            {
-                if (dr.contains(adjustedPoint))
-                    ret = s;
-            }
-        }
+        if(surface == m_dragIconSurfaceObject)
+            continue;
+        if(surface->isMinimized())
+            continue;
+        if(!surface->surface())
+            continue;
+
+        // a few pixels around the frame to grab for resizing
+        auto dr = surface->decoratedRect().toRect();
+        dr.adjust(-5,-5,5,5);
+        m_hitTest.add(surface, dr);
+
+        for(auto *child : surface->childSurfaceObjects())
+            addPlain(child);
     }
 
-    // target the actual bottom layer surface
-    if(ret == nullptr)
+    for(auto *surface : hwComp->backgroundLayerSurfaces())
+        for(auto *child : surface->childSurfaceObjects())
+            addPlain(child);
+
+    for(auto *surface : hwComp->bottomLayerSurfaces())
+        for(auto *child : surface->childSurfaceObjects())
+            addPlain(child);
+
+    for(auto *surface : hwComp->topLayerSurfaces())
     {
-        const auto views = hwComp->bottomLayerSurfaces();
-        for (auto *surface : views) {
-            if (surface == m_dragIconSurfaceObject)
-                continue;
-            QRectF geom(surface->surfacePosition(), surface->surface()->bufferSize()*surface->surface()->bufferScale());
-            if (geom.contains(adjustedPoint))
-                ret = surface;
-        }
+        addPlain(surface);
+        for(auto *child : surface->childSurfaceObjects())
+            addPlain(child);
     }
 
-    // target the actual background surface
-    if(ret == nullptr)
+    for(auto *surface : hwComp->overlayLayerSurfaces())
     {
-        const auto views = hwComp->backgroundLayerSurfaces();
-        for (auto *surface : views) {
-            QRectF geom(surface->surfacePosition(), surface->surface()->bufferSize()*surface->surface()->bufferScale());
-            if (geom.contains(adjustedPoint))
-                ret = surface;
-        }
+        addPlain(surface);
+        // menuserver popups
+        for(auto *child : surface->childSurfaceObjects())
+            addPlain(child);
     }
-
-    return ret;
 }
 
 void OutputWindow::startMove()
@@ -600,6 +566,7 @@ void OutputWindow::startDrag(Surface *dragIcon)
     }
     m_grabState = DragGrab;
     m_dragIconSurfaceObject = dragIcon;
+    invalidateHitTest();
     hwComp->raise(dragIcon);
 }
 
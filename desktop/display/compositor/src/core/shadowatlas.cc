@@ -0,0 +1,275 @@
+// Hollywood Wayland Compositor
+// SPDX-FileCopyrightText: 2024 Originull Software
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "shadowatlas.h"
+#include "outputwnd.h"
+
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLFramebufferObject>
+#include <cmath>
+
+// the blur the per-window shader pass used to compute every frame
+static const float ShadowSigma = 11.33f;
+static const float ShadowCorner = 15.54f;
+static const int InitialAtlasSize = 512;
+
+// vertices for the eight border quads: x, y, u, v
+static const int SliceVertices = 8 * 6;
+static const int VertexFloats = 4;
+
+// restores the caller's framebuffer and viewport when we have to draw
+// into the atlas in the middle of composing a window
+class FramebufferScope
+{
+public:
+    FramebufferScope(QOpenGLFunctions *f) : m_f(f)
+    {
+        m_f->glGetIntegerv(GL_FRAMEBUFFER_BINDING, &m_fbo);
+        m_f->glGetIntegerv(GL_VIEWPORT, m_viewport);
+    }
+    ~FramebufferScope()
+    {
+        m_f->glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+        m_f->glViewport(m_viewport[0], m_viewport[1], m_viewport[2], m_viewport[3]);
+    }
+private:
+    QOpenGLFunctions *m_f;
+    GLint m_fbo = 0;
+    GLint m_viewport[4];
+};
+
+ShadowAtlas::ShadowAtlas()
+    : m_vertices(QOpenGLBuffer::VertexBuffer)
+{
+}
+
+ShadowAtlas::~ShadowAtlas()
+{
+    delete m_atlas;
+    delete m_blurShader;
+    delete m_sliceShader;
+    m_vertices.destroy();
+}
+
+void ShadowAtlas::initialize()
+{
+    m_blurShader = new QOpenGLShaderProgram;
+    m_blurShader->addCacheableShaderFromSourceFile(QOpenGLShader::Vertex, ":/Shaders/shadow.vsh");
+    m_blurShader->addCacheableShaderFromSourceFile(QOpenGLShader::Fragment, ":/Shaders/shadow.fsh");
+    m_blurShader->link();
+
+    m_sliceShader = new QOpenGLShaderProgram;
+    m_sliceShader->addCacheableShaderFromSourceFile(QOpenGLShader::Vertex, ":/Shaders/shadowslice.vsh");
+    m_sliceShader->addCacheableShaderFromSourceFile(QOpenGLShader::Fragment, ":/Shaders/shadowslice.fsh");
+    m_sliceShader->link();
+
+    m_vertices.create();
+    m_vertices.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+    m_vertices.bind();
+    m_vertices.allocate(SliceVertices * VertexFloats * sizeof(float));
+    m_vertices.release();
+
+    reset(InitialAtlasSize);
+}
+
+void ShadowAtlas::reset(int size)
+{
+    qCDebug(hwRender, "ShadowAtlas: using %ix%i atlas", size, size);
+
+    QOpenGLFunctions *f = QOpenGLContext::currentContext()->functions();
+    FramebufferScope scope(f);
+
+    delete m_atlas;
+    QOpenGLFramebufferObjectFormat fmt;
+    fmt.setInternalTextureFormat(GL_RGBA);
+    fmt.setAttachment(QOpenGLFramebufferObject::NoAttachment);
+    m_atlas = new QOpenGLFramebufferObject(size, size, fmt);
+
+    m_atlas->bind();
+    f->glViewport(0, 0, size, size);
+    f->glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    f->glClear(GL_COLOR_BUFFER_BIT);
+
+    m_tiles.clear();
+    m_shelfX = m_shelfY = m_shelfHeight = 0;
+}
+
+bool ShadowAtlas::allocate(const QSize &size, QRect *rect)
+{
+    // simple shelf packing, there are only ever a handful of styles. the
+    // one pixel gutter keeps neighbouring tiles from bleeding into each other
+    if(m_shelfX + size.width() > m_atlas->width())
+    {
+        m_shelfX = 0;
+        m_shelfY += m_shelfHeight;
+        m_shelfHeight = 0;
+    }
+
+    if(size.width() > m_atlas->width() || m_shelfY + size.height() > m_atlas->height())
+        return false;
+
+    *rect = QRect(QPoint(m_shelfX, m_shelfY), size);
+    m_shelfX += size.width() + 1;
+    m_shelfHeight = qMax(m_shelfHeight, size.height() + 1);
+    return true;
+}
+
+const ShadowAtlas::Tile* ShadowAtlas::tile(const Key &key)
+{
+    auto it = m_tiles.constFind(key);
+    if(it != m_tiles.constEnd())
+        return &it.value();
+
+    // small margins (popups) get a tighter blur instead of a clipped one
+    const float sigma = qMin(ShadowSigma, key.radius / 3.0f);
+    const float corner = ShadowCorner;
+
+    // the middle two texels of each edge are where the frame's corners no
+    // longer contribute, so those rows and columns can be stretched
+    Tile t;
+    t.pad = int(std::ceil(3 * sigma));
+    t.slice = t.pad + int(std::ceil(corner + 3 * sigma));
+    const QSize size(2 * t.slice + 2, 2 * t.slice + 2);
+
+    if(!allocate(size, &t.rect))
+    {
+        GLint max = 0;
+        QOpenGLContext::currentContext()->functions()->glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max);
+        if(m_atlas->width() * 2 > max)
+        {
+            qCWarning(hwRender, "ShadowAtlas: out of space for shadow tiles");
+            return nullptr;
+        }
+
+        reset(m_atlas->width() * 2);
+        if(!allocate(size, &t.rect))
+            return nullptr;
+    }
+
+    renderTile(key, t, sigma, corner);
+    return &m_tiles.insert(key, t).value();
+}
+
+void ShadowAtlas::renderTile(const Key &key, const Tile &tile, float sigma, float corner)
+{
+    QOpenGLFunctions *f = QOpenGLContext::currentContext()->functions();
+    FramebufferScope scope(f);
+
+    const QRect &r = tile.rect;
+    m_atlas->bind();
+    f->glViewport(r.x(), r.y(), r.width(), r.height());
+    f->glDisable(GL_BLEND);
+
+    m_blurShader->bind();
+    // xmin ymin xmax ymax, local to the tile
+    m_blurShader->setUniformValue("box", float(tile.pad), float(tile.pad),
+                                  float(r.width() - tile.pad), float(r.height() - tile.pad));
+    switch(key.style)
+    {
+    case Popup:
+        m_blurShader->setUniformValue("color", 0.0f, 0.0f, 0.0f, 0.30f);
+        break;
+    case Inactive:
+        m_blurShader->setUniformValue("color", 0.0f, 0.0f, 0.0f, 0.35f);
+        break;
+    case Active:
+        m_blurShader->setUniformValue("color", 0.0f, 0.0f, 0.0f, 0.45f);
+        break;
+    }
+    m_blurShader->setUniformValue("sigma", sigma);
+    m_blurShader->setUniformValue("corner", corner);
+    m_blurShader->setUniformValue("window", float(r.width()), float(r.height()));
+
+    const float quad[] = { 0,0, 1,0, 0,1, 1,1 };
+    m_vertices.bind();
+    m_vertices.write(0, quad, sizeof(quad));
+    const int coord = m_blurShader->attributeLocation("coord");
+    m_blurShader->enableAttributeArray(coord);
+    m_blurShader->setAttributeBuffer(coord, GL_FLOAT, 0, 2);
+    f->glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    m_blurShader->disableAttributeArray(coord);
+    m_vertices.release();
+    m_blurShader->release();
+
+    // cut the frame out so the shadow never shows through the window
+    f->glEnable(GL_SCISSOR_TEST);
+    f->glScissor(r.x() + tile.pad, r.y() + tile.pad,
+                 r.width() - tile.pad * 2, r.height() - tile.pad * 2);
+    f->glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    f->glClear(GL_COLOR_BUFFER_BIT);
+    f->glDisable(GL_SCISSOR_TEST);
+}
+
+void ShadowAtlas::draw(const QSize &target, const QRect &frame, uint radius, Style style)
+{
+    if(!m_atlas || frame.isEmpty())
+        return;
+
+    const Tile *t = tile(Key{radius, style});
+    if(!t)
+        return;
+
+    const QRect outer = frame.adjusted(-t->pad, -t->pad, t->pad, t->pad);
+    // tiny windows squash the corners rather than overlap them
+    const int sx = qMin(t->slice, outer.width() / 2);
+    const int sy = qMin(t->slice, outer.height() / 2);
+
+    const float x[4] = { float(outer.left()), float(outer.left() + sx),
+                         float(outer.left() + outer.width() - sx), float(outer.left() + outer.width()) };
+    const float y[4] = { float(outer.top()), float(outer.top() + sy),
+                         float(outer.top() + outer.height() - sy), float(outer.top() + outer.height()) };
+
+    const QRect &r = t->rect;
+    const float aw = m_atlas->width(), ah = m_atlas->height();
+    const float u[4] = { r.left() / aw, (r.left() + t->slice) / aw,
+                         (r.left() + r.width() - t->slice) / aw, (r.left() + r.width()) / aw };
+    const float v[4] = { r.top() / ah, (r.top() + t->slice) / ah,
+                         (r.top() + r.height() - t->slice) / ah, (r.top() + r.height()) / ah };
+
+    float data[SliceVertices * VertexFloats];
+    float *p = data;
+    auto vertex = [&p, &x, &y, &u, &v](int i, int j) {
+        *p++ = x[i]; *p++ = y[j]; *p++ = u[i]; *p++ = v[j];
+    };
+    for(int j = 0; j < 3; ++j)
+    {
+        for(int i = 0; i < 3; ++i)
+        {
+            if(i == 1 && j == 1)
+                continue; // the window itself
+
+            vertex(i, j); vertex(i+1, j); vertex(i, j+1);
+            vertex(i+1, j); vertex(i+1, j+1); vertex(i, j+1);
+        }
+    }
+
+    QOpenGLFunctions *f = QOpenGLContext::currentContext()->functions();
+    f->glEnable(GL_BLEND);
+    f->glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    m_sliceShader->bind();
+    m_sliceShader->setUniformValue("viewport", float(target.width()), float(target.height()));
+    m_sliceShader->setUniformValue("atlas", 0);
+    f->glActiveTexture(GL_TEXTURE0);
+    f->glBindTexture(GL_TEXTURE_2D, m_atlas->texture());
+
+    m_vertices.bind();
+    m_vertices.write(0, data, sizeof(data));
+    const int position = m_sliceShader->attributeLocation("position");
+    const int texcoord = m_sliceShader->attributeLocation("texcoord");
+    m_sliceShader->enableAttributeArray(position);
+    m_sliceShader->enableAttributeArray(texcoord);
+    m_sliceShader->setAttributeBuffer(position, GL_FLOAT, 0, 2, VertexFloats * sizeof(float));
+    m_sliceShader->setAttributeBuffer(texcoord, GL_FLOAT, 2 * sizeof(float), 2, VertexFloats * sizeof(float));
+    f->glDrawArrays(GL_TRIANGLES, 0, SliceVertices);
+    m_sliceShader->disableAttributeArray(position);
+    m_sliceShader->disableAttributeArray(texcoord);
+    m_vertices.release();
+
+    f->glBindTexture(GL_TEXTURE_2D, 0);
+    m_sliceShader->release();
+    f->glDisable(GL_BLEND);
+}
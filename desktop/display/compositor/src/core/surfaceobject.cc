@@ -75,6 +75,10 @@ Surface::~Surface()
     delete m_wndctl;
     //delete m_view;
     delete m_ssdMgr;
+
+    // normally done when recycled, but cursor and drag icon surfaces are
+    // dropped without going through there
+    hwComp->unregisterSurface(this);
 }
 
 QWaylandSurface *Surface::surface() const
@@ -307,6 +311,7 @@ OriginullMenuServer *Surface::menuServer() const
 
 void Surface::setPosition(const QPointF &pos)
 {
+    hwComp->invalidateHitTests();
     if(m_surfaceType == Popup)
     {
         m_surfacePosition = pos;
@@ -603,7 +608,7 @@ void Surface::setParentSurfaceObject(Surface *parent)
     m_parentSurface = parent;
     m_parentSurface->addChildSurfaceObject(this);
     // remove ourself from the compositor's top level zorder list
-    hwComp->m_zorder.removeOne(this);
+    hwComp->zorderRemove(this);
     m_surfaceType = Surface::Popup;
 }
 
@@ -655,6 +660,7 @@ QPointF Surface::renderPosition() const
 void Surface::addChildSurfaceObject(Surface *child)
 {
     m_children.append(child);
+    hwComp->invalidateHitTests();
 }
 
 void Surface::addXdgChildSurfaceObject(Surface *child)
@@ -665,6 +671,7 @@ void Surface::addXdgChildSurfaceObject(Surface *child)
 void Surface::recycleChildSurfaceObject(Surface *child)
 {
     m_children.removeOne(child);
+    hwComp->invalidateHitTests();
 }
 
 void Surface::setLayerShellParent(Surface *surface)
@@ -748,11 +755,13 @@ void Surface::onDestinationSizeChanged()
         m_surfaceInit = true;
     }
 
+    hwComp->invalidateHitTests();
     hwComp->triggerRender();
 }
 
 void Surface::onBufferScaleChanged()
 {
+    hwComp->invalidateHitTests();
     hwComp->triggerRender();
 }
 
@@ -800,6 +809,7 @@ void Surface::decorationModeChanged()
         m_ssd = true;
     else
         m_ssd = false;
+    hwComp->invalidateHitTests();
     hwComp->triggerRender();
 }
 
@@ -821,12 +831,14 @@ void Surface::onQtShellActivationRequest()
 void Surface::onQtShellReposition(const QPoint &pos)
 {
     m_surfacePosition = pos;
+    hwComp->invalidateHitTests();
     hwComp->triggerRender();
 }
 
 void Surface::onQtShellSetSize(const QSize &size)
 {
     m_qt_size = size;
+    hwComp->invalidateHitTests();
     emit geometryChanged();
     hwComp->triggerRender();
 }
@@ -834,6 +846,7 @@ void Surface::onQtShellSetSize(const QSize &size)
 void Surface::onQtWindowFlagsChanged(const Qt::WindowFlags &f)
 {
     m_qt_wndflags = f;
+    hwComp->invalidateHitTests();
 
     if(f.testFlag(Qt::Window) && !f.testFlag(Qt::Popup) && !f.testFlag(Qt::FramelessWindowHint))
     {
@@ -1123,6 +1136,7 @@ void Surface::viewSurfaceDestroyed()
 void Surface::onXdgSetMaximized()
 {
     m_minimized = false;
+    hwComp->invalidateHitTests();
     m_maximized = true;
     m_priorNormalPos = m_surfacePosition;
     m_prior_normal_size = surfaceSize()/surface()->bufferScale();
@@ -1155,6 +1169,7 @@ void Surface::onXdgUnsetMaximized()
 void Surface::onXdgSetMinimized()
 {
     m_minimized = true;
+    hwComp->invalidateHitTests();
     hwComp->triggerRender();
     if(m_wndctl)
         m_wndctl->setMinimized(true);
@@ -1260,6 +1275,7 @@ void Surface::completeXdgConfigure()
 void Surface::unsetMinimized()
 {
     m_minimized = false;
+    hwComp->invalidateHitTests();
     if(m_wndctl)
         m_wndctl->setMinimized(false);
     hwComp->triggerRender();
@@ -1269,6 +1285,7 @@ void Surface::onXdgSetFullscreen(QWaylandOutput* clientPreferredOutput)
 {
     m_minimized = false;
     m_fullscreen = true;
+    hwComp->invalidateHitTests();
     // TODO: cache this
     QWaylandOutput *outputToFullscreen = clientPreferredOutput
             ? clientPreferredOutput
@@ -1324,6 +1341,7 @@ void Surface::onXdgAppIdChanged()
 
 void Surface::onXdgWindowGeometryChanged()
 {
+    hwComp->invalidateHitTests();
 }
 
 // Layer Shell Functions
@@ -1403,7 +1421,7 @@ void Surface::onLayerShellXdgPopupParentChanged(HWWaylandXdgPopup *popup)
     auto popupSurface = popup->xdgSurface()->surface();
     hwComp->findSurfaceObject(popupSurface)->setLayerShellParent(this);
     hwComp->findSurfaceObject(popupSurface)->handleLayerShellPopupPositioning();
-    hwComp->m_zorder.removeOne(hwComp->findSurfaceObject(popupSurface));
+    hwComp->zorderRemove(hwComp->findSurfaceObject(popupSurface));
     addChildSurfaceObject(hwComp->findSurfaceObject(popupSurface));
 
 }
@@ -1413,6 +1431,8 @@ void Surface::recalculateLayerShellAnchorPosition()
     if(!m_ls_size.isValid())
         return;
 
+    hwComp->invalidateHitTests();
+
     auto anchors = m_layerSurface->anchors();
     auto view = primaryView();
 
@@ -0,0 +1,111 @@
+// Hollywood Wayland Compositor
+// SPDX-FileCopyrightText: 2024 Originull Software
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "thumbnailrenderer.h"
+
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QOpenGLTexture>
+#include <QOpenGLFramebufferObject>
+#include <QMatrix4x4>
+
+// intermediate sizes differ from window to window, don't let them pile up
+static const int MaxFramebuffers = 16;
+
+ThumbnailRenderer::~ThumbnailRenderer()
+{
+    qDeleteAll(m_framebuffers);
+    m_blitter.destroy();
+}
+
+void ThumbnailRenderer::initialize()
+{
+    m_blitter.create();
+}
+
+QOpenGLFramebufferObject *ThumbnailRenderer::framebuffer(const QSize &size)
+{
+    const quint64 key = (quint64(size.width()) << 32) | quint64(size.height());
+    if(auto fbo = m_framebuffers.value(key))
+        return fbo;
+
+    if(m_framebuffers.count() >= MaxFramebuffers)
+    {
+        qDeleteAll(m_framebuffers);
+        m_framebuffers.clear();
+    }
+
+    auto fbo = new QOpenGLFramebufferObject(size);
+    // the next step samples this between texels
+    QOpenGLFunctions *f = QOpenGLContext::currentContext()->functions();
+    f->glBindTexture(GL_TEXTURE_2D, fbo->texture());
+    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    f->glBindTexture(GL_TEXTURE_2D, 0);
+    m_framebuffers.insert(key, fbo);
+    return fbo;
+}
+
+QImage ThumbnailRenderer::render(QOpenGLTexture *texture, QOpenGLTextureBlitter::Origin origin,
+                                 const QSize &source, const QSize &size)
+{
+    if(!texture || source.isEmpty() || size.isEmpty())
+        return QImage();
+
+    QOpenGLFunctions *f = QOpenGLContext::currentContext()->functions();
+    GLint prevFbo = 0;
+    GLint viewport[4];
+    f->glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prevFbo);
+    f->glGetIntegerv(GL_VIEWPORT, viewport);
+
+    // client textures are sampled with whatever filter they came with,
+    // the first step needs linear filtering for the average to work
+    const GLenum target = texture->target();
+    GLint minFilter = GL_LINEAR, magFilter = GL_LINEAR;
+    f->glBindTexture(target, texture->textureId());
+    f->glGetTexParameteriv(target, GL_TEXTURE_MIN_FILTER, &minFilter);
+    f->glGetTexParameteriv(target, GL_TEXTURE_MAG_FILTER, &magFilter);
+    f->glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    f->glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    f->glBindTexture(target, 0);
+
+    f->glDisable(GL_BLEND);
+
+    GLuint currentTexture = texture->textureId();
+    GLenum currentTarget = target;
+    QSize current = source;
+    QOpenGLFramebufferObject *fbo = nullptr;
+    do
+    {
+        QSize next(qMax(size.width(), current.width() / 2),
+                   qMax(size.height(), current.height() / 2));
+        if(current.width() < size.width() || current.height() < size.height())
+            next = size;
+
+        fbo = framebuffer(next);
+        fbo->bind();
+        f->glViewport(0, 0, next.width(), next.height());
+
+        m_blitter.bind(currentTarget);
+        m_blitter.blit(currentTexture, QMatrix4x4(), origin);
+        m_blitter.release();
+
+        // every later step samples one of our own framebuffers
+        currentTexture = fbo->texture();
+        currentTarget = GL_TEXTURE_2D;
+        origin = QOpenGLTextureBlitter::OriginBottomLeft;
+        current = next;
+    } while(current != size);
+
+    QImage image = fbo->toImage();
+
+    f->glBindTexture(target, texture->textureId());
+    f->glTexParameteri(target, GL_TEXTURE_MIN_FILTER, minFilter);
+    f->glTexParameteri(target, GL_TEXTURE_MAG_FILTER, magFilter);
+    f->glBindTexture(target, 0);
+
+    f->glBindFramebuffer(GL_FRAMEBUFFER, prevFbo);
+    f->glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    return image;
+}
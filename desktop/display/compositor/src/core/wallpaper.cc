@@ -12,6 +12,8 @@
 #include <QFile>
 #include <QDir>
 #include <QOpenGLTextureBlitter>
+#include <QImageReader>
+#include <QtConcurrent/QtConcurrentRun>
 
 Q_LOGGING_CATEGORY(hwWallpaper, "compositor.wallpaper")
 
@@ -21,7 +23,13 @@ static const float pos[12] = { -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, -1.0f, 1.
 
 WallpaperManager::WallpaperManager(OutputWindow *parent)
     : QObject{0}
-    , m_parent(parent) {}
+    , m_parent(parent)
+    , m_decodeWatcher(new QFutureWatcher<Decoded>(this))
+    , m_prefetchWatcher(new QFutureWatcher<Decoded>(this))
+{
+    connect(m_decodeWatcher, &QFutureWatcher<Decoded>::finished, this, &WallpaperManager::decoded);
+    connect(m_prefetchWatcher, &QFutureWatcher<Decoded>::finished, this, &WallpaperManager::prefetched);
+}
 
 void WallpaperManager::setup()
 {
@@ -36,122 +44,169 @@ void WallpaperManager::setup()
 
 void WallpaperManager::wallpaperChanged()
 {
-    // setup our wallpaper gl texture
-    if(m_texture != nullptr)
+    // the current texture stays up until the new image is decoded
+    if(m_decodeWatcher->isRunning())
     {
-        delete m_texture;
-        m_texture = nullptr;
+        m_decodeAgain = true;
+        return;
     }
+    startDecode();
+}
 
-    if(m_wallpaper.isNull())
-        return;
+void WallpaperManager::startDecode()
+{
+    m_decodeAgain = false;
+    m_decodeWatcher->setFuture(QtConcurrent::run(&WallpaperManager::decode,
+                                   m_wallpaper, m_parent->size(), m_displayMode));
+}
 
-    QImage bg(m_wallpaper);
-    if(bg.isNull())
+void WallpaperManager::decoded()
+{
+    // the wallpaper or the output changed while we were at it
+    if(m_decodeAgain)
     {
-        m_wallpaper = QString("");
+        startDecode();
         return;
     }
 
-    bg.mirror(false, true);
-    m_wpStartPoint = QPoint(0,0);
-    if(bg.size() != m_parent->size())
+    m_pending = m_decodeWatcher->result();
+    if(m_pending.isNull())
+        m_wallpaper = QString("");
+
+    m_hasPending = true;
+    m_pendingTransition = false;
+    hwComp->triggerRender();
+}
+
+// runs on a worker thread
+WallpaperManager::Decoded WallpaperManager::decode(const QString &path, const QSize &target, Layout mode)
+{
+    Decoded d;
+    d.path = path;
+    d.target = target;
+    d.mode = mode;
+    if(path.isEmpty() || target.isEmpty())
+        return d;
+
+    // only decode what ends up on the output, at the size it is shown;
+    // the reader does this while decoding (for jpeg in the DCT itself)
+    // instead of producing the full image first
+    QImageReader reader(path);
+    const QSize source = reader.size();
+    if(source.isValid())
     {
-        // only if we are equal in size do we not need
-        // to perform any scaling.  but we're not
-        bool lgw = bg.size().width() > m_parent->size().width();
-        bool lgh = bg.size().height() > m_parent->size().height();
-        switch(m_displayMode)
+        const bool lgw = source.width() > target.width();
+        const bool lgh = source.height() > target.height();
+        switch(mode)
         {
-        case FillScreen:
-        default:
-            // preserve aspect ratio
-            // preserve original size if larger
-            // enlarge if smaller
-            // center in screen
-            if(lgw || lgh)
-            {
-                // our background is larger than our
-                // screen surface so let's
-            }
-            break;
         case Center:
-            // center in the screen
-            // shrink if needed, do not enlarge
             if(!lgw && !lgh)
             {
                 // both sides are smaller - set a center point
-                auto wd = m_parent->size().width() - bg.size().width();
-                auto hd = m_parent->size().height() - bg.size().height();
-                m_wpStartPoint = QPoint(wd/2,hd/2);
-                break;
+                d.start = QPoint((target.width() - source.width())/2,
+                                 (target.height() - source.height())/2);
+            }
+            else if(lgw && lgh)
+            {
+                // both are bigger, shrink until the output is covered and
+                // crop out the middle
+                auto scaled = source.scaled(target, Qt::KeepAspectRatioByExpanding);
+                reader.setScaledSize(scaled);
+                reader.setScaledClipRect(QRect(QPoint((scaled.width() - target.width())/2,
+                                                      (scaled.height() - target.height())/2), target));
+            }
+            else if(lgh)
+            {
+                // crop out our height from the middle
+                reader.setClipRect(QRect(0, (source.height() - target.height())/2,
+                                         source.width(), target.height()));
+                d.start = QPoint((target.width() - source.width())/2, 0);
             }
             else
             {
-                // we have a side larger than our screen so shrink
-                if(!lgw && lgh)
-                {
-                    // height higher
-                    // crop out our height from the middle
-                    auto sh = bg.size().height() - m_parent->size().height();
-                    sh = sh / 2;
-                    bg = bg.copy(sh, 0, bg.size().width(), m_parent->size().height());
-                    m_wpStartPoint = QPoint(sh,0);
-                }
-                else if(lgw && !lgh)
-                {
-                    // width heigher
-                    auto sw = bg.size().width() - m_parent->size().width();
-                    sw = sw / 2;
-                    bg = bg.copy(0, sw, m_parent->size().width(), bg.size().height());
-                    m_wpStartPoint = QPoint(0, sw);
-                }
-                else
-                {
-                    // both are bigger!
-                    if(bg.width() > bg.height())
-                    {
-                        // wider image, scale the height
-                        bg = bg.scaledToHeight(m_parent->height(), Qt::SmoothTransformation);
-                        if(bg.width() > m_parent->width())
-                        {
-                            // width is still bigger so crop
-                            auto midpoint = (bg.width() - m_parent->width())/2;
-                            bg = bg.copy(midpoint, 0, m_parent->width(), bg.height());
-                        }
-                    }
-                    else
-                    {
-                        // tall - scale to width
-                        bg = bg.scaledToWidth(m_parent->width(), Qt::SmoothTransformation);
-                        auto midpoint = (bg.height() - m_parent->height())/2;
-                        bg = bg.copy(0,midpoint, bg.width(), m_parent->height());
-                    }
-                }
+                reader.setClipRect(QRect((source.width() - target.width())/2, 0,
+                                         target.width(), source.height()));
+                d.start = QPoint(0, (target.height() - source.height())/2);
             }
             break;
+        case FillScreen:
         case FitToScreen:
-            // preserve aspect ratio
-            // fit in the screen
-            // resize up/down if needed
-
-
         case Stretch:
-            // fit to screen
-            // then strech out in the
-            // other direction
+        default:
+            // drawn at the original size from the top left corner, what
+            // hangs off the output is never seen
+            if(lgw || lgh)
+                reader.setClipRect(QRect(QPoint(0,0), source.boundedTo(target)));
             break;
         }
     }
+
+    QImage bg = reader.read();
+    if(bg.isNull())
+    {
+        qCWarning(hwWallpaper) << "failed to load" << path << reader.errorString();
+        return d;
+    }
+
+    bg.mirror(false, true);
+    // QOpenGLTexture would convert on the render thread otherwise
+    d.image = bg.convertToFormat(QImage::Format_RGBA8888);
+    return d;
+}
+
+void WallpaperManager::uploadPending()
+{
+    m_hasPending = false;
+    Decoded d = m_pending;
+    m_pending = Decoded();
+    const bool transition = m_pendingTransition && m_texture != nullptr && !d.isNull();
+    m_pendingTransition = false;
+
+    // a newer image replaces the one we were fading to
+    if(m_intrans)
+    {
+        delete m_oldtexture;
+        m_oldtexture = nullptr;
+        m_intrans = false;
+    }
+
+    if(transition)
+        m_oldtexture = m_texture;
+    else
+        delete m_texture;
+    m_texture = nullptr;
+
+    if(d.isNull())
+        return;
+
     m_texture = new QOpenGLTexture(QOpenGLTexture::Target2D);
     m_texture->create();
-    m_texture->setSize(bg.size().width(), bg.size().height());
+    m_texture->setSize(d.image.width(), d.image.height());
     m_texture->setMagnificationFilter(QOpenGLTexture::Nearest);
     m_texture->setMinificationFilter(QOpenGLTexture::Linear);
     m_texture->setWrapMode(QOpenGLTexture::ClampToEdge);
-    m_texture->setData(bg);
+    m_texture->setData(d.image, QOpenGLTexture::DontGenerateMipMaps);
+
+    m_wpStartPoint = d.start;
+    m_bgSize = d.image.size();
 
-    m_bgSize = bg.size();
+    if(!transition)
+        return;
+
+    m_intrans = true;
+    m_transprogress = 0.0f;
+    m_shader->bind();
+    // clang analyzer complains about this
+    // we should make sure we are bound and
+    // TODO: write a fall back measure
+
+    float ratio = m_parent->size().width() / m_parent->size().height();
+    m_shader->setUniformValue("from", 0);
+    m_shader->setUniformValue("to",   1);
+    m_shader->setUniformValue("ratio",   ratio);
+    m_shader->setUniformValue("_fromR",  ratio);
+    m_shader->setUniformValue("_toR",   ratio);
+    m_shader->setUniformValue("progress", m_transprogress);
 }
 
 void WallpaperManager::clearBackgroundColor()
@@ -171,6 +226,9 @@ void WallpaperManager::clearBackgroundColor()
 
 void WallpaperManager::renderWallpaper()
 {
+    if(m_hasPending)
+        uploadPending();
+
     if(m_texture == nullptr)
         return;
 
@@ -233,6 +291,16 @@ void WallpaperManager::setupRotationTimer()
     }
 
     m_rotationTimer->start(time);
+
+    // have the next image decoded by the time the timer fires
+    if(m_prefetchTimer == nullptr)
+    {
+        m_prefetchTimer = new QTimer(this);
+        m_prefetchTimer->setSingleShot(true);
+        connect(m_prefetchTimer, &QTimer::timeout, this, &WallpaperManager::startPrefetch);
+    }
+    m_prefetch = Decoded();
+    m_prefetchTimer->start(qMax(0, int(time) - 15000));
 }
 
 void WallpaperManager::rotateNow()
@@ -251,32 +319,58 @@ void WallpaperManager::rotateNow()
 
 void WallpaperManager::transitionWallpaper()
 {
-    m_shader->bind();
+    if(m_prefetch.isNull() || m_prefetch.target != m_parent->size() ||
+       m_prefetch.mode != m_displayMode)
+    {
+        // not decoded yet (rotateNow), or for an output that has changed
+        m_prefetch = Decoded();
+        m_transitionWaiting = true;
+        startPrefetch();
+        return;
+    }
 
-    m_intrans = true;
-    m_oldtexture = m_texture;
-    m_texture = nullptr;
-    m_transprogress = 0.0f;
-    m_wallpaper = findNextWallpaperInOrder();
-    wallpaperChanged();
+    m_wallpaper = m_prefetch.path;
     setNewWallpaperPath(m_wallpaper);
 
-    // clang analyzer complains about this
-    // we should make sure we are bound and
-    // TODO: write a fall back measure
-
-    float ratio = m_parent->size().width() / m_parent->size().height();
-    m_shader->setUniformValue("from", 0);
-    m_shader->setUniformValue("to",   1);
-    m_shader->setUniformValue("ratio",   ratio);
-    m_shader->setUniformValue("_fromR",  ratio);
-    m_shader->setUniformValue("_toR",   ratio);
-    m_shader->setUniformValue("progress", m_transprogress);
+    // the next frame uploads it and starts the transition
+    m_pending = m_prefetch;
+    m_prefetch = Decoded();
+    m_hasPending = true;
+    m_pendingTransition = true;
 
     // TODO: disable transitions for legacy mode?
     hwComp->triggerRender();
 }
 
+void WallpaperManager::startPrefetch()
+{
+    if(m_prefetchWatcher->isRunning())
+        return;
+
+    m_prefetchWatcher->setFuture(QtConcurrent::run([folder = m_rotateFolder, current = m_wallpaper,
+                                                    target = m_parent->size(), mode = m_displayMode]() {
+        return decode(findNextWallpaperInOrder(folder, current), target, mode);
+    }));
+}
+
+void WallpaperManager::prefetched()
+{
+    m_prefetch = m_prefetchWatcher->result();
+    if(!m_transitionWaiting)
+        return;
+
+    m_transitionWaiting = false;
+    if(m_prefetch.isNull())
+    {
+        // nothing to rotate to right now, try again next time
+        qCDebug(hwWallpaper, "no wallpaper to rotate to in %s", qPrintable(m_rotateFolder));
+        if(m_rotate)
+            setupRotationTimer();
+        return;
+    }
+    transitionWallpaper();
+}
+
 void WallpaperManager::querySettings()
 {
     auto oldbg = m_wallpaper;
@@ -288,6 +382,8 @@ void WallpaperManager::querySettings()
     m_rotate = settings.value("Rotate", false).toBool();
     if(!m_rotate && m_rotationTimer != nullptr && m_rotationTimer->isActive())
         m_rotationTimer->stop();
+    if(!m_rotate && m_prefetchTimer != nullptr)
+        m_prefetchTimer->stop();
 
     m_rotateFolder = settings.value("RotateFolder").toString();
     m_wallpaper = settings.value("Wallpaper").toString();
@@ -329,21 +425,22 @@ void WallpaperManager::querySettings()
         setupRotationTimer();
 }
 
-QString WallpaperManager::findNextWallpaperInOrder()
+// runs on a worker thread
+QString WallpaperManager::findNextWallpaperInOrder(const QString &folder, const QString &current)
 {
-    QDir dir(m_rotateFolder);
+    QDir dir(folder);
     if(!dir.exists())
         return QString();
 
     QString firstValid;
 
+    // canRead() only looks at the header, nothing gets decoded here
     auto entries = dir.entryList(QDir::Files, QDir::Name);
     for(auto e : entries)
     {
-        QImage i;
-        if(i.load(QString("%1/%2").arg(m_rotateFolder, e)))
+        if(QImageReader(QString("%1/%2").arg(folder, e)).canRead())
         {
-            firstValid = QString("%1/%2").arg(m_rotateFolder, e);
+            firstValid = QString("%1/%2").arg(folder, e);
             break;
         }
     }
@@ -353,18 +450,17 @@ QString WallpaperManager::findNextWallpaperInOrder()
 
 
     QString nextWallpaper;
-    auto currWallpaper = m_wallpaper.split("/").last();
+    auto currWallpaper = current.split("/").last();
     auto idx = entries.indexOf(currWallpaper);
     if(idx == -1)
         return QString();
 
     for(int i = idx+1; i < entries.count(); ++i)
     {
-        QImage img;
-        auto imgpath = QString("%1/%2").arg(m_rotateFolder, entries[i]);
-        if(img.load(imgpath))
+        auto imgpath = QString("%1/%2").arg(folder, entries[i]);
+        if(QImageReader(imgpath).canRead())
         {
-            nextWallpaper = QString("%1/%2").arg(m_rotateFolder, entries[i]);
+            nextWallpaper = imgpath;
             break;
         }
     }
@@ -424,6 +520,7 @@ void WallpaperManager::completeTransition()
 
     m_shader->release();
     delete m_oldtexture;
+    m_oldtexture = nullptr;
     m_transprogress = 0.0f;
     m_intrans = false;
     hwComp->triggerRender();
@@ -0,0 +1,262 @@
+// Hollywood Wayland Compositor
+// SPDX-FileCopyrightText: 2024 Originull Software
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "compositor.h"
+#include "thumbnail.h"
+#include "surfaceobject.h"
+#include "view.h"
+#include "output.h"
+#include "outputwnd.h"
+
+#include <QWaylandSurface>
+#include <cstring>
+
+#define THUMBNAIL_VERSION  1
+
+// a thumbnail of a video or a game doesn't need to run at frame rate
+static const int MinimumInterval = 200;
+
+Q_LOGGING_CATEGORY(hwThumbnail, "compositor.thumbnail")
+
+WindowThumbnailManager::WindowThumbnailManager(QWaylandCompositor *compositor)
+    : QWaylandCompositorExtensionTemplate<WindowThumbnailManager>(compositor)
+    , QtWaylandServer::org_originull_thumbnail_manager(compositor->display(), THUMBNAIL_VERSION)
+{
+    qCInfo(hwThumbnail, "Supporting org_originull_thumbnail_manager (protocol version %i)", THUMBNAIL_VERSION);
+}
+
+void WindowThumbnailManager::initialize()
+{
+    QWaylandCompositorExtensionTemplate::initialize();
+    QWaylandCompositor *compositor = static_cast<QWaylandCompositor *>(extensionContainer());
+    init(compositor->display(), THUMBNAIL_VERSION);
+}
+
+void WindowThumbnailManager::org_originull_thumbnail_manager_get_thumbnail(Resource *resource, uint32_t id,
+                            const QString &uuid, int32_t max_width, int32_t max_height)
+{
+    Surface *surface = nullptr;
+    for(auto s : hwComp->surfaces())
+    {
+        if(s->uuid().toString(QUuid::WithoutBraces) == uuid)
+        {
+            surface = s;
+            break;
+        }
+    }
+
+    if(!surface)
+        qCDebug(hwThumbnail, "get_thumbnail: no window %s", qPrintable(uuid));
+
+    // an unknown window still gets its object, it just fails every capture
+    new WindowThumbnail(surface, QSize(qMax(0, max_width), qMax(0, max_height)),
+                        resource->client(), id, resource->version());
+}
+
+void WindowThumbnailManager::org_originull_thumbnail_manager_destroy(Resource *resource)
+{
+    wl_resource_destroy(resource->handle);
+}
+
+WindowThumbnail::WindowThumbnail(Surface *surface, const QSize &maxSize,
+                                 wl_client *client, uint32_t id, int version)
+    : QObject(nullptr)
+    , QtWaylandServer::org_originull_thumbnail(client, id, version)
+    , m_surface(surface)
+    , m_maxSize(maxSize)
+{
+    m_bufferListener.listener.notify = bufferDestroyed;
+    m_bufferListener.thumbnail = this;
+    wl_list_init(&m_bufferListener.listener.link);
+
+    m_throttle.setSingleShot(true);
+    connect(&m_throttle, &QTimer::timeout, this, &WindowThumbnail::schedule);
+
+    if(m_surface && m_surface->surface())
+        connect(m_surface->surface(), &QWaylandSurface::damaged,
+                this, &WindowThumbnail::surfaceDamaged);
+    if(m_surface)
+        connect(m_surface, &QObject::destroyed, this, &WindowThumbnail::failCapture);
+
+    m_size = targetSize();
+    send_buffer(WL_SHM_FORMAT_ARGB8888, m_size.width(), m_size.height(), m_size.width() * 4);
+}
+
+WindowThumbnail::~WindowThumbnail()
+{
+    releaseBuffer();
+}
+
+QSize WindowThumbnail::targetSize() const
+{
+    if(!m_surface || !m_surface->surface())
+        return QSize();
+
+    QSize source = m_surface->surface()->bufferSize();
+    if(source.isEmpty() || m_maxSize.isEmpty())
+        return QSize();
+
+    // never scale up, a small window is its own thumbnail
+    if(source.width() <= m_maxSize.width() && source.height() <= m_maxSize.height())
+        return source;
+
+    return source.scaled(m_maxSize, Qt::KeepAspectRatio).expandedTo(QSize(1, 1));
+}
+
+void WindowThumbnail::releaseBuffer()
+{
+    if(!m_buffer)
+        return;
+
+    wl_list_remove(&m_bufferListener.listener.link);
+    wl_list_init(&m_bufferListener.listener.link);
+    m_buffer = nullptr;
+}
+
+void WindowThumbnail::failCapture()
+{
+    if(!m_buffer)
+        return;
+
+    releaseBuffer();
+    send_failed();
+}
+
+void WindowThumbnail::bufferDestroyed(wl_listener *listener, void *data)
+{
+    Q_UNUSED(data);
+    BufferListener *bl = wl_container_of(listener, bl, listener);
+    bl->thumbnail->releaseBuffer();
+}
+
+void WindowThumbnail::org_originull_thumbnail_capture(Resource *resource, wl_resource *buffer)
+{
+    Q_UNUSED(resource);
+    releaseBuffer();
+
+    auto *shm = wl_shm_buffer_get(buffer);
+    if(!shm || !m_surface || m_size.isEmpty())
+    {
+        send_failed();
+        return;
+    }
+
+    // a buffer event may have crossed this request, that's not an error
+    if(wl_shm_buffer_get_format(shm) != WL_SHM_FORMAT_ARGB8888 ||
+       wl_shm_buffer_get_width(shm) != m_size.width() ||
+       wl_shm_buffer_get_height(shm) != m_size.height() ||
+       wl_shm_buffer_get_stride(shm) < m_size.width() * 4)
+    {
+        qCDebug(hwThumbnail, "capture: buffer doesn't match %ix%i", m_size.width(), m_size.height());
+        send_failed();
+        return;
+    }
+
+    m_buffer = buffer;
+    wl_resource_add_destroy_listener(buffer, &m_bufferListener.listener);
+
+    if(m_damaged)
+        schedule();
+}
+
+void WindowThumbnail::org_originull_thumbnail_destroy(Resource *resource)
+{
+    wl_resource_destroy(resource->handle);
+}
+
+void WindowThumbnail::org_originull_thumbnail_destroy_resource(Resource *resource)
+{
+    Q_UNUSED(resource);
+    releaseBuffer();
+    deleteLater();
+}
+
+void WindowThumbnail::surfaceDamaged()
+{
+    m_damaged = true;
+    if(m_buffer)
+        schedule();
+}
+
+void WindowThumbnail::schedule()
+{
+    if(m_queued || !m_buffer)
+        return;
+
+    if(m_lastUpdate.isValid() && m_lastUpdate.elapsed() < MinimumInterval)
+    {
+        if(!m_throttle.isActive())
+            m_throttle.start(MinimumInterval - m_lastUpdate.elapsed());
+        return;
+    }
+
+    if(!m_surface || !m_surface->primaryView())
+    {
+        failCapture();
+        return;
+    }
+
+    auto output = hwComp->outputFor(m_surface->primaryView()->output());
+    if(!output || !output->hwWindow())
+    {
+        failCapture();
+        return;
+    }
+
+    m_queued = true;
+    output->hwWindow()->queueThumbnail(this);
+    hwComp->triggerRender();
+}
+
+bool WindowThumbnail::prepare()
+{
+    m_queued = false;
+    if(!m_buffer)
+        return false;
+
+    if(!m_surface || !m_surface->surface())
+    {
+        failCapture();
+        return false;
+    }
+
+    QSize size = targetSize();
+    if(size != m_size)
+    {
+        m_size = size;
+        failCapture();
+        send_buffer(WL_SHM_FORMAT_ARGB8888, m_size.width(), m_size.height(), m_size.width() * 4);
+        return false;
+    }
+
+    return !m_size.isEmpty();
+}
+
+void WindowThumbnail::deliver(const QImage &image)
+{
+    if(!m_buffer)
+        return;
+
+    if(image.size() != m_size)
+    {
+        failCapture();
+        return;
+    }
+
+    QImage src = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    auto *shm = wl_shm_buffer_get(m_buffer);
+    const int stride = wl_shm_buffer_get_stride(shm);
+    const int row = m_size.width() * 4;
+
+    wl_shm_buffer_begin_access(shm);
+    uchar *data = static_cast<uchar*>(wl_shm_buffer_get_data(shm));
+    for(int y = 0; y < m_size.height(); y++)
+        memcpy(data + y * stride, src.constScanLine(y), row);
+    wl_shm_buffer_end_access(shm);
+
+    releaseBuffer();
+    m_damaged = false;
+    m_lastUpdate.start();
+    send_ready();
+}
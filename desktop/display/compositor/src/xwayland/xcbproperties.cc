@@ -41,6 +41,10 @@ void dump(xcb_atom_t property, xcb_get_property_reply_t *reply)
 
 void dumpProperty(xcb_atom_t property, xcb_get_property_reply_t *reply)
 {
+    // naming the atoms takes a round trip each
+    if (!gLcXwaylandTrace().isDebugEnabled())
+        return;
+
     QString buffer = QStringLiteral("\t%1: ").arg(Xcb::Atom::nameFromAtom(property));
 
     if (!reply) {
@@ -81,6 +85,9 @@ void dumpProperty(xcb_atom_t property, xcb_get_property_reply_t *reply)
 
 void readAndDumpProperty(xcb_atom_t atom, xcb_window_t window)
 {
+    if (!gLcXwaylandTrace().isDebugEnabled())
+        return;
+
     xcb_get_property_cookie_t cookie =
             xcb_get_property(Xcb::connection(), 0, window,
                              atom, XCB_ATOM_ANY, 0, 2048);
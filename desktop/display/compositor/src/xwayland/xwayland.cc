@@ -30,6 +30,7 @@
  */
 
 #include <QtCore/QSocketNotifier>
+#include <QtCore/QTimer>
 #include <QtCore/QtMath>
 
 #include <QWaylandSurface>
@@ -53,12 +54,18 @@ Q_LOGGING_CATEGORY(gLcXwaylandTrace, "compositor.x11.trace")
 XWaylandManager::XWaylandManager(QObject *parent)
     : QObject(parent)
     , m_server(nullptr)
+    , m_wmNotifier(nullptr)
+    , m_windowCount(0)
+    , m_propertyTimer(new QTimer(this))
     , m_cursors(nullptr)
     , m_lastCursor(CursorUnset)
     , m_wmWindow(nullptr)
     , m_compositor(nullptr)
     , m_focusWindow(nullptr)
 {
+    m_propertyTimer->setSingleShot(true);
+    m_propertyTimer->setInterval(16);
+    connect(m_propertyTimer, &QTimer::timeout, this, &XWaylandManager::processPropertyReplies);
 }
 
 XWaylandManager::~XWaylandManager()
@@ -100,8 +107,8 @@ void XWaylandManager::start(int fd)
     }
 
     // Listen to WM events
-    QSocketNotifier *notifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
-    connect(notifier, SIGNAL(activated(int)), this, SLOT(wmEvents()));
+    m_wmNotifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+    connect(m_wmNotifier, SIGNAL(activated(int)), this, SLOT(wmEvents()));
 
     // Resources and atoms
     Xcb::resources();
@@ -161,15 +168,70 @@ void XWaylandManager::start(int fd)
     Q_EMIT created();
 }
 
+void XWaylandManager::stop()
+{
+    if (!Xcb::connection())
+        return;
+
+    qCDebug(gLcXwayland) << "Disconnect from X11";
+    delete m_wmNotifier;
+    m_wmNotifier = nullptr;
+
+    // the shell surfaces belong to the compositor, they would outlive the
+    // connection their windows came from
+    for (auto shellSurface : std::as_const(m_windowsMap))
+        if (shellSurface)
+            shellSurface->deleteLater();
+    m_windowsMap.clear();
+    m_unpairedWindows.clear();
+    m_windowCount = 0;
+    m_pendingProperties.clear();
+    m_propertyTimer->stop();
+    m_focusWindow = nullptr;
+
+    Xcb::Cursors::destroyCursors(m_cursors);
+    m_cursors = nullptr;
+    m_lastCursor = CursorUnset;
+    delete m_wmWindow;
+    m_wmWindow = nullptr;
+
+    // also closes the WM end of the socket pair
+    Xcb::closeConnection();
+}
+
 void XWaylandManager::addWindow(xcb_window_t id, XWaylandShellSurface *shellSurface)
 {
-    if (id != XCB_WINDOW_NONE && shellSurface)
-        m_windowsMap[id] = shellSurface;
+    if (id == XCB_WINDOW_NONE || !shellSurface)
+        return;
+
+    m_windowsMap[id] = shellSurface;
+    updateWindowCount();
+}
+
+void XWaylandManager::removeWindow(xcb_window_t id, XWaylandShellSurface *shellSurface)
+{
+    // shell surfaces from a previous Xwayland are deleted late, and the
+    // new one may have handed out their window id again
+    auto it = m_windowsMap.find(id);
+    if (it == m_windowsMap.end() || (it.value() && it.value() != shellSurface))
+        return;
+
+    m_windowsMap.erase(it);
+    updateWindowCount();
 }
 
-void XWaylandManager::removeWindow(xcb_window_t id)
+void XWaylandManager::updateWindowCount()
 {
-    m_windowsMap.remove(id);
+    // lookups through operator[] leave null entries behind
+    int count = 0;
+    for (auto shellSurface : std::as_const(m_windowsMap))
+        if (shellSurface)
+            ++count;
+
+    if (count == m_windowCount)
+        return;
+    m_windowCount = count;
+    Q_EMIT windowCountChanged(count);
 }
 
 void XWaylandManager::setActiveWindow(xcb_window_t window)
@@ -448,6 +510,7 @@ void XWaylandManager::handleReparentNotify(xcb_reparent_notify_event_t *event)
         if (!m_windowsMap.contains(event->parent))
             return;
         m_windowsMap.take(event->parent)->deleteLater();
+        updateWindowCount();
     }
 }
 
@@ -530,6 +593,7 @@ void XWaylandManager::handleDestroyNotify(xcb_destroy_notify_event_t *event)
         return;
 
     XWaylandShellSurface *shellSurface = m_windowsMap.take(event->window);
+    updateWindowCount();
     connect(shellSurface, &XWaylandShellSurface::unmapped,
             shellSurface, &XWaylandShellSurface::deleteLater);
     shellSurface->setSurface(nullptr);
@@ -539,16 +603,66 @@ void XWaylandManager::handlePropertyNotify(xcb_property_notify_event_t *event)
 {
     qCDebug(gLcXwaylandTrace, "XCB_PROPERTY_NOTIFY (window %d)", event->window);
 
-    XWaylandShellSurface *shellSurface = m_windowsMap[event->window];
+    XWaylandShellSurface *shellSurface = m_windowsMap.value(event->window);
     if (!shellSurface)
         return;
 
-    shellSurface->dirtyProperties();
-
     if (event->state == XCB_PROPERTY_DELETE)
         qCDebug(gLcXwaylandTrace, "\tdeleted");
-    else
-        Xcb::Properties::readAndDumpProperty(event->atom, event->window);
+
+    // Before the window is mapped the full read picks the change up. After
+    // that only the atom that changed is fetched, and the reply is handled
+    // once it arrives instead of waiting for it here.
+    if (!shellSurface->propertiesRead() || !shellSurface->watchesProperty(event->atom)) {
+        if (event->state != XCB_PROPERTY_DELETE)
+            Xcb::Properties::readAndDumpProperty(event->atom, event->window);
+        return;
+    }
+
+    PendingProperty pending;
+    pending.window = event->window;
+    pending.atom = event->atom;
+    pending.cookie = xcb_get_property(Xcb::connection(), 0, event->window,
+                                      event->atom, XCB_ATOM_ANY, 0, 2048);
+    m_pendingProperties.append(pending);
+}
+
+void XWaylandManager::processPropertyReplies()
+{
+    while (!m_pendingProperties.isEmpty()) {
+        const PendingProperty pending = m_pendingProperties.first();
+
+        void *reply = nullptr;
+        xcb_generic_error_t *error = nullptr;
+        if (!xcb_poll_for_reply(Xcb::connection(), pending.cookie.sequence, &reply, &error))
+            break;
+        m_pendingProperties.removeFirst();
+
+        // Bad window, usually
+        free(error);
+        if (!reply)
+            continue;
+
+        // a newer request for the same property supersedes this reply
+        bool superseded = false;
+        for (const PendingProperty &later : std::as_const(m_pendingProperties)) {
+            if (later.window == pending.window && later.atom == pending.atom) {
+                superseded = true;
+                break;
+            }
+        }
+
+        XWaylandShellSurface *shellSurface = m_windowsMap.value(pending.window);
+        if (shellSurface && !superseded)
+            shellSurface->updateProperty(pending.atom,
+                                         static_cast<xcb_get_property_reply_t *>(reply));
+        free(reply);
+    }
+
+    // Replies that xcb read off the socket while something else waited
+    // for its own reply don't wake up the notifier again
+    if (!m_pendingProperties.isEmpty() && !m_propertyTimer->isActive())
+        m_propertyTimer->start();
 }
 
 void XWaylandManager::handleClientMessage(xcb_client_message_event_t *event)
@@ -836,6 +950,8 @@ void XWaylandManager::wmEvents()
         count++;
     }
 
+    processPropertyReplies();
+
     if (count > 0)
         xcb_flush(Xcb::connection());
 }
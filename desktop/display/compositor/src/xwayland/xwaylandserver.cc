@@ -8,6 +8,7 @@
 #include <QtCore/QFile>
 #include <QtCore/QFutureWatcher>
 #include <QtCore/QSocketNotifier>
+#include <QtCore/QTimer>
 #include <QtConcurrent/QtConcurrentRun>
 
 #include "xwayland.h"
@@ -15,8 +16,13 @@
 
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
 #include <sys/un.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <signal.h>
+#include <stdio.h>
 #include <unistd.h>
 
 #include <wayland-server.h>
@@ -38,20 +44,57 @@ public:
 };
 
 
+static qint64 residentSizeKb(qint64 pid)
+{
+    QFile status(QStringLiteral("/proc/%1/status").arg(pid));
+    if (!status.open(QFile::ReadOnly))
+        return -1;
+
+    while (!status.atEnd()) {
+        const QByteArray line = status.readLine();
+        if (line.startsWith("VmRSS:"))
+            return line.mid(6).trimmed().split(' ').value(0).toLongLong();
+    }
+    return -1;
+}
+
 XWaylandServer::XWaylandServer(Compositor *compositor, QObject *parent)
     : QObject(parent)
     , m_compositor(compositor)
-    , m_display(0)
+    , m_display(-1)
     , m_process(nullptr)
+    , m_idleTimer(new QTimer(this))
+    , m_shuttingDown(false)
+    , m_failed(false)
     , m_client(nullptr)
 {
     m_serverPairFd[0] = m_serverPairFd[1] = -1;
     m_wmPairFd[0] = m_wmPairFd[1] = -1;
+    m_listenFd[0] = m_listenFd[1] = -1;
+    m_listenNotifier[0] = m_listenNotifier[1] = nullptr;
+
+    m_idleTimer->setSingleShot(true);
+    connect(m_idleTimer, &QTimer::timeout, this, [this] {
+        if (!m_process)
+            return;
+        qCInfo(gLcXwayland) << "Xwayland idle, stopping it until the next X11 client";
+        m_process->terminate();
+    });
+    connect(this, &XWaylandServer::started, this, [this] {
+        const qint64 pid = m_process ? m_process->processId() : 0;
+        qCInfo(gLcXwayland, "Xwayland ready after %lld ms, resident %lld KiB",
+               m_startTimer.elapsed(), pid > 0 ? residentSizeKb(pid) : -1LL);
+
+        // Xwayland might be started for a client that never maps a window
+        setIdle(true);
+    });
 }
 
 XWaylandServer::~XWaylandServer()
 {
+    m_shuttingDown = true;
     shutdown();
+    unbindDisplay();
 }
 
 Compositor *XWaylandServer::compositor() const
@@ -64,23 +107,186 @@ QString XWaylandServer::displayName() const
     return m_displayName;
 }
 
-bool XWaylandServer::start()
+static int openDisplaySocket(const sockaddr_un &addr, socklen_t size)
 {
-    if (::pipe(m_serverPairFd) < 0) {
-        qCWarning(gLcXwayland, "Failed to create pipe for XWayland server: %s",
-                  strerror(errno));
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+
+    if (::bind(fd, reinterpret_cast<const sockaddr *>(&addr), size) < 0
+            || ::listen(fd, 1) < 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool XWaylandServer::bindDisplay()
+{
+    // Same protocol as the X server itself: the lock file holds the
+    // owner's pid, stale ones are taken over
+    ::mkdir("/tmp/.X11-unix", 01777);
+
+    for (int display = 0; display <= 32; ++display) {
+        const QByteArray lockPath = QByteArray("/tmp/.X") + QByteArray::number(display) + "-lock";
+        int lockFd = ::open(lockPath.constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0444);
+        if (lockFd < 0 && errno == EEXIST) {
+            QFile lock(QString::fromLocal8Bit(lockPath));
+            if (!lock.open(QFile::ReadOnly))
+                continue;
+            bool ok = false;
+            const pid_t owner = lock.readAll().trimmed().toInt(&ok);
+            if (!ok || owner <= 0 || (::kill(owner, 0) < 0 && errno == ESRCH)) {
+                qCDebug(gLcXwayland, "Removing stale lock file %s", lockPath.constData());
+                ::unlink(lockPath.constData());
+                lockFd = ::open(lockPath.constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0444);
+            }
+        }
+        if (lockFd < 0)
+            continue;
+
+        char pid[12];
+        snprintf(pid, sizeof(pid), "%10d\n", int(::getpid()));
+        const bool written = ::write(lockFd, pid, 11) == 11;
+        ::close(lockFd);
+        if (!written) {
+            ::unlink(lockPath.constData());
+            continue;
+        }
+
+        const QByteArray path = QByteArray("/tmp/.X11-unix/X") + QByteArray::number(display);
+
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        addr.sun_path[0] = '\0';
+        memcpy(addr.sun_path + 1, path.constData(), path.size());
+        m_listenFd[0] = openDisplaySocket(addr, offsetof(sockaddr_un, sun_path) + 1 + path.size());
+
+        memset(addr.sun_path, 0, sizeof(addr.sun_path));
+        memcpy(addr.sun_path, path.constData(), path.size());
+        ::unlink(path.constData());
+        m_listenFd[1] = openDisplaySocket(addr, offsetof(sockaddr_un, sun_path) + path.size() + 1);
+
+        if (m_listenFd[0] < 0 || m_listenFd[1] < 0) {
+            qCDebug(gLcXwayland, "Display :%d is taken: %s", display, strerror(errno));
+            unbindDisplay();
+            ::unlink(lockPath.constData());
+            continue;
+        }
+
+        m_display = display;
+        m_displayName = QStringLiteral(":%1").arg(display);
+        Q_EMIT displayNameChanged();
+        return true;
+    }
+
+    qCWarning(gLcXwayland, "No free X11 display available");
+    return false;
+}
+
+void XWaylandServer::unbindDisplay()
+{
+    for (int i = 0; i < 2; ++i) {
+        delete m_listenNotifier[i];
+        m_listenNotifier[i] = nullptr;
+        if (m_listenFd[i] >= 0)
+            ::close(m_listenFd[i]);
+        m_listenFd[i] = -1;
+    }
+
+    if (m_display < 0)
+        return;
+
+    ::unlink(QByteArray("/tmp/.X11-unix/X" + QByteArray::number(m_display)).constData());
+    ::unlink(QByteArray("/tmp/.X" + QByteArray::number(m_display) + "-lock").constData());
+    m_display = -1;
+}
+
+void XWaylandServer::armListeners(bool enabled)
+{
+    for (int i = 0; i < 2; ++i) {
+        if (m_listenFd[i] < 0)
+            continue;
+
+        if (!m_listenNotifier[i]) {
+            m_listenNotifier[i] = new QSocketNotifier(m_listenFd[i], QSocketNotifier::Read, this);
+            connect(m_listenNotifier[i], &QSocketNotifier::activated, this, [this] {
+                if (m_failed) {
+                    rejectClients();
+                    return;
+                }
+
+                // Xwayland accepts the pending connection itself
+                armListeners(false);
+                qCInfo(gLcXwayland) << "X11 client connecting to" << m_displayName.toLatin1().constData()
+                                    << "- starting Xwayland";
+                if (!spawn())
+                    failStart();
+            });
+        }
+        m_listenNotifier[i]->setEnabled(enabled);
+    }
+}
+
+void XWaylandServer::rejectClients()
+{
+    // nobody is going to accept these, close them so the clients get an
+    // error rather than waiting for an X server
+    for (int i = 0; i < 2; ++i) {
+        if (m_listenFd[i] < 0)
+            continue;
+
+        pollfd pfd = { m_listenFd[i], POLLIN, 0 };
+        while (::poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN)) {
+            int fd = ::accept4(m_listenFd[i], nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd < 0)
+                break;
+            ::close(fd);
+        }
+    }
+}
+
+void XWaylandServer::failStart()
+{
+    // retrying cannot help, keep turning clients away instead of starting
+    // Xwayland for each of them
+    m_failed = true;
+    rejectClients();
+    armListeners(true);
+    Q_EMIT failedToStart();
+}
+
+bool XWaylandServer::start(bool onDemand)
+{
+    if (!bindDisplay())
         return false;
+
+    // clients started before Xwayland is up still find it
+    qputenv("DISPLAY", m_displayName.toLatin1());
+
+    if (onDemand) {
+        qCInfo(gLcXwayland) << "Xwayland will start on demand on display"
+                            << m_displayName.toLatin1().constData();
+        armListeners(true);
+        return true;
     }
 
-    if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, m_wmPairFd) < 0) {
-        qCWarning(gLcXwayland, "Failed to create socket pair for window manager: %s",
+    return spawn();
+}
+
+bool XWaylandServer::spawn()
+{
+    if (m_process)
+        return true;
+
+    if (::pipe2(m_serverPairFd, O_CLOEXEC) < 0) {
+        qCWarning(gLcXwayland, "Failed to create pipe for XWayland server: %s",
                   strerror(errno));
         return false;
     }
 
-    int fd = ::dup(m_wmPairFd[1]);
-    if (fd < 0) {
-        qCWarning(gLcXwayland, "Failed to duplicate socket for window manager: %s",
+    if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, m_wmPairFd) < 0) {
+        qCWarning(gLcXwayland, "Failed to create socket pair for window manager: %s",
                   strerror(errno));
         return false;
     }
@@ -93,8 +299,16 @@ bool XWaylandServer::start()
     }
     m_client = wl_client_create(m_compositor->display(), sx[0]);
 
+    // The child gets duplicates, which unlike the originals are not
+    // close-on-exec; ours are closed again once it is running
+    const int displayFd = ::dup(m_serverPairFd[1]);
+    const int wmFd = ::dup(m_wmPairFd[1]);
+    const int waylandFd = ::dup(sx[1]);
+    const int abstractFd = ::dup(m_listenFd[0]);
+    const int pathFd = ::dup(m_listenFd[1]);
+
     QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-    env.insert(QStringLiteral("WAYLAND_SOCKET"), QString::number(::dup(sx[1])));
+    env.insert(QStringLiteral("WAYLAND_SOCKET"), QString::number(waylandFd));
     env.insert(QStringLiteral("EGL_PLATFORM"), QStringLiteral("DRM"));
 
     m_process = new ServerProcess();
@@ -108,44 +322,90 @@ bool XWaylandServer::start()
         watcher->setFuture(QtConcurrent::run([this] { handleServerStarted(); }));
     });
     connect(m_process, &QProcess::errorOccurred, [this](QProcess::ProcessError error) {
-        if (error == QProcess::FailedToStart)
-            Q_EMIT failedToStart();
+        if (error != QProcess::FailedToStart)
+            return;
+
+        // no finished() follows
+        qCWarning(gLcXwayland) << "Failed to run Xwayland:" << m_process->errorString();
+        m_process->deleteLater();
+        m_process = nullptr;
+        m_client = nullptr;
+        ::close(m_serverPairFd[0]);
+        ::close(m_wmPairFd[0]);
+        ::close(m_wmPairFd[1]);
+        m_serverPairFd[0] = m_wmPairFd[0] = m_wmPairFd[1] = -1;
+        failStart();
     });
     connect(m_process, (void (QProcess::*)(int))&QProcess::finished, [this](int exitCode) {
         qCDebug(gLcXwayland) << "Xwayland finished with exit code" << exitCode;
 
+        m_idleTimer->stop();
         if (m_process) {
-            delete m_process;
+            m_process->deleteLater();
             m_process = nullptr;
         }
+        // the connection went away with the process, libwayland
+        // destroys the client on its own
+        m_client = nullptr;
+        ::close(m_wmPairFd[1]);
+        m_wmPairFd[0] = m_wmPairFd[1] = -1;
+
+        if (m_shuttingDown)
+            return;
+
+        Q_EMIT stopped();
+        armListeners(true);
     });
 
     QStringList args = QStringList()
-            << QStringLiteral("-displayfd") << QString::number(m_serverPairFd[1])
+            << m_displayName
+            << QStringLiteral("-displayfd") << QString::number(displayFd)
+            << QStringLiteral("-listenfd") << QString::number(abstractFd)
+            << QStringLiteral("-listenfd") << QString::number(pathFd)
             << QStringLiteral("-rootless")
-            << QStringLiteral("-wm") << QString::number(fd);
+            << QStringLiteral("-wm") << QString::number(wmFd);
     qCDebug(gLcXwayland) << "Running:" << "Xwayland" << qPrintable(args.join(QStringLiteral(" ")));
+    m_startTimer.start();
     m_process->start(QStringLiteral("Xwayland"), args);
 
+    ::close(displayFd);
+    ::close(wmFd);
+    ::close(waylandFd);
+    ::close(abstractFd);
+    ::close(pathFd);
+    ::close(sx[1]);
     ::close(m_serverPairFd[1]);
+    m_serverPairFd[1] = -1;
 
     return true;
 }
 
 void XWaylandServer::shutdown()
 {
-    // Terminate XWayland server
-    if (m_process) {
-        m_process->terminate();
-        m_process->waitForFinished();
+    m_idleTimer->stop();
+
+    // Terminate XWayland server, finished() clears m_process
+    if (ServerProcess *process = m_process) {
+        process->terminate();
+        if (!process->waitForFinished(3000)) {
+            // Kill the process only if it's still running
+            process->kill();
+            process->waitForFinished();
+        }
+    }
+}
 
-        // Kill the process only if it's still running
-        if (m_process && m_process->state() == QProcess::Running)
-            m_process->kill();
+void XWaylandServer::setIdleTimeout(int msecs)
+{
+    m_idleTimer->setInterval(msecs);
+}
 
-        m_process->deleteLater();
-        m_process = nullptr;
-    }
+void XWaylandServer::setIdle(bool idle)
+{
+    if (idle && m_process && m_idleTimer->interval() > 0)
+        m_idleTimer->start();
+    else
+        m_idleTimer->stop();
 }
 
 void XWaylandServer::handleServerStarted()
@@ -154,28 +414,25 @@ void XWaylandServer::handleServerStarted()
     if (!readPipe.open(m_serverPairFd[0], QFile::ReadOnly)) {
         qCWarning(gLcXwayland, "Failed to open pipe to start Xwayland: %s",
                   readPipe.errorString().toLatin1().constData());
+        ::close(m_serverPairFd[0]);
         return;
     }
 
+    // Xwayland writes the display number once it is ready for clients
     QByteArray displayNumber = readPipe.readLine().trimmed();
+    readPipe.close();
+    ::close(m_serverPairFd[0]);
+    m_serverPairFd[0] = -1;
 
     bool ok = false;
-    m_display = displayNumber.toInt(&ok);
-    if (!ok) {
-        qCWarning(gLcXwayland, "Xwayland display read from pipe is not a number: %s",
+    const int display = displayNumber.toInt(&ok);
+    if (!ok || display != m_display) {
+        qCWarning(gLcXwayland, "Xwayland display read from pipe is not ours: %s",
                   displayNumber.constData());
         return;
     }
 
-    displayNumber.prepend(QByteArray(":"));
-    m_displayName = QString::fromLatin1(displayNumber);
-    Q_EMIT displayNameChanged();
-
-    qputenv("DISPLAY", m_displayName.toLatin1());
-
     qCInfo(gLcXwayland) << "Xwayland started on display" << m_displayName.toLatin1().constData();
 
-    ::close(m_serverPairFd[0]);
-
     Q_EMIT started(m_displayName);
 }
@@ -71,7 +71,7 @@ XWaylandShellSurface::XWaylandShellSurface(QObject *parent)
 XWaylandShellSurface::~XWaylandShellSurface()
 {
     if (m_wm)
-        m_wm->removeWindow(m_window);
+        m_wm->removeWindow(m_window, this);
 }
 
 void XWaylandShellSurface::initialize(XWaylandManager *wm, quint32 window,
@@ -168,7 +168,7 @@ void XWaylandShellSurface::setSurface(QWaylandSurface *surface)
     } else {
         qCDebug(gLcXwayland) << "Unassign surface to shell surface for" << m_window;
         Q_EMIT unmapped();
-        m_wm->removeWindow(m_window);
+        m_wm->removeWindow(m_window, this);
     }
 }
 
@@ -295,17 +295,10 @@ void XWaylandShellSurface::setWorkspace(int workspace)
     xcb_flush(Xcb::connection());
 }
 
-void XWaylandShellSurface::dirtyProperties()
+// The properties the window manager follows, and how their values are
+// interpreted. Not cached, the atoms are per connection to Xwayland.
+static QMap<xcb_atom_t, xcb_atom_t> watchedProperties()
 {
-    m_propsDirty = true;
-}
-
-void XWaylandShellSurface::readProperties()
-{
-    if (!m_propsDirty)
-        return;
-    m_propsDirty = false;
-
     QMap<xcb_atom_t, xcb_atom_t> props;
     props[XCB_ATOM_WM_CLASS] = XCB_ATOM_STRING;
     props[XCB_ATOM_WM_NAME] = XCB_ATOM_STRING;
@@ -316,7 +309,18 @@ void XWaylandShellSurface::readProperties()
     props[Xcb::resources()->atoms->net_wm_window_type] = XCB_ATOM_ATOM;
     props[Xcb::resources()->atoms->net_wm_name] = XCB_ATOM_STRING;
     props[Xcb::resources()->atoms->motif_wm_hints] = TYPE_MOTIF_WM_HINTS;
+    return props;
+}
+
+void XWaylandShellSurface::readProperties()
+{
+    if (!m_propsDirty)
+        return;
+    m_propsDirty = false;
 
+    const QMap<xcb_atom_t, xcb_atom_t> props = watchedProperties();
+
+    // send all requests before waiting for the first reply
     QMap<xcb_atom_t, xcb_get_property_cookie_t> cookies;
     for (xcb_atom_t atom : props.keys()) {
         xcb_get_property_cookie_t cookie = xcb_get_property(
@@ -324,10 +328,6 @@ void XWaylandShellSurface::readProperties()
         cookies[atom] = cookie;
     }
 
-    m_sizeHints.flags = 0;
-    m_motifHints.flags = 0;
-    m_properties.deleteWindow = 0;
-
     if (m_overrideRedirect) {
         m_decorate = false;
         Q_EMIT decorateChanged();
@@ -341,140 +341,182 @@ void XWaylandShellSurface::readProperties()
         if (!reply)
             // Bad window, usually
             continue;
-        if (reply->type == XCB_ATOM_NONE) {
-            // No such property
-            free(reply);
-            continue;
-        }
 
-        Xcb::Properties::dumpProperty(atom, reply);
+        applyProperty(atom, props[atom], reply);
+        free(reply);
+    }
+}
 
-        switch (props[atom]) {
-        case XCB_ATOM_STRING: {
-            char *p = strndup(reinterpret_cast<char *>(xcb_get_property_value(reply)),
-                              xcb_get_property_value_length(reply));
-            if (atom == XCB_ATOM_WM_CLASS) {
-                m_properties.appId = QString::fromUtf8(p);
+bool XWaylandShellSurface::propertiesRead() const
+{
+    return !m_propsDirty;
+}
+
+bool XWaylandShellSurface::watchesProperty(xcb_atom_t atom) const
+{
+    return watchedProperties().contains(atom);
+}
+
+void XWaylandShellSurface::updateProperty(xcb_atom_t atom, xcb_get_property_reply_t *reply)
+{
+    const xcb_atom_t type = watchedProperties().value(atom, XCB_ATOM_NONE);
+    if (type != XCB_ATOM_NONE)
+        applyProperty(atom, type, reply);
+}
+
+void XWaylandShellSurface::applyProperty(xcb_atom_t atom, xcb_atom_t type,
+                                         xcb_get_property_reply_t *reply)
+{
+    // a deleted property resets what it controls
+    switch (type) {
+    case TYPE_WM_PROTOCOLS:
+        m_properties.deleteWindow = 0;
+        break;
+    case TYPE_WM_NORMAL_HINTS:
+        m_sizeHints.flags = 0;
+        break;
+    case TYPE_MOTIF_WM_HINTS:
+        m_motifHints.flags = 0;
+        break;
+    default:
+        break;
+    }
+
+    if (reply->type == XCB_ATOM_NONE)
+        // No such property
+        return;
+
+    Xcb::Properties::dumpProperty(atom, reply);
+
+    switch (type) {
+    case XCB_ATOM_STRING: {
+        char *p = strndup(reinterpret_cast<char *>(xcb_get_property_value(reply)),
+                          xcb_get_property_value_length(reply));
+        const QString value = QString::fromUtf8(p);
+        free(p);
+        // terminals and browsers rewrite their title constantly, mostly
+        // with the same text
+        if (atom == XCB_ATOM_WM_CLASS) {
+            if (value != m_properties.appId) {
+                m_properties.appId = value;
                 Q_EMIT appIdChanged();
-            } else if (atom == XCB_ATOM_WM_NAME || Xcb::resources()->atoms->net_wm_name) {
-                m_properties.title = QString::fromUtf8(p);
+            }
+        } else if (atom == XCB_ATOM_WM_NAME || atom == Xcb::resources()->atoms->net_wm_name) {
+            if (value != m_properties.title) {
+                m_properties.title = value;
                 Q_EMIT titleChanged();
-            } else {
-                free(p);
             }
-            break;
         }
-        case XCB_ATOM_WINDOW: {
-            xcb_window_t *xid = reinterpret_cast<xcb_window_t *>(xcb_get_property_value(reply));
-            XWaylandShellSurface *shellSurface = m_wm->shellSurfaceFromId(*xid);
-            if (shellSurface) {
-                m_transientFor = shellSurface;
-                m_windowType = Qt::SubWindow;
-                Q_EMIT parentSurfaceChanged();
-                Q_EMIT windowTypeChanged();
-            }
-            break;
+        break;
+    }
+    case XCB_ATOM_WINDOW: {
+        xcb_window_t *xid = reinterpret_cast<xcb_window_t *>(xcb_get_property_value(reply));
+        XWaylandShellSurface *shellSurface = m_wm->shellSurfaceFromId(*xid);
+        if (shellSurface) {
+            m_transientFor = shellSurface;
+            m_windowType = Qt::SubWindow;
+            Q_EMIT parentSurfaceChanged();
+            Q_EMIT windowTypeChanged();
         }
-        case XCB_ATOM_ATOM: {
-            if (atom == Xcb::resources()->atoms->net_wm_window_type) {
-                xcb_atom_t *atoms = static_cast<xcb_atom_t *>(xcb_get_property_value(reply));
-                for (quint32 i = 0; i < reply->value_len; ++i) {
-                    // Set Popup window type unless we already know this is a SubWindow
-                    if (!m_transientFor) {
-                        if (atoms[i] == Xcb::resources()->atoms->net_wm_window_type_tooltip ||
-                                atoms[i] == Xcb::resources()->atoms->net_wm_window_type_utility ||
-                                atoms[i] == Xcb::resources()->atoms->net_wm_window_type_dnd ||
-                                atoms[i] == Xcb::resources()->atoms->net_wm_window_type_dropdown ||
-                                atoms[i] == Xcb::resources()->atoms->net_wm_window_type_menu ||
-                                atoms[i] == Xcb::resources()->atoms->net_wm_window_type_notification ||
-                                atoms[i] == Xcb::resources()->atoms->net_wm_window_type_popup ||
-                                atoms[i] == Xcb::resources()->atoms->net_wm_window_type_combo) {
-                            m_windowType = Qt::Popup;
-                            Q_EMIT windowTypeChanged();
-                        }
+        break;
+    }
+    case XCB_ATOM_ATOM: {
+        if (atom == Xcb::resources()->atoms->net_wm_window_type) {
+            xcb_atom_t *atoms = static_cast<xcb_atom_t *>(xcb_get_property_value(reply));
+            for (quint32 i = 0; i < reply->value_len; ++i) {
+                // Set Popup window type unless we already know this is a SubWindow
+                if (!m_transientFor) {
+                    if (atoms[i] == Xcb::resources()->atoms->net_wm_window_type_tooltip ||
+                            atoms[i] == Xcb::resources()->atoms->net_wm_window_type_utility ||
+                            atoms[i] == Xcb::resources()->atoms->net_wm_window_type_dnd ||
+                            atoms[i] == Xcb::resources()->atoms->net_wm_window_type_dropdown ||
+                            atoms[i] == Xcb::resources()->atoms->net_wm_window_type_menu ||
+                            atoms[i] == Xcb::resources()->atoms->net_wm_window_type_notification ||
+                            atoms[i] == Xcb::resources()->atoms->net_wm_window_type_popup ||
+                            atoms[i] == Xcb::resources()->atoms->net_wm_window_type_combo) {
+                        m_windowType = Qt::Popup;
+                        Q_EMIT windowTypeChanged();
                     }
+                }
 
-                    // Save XWayland window type
-                    WmWindowType wmWindowType;
-                    if (atoms[i] == Xcb::resources()->atoms->net_wm_window_type_tooltip)
-                        wmWindowType = TooltipWindow;
-                    else if (atoms[i] == Xcb::resources()->atoms->net_wm_window_type_utility)
-                        wmWindowType = UtilityWindow;
-                    else if (atoms[i] == Xcb::resources()->atoms->net_wm_window_type_dnd)
-                        wmWindowType = DndWindow;
-                    else if (atoms[i] == Xcb::resources()->atoms->net_wm_window_type_dropdown)
-                        wmWindowType = DropdownWindow;
-                    else if (atoms[i] == Xcb::resources()->atoms->net_wm_window_type_menu)
-                        wmWindowType = MenuWindow;
-                    else if (atoms[i] == Xcb::resources()->atoms->net_wm_window_type_notification)
-                        wmWindowType = NotificationWindow;
-                    else if (atoms[i] == Xcb::resources()->atoms->net_wm_window_type_popup)
-                        wmWindowType = PopupWindow;
-                    else if (atoms[i] == Xcb::resources()->atoms->net_wm_window_type_combo)
-                        wmWindowType = ComboWindow;
-                    else if (atoms[i] == Xcb::resources()->atoms->net_wm_window_type_splash)
-                        wmWindowType = SplashWindow;
-                    else
-                        wmWindowType = ToplevelWindow;
-                    if (wmWindowType != m_wmWindowType) {
-                        m_wmWindowType = wmWindowType;
-                        Q_EMIT wmWindowTypeChanged();
-                    }
+                // Save XWayland window type
+                WmWindowType wmWindowType;
+                if (atoms[i] == Xcb::resources()->atoms->net_wm_window_type_tooltip)
+                    wmWindowType = TooltipWindow;
+                else if (atoms[i] == Xcb::resources()->atoms->net_wm_window_type_utility)
+                    wmWindowType = UtilityWindow;
+                else if (atoms[i] == Xcb::resources()->atoms->net_wm_window_type_dnd)
+                    wmWindowType = DndWindow;
+                else if (atoms[i] == Xcb::resources()->atoms->net_wm_window_type_dropdown)
+                    wmWindowType = DropdownWindow;
+                else if (atoms[i] == Xcb::resources()->atoms->net_wm_window_type_menu)
+                    wmWindowType = MenuWindow;
+                else if (atoms[i] == Xcb::resources()->atoms->net_wm_window_type_notification)
+                    wmWindowType = NotificationWindow;
+                else if (atoms[i] == Xcb::resources()->atoms->net_wm_window_type_popup)
+                    wmWindowType = PopupWindow;
+                else if (atoms[i] == Xcb::resources()->atoms->net_wm_window_type_combo)
+                    wmWindowType = ComboWindow;
+                else if (atoms[i] == Xcb::resources()->atoms->net_wm_window_type_splash)
+                    wmWindowType = SplashWindow;
+                else
+                    wmWindowType = ToplevelWindow;
+                if (wmWindowType != m_wmWindowType) {
+                    m_wmWindowType = wmWindowType;
+                    Q_EMIT wmWindowTypeChanged();
+                }
 
-                    // Make sure only toplevel windows are decorated
-                    if (m_decorate && m_wmWindowType != ToplevelWindow) {
-                        m_decorate = false;
-                        Q_EMIT decorateChanged();
-                    }
+                // Make sure only toplevel windows are decorated
+                if (m_decorate && m_wmWindowType != ToplevelWindow) {
+                    m_decorate = false;
+                    Q_EMIT decorateChanged();
                 }
             }
-            break;
-        }
-        case TYPE_WM_PROTOCOLS: {
-            xcb_atom_t *atoms = reinterpret_cast<xcb_atom_t *>(xcb_get_property_value(reply));
-            for (quint32 i = 0; i < reply->value_len; ++i)
-                if (atoms[i] == Xcb::resources()->atoms->wm_delete_window)
-                    m_properties.deleteWindow = 1;
-            break;
         }
-        case TYPE_WM_NORMAL_HINTS:
-            memcpy(&m_sizeHints, xcb_get_property_value(reply), sizeof m_sizeHints);
-            break;
-        case TYPE_NET_WM_STATE: {
-            xcb_atom_t *value = reinterpret_cast<xcb_atom_t *>(xcb_get_property_value(reply));
-            uint32_t i;
-            for (i = 0; i < reply->value_len; i++) {
-                if (value[i] == Xcb::resources()->atoms->net_wm_state_fullscreen && !m_fullscreen) {
-                    m_fullscreen = true;
-                    Q_EMIT fullscreenChanged();
-                }
-            }
-            if (value[i] == Xcb::resources()->atoms->net_wm_state_maximized_horz && !m_maximized) {
-                m_maximized = true;
-                Q_EMIT maximizedChanged();
-            }
-            if (value[i] == Xcb::resources()->atoms->net_wm_state_maximized_vert && !m_maximized) {
-                m_maximized = true;
-                Q_EMIT maximizedChanged();
+        break;
+    }
+    case TYPE_WM_PROTOCOLS: {
+        xcb_atom_t *atoms = reinterpret_cast<xcb_atom_t *>(xcb_get_property_value(reply));
+        for (quint32 i = 0; i < reply->value_len; ++i)
+            if (atoms[i] == Xcb::resources()->atoms->wm_delete_window)
+                m_properties.deleteWindow = 1;
+        break;
+    }
+    case TYPE_WM_NORMAL_HINTS:
+        memcpy(&m_sizeHints, xcb_get_property_value(reply), sizeof m_sizeHints);
+        break;
+    case TYPE_NET_WM_STATE: {
+        xcb_atom_t *value = reinterpret_cast<xcb_atom_t *>(xcb_get_property_value(reply));
+        uint32_t i;
+        for (i = 0; i < reply->value_len; i++) {
+            if (value[i] == Xcb::resources()->atoms->net_wm_state_fullscreen && !m_fullscreen) {
+                m_fullscreen = true;
+                Q_EMIT fullscreenChanged();
             }
-            break;
         }
-        case TYPE_MOTIF_WM_HINTS:
-            memcpy(&m_motifHints, xcb_get_property_value(reply), sizeof m_motifHints);
-            if (m_motifHints.flags & MWM_HINTS_DECORATIONS) {
-                if (m_motifHints.decorations & MWM_DECOR_ALL)
-                    // MWM_DECOR_ALL means all except the other values listed
-                    m_decorate = MWM_DECOR_EVERYTHING & (~m_motifHints.decorations);
-                else
-                    m_decorate = m_motifHints.decorations > 0;
-                Q_EMIT decorateChanged();
-            }
-            break;
-        default:
-            break;
+        if (value[i] == Xcb::resources()->atoms->net_wm_state_maximized_horz && !m_maximized) {
+            m_maximized = true;
+            Q_EMIT maximizedChanged();
         }
-
-        free(reply);
+        if (value[i] == Xcb::resources()->atoms->net_wm_state_maximized_vert && !m_maximized) {
+            m_maximized = true;
+            Q_EMIT maximizedChanged();
+        }
+        break;
+    }
+    case TYPE_MOTIF_WM_HINTS:
+        memcpy(&m_motifHints, xcb_get_property_value(reply), sizeof m_motifHints);
+        if (m_motifHints.flags & MWM_HINTS_DECORATIONS) {
+            if (m_motifHints.decorations & MWM_DECOR_ALL)
+                // MWM_DECOR_ALL means all except the other values listed
+                m_decorate = MWM_DECOR_EVERYTHING & (~m_motifHints.decorations);
+            else
+                m_decorate = m_motifHints.decorations > 0;
+            Q_EMIT decorateChanged();
+        }
+        break;
+    default:
+        break;
     }
 }
 
@@ -2,6 +2,8 @@ TEMPLATE = subdirs
 SUBDIRS = \
     driver \
     compositor \
-    proxy
+    proxy \
+    benchmark
     compositor.depends = driver
+    benchmark.depends = compositor
 
@@ -95,6 +95,7 @@ public:
     virtual void *nativeResourceForIntegration(const QByteArray &name);
     virtual void *nativeResourceForScreen(const QByteArray &resource, QScreen *screen);
     virtual void *wlDisplay() const;
+    virtual bool requiresSession() const;
 
     static EGLConfig chooseConfig(EGLDisplay display, const QSurfaceFormat &format);
 };
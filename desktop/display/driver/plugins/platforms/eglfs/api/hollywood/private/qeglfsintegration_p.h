@@ -119,6 +119,7 @@ public:
 
 private:
     EGLNativeDisplayType nativeDisplay() const;
+    void initializeDisplay();
     void createInputHandlers();
 
     static void setCursorThemeStatic(const QString &name, int size);
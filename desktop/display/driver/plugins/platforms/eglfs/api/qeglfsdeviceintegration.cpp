@@ -375,6 +375,13 @@ void *HWEglFSDeviceIntegration::wlDisplay() const
     return nullptr;
 }
 
+// Integrations driving real hardware need a logind session (DRM master,
+// input devices, VT). Virtual outputs can start without one.
+bool HWEglFSDeviceIntegration::requiresSession() const
+{
+    return true;
+}
+
 EGLConfig HWEglFSDeviceIntegration::chooseConfig(EGLDisplay display, const QSurfaceFormat &format)
 {
     class Chooser : public QEglConfigChooser {
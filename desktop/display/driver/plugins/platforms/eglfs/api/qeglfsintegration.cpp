@@ -112,35 +112,48 @@ void HWEglFSIntegration::removeScreen(QPlatformScreen *screen)
 
 void HWEglFSIntegration::initialize()
 {
+    if (!qt_egl_device_integration()->requiresSession()) {
+        // no seat, VT or libinput devices to acquire
+        initializeDisplay();
+        return;
+    }
+
     m_logindHandler = new QEglFSLogindHandler();
     connect(m_logindHandler, &QEglFSLogindHandler::initializationRequested, this, [&] {
-        qt_egl_device_integration()->platformInit();
+        initializeDisplay();
+
+        // Exit initialization
+        m_logindHandler->stop();
+    });
+    m_logindHandler->initialize();
+}
 
-        m_display = qt_egl_device_integration()->createDisplay(nativeDisplay());
-        if (Q_UNLIKELY(m_display == EGL_NO_DISPLAY))
-            qFatal("Could not open egl display");
+void HWEglFSIntegration::initializeDisplay()
+{
+    const bool session = qt_egl_device_integration()->requiresSession();
+    qt_egl_device_integration()->platformInit();
 
-        EGLint major, minor;
-        if (Q_UNLIKELY(!eglInitialize(m_display, &major, &minor)))
-            qFatal("Could not initialize egl display");
+    m_display = qt_egl_device_integration()->createDisplay(nativeDisplay());
+    if (Q_UNLIKELY(m_display == EGL_NO_DISPLAY))
+        qFatal("Could not open egl display");
 
-        m_inputContext = QPlatformInputContextFactory::create();
+    EGLint major, minor;
+    if (Q_UNLIKELY(!eglInitialize(m_display, &major, &minor)))
+        qFatal("Could not initialize egl display");
 
-        m_vtHandler.reset(new VtHandler);
+    m_inputContext = QPlatformInputContextFactory::create();
 
-        if (qt_egl_device_integration()->usesDefaultScreen())
-            QWindowSystemInterface::handleScreenAdded(new HWEglFSScreen(display()));
-        else
-            qt_egl_device_integration()->screenInit();
+    if (session)
+        m_vtHandler.reset(new VtHandler);
 
-        // Input code may rely on the screens, so do it only after the screen init.
-        if (!m_disableInputHandlers)
-            createInputHandlers();
+    if (qt_egl_device_integration()->usesDefaultScreen())
+        QWindowSystemInterface::handleScreenAdded(new HWEglFSScreen(display()));
+    else
+        qt_egl_device_integration()->screenInit();
 
-        // Exit initialization
-        m_logindHandler->stop();
-    });
-    m_logindHandler->initialize();
+    // Input code may rely on the screens, so do it only after the screen init.
+    if (!m_disableInputHandlers && session)
+        createInputHandlers();
 }
 
 void HWEglFSIntegration::destroy()
@@ -155,7 +168,8 @@ void HWEglFSIntegration::destroy()
 
     qt_egl_device_integration()->platformDestroy();
 
-    m_logindHandler->deleteLater();
+    if (m_logindHandler)
+        m_logindHandler->deleteLater();
 }
 
 QAbstractEventDispatcher *HWEglFSIntegration::createEventDispatcher() const
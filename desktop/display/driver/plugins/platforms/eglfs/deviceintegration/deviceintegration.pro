@@ -1,7 +1,7 @@
 TEMPLATE = subdirs
 QT_FOR_CONFIG += gui-private
 
-SUBDIRS *= eglfs_kms_support eglfs_kms
+SUBDIRS *= eglfs_kms_support eglfs_kms eglfs_headless
 #qtConfig(eglfs_egldevice): SUBDIRS *= eglfs_kms_support eglfs_kms_egldevice
 #qtConfig(eglfs_vsp2): SUBDIRS += eglfs_kms_vsp2
 #qtConfig(eglfs_brcm): SUBDIRS += eglfs_brcm
@@ -0,0 +1,43 @@
+include(../../../../../../../include/global.pri)
+TARGET = eglfs-headless-integration
+
+PLUGIN_TYPE = hwegldeviceintegrations
+PLUGIN_CLASS_NAME = HWEglFSHeadlessIntegrationPlugin
+TEMPLATE=lib
+CONFIG += plugin
+QT += core-private gui-private opengl_private
+
+DESTDIR=$${OBJECTS_DIR}../../../../../../../output/
+
+INCLUDEPATH += $$PWD/../../api
+INCLUDEPATH += $$PWD/../../api/hollywood/private
+INCLUDEPATH += $$PWD/../../api/hollywood
+INCLUDEPATH += $$PWD/../../../../../platformheaders/
+INCLUDEPATH += $$PWD/../../../../../eglfsxkb/hollywood
+# Avoid X11 header collision, use generic EGL native types
+DEFINES += QT_EGL_NO_X11
+
+CONFIG += egl link_pkgconfig
+PKGCONFIG += xkbcommon
+
+SOURCES += $$PWD/qeglfsheadlessmain.cpp \
+           $$PWD/qeglfsheadlessintegration.cpp \
+           $$PWD/qeglfsheadlessscreen.cpp \
+           $$PWD/qeglfsheadlesswindow.cpp \
+           $$PWD/qeglfsheadlessinput.cpp \
+           $$PWD/../../../../../eglfsxkb/eglfsxkb.cpp
+
+HEADERS += $$PWD/qeglfsheadlessintegration_p.h \
+           $$PWD/qeglfsheadlessscreen_p.h \
+           $$PWD/qeglfsheadlesswindow_p.h \
+           $$PWD/qeglfsheadlessinput_p.h
+
+OTHER_FILES += $$PWD/eglfs_headless.json
+
+LIBS += -L$$OUT_PWD \
+    -L$${OBJECTS_DIR}../../../../../../../output/ \
+    -L$$[QT_INSTALL_PLUGINS]/platforms/ \
+    -lHWEglFSDeviceIntegration
+
+target.path = $$[QT_INSTALL_PLUGINS]/hwdeviceintegrations
+INSTALLS += target
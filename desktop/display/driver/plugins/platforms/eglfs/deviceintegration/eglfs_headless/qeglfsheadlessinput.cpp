@@ -0,0 +1,138 @@
+// Hollywood Wayland Compositor
+// SPDX-FileCopyrightText: 2024 Originull Software
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "qeglfsheadlessinput_p.h"
+#include "eglfsxkb.h"
+
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QSocketNotifier>
+#include <QtCore/QVarLengthArray>
+#include <QtCore/private/qcore_unix_p.h>
+#include <qpa/qwindowsysteminterface.h>
+
+#include <cstring>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+Q_DECLARE_LOGGING_CATEGORY(qLcEglfsHeadlessDebug)
+
+using namespace Originull::Platform;
+
+HWEglFSHeadlessInput::HWEglFSHeadlessInput(const QByteArray &path, QObject *parent)
+    : QObject(parent)
+    , m_path(path)
+{
+    struct stat st;
+    if (::stat(path.constData(), &st) != 0 && ::mkfifo(path.constData(), 0600) != 0) {
+        qCWarning(qLcEglfsHeadlessDebug, "Could not create input FIFO %s: %s",
+                  path.constData(), strerror(errno));
+        return;
+    }
+
+    // Opening for writing as well keeps the FIFO from reporting EOF every
+    // time the injecting process closes its end.
+    m_fd = qt_safe_open(path.constData(), O_RDWR | O_NONBLOCK);
+    if (m_fd < 0) {
+        qCWarning(qLcEglfsHeadlessDebug, "Could not open input FIFO %s: %s",
+                  path.constData(), strerror(errno));
+        return;
+    }
+
+    m_context = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
+    if (m_context)
+        m_keymap = xkb_keymap_new_from_names(m_context, nullptr, XKB_KEYMAP_COMPILE_NO_FLAGS);
+    if (m_keymap)
+        m_state = xkb_state_new(m_keymap);
+
+    m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &HWEglFSHeadlessInput::readCommands);
+    qCInfo(qLcEglfsHeadlessDebug, "Accepting injected input on %s", path.constData());
+}
+
+HWEglFSHeadlessInput::~HWEglFSHeadlessInput()
+{
+    if (m_state)
+        xkb_state_unref(m_state);
+    if (m_keymap)
+        xkb_keymap_unref(m_keymap);
+    if (m_context)
+        xkb_context_unref(m_context);
+    if (m_fd >= 0)
+        qt_safe_close(m_fd);
+}
+
+void HWEglFSHeadlessInput::readCommands()
+{
+    char buf[4096];
+    ssize_t len;
+    while ((len = qt_safe_read(m_fd, buf, sizeof(buf))) > 0)
+        m_buffer.append(buf, len);
+
+    int eol;
+    while ((eol = m_buffer.indexOf('\n')) >= 0) {
+        handleCommand(m_buffer.left(eol).simplified());
+        m_buffer.remove(0, eol + 1);
+    }
+}
+
+void HWEglFSHeadlessInput::handleCommand(const QByteArray &line)
+{
+    const QList<QByteArray> args = line.split(' ');
+    const QByteArray &cmd = args.first();
+
+    if (cmd == "motion" && args.count() == 3) {
+        m_pos = QPoint(args.at(1).toInt(), args.at(2).toInt());
+        QWindowSystemInterface::handleMouseEvent(nullptr, m_pos, m_pos, m_buttons,
+                                                 Qt::NoButton, QEvent::MouseMove, m_modifiers);
+    } else if (cmd == "button" && args.count() == 3) {
+        Qt::MouseButton button = Qt::LeftButton;
+        if (args.at(1) == "right")
+            button = Qt::RightButton;
+        else if (args.at(1) == "middle")
+            button = Qt::MiddleButton;
+
+        const bool pressed = args.at(2) == "press";
+        m_buttons.setFlag(button, pressed);
+        QWindowSystemInterface::handleMouseEvent(nullptr, m_pos, m_pos, m_buttons, button,
+                                                 pressed ? QEvent::MouseButtonPress : QEvent::MouseButtonRelease,
+                                                 m_modifiers);
+    } else if (cmd == "axis" && args.count() == 3) {
+        const QPoint delta(args.at(1).toInt(), args.at(2).toInt());
+        QWindowSystemInterface::handleWheelEvent(nullptr, m_pos, m_pos, QPoint(), delta, m_modifiers);
+    } else if (cmd == "key" && args.count() == 3) {
+        handleKey(args.at(1).toUInt(), args.at(2) == "press");
+    } else if (!cmd.isEmpty()) {
+        qCWarning(qLcEglfsHeadlessDebug) << "Unknown injected input command" << line;
+    }
+}
+
+void HWEglFSHeadlessInput::handleKey(quint32 code, bool pressed)
+{
+    if (!m_state)
+        return;
+
+    // same translation as LibInputKeyboard
+    const quint32 key = code + 8;
+    const xkb_keysym_t keysym = xkb_state_key_get_one_sym(m_state, key);
+
+    QVarLengthArray<char, 32> chars(32);
+    const int size = xkb_state_key_get_utf8(m_state, key, chars.data(), chars.size());
+    if (Q_UNLIKELY(size + 1 > chars.size())) { // +1 for NUL
+        chars.resize(size + 1);
+        xkb_state_key_get_utf8(m_state, key, chars.data(), chars.size());
+    }
+    const QString text = QString::fromUtf8(chars.constData(), size);
+
+    Qt::KeyboardModifiers modifiers = Qt::NoModifier;
+    const int qtkey = EglFSXkb::keysymToQtKey(keysym, modifiers, text);
+
+    xkb_state_update_key(m_state, key, pressed ? XKB_KEY_DOWN : XKB_KEY_UP);
+    m_modifiers = EglFSXkb::modifiers(m_state);
+
+    QWindowSystemInterface::handleExtendedKeyEvent(nullptr, pressed ? QEvent::KeyPress : QEvent::KeyRelease,
+                                                   qtkey, m_modifiers, key, keysym, m_modifiers,
+                                                   text, false, 1);
+}
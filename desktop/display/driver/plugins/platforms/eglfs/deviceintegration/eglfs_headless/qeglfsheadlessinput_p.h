@@ -0,0 +1,60 @@
+// Hollywood Wayland Compositor
+// SPDX-FileCopyrightText: 2024 Originull Software
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef QEGLFSHEADLESSINPUT_H
+#define QEGLFSHEADLESSINPUT_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/QObject>
+#include <QtCore/QPoint>
+#include <QtCore/QByteArray>
+
+#include <xkbcommon/xkbcommon.h>
+
+class QSocketNotifier;
+
+// Reads newline separated input commands from a FIFO and feeds them to
+// QWindowSystemInterface, standing in for libinput on headless outputs:
+//
+//   motion X Y               absolute pointer position in global coordinates
+//   button left|right|middle press|release
+//   axis DX DY               wheel, in eighths of a degree
+//   key CODE press|release   evdev key code (KEY_* from linux/input.h)
+class HWEglFSHeadlessInput : public QObject
+{
+    Q_OBJECT
+public:
+    explicit HWEglFSHeadlessInput(const QByteArray &path, QObject *parent = nullptr);
+    ~HWEglFSHeadlessInput();
+
+private Q_SLOTS:
+    void readCommands();
+
+private:
+    void handleCommand(const QByteArray &line);
+    void handleKey(quint32 code, bool pressed);
+
+    QByteArray m_path;
+    int m_fd = -1;
+    QSocketNotifier *m_notifier = nullptr;
+    QByteArray m_buffer;
+    QPoint m_pos;
+    Qt::MouseButtons m_buttons = Qt::NoButton;
+    Qt::KeyboardModifiers m_modifiers = Qt::NoModifier;
+    xkb_context *m_context = nullptr;
+    xkb_keymap *m_keymap = nullptr;
+    xkb_state *m_state = nullptr;
+};
+
+#endif // QEGLFSHEADLESSINPUT_H
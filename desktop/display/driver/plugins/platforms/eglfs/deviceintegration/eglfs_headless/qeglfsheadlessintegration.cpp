@@ -0,0 +1,145 @@
+// Hollywood Wayland Compositor
+// SPDX-FileCopyrightText: 2024 Originull Software
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "qeglfsheadlessintegration_p.h"
+#include "qeglfsheadlessscreen_p.h"
+#include "qeglfsheadlesswindow_p.h"
+#include "qeglfsheadlessinput_p.h"
+#include "private/qeglfsintegration_p.h"
+
+#include <QtCore/QLoggingCategory>
+#include <QtGui/private/qguiapplication_p.h>
+#include <qpa/qwindowsysteminterface.h>
+#include <qpa/qplatformwindow.h>
+
+#include <cstring>
+
+Q_LOGGING_CATEGORY(qLcEglfsHeadlessDebug, "compositor.headless", QtInfoMsg)
+
+#ifndef EGL_EXT_platform_base
+typedef EGLDisplay (EGLAPIENTRYP PFNEGLGETPLATFORMDISPLAYEXTPROC) (EGLenum platform, void *native_display, const EGLint *attrib_list);
+#endif
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+HWEglFSHeadlessIntegration::HWEglFSHeadlessIntegration()
+{
+    m_clock.start();
+}
+
+HWEglFSHeadlessIntegration::~HWEglFSHeadlessIntegration()
+{
+    delete m_input;
+}
+
+QList<HWEglFSHeadlessIntegration::OutputMode> HWEglFSHeadlessIntegration::parseOutputs(const QByteArray &spec)
+{
+    const OutputMode fallback { QSize(1920, 1080), 60 };
+    QList<OutputMode> outputs;
+
+    bool isCount = false;
+    int count = spec.toInt(&isCount);
+    if (spec.isEmpty() || isCount) {
+        for (int i = 0; i < qBound(1, isCount ? count : 1, 16); ++i)
+            outputs.append(fallback);
+        return outputs;
+    }
+
+    for (const QByteArray &entry : spec.split(',')) {
+        // WIDTHxHEIGHT[@HZ]
+        OutputMode mode = fallback;
+        QList<QByteArray> parts = entry.trimmed().split('@');
+        QList<QByteArray> size = parts.first().split('x');
+        if (size.count() == 2 && size.at(0).toInt() > 0 && size.at(1).toInt() > 0)
+            mode.size = QSize(size.at(0).toInt(), size.at(1).toInt());
+        else
+            qCWarning(qLcEglfsHeadlessDebug) << "Invalid headless output mode" << entry;
+        if (parts.count() > 1)
+            mode.refreshRate = qMax(0.0, parts.at(1).toDouble());
+        outputs.append(mode);
+    }
+    return outputs;
+}
+
+void HWEglFSHeadlessIntegration::platformInit()
+{
+    // no framebuffer device to open
+    m_outputs = parseOutputs(qgetenv("QT_QPA_EGLFS_HEADLESS_OUTPUTS"));
+
+    const QByteArray inputPath = qgetenv("QT_QPA_EGLFS_HEADLESS_INPUT");
+    if (!inputPath.isEmpty())
+        m_input = new HWEglFSHeadlessInput(inputPath);
+}
+
+void HWEglFSHeadlessIntegration::platformDestroy()
+{
+    delete m_input;
+    m_input = nullptr;
+}
+
+EGLDisplay HWEglFSHeadlessIntegration::createDisplay(EGLNativeDisplayType nativeDisplay)
+{
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = nullptr;
+    const char *extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (extensions && strstr(extensions, "EGL_MESA_platform_surfaceless")) {
+        getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+            eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    }
+
+    if (getPlatformDisplay) {
+        qCDebug(qLcEglfsHeadlessDebug, "Using the surfaceless EGL platform");
+        return getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+
+    qCDebug(qLcEglfsHeadlessDebug, "No surfaceless EGL platform, falling back to eglGetDisplay");
+    return eglGetDisplay(nativeDisplay);
+}
+
+void HWEglFSHeadlessIntegration::screenInit()
+{
+    EGLDisplay display = static_cast<HWEglFSIntegration *>(QGuiApplicationPrivate::platformIntegration())->display();
+
+    // outputs are laid out left to right, the first one is primary
+    int x = 0;
+    for (int i = 0; i < m_outputs.count(); ++i) {
+        const OutputMode &mode = m_outputs.at(i);
+        auto screen = new HWEglFSHeadlessScreen(display, i, QRect(QPoint(x, 0), mode.size), mode.refreshRate);
+        QWindowSystemInterface::handleScreenAdded(screen, i == 0);
+        x += mode.size.width();
+        qCInfo(qLcEglfsHeadlessDebug) << "Created virtual output" << screen->name()
+                                      << mode.size << "@" << mode.refreshRate << "Hz";
+    }
+}
+
+QSize HWEglFSHeadlessIntegration::screenSize() const
+{
+    return m_outputs.isEmpty() ? QSize() : m_outputs.first().size;
+}
+
+QSizeF HWEglFSHeadlessIntegration::physicalScreenSize() const
+{
+    // report 96 DPI
+    const QSize size = screenSize();
+    return QSizeF(size.width() * 25.4 / 96, size.height() * 25.4 / 96);
+}
+
+qreal HWEglFSHeadlessIntegration::refreshRate() const
+{
+    return m_outputs.isEmpty() ? 60 : m_outputs.first().refreshRate;
+}
+
+HWEglFSWindow *HWEglFSHeadlessIntegration::createWindow(QWindow *window) const
+{
+    return new HWEglFSHeadlessWindow(window);
+}
+
+void HWEglFSHeadlessIntegration::presentBuffer(QPlatformSurface *surface)
+{
+    QPlatformWindow *window = static_cast<QPlatformWindow *>(surface);
+    auto screen = static_cast<HWEglFSHeadlessScreen *>(window->screen());
+    if (screen)
+        screen->waitForVBlank(m_clock.nsecsElapsed());
+}
@@ -0,0 +1,72 @@
+// Hollywood Wayland Compositor
+// SPDX-FileCopyrightText: 2024 Originull Software
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef QEGLFSHEADLESSINTEGRATION_H
+#define QEGLFSHEADLESSINTEGRATION_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "private/qeglfsdeviceintegration_p.h"
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QList>
+#include <QtCore/QSize>
+
+class HWEglFSHeadlessInput;
+
+// Virtual outputs rendered into EGL pbuffers, for profiling and automated
+// tests on machines without a DRM device or logind seat.
+//
+// QT_QPA_EGLFS_HEADLESS_OUTPUTS   either a count, or a comma separated list
+//                                 of WIDTHxHEIGHT[@HZ] modes (default
+//                                 1920x1080@60). A refresh rate of 0
+//                                 disables the simulated vblank.
+// QT_QPA_EGLFS_HEADLESS_INPUT     path of a FIFO accepting injected input,
+//                                 see HWEglFSHeadlessInput.
+class HWEglFSHeadlessIntegration : public HWEglFSDeviceIntegration
+{
+public:
+    struct OutputMode
+    {
+        QSize size;
+        qreal refreshRate;
+    };
+
+    HWEglFSHeadlessIntegration();
+    ~HWEglFSHeadlessIntegration();
+
+    void platformInit() override;
+    void platformDestroy() override;
+    EGLDisplay createDisplay(EGLNativeDisplayType nativeDisplay) override;
+    bool usesDefaultScreen() override { return false; }
+    void screenInit() override;
+    QSize screenSize() const override;
+    QSizeF physicalScreenSize() const override;
+    int screenDepth() const override { return 32; }
+    QImage::Format screenFormat() const override { return QImage::Format_RGB32; }
+    qreal refreshRate() const override;
+    EGLint surfaceType() const override { return EGL_PBUFFER_BIT; }
+    HWEglFSWindow *createWindow(QWindow *window) const override;
+    void presentBuffer(QPlatformSurface *surface) override;
+    bool requiresSession() const override { return false; }
+
+    const QElapsedTimer &clock() const { return m_clock; }
+
+private:
+    static QList<OutputMode> parseOutputs(const QByteArray &spec);
+
+    QList<OutputMode> m_outputs;
+    QElapsedTimer m_clock;
+    HWEglFSHeadlessInput *m_input = nullptr;
+};
+
+#endif // QEGLFSHEADLESSINTEGRATION_H
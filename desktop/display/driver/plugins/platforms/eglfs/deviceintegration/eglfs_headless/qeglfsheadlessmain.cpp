@@ -0,0 +1,21 @@
+// Hollywood Wayland Compositor
+// SPDX-FileCopyrightText: 2024 Originull Software
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "private/qeglfsdeviceintegration_p.h"
+#include "qeglfsheadlessintegration_p.h"
+
+QT_BEGIN_NAMESPACE
+
+class HWEglFSHeadlessIntegrationPlugin : public HWEglFSDeviceIntegrationPlugin
+{
+    Q_OBJECT
+    Q_PLUGIN_METADATA(IID QEglFSDeviceIntegrationFactoryInterface_iid FILE "eglfs_headless.json")
+
+public:
+    HWEglFSDeviceIntegration *create() override { return new HWEglFSHeadlessIntegration; }
+};
+
+QT_END_NAMESPACE
+
+#include "qeglfsheadlessmain.moc"
@@ -0,0 +1,78 @@
+// Hollywood Wayland Compositor
+// SPDX-FileCopyrightText: 2024 Originull Software
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "qeglfsheadlessscreen_p.h"
+
+#include <QtCore/QThread>
+
+HWEglFSHeadlessScreen::HWEglFSHeadlessScreen(EGLDisplay display, int index, const QRect &geometry, qreal refreshRate)
+    : HWEglFSScreen(display)
+    , m_index(index)
+    , m_geometry(geometry)
+    , m_refreshRate(refreshRate)
+{
+}
+
+QRect HWEglFSHeadlessScreen::rawGeometry() const
+{
+    return m_geometry;
+}
+
+QSizeF HWEglFSHeadlessScreen::physicalSize() const
+{
+    // report 96 DPI
+    return QSizeF(m_geometry.width() * 25.4 / 96, m_geometry.height() * 25.4 / 96);
+}
+
+QDpi HWEglFSHeadlessScreen::logicalDpi() const
+{
+    return QDpi(96, 96);
+}
+
+qreal HWEglFSHeadlessScreen::refreshRate() const
+{
+    // an unthrottled output still has to report something sensible
+    return m_refreshRate > 0 ? m_refreshRate : 60;
+}
+
+QString HWEglFSHeadlessScreen::name() const
+{
+    return QStringLiteral("HEADLESS-%1").arg(m_index + 1);
+}
+
+QString HWEglFSHeadlessScreen::manufacturer() const
+{
+    return QStringLiteral("Hollywood");
+}
+
+QString HWEglFSHeadlessScreen::model() const
+{
+    return QStringLiteral("Virtual Output");
+}
+
+QString HWEglFSHeadlessScreen::serialNumber() const
+{
+    return QString::number(m_index + 1);
+}
+
+QList<QPlatformScreen::Mode> HWEglFSHeadlessScreen::modes() const
+{
+    return { Mode { m_geometry.size(), refreshRate() } };
+}
+
+void HWEglFSHeadlessScreen::waitForVBlank(qint64 nowNs)
+{
+    if (m_refreshRate <= 0)
+        return;
+
+    // All outputs share one clock, so outputs with the same refresh rate
+    // tick together, as they would behind a single CRTC vblank.
+    const qint64 interval = qint64(1000000000.0 / m_refreshRate);
+    qint64 next = (nowNs / interval + 1) * interval;
+    if (next <= m_lastVBlank)
+        next = m_lastVBlank + interval;
+
+    QThread::usleep(quint64((next - nowNs) / 1000));
+    m_lastVBlank = next;
+}
@@ -0,0 +1,52 @@
+// Hollywood Wayland Compositor
+// SPDX-FileCopyrightText: 2024 Originull Software
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef QEGLFSHEADLESSSCREEN_H
+#define QEGLFSHEADLESSSCREEN_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "private/eglfsscreen_p.h"
+
+class HWEglFSHeadlessScreen : public HWEglFSScreen
+{
+public:
+    HWEglFSHeadlessScreen(EGLDisplay display, int index, const QRect &geometry, qreal refreshRate);
+
+    QRect rawGeometry() const override;
+    QSizeF physicalSize() const override;
+    QDpi logicalDpi() const override;
+    qreal refreshRate() const override;
+    QString name() const override;
+    QString manufacturer() const override;
+    QString model() const override;
+    QString serialNumber() const override;
+    QList<Mode> modes() const override;
+    int currentMode() const override { return 0; }
+    int preferredMode() const override { return 0; }
+    PowerState powerState() const override { return m_powerState; }
+    void setPowerState(PowerState state) override { m_powerState = state; }
+
+    // Blocks until the next tick of the simulated vblank clock, the way a
+    // page flip does on real hardware.
+    void waitForVBlank(qint64 nowNs);
+
+private:
+    int m_index;
+    QRect m_geometry;
+    qreal m_refreshRate;
+    qint64 m_lastVBlank = 0;
+    PowerState m_powerState = PowerStateOn;
+};
+
+#endif // QEGLFSHEADLESSSCREEN_H
@@ -0,0 +1,31 @@
+// Hollywood Wayland Compositor
+// SPDX-FileCopyrightText: 2024 Originull Software
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "qeglfsheadlesswindow_p.h"
+#include "private/qeglfsdeviceintegration_p.h"
+#include "private/qeglfshooks_p.h"
+
+#include <QtGui/private/qeglconvenience_p.h>
+
+EGLSurface HWEglFSHeadlessWindow::createPbuffer(const QSize &size) const
+{
+    const EGLint attribs[] = {
+        EGL_WIDTH, size.width(),
+        EGL_HEIGHT, size.height(),
+        EGL_NONE
+    };
+    return eglCreatePbufferSurface(screen()->display(), m_config, attribs);
+}
+
+void HWEglFSHeadlessWindow::resetSurface()
+{
+    EGLDisplay display = screen()->display();
+    QSurfaceFormat platformFormat = qt_egl_device_integration()->surfaceFormatFor(window()->requestedFormat());
+
+    m_config = HWEglFSDeviceIntegration::chooseConfig(display, platformFormat);
+    m_format = q_glFormatFromConfig(display, m_config, platformFormat);
+    m_window = 0;
+    m_surface = createPbuffer(screen()->rawGeometry().size());
+}
+
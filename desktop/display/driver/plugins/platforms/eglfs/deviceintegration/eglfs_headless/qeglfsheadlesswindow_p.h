@@ -0,0 +1,36 @@
+// Hollywood Wayland Compositor
+// SPDX-FileCopyrightText: 2024 Originull Software
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef QEGLFSHEADLESSWINDOW_H
+#define QEGLFSHEADLESSWINDOW_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "private/qeglfswindow_p.h"
+
+// Renders into a pbuffer sized to the virtual output instead of a native
+// window surface.
+class HWEglFSHeadlessWindow : public HWEglFSWindow
+{
+public:
+    HWEglFSHeadlessWindow(QWindow *w) : HWEglFSWindow(w) { }
+
+    void resetSurface() override;
+    // virtual outputs keep the mode they were created with
+    bool resizeSurface(const QSize &) override { return false; }
+
+private:
+    EGLSurface createPbuffer(const QSize &size) const;
+};
+
+#endif // QEGLFSHEADLESSWINDOW_H
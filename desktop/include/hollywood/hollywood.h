@@ -9,6 +9,16 @@
 #define HOLLYWOOD_SESSION_DBUSOBJ   "/Session"
 #define HOLLYWOOD_SESSION_DBUSPATH  "org.originull.hollywood.Session"
 
+// Written to stdout by the compositor once the first frame is on screen
+// so the session manager can release the processes depending on it
+#define HOLLYWOOD_COMPOSITOR_READY  "HOLLYWOOD_COMPOSITOR_READY"
+
+// When set in the environment the platform theme writes
+// HOLLYWOOD_STARTUP_READY and the microseconds since it was created to
+// stdout once the first window is painted, then quits the application
+#define HOLLYWOOD_STARTUP_BENCH     "HOLLYWOOD_STARTUP_BENCH"
+#define HOLLYWOOD_STARTUP_READY     "HOLLYWOOD_STARTUP_READY"
+
 #define HOLYWOOD_SETTINGS_APP       "org.originull.hwsettings.desktop"
 #define HOLYWOOD_SYSMON_APP         "org.originull.hwsysmon.desktop"
 #define HOLYWOOD_TERMINULL_APP      "org.originull.terminull.desktop"
@@ -5,6 +5,7 @@
 // SPDX-License-Identifier: MIT
 
 #include "private/connman_p.h"
+#include "private/service_p.h"
 #include "connman.h"
 #include "agent.h"
 #include "service.h"
@@ -69,11 +70,11 @@ ConnmanPrivate::ConnmanPrivate(ConnectionManager *p)
           } */
 
         // connect some dbus signals to our slots
-        QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "PropertyChanged", this, SLOT(dbsPropertyChanged(QString, QDBusVariant)));
-        QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "ServicesChanged", this, SLOT(dbsServicesChanged(QList<QVariant>, QList<QDBusObjectPath>, QDBusMessage)));
-        QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "PeersChanged", this, SLOT(dbsPeersChanged(QList<QVariant>, QList<QDBusObjectPath>, QDBusMessage)));
-        QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "TechnologyAdded", this, SLOT(dbsTechnologyAdded(QDBusObjectPath, QVariantMap)));
-        QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "TechnologyRemoved", this, SLOT(dbsTechnologyRemoved(QDBusObjectPath)));
+        QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "PropertyChanged", this, SLOT(dbusPropertyChanged(QString, QDBusVariant)));
+        QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "ServicesChanged", this, SLOT(dbusServicesChanged(QDBusMessage)));
+        QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "PeersChanged", this, SLOT(dbusPeersChanged(QDBusMessage)));
+        QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "TechnologyAdded", this, SLOT(dbusTechnologyAdded(QDBusObjectPath, QVariantMap)));
+        QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "TechnologyRemoved", this, SLOT(dbusTechnologyRemoved(QDBusObjectPath)));
 
         // clear the counters if selected
         //clearCounters();
@@ -211,8 +212,7 @@ bool ConnmanPrivate::getServices()
         // map our values to classes
         for(auto d : services_list)
         {
-            auto svc = new Service(m_q, d);
-            m_services.append(svc);
+            auto svc = addService(d);
             if(svc->type() == "wifi")
                 m_wifiNetworks.append(svc);
         }
@@ -247,7 +247,6 @@ bool ConnmanPrivate::getArray(QList<arrayElement> &r_list, const QDBusMessage &r
        arrayElement ael;
        qdb_arg.beginStructure();
        qdb_arg >> ael.objpath >> ael.objmap;
-       qDebug() << ael.objpath.path() << ael.objmap;
 
        qdb_arg.endStructure();
        r_list.append (ael);
@@ -398,12 +397,87 @@ void ConnmanPrivate::dbusPropertyChanged(QString prop, QDBusVariant dbvalue)
     } // if state change
 }
 
-void ConnmanPrivate::dbusServicesChanged(QList<QVariant>, QList<QDBusObjectPath>, QDBusMessage)
+Service* ConnmanPrivate::addService(arrayElement &data)
 {
-    m_model->rescanSys();
+    auto svc = new Service(m_q, data);
+    m_services.append(svc);
+    m_servicePaths.insert(data.objpath.path(), svc);
+    connect(svc, &Service::servicePropertiesUpdated, this, [this, svc]() {
+        m_wifiModel->serviceUpdated(svc);
+        m_model->serviceUpdated(svc);
+    });
+    return svc;
 }
 
-void ConnmanPrivate::dbusPeersChanged(QList<QVariant>, QList<QDBusObjectPath>, QDBusMessage)
+void ConnmanPrivate::removeService(Service *svc)
+{
+    m_servicePaths.remove(svc->m_d->m_dbusData.objpath.path());
+    m_services.removeAll(svc);
+    m_wifiModel->removeService(svc);
+    m_model->serviceRemoved(svc);
+    svc->deleteLater();
+}
+
+// ServicesChanged carries the complete ordered service list, with
+// properties only for services that are new or have changed, followed by
+// the removed object paths. Apply it to the models without going back to
+// connman for GetServices.
+void ConnmanPrivate::dbusServicesChanged(QDBusMessage msg)
+{
+    if(msg.arguments().count() < 2)
+        return;
+
+    QList<arrayElement> changed;
+    if(!getArray(changed, msg))
+        return;
+
+    auto removed = qdbus_cast<QList<QDBusObjectPath>>(msg.arguments().at(1));
+    for(auto &path : removed)
+    {
+        auto svc = m_servicePaths.value(path.path());
+        if(svc != nullptr)
+            removeService(svc);
+    }
+
+    QList<Service*> order;
+    for(auto &d : changed)
+    {
+        auto svc = m_servicePaths.value(d.objpath.path());
+        if(svc == nullptr)
+        {
+            svc = addService(d);
+            if(svc->type() == "wifi")
+                m_wifiModel->insertService(svc);
+            m_model->serviceUpdated(svc);
+        }
+        else
+            svc->m_d->updateProperties(d.objmap);
+        order.append(svc);
+    }
+
+    // follow connman's ordering (strength, favorites) for the wifi list
+    QList<Service*> wifiOrder;
+    for(auto svc : order)
+    {
+        if(svc->type() == "wifi")
+            wifiOrder.append(svc);
+    }
+    for(auto svc : std::as_const(m_wifiNetworks))
+    {
+        if(!wifiOrder.contains(svc))
+            wifiOrder.append(svc);
+    }
+    m_wifiModel->reorderServices(wifiOrder);
+
+    for(auto svc : std::as_const(m_services))
+    {
+        if(!order.contains(svc))
+            order.append(svc);
+    }
+    m_services = order;
+}
+
+void ConnmanPrivate::dbusPeersChanged(QDBusMessage)
 {
 
 }
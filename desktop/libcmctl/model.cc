@@ -17,10 +17,77 @@
 namespace HWCM
 {
 
+// ConnMan reports signal strength changes for every visible network;
+// coalesce those into at most a few model refreshes per second.
+static const int s_refreshInterval = 250;
 
 WifiModel::WifiModel(ConnmanPrivate *parent)
     : QAbstractListModel(parent)
-    , m_parent(parent) {}
+    , m_parent(parent)
+{
+    m_refresh.setSingleShot(true);
+    m_refresh.setInterval(s_refreshInterval);
+    connect(&m_refresh, &QTimer::timeout, this, &WifiModel::flushUpdates);
+}
+
+void WifiModel::insertService(Service *svc)
+{
+    auto row = m_parent->m_wifiNetworks.count();
+    beginInsertRows(QModelIndex(), row, row);
+    m_parent->m_wifiNetworks.append(svc);
+    endInsertRows();
+}
+
+void WifiModel::removeService(Service *svc)
+{
+    m_dirty.remove(svc);
+    auto row = m_parent->m_wifiNetworks.indexOf(svc);
+    if(row < 0)
+        return;
+
+    beginRemoveRows(QModelIndex(), row, row);
+    m_parent->m_wifiNetworks.removeAt(row);
+    endRemoveRows();
+}
+
+void WifiModel::reorderServices(const QList<Service*> &order)
+{
+    if(order == m_parent->m_wifiNetworks)
+        return;
+
+    emit layoutAboutToBeChanged();
+    auto persistent = persistentIndexList();
+    QList<Service*> services;
+    for(auto &idx : persistent)
+        services.append(m_parent->m_wifiNetworks.value(idx.row()));
+
+    m_parent->m_wifiNetworks = order;
+    for(int i = 0; i < persistent.count(); ++i)
+    {
+        auto row = order.indexOf(services.at(i));
+        changePersistentIndex(persistent.at(i), row < 0 ? QModelIndex() : index(row));
+    }
+    emit layoutChanged();
+}
+
+void WifiModel::serviceUpdated(Service *svc)
+{
+    m_dirty.insert(svc);
+    if(!m_refresh.isActive())
+        m_refresh.start();
+}
+
+void WifiModel::flushUpdates()
+{
+    for(auto svc : std::as_const(m_dirty))
+    {
+        auto row = m_parent->m_wifiNetworks.indexOf(svc);
+        if(row < 0)
+            continue;
+        emit dataChanged(index(row), index(row));
+    }
+    m_dirty.clear();
+}
 
 Service *WifiModel::serviceForIndex(const QModelIndex &index)
 {
@@ -46,7 +113,12 @@ int WifiModel::rowCount(const QModelIndex &parent) const
 
 DeviceModel::DeviceModel(ConnmanPrivate *parent)
     : QAbstractListModel(parent)
-    , m_parent(parent) {}
+    , m_parent(parent)
+{
+    m_refresh.setSingleShot(true);
+    m_refresh.setInterval(s_refreshInterval);
+    connect(&m_refresh, &QTimer::timeout, this, &DeviceModel::flushUpdates);
+}
 
 void DeviceModel::rescanSys()
 {
@@ -72,38 +144,99 @@ void DeviceModel::rescanSys()
         if(dev.startsWith("wlan"))
             di->type = DeviceModelItem::WiFi;
 
-        for(auto i : m_parent->m_services)
+        bindService(di);
+        auto row = m_devices.count();
+        beginInsertRows(QModelIndex(), row, row);
+        m_devices.append(di);
+        endInsertRows();
+    }
+
+    for(int row = m_devices.count() - 1; row >= 0; --row)
+    {
+        if(currentDevices.contains(m_devices.at(row)->devName))
+            continue;
+
+        beginRemoveRows(QModelIndex(), row, row);
+        delete m_devices.takeAt(row);
+        endRemoveRows();
+    }
+
+    // TODO: add vpn/bluetooth
+}
+
+// Associates the device with its ConnMan service, returns true if that
+// association (and with it the row's contents) changed.
+bool DeviceModel::bindService(DeviceModelItem *di)
+{
+    auto &dev = di->devName;
+    Service *service = nullptr;
+    for(auto i : m_parent->m_services)
+    {
+        if(dev.startsWith("eth") || dev.startsWith("en"))
         {
-            if(dev.startsWith("eth") || dev.startsWith("en"))
-            {
-                if(i->interface() == dev)
-                    di->service = i;
-            }
+            if(i->interface() == dev)
+                service = i;
+        }
 
-            if(dev.startsWith("wifi") || dev.startsWith("wl"))
+        if(dev.startsWith("wifi") || dev.startsWith("wl"))
+        {
+            auto state = i->mapValue("State").toString();
+            if(state != QLatin1String("idle"))
             {
-                auto state = i->mapValue("State").toString();
-                if(state != QLatin1String("idle"))
-                {
-                    if(i->interface() == dev)
-                        di->service = i;
-                }
+                if(i->interface() == dev)
+                    service = i;
             }
         }
-        if(di->service != nullptr)
-        {
-            if(di->service->type() == "wifi")
-                di->type = DeviceModelItem::WiFi;
-            if(di->service->type() == "ethernet")
-                di->type = DeviceModelItem::Ethernet;
-            if(di->service->type() == "bluetooth")
-                di->type = DeviceModelItem::Bluetooth;
+    }
 
-        }
-        m_devices.append(di);
+    if(service == di->service)
+        return false;
+
+    di->service = service;
+    if(di->service != nullptr)
+    {
+        if(di->service->type() == "wifi")
+            di->type = DeviceModelItem::WiFi;
+        if(di->service->type() == "ethernet")
+            di->type = DeviceModelItem::Ethernet;
+        if(di->service->type() == "bluetooth")
+            di->type = DeviceModelItem::Bluetooth;
     }
+    return true;
+}
 
-    // TODO: add vpn/bluetooth
+void DeviceModel::serviceRemoved(Service *svc)
+{
+    m_dirty.remove(svc);
+    for(int row = 0; row < m_devices.count(); ++row)
+    {
+        auto di = m_devices.at(row);
+        if(di->service != svc)
+            continue;
+
+        di->service = nullptr;
+        bindService(di);
+        emit dataChanged(index(row), index(row));
+    }
+}
+
+void DeviceModel::serviceUpdated(Service *svc)
+{
+    m_dirty.insert(svc);
+    if(!m_refresh.isActive())
+        m_refresh.start();
+}
+
+void DeviceModel::flushUpdates()
+{
+    for(int row = 0; row < m_devices.count(); ++row)
+    {
+        auto di = m_devices.at(row);
+        bool dirty = di->service != nullptr && m_dirty.contains(di->service);
+        if(bindService(di) || dirty)
+            emit dataChanged(index(row), index(row));
+    }
+    m_dirty.clear();
 }
 
 bool DeviceModel::hasDevice(const QString &dev)
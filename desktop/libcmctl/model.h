@@ -7,6 +7,8 @@
 
 #include <QAbstractListModel>
 #include <QObject>
+#include <QSet>
+#include <QTimer>
 
 #include "service.h"
 #include "technology.h"
@@ -38,12 +40,20 @@ public:
 protected:
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
     int rowCount(const QModelIndex &parent = QModelIndex()) const;
+private slots:
+    void flushUpdates();
 private:
     friend class WifiMenu;
     friend class WifiMenuPrivate;
     friend class ConnmanPrivate;
     WifiModel(ConnmanPrivate *parent);
+    void insertService(Service *svc);
+    void removeService(Service *svc);
+    void reorderServices(const QList<Service*> &order);
+    void serviceUpdated(Service *svc);
     ConnmanPrivate *m_parent = nullptr;
+    QSet<Service*> m_dirty;
+    QTimer m_refresh;
 };
 
 class Service;
@@ -61,12 +71,19 @@ public slots:
 protected:
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
     int rowCount(const QModelIndex &parent = QModelIndex()) const;
+private slots:
+    void flushUpdates();
 private:    
     friend class ConnmanPrivate;
     DeviceModel(ConnmanPrivate *parent);
     bool hasDevice(const QString &dev);
+    bool bindService(DeviceModelItem *di);
+    void serviceRemoved(Service *svc);
+    void serviceUpdated(Service *svc);
     ConnmanPrivate *m_parent = nullptr;
     QList<DeviceModelItem*> m_devices;
+    QSet<Service*> m_dirty;
+    QTimer m_refresh;
 };
 } // namespace HWCM
 #endif // MODEL_H
@@ -11,6 +11,7 @@
 #include <QDBusVariant>
 #include <QDBusMessage>
 #include <QDBusInterface>
+#include <QHash>
 
 #include "libcmctl_global.h"
 
@@ -43,10 +44,12 @@ private:
     bool getMap(QMap<QString,QVariant>&, const QDBusMessage&);
     QDBusMessage::MessageType processReply(const QDBusMessage& reply);
     void queryVersion();
+    Service* addService(arrayElement &data);
+    void removeService(Service *svc);
 private slots:
     void dbusPropertyChanged(QString,QDBusVariant);
-    void dbusServicesChanged(QList<QVariant>, QList<QDBusObjectPath>, QDBusMessage);
-    void dbusPeersChanged(QList<QVariant>, QList<QDBusObjectPath>, QDBusMessage);
+    void dbusServicesChanged(QDBusMessage);
+    void dbusPeersChanged(QDBusMessage);
     //void dbusVPNPropertyChanged(QString, QDBusVariant, QDBusMessage);
     void dbusTechnologyAdded(QDBusObjectPath, QVariantMap);
     void dbusTechnologyRemoved(QDBusObjectPath);
@@ -65,6 +68,7 @@ private:
     QMap<QString,QVariant>  properties_map;
     QList<arrayElement>  services_list;
     QList<Service*> m_services;
+    QHash<QString,Service*> m_servicePaths;
     QList<Service*> m_wifiNetworks;
     QList<arrayElement> technologies_list;
     QList<Technology*> m_technologies;
@@ -19,8 +19,10 @@ class ServicePrivate : public QObject
     Q_OBJECT
 private:
     friend class Service;
+    friend class ConnmanPrivate;
     ServicePrivate(Service *parent, arrayElement &data);
     ~ServicePrivate();
+    void updateProperties(const QVariantMap &changed);
 private Q_SLOTS:
     void dbusServicePropertyChanged(QString, QDBusVariant, QDBusMessage);
 private:
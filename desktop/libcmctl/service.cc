@@ -12,6 +12,7 @@
 #include <QDBusConnection>
 #include <QDBusMessage>
 #include <QDBusInterface>
+#include <QDBusPendingCallWatcher>
 
 namespace HWCM
 {
@@ -20,6 +21,7 @@ ServicePrivate::ServicePrivate(Service *parent, arrayElement &data)
     : QObject(parent)
     , m_q(parent)
     , m_dbusData(data)
+    , m_online(data.objmap.value("State").toString() == "online")
 {
     QDBusConnection::systemBus().
     connect(DBUS_CON_SERVICE,
@@ -45,15 +47,9 @@ void ServicePrivate::dbusServicePropertyChanged(QString property, QDBusVariant d
 {
     QString s_path = msg.path();
     QVariant value = dbvalue.variant();
-    QString s_state;
 
-    // replace the old values with the changed ones.
-    QMap<QString,QVariant> map = m_dbusData.objmap;
-    map.remove(property);
-    map.insert(property, value );
-    arrayElement ae = {m_dbusData.objpath, map};
-    s_state = map.value("State").toString();
-    m_dbusData = ae;
+    updateProperties({{property, value}});
+    QString s_state = m_dbusData.objmap.value("State").toString();
 
     // process errrors   - errors only valid when service is in the failure state
     // TODO: fix notifications with a signal
@@ -65,22 +61,29 @@ void ServicePrivate::dbusServicePropertyChanged(QString property, QDBusVariant d
        notifyclient->setUrgency(Nc::UrgencyCritical);
        this->sendNotifications(); */
     }
+}
+
+// Merges changed properties, either from a single PropertyChanged signal or
+// from the dictionary carried by the manager's ServicesChanged signal.
+void ServicePrivate::updateProperties(const QVariantMap &changed)
+{
+    if(changed.isEmpty())
+        return;
+
+    for(auto it = changed.constBegin(); it != changed.constEnd(); ++it)
+        m_dbusData.objmap.insert(it.key(), it.value());
 
     // if state property changed sync the online data members.
-    if (property == "State")
+    if (changed.contains("State"))
     {
         bool old_online = m_online;
-       if (value.toString() == "online")
-          m_online = true;
-       else
-           m_online = false;
+        m_online = m_dbusData.objmap.value("State").toString() == "online";
 
-       if(m_online != old_online)
-           Q_EMIT m_q->onlineChanged(m_online);
+        if(m_online != old_online)
+            Q_EMIT m_q->onlineChanged(m_online);
     }
 
     Q_EMIT m_q->servicePropertiesUpdated();
-    return;
 }
 
 Service::Service(ConnectionManager *parent, arrayElement &data)
@@ -147,16 +150,19 @@ QString Service::type() const
 void Service::requestConnection()
 {
     qDebug() << "service connection requested";
-    QDBusInterface* iface_serv = NULL;
-
-    iface_serv = new QDBusInterface(DBUS_CON_SERVICE, m_d->m_dbusData.objpath.path(),
-                                    "net.connman.Service", QDBusConnection::systemBus(), this);
-    iface_serv->setTimeout(5); // need a short timeout to get the Agent
-    QDBusMessage reply = iface_serv->call(QDBus::AutoDetect, "Connect");
-    if (reply.errorName() != "org.freedesktop.DBus.Error.NoReply")
-        Q_EMIT dbusError(reply);
 
-    iface_serv->deleteLater();
+    // Connect only returns once the agent has answered, and the agent
+    // lives in this process - never wait for the reply.
+    auto call = QDBusMessage::createMethodCall(DBUS_CON_SERVICE, m_d->m_dbusData.objpath.path(),
+                                               "net.connman.Service", "Connect");
+    auto watcher = new QDBusPendingCallWatcher(QDBusConnection::systemBus().asyncCall(call), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *w) {
+        QDBusMessage reply = w->reply();
+        w->deleteLater();
+        if (reply.type() == QDBusMessage::ErrorMessage &&
+            reply.errorName() != "org.freedesktop.DBus.Error.NoReply")
+            Q_EMIT dbusError(reply);
+    });
 }
 
 Service::IP4Config Service::ipv4Config() const
@@ -0,0 +1,44 @@
+// Hollywood Shell Library
+// (C) 2024 Originull Software
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#pragma once
+
+#include <QObject>
+#include "libshell_int.h"
+
+// A single binary file holding every parsed desktop entry visible to the
+// user along with the MIME type to application map.  The session manager
+// rebuilds it when the applications directories change and every other
+// process maps it read-only so lookups are hash probes with no file I/O.
+class LSDesktopCachePrivate;
+class LIBSHELL_EXPORT LSDesktopCache : public QObject
+{
+    Q_OBJECT
+public:
+    static LSDesktopCache* instance();
+    ~LSDesktopCache() override;
+
+    bool isValid() const;
+    QString pathForId(const QString &id) const;
+    QString pathForExec(const QString &exec) const;
+    QStringList pathsForMimeType(const QString &mimeType) const;
+    QStringList mimeTypes() const;
+    QStringList allPaths() const;
+    bool items(const QString &path, QMap<QString,QVariant> &items) const;
+    QString value(const QString &path, const QString &key) const;
+
+    static QString cacheFile();
+    static QStringList sourceDirectories();
+    static QStringList watchDirectories();
+    static bool isStale();
+    static bool rebuild();
+    static bool rebuildIfStale();
+signals:
+    void changed();
+private slots:
+    void cacheFileChanged();
+private:
+    explicit LSDesktopCache(QObject *parent = nullptr);
+    LSDesktopCachePrivate *p;
+};
@@ -54,6 +54,9 @@ protected:
     virtual QString prefix() const { return QLatin1String("Desktop Entry"); }
     virtual bool check() const { return true; }
 private:
+    friend class LSDesktopCache;
+    bool loadFromFile(const QString &fileName);
+    QMap<QString, QVariant> items() const;
     QString localizedKey(const QString& key) const;
     QSharedDataPointer<LSDesktopEntryPrivate> d;
 };
@@ -0,0 +1,66 @@
+// Hollywood Shell Library
+// (C) 2024 Originull Software
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#pragma once
+
+#include <QObject>
+#include "libshell_int.h"
+
+// One file from an icon theme along with the index.theme description of
+// the directory it was found in.
+struct LIBSHELL_EXPORT LSIconCacheEntry
+{
+    QString path;
+    int type = 0;
+    int size = 0;
+    int minSize = 0;
+    int maxSize = 0;
+    int threshold = 0;
+    int scale = 1;
+};
+
+// Icon name lookups for an XDG icon theme with the Inherits chain already
+// resolved.  The session manager builds one cache per theme whenever the
+// icon directories change; the platform theme maps it read-only so that
+// QIcon::fromTheme is a hash probe instead of a walk over every theme
+// directory.
+class LSIconCachePrivate;
+class LIBSHELL_EXPORT LSIconCache : public QObject
+{
+    Q_OBJECT
+public:
+    // matches the Type key of an index.theme directory, Fallback is an
+    // unthemed icon from a pixmaps directory
+    enum DirectoryType {
+        Fixed,
+        Scalable,
+        Threshold,
+        Fallback
+    };
+
+    static LSIconCache* forTheme(const QString &theme);
+    ~LSIconCache() override;
+
+    bool isValid() const;
+    QString theme() const;
+    // bumped every time the cache file is mapped again
+    quint32 serial() const;
+    bool contains(const QString &name) const;
+    QList<LSIconCacheEntry> entries(const QString &name) const;
+
+    static QString cacheFile(const QString &theme);
+    static QStringList searchPaths();
+    static QStringList fallbackPaths();
+    static QStringList watchDirectories(const QString &theme);
+    static bool isStale(const QString &theme);
+    static bool rebuild(const QString &theme);
+    static bool rebuildIfStale(const QString &theme);
+signals:
+    void changed();
+private slots:
+    void cacheFileChanged();
+private:
+    explicit LSIconCache(const QString &theme, QObject *parent = nullptr);
+    LSIconCachePrivate *p;
+};
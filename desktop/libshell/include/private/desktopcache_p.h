@@ -0,0 +1,98 @@
+#pragma once
+
+#include <QFile>
+#include <QFileSystemWatcher>
+#include <QReadWriteLock>
+#include <QStringView>
+
+// On-disk layout of the desktop entry cache.  Strings are stored once in a
+// UTF-16 pool so readers can compare them in place; every table is an
+// open addressed hash using FNV-1a so the layout is the same in every
+// process regardless of Qt's per-process hash seed.
+#define LSDC_MAGIC      "HWDCACHE"
+#define LSDC_VERSION    1
+
+struct LSDCString
+{
+    quint32 offset;     // in UTF-16 code units from the start of the pool
+    quint32 length;
+};
+
+struct LSDCEntry
+{
+    LSDCString id;
+    LSDCString path;
+    LSDCString exec;
+    quint32 firstItem;
+    quint32 itemCount;
+};
+
+struct LSDCItem
+{
+    LSDCString key;
+    LSDCString value;
+};
+
+// one bucket of a hash table; value is the entry (or mime) index plus one
+// so that an all-zero bucket is empty
+struct LSDCSlot
+{
+    LSDCString key;
+    quint32 value;
+};
+
+struct LSDCMime
+{
+    LSDCString name;
+    quint32 firstApp;
+    quint32 appCount;
+};
+
+struct LSDCHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 entryCount;
+    quint32 entryOffset;
+    quint32 itemCount;
+    quint32 itemOffset;
+    quint32 mimeCount;
+    quint32 mimeOffset;
+    quint32 mimeAppCount;
+    quint32 mimeAppOffset;
+    quint32 idBuckets;      // every bucket count is a power of two
+    quint32 idTable;
+    quint32 buckets;        // shared by the path and exec tables
+    quint32 pathTable;
+    quint32 execTable;
+    quint32 mimeBuckets;
+    quint32 mimeTable;
+    quint32 stringOffset;
+    quint32 stringSize;
+    quint64 sourceStamp;
+};
+
+class LSDesktopCache;
+class LSDesktopCachePrivate
+{
+private:
+    friend class LSDesktopCache;
+    LSDesktopCache *d;
+    LSDesktopCachePrivate(LSDesktopCache *parent);
+    ~LSDesktopCachePrivate();
+    bool map();
+    void unmap();
+    QStringView string(const LSDCString &s) const;
+    const LSDCEntry* entry(quint32 index) const;
+    quint32 probe(quint32 table, quint32 buckets, QStringView key) const;
+
+    QFile m_file;
+    const uchar *m_data = nullptr;
+    qint64 m_size = 0;
+    const LSDCHeader *m_header = nullptr;
+    QFileSystemWatcher *m_watch = nullptr;
+    // device, inode, mtime and size of the file last opened by map(),
+    // kept when it turned out invalid so it isn't mapped again for nothing
+    QByteArray m_identity;
+    mutable QReadWriteLock m_lock;
+};
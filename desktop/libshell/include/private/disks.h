@@ -13,6 +13,9 @@
 #include <QtDBus/QDBusObjectPath>
 #include <QTimer>
 #include <QStringList>
+#include <QHash>
+#include <QtDBus/QDBusMessage>
+#include <QtDBus/QDBusPendingCallWatcher>
 
 #define DBUS_SERVICE "org.freedesktop.UDisks2"
 #define DBUS_PATH "/org/freedesktop/UDisks2"
@@ -22,11 +25,18 @@
 #define DBUS_DEVICE_ADDED "InterfacesAdded"
 #define DBUS_DEVICE_REMOVED "InterfacesRemoved"
 
+// org.freedesktop.DBus.ObjectManager payloads
+typedef QMap<QString, QVariantMap> LSDBusInterfaceMap;
+typedef QMap<QDBusObjectPath, LSDBusInterfaceMap> LSDBusManagedObjects;
+Q_DECLARE_METATYPE(LSDBusInterfaceMap)
+Q_DECLARE_METATYPE(LSDBusManagedObjects)
+
+class LSUDisks;
 class LSUDiskDevice : public QObject
 {
     Q_OBJECT
 public:
-    explicit LSUDiskDevice(const QString block, QObject *parent = nullptr);
+    explicit LSUDiskDevice(const QString block, LSUDisks *parent);
     bool isLoopDevice() const;
     bool isOptical() const;
     bool hasOpticalMedia();
@@ -51,28 +61,37 @@ signals:
     void mountpointChanged(QString devicePath, QString deviceMountpoint);
     void nameChanged(QString devicePath, QString deviceName);
     void errorMessage(QString devicePath, QString deviceError);
+    void mounted(QString devicePath, QString deviceMountpoint);
+    void unmounted(QString devicePath);
+    void ejected(QString devicePath);
 public slots:
     void mount();
     void unmount();
     void eject();
 private slots:
     void updateDeviceProperties();
-    void handlePropertiesChanged(const QString &interfaceType, const QMap<QString, QVariant> &changedProperties);
 private:
+    friend class LSUDisks;
+    enum Operation { Mount, Unmount, Eject };
     QVariant queryDriveProperty(const QString &property) const;
     QVariant queryBlockProperty(const QString &property) const;
     QVariant queryPartitionProperty(const QString &property) const;
+    bool isValid() const;
 
     QString getMountPointOptical() const;
     QString getMountPoint() const;
     QString getDeviceName() const;
-    QString mountDevice() const;
-    QString mountOptical() const;
-    QString unmountDevice() const;
-    QString unmountOptical() const;
-    QString ejectDevice() const;
+    void mountDevice();
+    void mountOptical();
+    void unmountDevice();
+    void unmountOptical();
+    void ejectDevice();
+    void callAsync(const QString &path, const QString &interface, const QString &method,
+                   const QVariantMap &options, Operation op);
+    void runUDisksCtl(const QStringList &args, Operation op);
+    void operationFinished(Operation op, const QString &error, const QString &result = QString());
 
-    QDBusInterface *m_dbus;
+    LSUDisks *m_disks;
     QString m_name = QString();
     QString m_path = QString();
     QString dev = QString();
@@ -92,6 +111,9 @@ private:
     qulonglong m_blockSize = 0;
 };
 
+// Keeps an in-memory copy of every UDisks2 object's properties, seeded by a
+// single GetManagedObjects call and kept current from the ObjectManager and
+// PropertiesChanged signals, so device queries never touch the bus.
 class LSUDisks : public QObject
 {
     Q_OBJECT
@@ -100,12 +122,19 @@ public:
     QMap<QString, LSUDiskDevice*> devices;
     LSUDiskDevice* deviceForMountpath(const QString &mount);
     LSUDiskDevice* deviceForDevPath(const QString &mount);
+    QVariant property(const QString &path, const QString &interface, const QString &name) const;
+    bool hasInterface(const QString &path, const QString &interface) const;
 
 private:
-    QDBusInterface *dbus;
-    QTimer timer;
-private:
-    static const QStringList getDevices();
+    void mergeInterfaces(const QString &path, const LSDBusInterfaceMap &interfaces);
+    void updateDevicesFor(const QString &path);
+    bool isBlockDevice(const QString &path) const;
+    void addDevice(const QString &path);
+    void removeDevice(const QString &path);
+    static QVariant normalize(const QVariant &value);
+
+    QHash<QString, LSDBusInterfaceMap> m_objects;
+    bool m_connected = false;
 
 signals:
     void updatedDevices();
@@ -118,11 +147,12 @@ signals:
 private slots:
     void setupDBus();
     void scanDevices();
-    void deviceAdded(const QDBusObjectPath &obj);
-    void deviceRemoved(const QDBusObjectPath &obj);
+    void interfacesAdded(const QDBusObjectPath &obj, const LSDBusInterfaceMap &interfaces);
+    void interfacesRemoved(const QDBusObjectPath &obj, const QStringList &interfaces);
+    void propertiesChanged(const QDBusMessage &message);
     void handleDeviceMediaChanged(QString devicePath, bool mediaPresent);
     void handleDeviceMountpointChanged(QString devicePath, QString deviceMountpoint);
     void handleDeviceErrorMessage(QString devicePath, QString deviceError);
-    void checkUDisks();
+    void serviceRegistered();
 
 };
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <QFile>
+#include <QFileSystemWatcher>
+#include <QReadWriteLock>
+#include <QStringView>
+
+// On-disk layout of an icon theme cache, one file per theme.  Like the
+// desktop entry cache strings live in a UTF-16 pool and the name table
+// is an open addressed FNV-1a hash.  Each icon lists the files of the
+// first theme in the inheritance chain that has it, so a lookup never
+// has to walk index.theme files again.
+#define LSIC_MAGIC      "HWICACHE"
+#define LSIC_VERSION    1
+
+struct LSICString
+{
+    quint32 offset;     // in UTF-16 code units from the start of the pool
+    quint32 length;
+};
+
+// an index.theme directory in one of the theme's content directories
+struct LSICDir
+{
+    LSICString path;
+    quint16 size;
+    quint16 minSize;
+    quint16 maxSize;
+    quint16 threshold;
+    quint16 scale;
+    quint16 type;       // LSIconCache::DirectoryType
+};
+
+// the file is <dir>/<icon name>.<suffix>, storing the full path for every
+// size of every icon would make the pool several times larger
+struct LSICFile
+{
+    quint32 dir;
+    quint32 suffix;     // index into lsicSuffixes
+};
+
+struct LSICIcon
+{
+    LSICString name;
+    quint32 firstFile;
+    quint32 fileCount;
+};
+
+// value is the icon index plus one so that an all-zero bucket is empty
+struct LSICSlot
+{
+    LSICString key;
+    quint32 value;
+};
+
+struct LSICHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 themeCount;     // the inheritance chain, the theme itself first
+    quint32 themeOffset;
+    quint32 dirCount;
+    quint32 dirOffset;
+    quint32 iconCount;
+    quint32 iconOffset;
+    quint32 fileCount;
+    quint32 fileOffset;
+    quint32 buckets;        // a power of two
+    quint32 iconTable;
+    quint32 stringOffset;
+    quint32 stringSize;
+    // theme directories and index.theme files, checked by every reader
+    quint64 themeStamp;
+    // every icon directory, only checked by the session manager
+    quint64 contentStamp;
+};
+
+class LSIconCache;
+class LSIconCachePrivate
+{
+private:
+    friend class LSIconCache;
+    LSIconCache *d;
+    LSIconCachePrivate(LSIconCache *parent, const QString &theme);
+    ~LSIconCachePrivate();
+    bool map();
+    void unmap();
+    QStringView string(const LSICString &s) const;
+    QStringList chain() const;
+    quint32 probe(QStringView key) const;
+    static const LSICHeader* validate(const uchar *data, qint64 size);
+
+    QString m_theme;
+    QFile m_file;
+    const uchar *m_data = nullptr;
+    qint64 m_size = 0;
+    const LSICHeader *m_header = nullptr;
+    quint32 m_serial = 0;
+    QFileSystemWatcher *m_watch = nullptr;
+    mutable QReadWriteLock m_lock;
+};
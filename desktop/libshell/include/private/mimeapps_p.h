@@ -18,6 +18,7 @@ private:
     QHash<QString,LSDesktopEntry*> m_defaults;
 
     QList<LSDesktopEntry*> m_desktops;
+    QHash<QString,LSDesktopEntry*> m_paths;
     QFileSystemWatcher *m_watch = nullptr;
     QMutex m_mutex;
     QString m_defaultsFile;
@@ -0,0 +1,34 @@
+// Hollywood Shell Library
+// (C) 2024 Originull Software
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#pragma once
+
+#include <QHash>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QDateTime>
+
+// Maps installed files to the apk package that owns them by reading the
+// installed database directly rather than forking `apk info --who-owns`.
+// Only the directories we ask about (desktop entries) are indexed; the
+// result is kept in the user's cache and rebuilt when the database changes.
+class LSPackageIndex
+{
+public:
+    static QString ownerOf(const QString &path);
+private:
+    LSPackageIndex() = default;
+    static LSPackageIndex* instance();
+    void refresh();
+    bool loadCache(const QDateTime &mtime, qint64 size);
+    void saveCache() const;
+    void parseDatabase();
+    QString cacheFile() const;
+
+    QHash<QString,QString> m_owners;
+    QDateTime m_dbModified;
+    qint64 m_dbSize = -1;
+    QElapsedTimer m_checked;
+    QMutex m_mutex;
+};
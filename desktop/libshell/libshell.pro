@@ -42,6 +42,7 @@ SOURCES += \
     src/core/disks.cc \
     src/core/fileoperation.cc \
     src/core/opmanager.cc \
+    src/core/packageindex.cc \
     src/core/privatewayland.cc \
     src/core/shellundo.cc \
     src/dialogs/getinfodialog.cc \
@@ -70,7 +71,9 @@ SOURCES += \
     src/widgets/sectionwidget.cc \
     src/widgets/shellhost.cc \
     src/xdg/directories.cc \
+    src/xdg/desktopcache.cc \
     src/xdg/desktopentry.cc \
+    src/xdg/iconcache.cc \
     src/xdg/executor.cc  \
     src/xdg/mimeapps.cc
 
@@ -83,11 +86,14 @@ HEADERS += \
     include/private/actionmanager_p.h \
     include/private/appmodel_p.h \
     include/private/columnpreview_p.h \
+    include/private/desktopcache_p.h \
     include/private/desktopmodel_p.h \
     include/private/disks.h \
     include/private/getinfowidgets_p.h \
+    include/private/iconcache_p.h \
     include/private/lsdiskmodel.h \
     include/private/opmanager_p.h \
+    include/private/packageindex.h \
     include/private/sectionwidget.h \
     include/private/shellundo_p.h \
     include/private/fileinfogatherer_p.h \
@@ -113,12 +119,14 @@ HEADERS += \
     include/appmodel.h \
     include/actionmanager.h \
     include/columnpreview.h \
+    include/desktopcache.h \
     include/desktopentry.h \
     include/desktopmodel.h \
     include/directories.h \
     include/filesystemmodel.h \
     include/fsitemdelegate.h \
     include/hwfileiconprovider.h \
+    include/iconcache.h \
     include/libshell_int.h \
     include/locationbar.h \
     include/mimeapps.h \
@@ -14,7 +14,9 @@
 #include <QDBusMessage>
 #include <QDBusReply>
 #include <QDBusInterface>
-#include <QXmlStreamReader>
+#include <QDBusMetaType>
+#include <QDBusPendingReply>
+#include <QDBusServiceWatcher>
 #include <QProcess>
 #include <QFile>
 #include <QTextStream>
@@ -57,9 +59,9 @@ static QMap<QString,QString> g_device_names{{"thumb", "USB Flash Drive"},
                                             {"optical_mrw", "Can read Mount Rainer media"},
                                             {"optical_mrw_w", "Can write Mount Rainer media"}};
 
-LSUDiskDevice::LSUDiskDevice(const QString block, QObject *parent)
+LSUDiskDevice::LSUDiskDevice(const QString block, LSUDisks *parent)
     : QObject(parent)
-    , m_dbus(nullptr)
+    , m_disks(parent)
     , m_path(block)
     , m_isOptical(false)
     , m_removable(false)
@@ -69,9 +71,6 @@ LSUDiskDevice::LSUDiskDevice(const QString block, QObject *parent)
     , m_isBlankDisc(false)
     , m_hasPartition(false)
 {
-    QDBusConnection system = QDBusConnection::systemBus();
-    m_dbus = new QDBusInterface(DBUS_SERVICE, m_path, QString("%1.Block").arg(DBUS_SERVICE), system, parent);
-    system.connect(m_dbus->service(), m_dbus->path(), DBUS_PROPERTIES, "PropertiesChanged", this, SLOT(handlePropertiesChanged(QString,QMap<QString,QVariant>)));
     updateDeviceProperties();
 }
 
@@ -91,84 +90,130 @@ bool LSUDiskDevice::isLoopDevice() const
 
 QVariant LSUDiskDevice::queryDriveProperty(const QString &property) const
 {
-    QDBusInterface iface(DBUS_SERVICE,
-                         m_drive,
-                         QString("%1.Drive").arg(DBUS_SERVICE),
-                         QDBusConnection::systemBus());
-
-    if (!iface.isValid())
-        return QVariant();
-    return iface.property(property.toUtf8());
+    return m_disks->property(m_drive, QString("%1.Drive").arg(DBUS_SERVICE), property);
 }
 
 QVariant LSUDiskDevice::queryBlockProperty(const QString &property) const
 {
-    QDBusInterface iface(DBUS_SERVICE,
-                         m_path,
-                         QString("%1.Block").arg(DBUS_SERVICE),
-                         QDBusConnection::systemBus());
-
-    if (!iface.isValid())
-        return QVariant();
-    return iface.property(property.toUtf8());
+    return m_disks->property(m_path, QString("%1.Block").arg(DBUS_SERVICE), property);
 }
 
 QVariant LSUDiskDevice::queryPartitionProperty(const QString &property) const
 {
-    QDBusInterface iface(DBUS_SERVICE,
-                         m_path,
-                         QString("%1.Partition").arg(DBUS_SERVICE),
-                         QDBusConnection::systemBus());
+    return m_disks->property(m_path, QString("%1.Partition").arg(DBUS_SERVICE), property);
+}
 
-    if (!iface.isValid())
-        return QVariant();
-    return iface.property(property.toUtf8());
+bool LSUDiskDevice::isValid() const
+{
+    return m_disks->hasInterface(m_path, QString("%1.Block").arg(DBUS_SERVICE));
 }
 
+// mount, unmount and eject return immediately; completion is reported
+// through mounted/unmounted/ejected, failures through errorMessage.
 void LSUDiskDevice::mount()
 {
-    if (!m_dbus->isValid() || !m_mountpoint.isEmpty()) { return; }
-    QString reply;
-    if (m_isOptical) {
-        reply = mountOptical();
-    }
-    else { reply = mountDevice(); }
-    if (!reply.isEmpty()) {
-        emit errorMessage(m_path, reply);
-        return;
-    }
-    updateDeviceProperties();
+    if (!isValid() || !m_mountpoint.isEmpty()) { return; }
+    if (m_isOptical) { mountOptical(); }
+    else { mountDevice(); }
 }
 
 void LSUDiskDevice::unmount()
 {
-    if (!m_dbus->isValid() || (m_mountpoint.isEmpty() && !m_isOptical)) { return; }
-    QString reply;
-    if (m_isOptical) { reply = unmountOptical(); }
-    else { reply = unmountDevice(); }
-    updateDeviceProperties();
-    if (!reply.isEmpty() || (!m_mountpoint.isEmpty())) {
-        if (reply.isEmpty()) { reply = QObject::tr("Failed to umount %1").arg(m_name); }
-        emit errorMessage(m_path, reply);
-        return;
-    }
-    if (m_isOptical) { eject(); }
+    if (!isValid() || (m_mountpoint.isEmpty() && !m_isOptical)) { return; }
+    if (m_isOptical && m_mountpoint.isEmpty()) { eject(); }
+    else if (m_isOptical) { unmountOptical(); }
+    else { unmountDevice(); }
 }
 
 void LSUDiskDevice::eject()
 {
-    if (!m_dbus->isValid()) { return; }
-    QString reply = ejectDevice();
+    if (!isValid()) { return; }
+    ejectDevice();
+}
+
+void LSUDiskDevice::operationFinished(Operation op, const QString &error, const QString &result)
+{
     updateDeviceProperties();
-    if (!reply.isEmpty()/* || hasMedia*/) {
-        if (reply.isEmpty()) { reply = QObject::tr("Failed to eject %1").arg(m_name); }
-        emit errorMessage(m_path, reply);
+    switch(op)
+    {
+    case Mount:
+        if (!error.isEmpty()) {
+            emit errorMessage(m_path, error);
+            return;
+        }
+        emit mounted(m_path, result.isEmpty() ? m_mountpoint : result);
+        break;
+    case Unmount:
+        if (!error.isEmpty() || (!m_mountpoint.isEmpty() && !m_isOptical)) {
+            emit errorMessage(m_path, error.isEmpty() ? QObject::tr("Failed to umount %1").arg(m_name) : error);
+            return;
+        }
+        emit unmounted(m_path);
+        if (m_isOptical) { eject(); }
+        break;
+    case Eject:
+        if (!error.isEmpty()) {
+            emit errorMessage(m_path, error);
+            return;
+        }
+        emit ejected(m_path);
+        break;
     }
 }
 
+void LSUDiskDevice::callAsync(const QString &path, const QString &interface, const QString &method,
+                              const QVariantMap &options, Operation op)
+{
+    QDBusMessage call = QDBusMessage::createMethodCall(DBUS_SERVICE, path, interface, method);
+    call.setArguments(QVariantList() << options);
+    auto watcher = new QDBusPendingCallWatcher(QDBusConnection::systemBus().asyncCall(call), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, op](QDBusPendingCallWatcher *w) {
+        QDBusMessage reply = w->reply();
+        w->deleteLater();
+        if (reply.type() == QDBusMessage::ErrorMessage) {
+            operationFinished(op, reply.errorMessage().isEmpty() ? reply.errorName() : reply.errorMessage());
+            return;
+        }
+        QString result;
+        if (!reply.arguments().isEmpty())
+            result = reply.arguments().first().toString();
+        operationFinished(op, QString(), result);
+    });
+}
+
+void LSUDiskDevice::runUDisksCtl(const QStringList &args, Operation op)
+{
+    auto proc = new QProcess(this);
+    proc->setProgram(QString("udisksctl"));
+    proc->setArguments(args);
+    connect(proc, &QProcess::finished, this, [this, proc, op](int exitCode, QProcess::ExitStatus status) {
+        proc->deleteLater();
+        if (status != QProcess::NormalExit || exitCode != 0) {
+            QString error = QString::fromLocal8Bit(proc->readAllStandardError()).trimmed();
+            operationFinished(op, error.isEmpty() ? tr("udisksctl failed for %1").arg(m_name) : error);
+            return;
+        }
+        // "Mounted /dev/sr0 at /run/media/user/DISC"
+        QString output = QString::fromLocal8Bit(proc->readAllStandardOutput()).trimmed();
+        QString result;
+        int at = output.indexOf(" at ");
+        if (op == Mount && at > 0) {
+            result = output.mid(at + 4);
+            if (result.endsWith('.')) { result.chop(1); }
+        }
+        operationFinished(op, QString(), result);
+    });
+    connect(proc, &QProcess::errorOccurred, this, [this, proc, op](QProcess::ProcessError error) {
+        if (error != QProcess::FailedToStart) { return; }
+        proc->deleteLater();
+        operationFinished(op, proc->errorString());
+    });
+    proc->start();
+}
+
 void LSUDiskDevice::updateDeviceProperties()
 {
-    if (!m_dbus->isValid()) { return; }
+    if (!isValid()) { return; }
 
     bool hadMedia =  m_hasMedia;
     QString lastMountpoint = m_mountpoint;
@@ -209,21 +254,9 @@ void LSUDiskDevice::updateDeviceProperties()
         emit nameChanged(m_path, m_name);
 }
 
-void LSUDiskDevice::handlePropertiesChanged(const QString &interfaceType, const QMap<QString, QVariant> &changedProperties)
-{
-    Q_UNUSED(interfaceType)
-    Q_UNUSED(changedProperties)
-    updateDeviceProperties();
-}
-
 bool LSUDiskDevice::isOptical() const
 {
-    QDBusInterface iface(DBUS_SERVICE,
-                         m_drive,
-                         QString("%1.Drive").arg(DBUS_SERVICE),
-                         QDBusConnection::systemBus());
-    if (!iface.isValid()) { return false; }
-    QStringList compat = iface.property("MediaCompatibility").toStringList();
+    QStringList compat = queryDriveProperty("MediaCompatibility").toStringList();
     for (int i=0;i<compat.size();i++) {
         if (compat.at(i).startsWith("optical_")) { return true; }
     }
@@ -232,12 +265,7 @@ bool LSUDiskDevice::isOptical() const
 
 bool LSUDiskDevice::hasOpticalMedia()
 {
-    QDBusInterface iface(DBUS_SERVICE,
-                         m_drive,
-                         QString("%1.Drive").arg(DBUS_SERVICE),
-                         QDBusConnection::systemBus());
-    if (!iface.isValid()) { return false; }
-    QString type = iface.property("Media").toString();
+    QString type = queryDriveProperty("Media").toString();
     if (type.startsWith("optical_")) { return true; }
     return false;
 }
@@ -392,115 +420,78 @@ QString LSUDiskDevice::getMountPointOptical() const
 
 QString LSUDiskDevice::getMountPoint() const
 {
-    QString mountpoint;
-    QDBusMessage message = QDBusMessage::createMethodCall(DBUS_SERVICE,
-                                                          m_path,
-                                                          DBUS_PROPERTIES,
-                                                          "Get");
-    QList<QVariant> args;
-    args << QString("%1.Filesystem").arg(DBUS_SERVICE) << "MountPoints";
-    message.setArguments(args);
-    QDBusMessage reply = QDBusConnection::systemBus().call(message);
-    QStringList mountpoints;
-    QList<QByteArray> argList;
-    foreach (QVariant arg, reply.arguments()) {
-        if (!arg.value<QDBusVariant>().variant().isValid()) { continue; }
-        arg.value<QDBusVariant>().variant().value<QDBusArgument>() >> argList;
-    }
-    foreach (QByteArray point, argList) { mountpoints.append(point); }
-    mountpoint = mountpoints.join("");
-    // TODO: fix ugly hack
-    mountpoint.remove('\u0000');
-    return mountpoint;
+    // MountPoints is normalized to a QStringList by LSUDisks
+    QStringList mountpoints = m_disks->property(m_path, QString("%1.Filesystem").arg(DBUS_SERVICE),
+                                                "MountPoints").toStringList();
+    if (mountpoints.isEmpty()) { return QString(); }
+    return mountpoints.first();
 }
 
 QString LSUDiskDevice::getDeviceName() const
 {
-    QDBusInterface iface(DBUS_SERVICE,
-                         m_drive,
-                         QString("%1.Drive").arg(DBUS_SERVICE),
-                         QDBusConnection::systemBus());
-    if (!iface.isValid()) { return QString(); }
-    QString name = iface.property("Vendor").toString().simplified();
+    QString name = queryDriveProperty("Vendor").toString().simplified();
     if (!name.isEmpty()) { name.append(" "); }
-    name.append(iface.property("Model").toString().simplified());
-    return name;
+    name.append(queryDriveProperty("Model").toString().simplified());
+    return name.trimmed();
 }
 
-QString LSUDiskDevice::mountDevice() const
+void LSUDiskDevice::mountDevice()
 {
-    QDBusInterface filesystem(DBUS_SERVICE,
-                              m_path,
-                              QString("%1.Filesystem").arg(DBUS_SERVICE),
-                              QDBusConnection::systemBus());
-    if (!filesystem.isValid()) { return QObject::tr("Failed D-Bus connection."); }
+    if (!m_disks->hasInterface(m_path, QString("%1.Filesystem").arg(DBUS_SERVICE))) {
+        emit errorMessage(m_path, QObject::tr("Failed D-Bus connection."));
+        return;
+    }
     QVariantMap options;
 
     auto fs = queryBlockProperty("IdType").toString();
     if (fs == "vfat") { options.insert("options", "flush"); }
-    QDBusReply<QString> mountpoint =  filesystem.call("Mount", options);
-    return mountpoint.error().message();
+    callAsync(m_path, QString("%1.Filesystem").arg(DBUS_SERVICE), "Mount", options, Mount);
 }
 
-QString LSUDiskDevice::mountOptical() const
+void LSUDiskDevice::mountOptical()
 {
     // something is broken somewhere in udev/udisk, whatever ...
     // So we need to handle opticals using udisks cmd
     // https://bugs.archlinux.org/task/49643
     // https://bugs.freedesktop.org/show_bug.cgi?id=52357
-
-    QProcess proc;
-    proc.setProgram(QString("udisksctl"));
-    proc.setArguments(QStringList() << "mount" << "-b" << QString("/dev/%1").arg((m_path.split("/").takeLast())));
-    proc.start();
-    proc.waitForFinished();
-    return QString();
+    runUDisksCtl(QStringList() << "mount" << "-b" << devDevice(), Mount);
 }
 
-QString LSUDiskDevice::unmountDevice() const
+void LSUDiskDevice::unmountDevice()
 {
-    QDBusInterface filesystem(DBUS_SERVICE,
-                              m_path,
-                              QString("%1.Filesystem").arg(DBUS_SERVICE),
-                              QDBusConnection::systemBus());
-    if (!filesystem.isValid()) { return QObject::tr("Failed D-Bus connection."); }
-    QDBusMessage reply = filesystem.call("Unmount", QVariantMap());
-    return reply.arguments().first().toString();
+    if (!m_disks->hasInterface(m_path, QString("%1.Filesystem").arg(DBUS_SERVICE))) {
+        emit errorMessage(m_path, QObject::tr("Failed D-Bus connection."));
+        return;
+    }
+    callAsync(m_path, QString("%1.Filesystem").arg(DBUS_SERVICE), "Unmount", QVariantMap(), Unmount);
 }
 
-QString LSUDiskDevice::unmountOptical() const
+void LSUDiskDevice::unmountOptical()
 {
-    // something is broken somewhere in udev/udisk, whatever ...
-    // So we need to handle opticals using udisks cmd
-    // https://bugs.archlinux.org/task/49643
-    // https://bugs.freedesktop.org/show_bug.cgi?id=52357
-    QProcess proc;
-    proc.setProgram(QString("udisks2"));
-    proc.setArguments(QStringList() << "unmount" << "-b" << QString("/dev/%1").arg((m_path.split("/").takeLast())));
-    proc.start();
-    proc.waitForFinished();
-    return QString();
+    // see mountOptical
+    runUDisksCtl(QStringList() << "unmount" << "-b" << devDevice(), Unmount);
 }
 
-QString LSUDiskDevice::ejectDevice() const
+void LSUDiskDevice::ejectDevice()
 {
-    QDBusInterface filesystem(DBUS_SERVICE,
-                              m_drive,
-                              QString("%1.Drive").arg(DBUS_SERVICE),
-                              QDBusConnection::systemBus());
-    if (!filesystem.isValid()) { return QObject::tr("Failed D-Bus connection."); }
-    QDBusMessage reply = filesystem.call("Eject", QVariantMap());
-    return reply.arguments().first().toString();
+    if (!m_disks->hasInterface(m_drive, QString("%1.Drive").arg(DBUS_SERVICE))) {
+        emit errorMessage(m_path, QObject::tr("Failed D-Bus connection."));
+        return;
+    }
+    callAsync(m_drive, QString("%1.Drive").arg(DBUS_SERVICE), "Eject", QVariantMap(), Eject);
 }
 
 LSUDisks::LSUDisks(QObject *parent)
     : QObject(parent)
-    , dbus(Q_NULLPTR)
 {
+    qDBusRegisterMetaType<LSDBusInterfaceMap>();
+    qDBusRegisterMetaType<LSDBusManagedObjects>();
+
+    // pick up a restarted (or late starting) UDisks daemon
+    auto watcher = new QDBusServiceWatcher(DBUS_SERVICE, QDBusConnection::systemBus(),
+                                           QDBusServiceWatcher::WatchForRegistration, this);
+    connect(watcher, &QDBusServiceWatcher::serviceRegistered, this, &LSUDisks::serviceRegistered);
     setupDBus();
-    timer.setInterval(60000);
-    connect(&timer, SIGNAL(timeout()), this, SLOT(checkUDisks()));
-    timer.start();
 }
 
 LSUDiskDevice *LSUDisks::deviceForMountpath(const QString &mount)
@@ -525,84 +516,201 @@ LSUDiskDevice *LSUDisks::deviceForDevPath(const QString &mount)
     return nullptr;
 }
 
+QVariant LSUDisks::property(const QString &path, const QString &interface, const QString &name) const
+{
+    auto obj = m_objects.constFind(path);
+    if (obj == m_objects.constEnd()) { return QVariant(); }
+    auto iface = obj->constFind(interface);
+    if (iface == obj->constEnd()) { return QVariant(); }
+    return iface->value(name);
+}
+
+bool LSUDisks::hasInterface(const QString &path, const QString &interface) const
+{
+    auto obj = m_objects.constFind(path);
+    if (obj == m_objects.constEnd()) { return false; }
+    return obj->contains(interface);
+}
+
 void LSUDisks::setupDBus()
 {
     QDBusConnection system = QDBusConnection::systemBus();
-    if (system.isConnected()) {
-        system.connect(DBUS_SERVICE, DBUS_PATH, DBUS_OBJMANAGER, DBUS_DEVICE_ADDED, this, SLOT(deviceAdded(const QDBusObjectPath&)));
-        system.connect(DBUS_SERVICE, DBUS_PATH, DBUS_OBJMANAGER, DBUS_DEVICE_REMOVED, this, SLOT(deviceRemoved(const QDBusObjectPath&)));
-        if (dbus==Q_NULLPTR) { dbus = new QDBusInterface(DBUS_SERVICE, DBUS_PATH, DBUS_OBJMANAGER, system); } // only used to verify the UDisks is running
-        scanDevices();
+    if (!system.isConnected()) { return; }
+
+    if (!m_connected) {
+        m_connected = true;
+        system.connect(DBUS_SERVICE, DBUS_PATH, DBUS_OBJMANAGER, DBUS_DEVICE_ADDED, this,
+                       SLOT(interfacesAdded(QDBusObjectPath,LSDBusInterfaceMap)));
+        system.connect(DBUS_SERVICE, DBUS_PATH, DBUS_OBJMANAGER, DBUS_DEVICE_REMOVED, this,
+                       SLOT(interfacesRemoved(QDBusObjectPath,QStringList)));
+        // one match rule for every object instead of one per device
+        system.connect(DBUS_SERVICE, QString(), DBUS_PROPERTIES, "PropertiesChanged", this,
+                       SLOT(propertiesChanged(QDBusMessage)));
     }
+    scanDevices();
 }
 
+// Seeds the cache with one GetManagedObjects round trip. This stays a
+// blocking call so the device list is populated once the constructor
+// returns, as the disk models expect.
 void LSUDisks::scanDevices()
 {
-    if (!dbus) { return; }
-    if (!dbus->isValid()) { return; }
-    QStringList foundDevices = getDevices();
-    for (int i=0;i<foundDevices.size();i++) {
-        QString foundDevicePath = foundDevices.at(i);
-        bool hasDevice = devices.contains(foundDevicePath);
-        if (hasDevice) { continue; }
-        LSUDiskDevice *newDevice = new LSUDiskDevice(foundDevicePath, this);
-        connect(newDevice, SIGNAL(mediaChanged(QString,bool)), this, SLOT(handleDeviceMediaChanged(QString,bool)));
-        connect(newDevice, SIGNAL(mountpointChanged(QString,QString)), this, SLOT(handleDeviceMountpointChanged(QString,QString)));
-        connect(newDevice, SIGNAL(errorMessage(QString,QString)), this, SLOT(handleDeviceErrorMessage(QString,QString)));
-        devices[foundDevicePath] = newDevice;
+    QDBusMessage call = QDBusMessage::createMethodCall(DBUS_SERVICE, DBUS_PATH,
+                                                       DBUS_OBJMANAGER, "GetManagedObjects");
+    QDBusPendingReply<LSDBusManagedObjects> reply = QDBusConnection::systemBus().call(call);
+    if (reply.isError()) { return; }
+
+    const LSDBusManagedObjects objects = reply.value();
+    m_objects.clear();
+    for (auto it = objects.constBegin(); it != objects.constEnd(); ++it)
+        mergeInterfaces(it.key().path(), it.value());
+
+    // drop devices that went away while UDisks was unavailable
+    for (const QString &path : devices.keys()) {
+        if (!isBlockDevice(path))
+            removeDevice(path);
+    }
+
+    for (auto it = m_objects.constBegin(); it != m_objects.constEnd(); ++it) {
+        if (!isBlockDevice(it.key())) { continue; }
+        if (devices.contains(it.key())) { devices[it.key()]->updateDeviceProperties(); }
+        else { addDevice(it.key()); }
     }
     emit updatedDevices();
 }
 
-const QStringList LSUDisks::getDevices()
-{
-    QStringList result;
-    QDBusMessage call = QDBusMessage::createMethodCall(DBUS_SERVICE,
-                                                       QString("%1/block_devices").arg(DBUS_PATH),
-                                                       DBUS_INTROSPECTABLE,
-                                                       "Introspect");
-    QDBusPendingReply<QString> reply = QDBusConnection::systemBus().call(call);
-    QList<QDBusObjectPath> devices;
-    if (reply.isError()) { return result; }
-    QXmlStreamReader xml(reply.value());
-    while (!xml.atEnd()) {
-        xml.readNext();
-        if (xml.tokenType() == QXmlStreamReader::StartElement && xml.name().toString() == "node" ) {
-            QString name = xml.attributes().value("name").toString();
-            if(!name.isEmpty()) { devices << QDBusObjectPath("/org/freedesktop/UDisks2/block_devices/" + name); }
+QVariant LSUDisks::normalize(const QVariant &value)
+{
+    if (value.userType() != qMetaTypeId<QDBusArgument>())
+        return value;
+
+    const QDBusArgument arg = value.value<QDBusArgument>();
+    if (arg.currentSignature() == "aay") {
+        // MountPoints and Symlinks are NUL terminated byte strings
+        QList<QByteArray> list;
+        arg >> list;
+        QStringList result;
+        for (QByteArray item : list) {
+            if (item.endsWith('\0')) { item.chop(1); }
+            result << QString::fromLocal8Bit(item);
         }
+        return result;
+    }
+    if (arg.currentSignature() == "ao") {
+        QList<QDBusObjectPath> list;
+        arg >> list;
+        return QVariant::fromValue(list);
+    }
+
+    return value;
+}
+
+void LSUDisks::mergeInterfaces(const QString &path, const LSDBusInterfaceMap &interfaces)
+{
+    LSDBusInterfaceMap &obj = m_objects[path];
+    for (auto iface = interfaces.constBegin(); iface != interfaces.constEnd(); ++iface) {
+        QVariantMap &props = obj[iface.key()];
+        for (auto prop = iface.value().constBegin(); prop != iface.value().constEnd(); ++prop)
+            props.insert(prop.key(), normalize(prop.value()));
+    }
+}
+
+bool LSUDisks::isBlockDevice(const QString &path) const
+{
+    if (!path.startsWith(QString("%1/block_devices/").arg(DBUS_PATH))) { return false; }
+    return hasInterface(path, QString("%1.Block").arg(DBUS_SERVICE));
+}
+
+void LSUDisks::addDevice(const QString &path)
+{
+    LSUDiskDevice *newDevice = new LSUDiskDevice(path, this);
+    connect(newDevice, SIGNAL(mediaChanged(QString,bool)), this, SLOT(handleDeviceMediaChanged(QString,bool)));
+    connect(newDevice, SIGNAL(mountpointChanged(QString,QString)), this, SLOT(handleDeviceMountpointChanged(QString,QString)));
+    connect(newDevice, SIGNAL(errorMessage(QString,QString)), this, SLOT(handleDeviceErrorMessage(QString,QString)));
+    devices[path] = newDevice;
+}
+
+void LSUDisks::removeDevice(const QString &path)
+{
+    if (!devices.contains(path)) { return; }
+    emit removedDevice(path);
+    devices.take(path)->deleteLater();
+}
+
+// Refreshes every device backed by path: the block device itself, or all
+// block devices (partitions included) sitting on a drive object.
+void LSUDisks::updateDevicesFor(const QString &path)
+{
+    if (devices.contains(path)) {
+        devices[path]->updateDeviceProperties();
+        return;
     }
-    foreach (QDBusObjectPath device, devices) {
-        result << device.path();
+    for (auto device : std::as_const(devices)) {
+        if (device->m_drive == path)
+            device->updateDeviceProperties();
     }
-    return result;
 }
 
-void LSUDisks::deviceAdded(const QDBusObjectPath &obj)
+void LSUDisks::interfacesAdded(const QDBusObjectPath &obj, const LSDBusInterfaceMap &interfaces)
 {
-    if (!dbus) { return; }
-    if (!dbus->isValid()) { return; }
     QString path = obj.path();
     if (path.startsWith(QString("%1/jobs").arg(DBUS_PATH))) { return; }
 
-    scanDevices();
+    mergeInterfaces(path, interfaces);
+    if (!isBlockDevice(path)) {
+        updateDevicesFor(path);
+        return;
+    }
+
+    if (devices.contains(path)) {
+        // e.g. a Filesystem interface appearing after formatting
+        devices[path]->updateDeviceProperties();
+        return;
+    }
+    addDevice(path);
+    emit updatedDevices();
     emit foundNewDevice(path);
 }
 
-void LSUDisks::deviceRemoved(const QDBusObjectPath &obj)
+void LSUDisks::interfacesRemoved(const QDBusObjectPath &obj, const QStringList &interfaces)
 {
-    if (!dbus) { return; }
-    if (!dbus->isValid()) { return; }
     QString path = obj.path();
-    bool deviceExists = devices.contains(path);
     if (path.startsWith(QString("%1/jobs").arg(DBUS_PATH))) { return; }
+    if (!m_objects.contains(path)) { return; }
 
-    if (deviceExists) {
-        if (getDevices().contains(path)) { return; }
-        emit removedDevice(path);
-        delete devices.take(path);
+    LSDBusInterfaceMap &cached = m_objects[path];
+    for (const QString &iface : interfaces)
+        cached.remove(iface);
+    if (cached.isEmpty())
+        m_objects.remove(path);
+
+    if (devices.contains(path) && !isBlockDevice(path)) {
+        removeDevice(path);
+        emit updatedDevices();
+        return;
     }
-    scanDevices();
+    updateDevicesFor(path);
+}
+
+void LSUDisks::propertiesChanged(const QDBusMessage &message)
+{
+    const QList<QVariant> args = message.arguments();
+    if (args.size() < 2) { return; }
+
+    QString path = message.path();
+    QString iface = args.at(0).toString();
+    if (!m_objects.contains(path)) { return; }
+
+    QVariantMap &props = m_objects[path][iface];
+    const QVariantMap changed = qdbus_cast<QVariantMap>(args.at(1));
+    for (auto it = changed.constBegin(); it != changed.constEnd(); ++it)
+        props.insert(it.key(), normalize(it.value()));
+    if (args.size() >= 3) {
+        for (const QString &name : qdbus_cast<QStringList>(args.at(2)))
+            props.remove(name);
+    }
+
+    updateDevicesFor(path);
 }
 
 void LSUDisks::handleDeviceMediaChanged(QString devicePath, bool mediaPresent)
@@ -620,15 +728,7 @@ void LSUDisks::handleDeviceErrorMessage(QString devicePath, QString deviceError)
     emit deviceErrorMessage(devicePath, deviceError);
 }
 
-void LSUDisks::checkUDisks()
+void LSUDisks::serviceRegistered()
 {
-    if (!QDBusConnection::systemBus().isConnected()) {
-        setupDBus();
-        //return;
-    }
-    if (!dbus) { return; }
-    if (dbus->isValid()) { scanDevices(); }
+    setupDBus();
 }
-
-
-
@@ -0,0 +1,142 @@
+// Hollywood Shell Library
+// (C) 2024 Originull Software
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include "packageindex.h"
+#include "directories.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDataStream>
+#include <QSaveFile>
+#include <QDir>
+
+#define APK_INSTALLED_DB    "/lib/apk/db/installed"
+#define APK_INDEX_VERSION   1
+
+// the only tree we currently ask about
+static const QLatin1String indexedPrefix("usr/share/applications");
+
+QString LSPackageIndex::ownerOf(const QString &path)
+{
+    auto index = instance();
+    QMutexLocker locker(&index->m_mutex);
+    index->refresh();
+
+    auto relative = path.startsWith(QLatin1Char('/')) ? path.mid(1) : path;
+    return index->m_owners.value(relative);
+}
+
+LSPackageIndex *LSPackageIndex::instance()
+{
+    static LSPackageIndex index;
+    return &index;
+}
+
+void LSPackageIndex::refresh()
+{
+    // callers tend to come in bursts (listing applications), one stat
+    // of the database every couple of seconds is plenty
+    if(m_checked.isValid() && m_checked.elapsed() < 2000)
+        return;
+    m_checked.start();
+
+    QFileInfo db(QLatin1String(APK_INSTALLED_DB));
+    auto mtime = db.lastModified();
+    auto size = db.exists() ? db.size() : -1;
+    if(mtime == m_dbModified && size == m_dbSize)
+        return;
+
+    m_dbModified = mtime;
+    m_dbSize = size;
+    m_owners.clear();
+    if(size < 0)
+        return;
+
+    if(loadCache(mtime, size))
+        return;
+
+    parseDatabase();
+    saveCache();
+}
+
+bool LSPackageIndex::loadCache(const QDateTime &mtime, qint64 size)
+{
+    QFile file(cacheFile());
+    if(!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&file);
+    quint32 version = 0;
+    QDateTime cachedTime;
+    qint64 cachedSize = -1;
+    stream >> version >> cachedTime >> cachedSize;
+    if(version != APK_INDEX_VERSION || cachedTime != mtime || cachedSize != size)
+        return false;
+
+    stream >> m_owners;
+    return stream.status() == QDataStream::Ok;
+}
+
+void LSPackageIndex::saveCache() const
+{
+    QDir().mkpath(QFileInfo(cacheFile()).absolutePath());
+    QSaveFile file(cacheFile());
+    if(!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream stream(&file);
+    stream << quint32(APK_INDEX_VERSION) << m_dbModified << m_dbSize << m_owners;
+    file.commit();
+}
+
+void LSPackageIndex::parseDatabase()
+{
+    // the installed database is a series of blank line separated package
+    // records; P: names the package, F: starts a directory and each R:
+    // that follows is a file within it
+    QFile file(QLatin1String(APK_INSTALLED_DB));
+    if(!file.open(QIODevice::ReadOnly))
+        return;
+
+    QString package;
+    QString folder;
+    bool indexed = false;
+    while(!file.atEnd())
+    {
+        auto line = file.readLine();
+        if(line.size() < 2 || line.at(1) != ':')
+        {
+            if(line.trimmed().isEmpty())
+            {
+                package.clear();
+                folder.clear();
+                indexed = false;
+            }
+            continue;
+        }
+
+        auto value = line.mid(2).trimmed();
+        switch(line.at(0))
+        {
+        case 'P':
+            package = QString::fromUtf8(value);
+            break;
+        case 'F':
+            folder = QString::fromUtf8(value);
+            indexed = folder.startsWith(indexedPrefix);
+            break;
+        case 'R':
+            if(indexed && !package.isEmpty())
+                m_owners.insert(QString("%1/%2").arg(folder, QString::fromUtf8(value)), package);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+QString LSPackageIndex::cacheFile() const
+{
+    return QString("%1/hollywood/apk-owners.cache").arg(LSDirectories::cacheHome(false));
+}
@@ -169,7 +169,11 @@ void LSGeneralInfoWidget::reloadInfo(struct stat sb)
             m_openwith->addItem(def->icon(), def->value("Name").toString());
 
         for(auto a : apps)
+        {
+            if(def && a->fileName() == def->fileName())
+                continue;
             m_openwith->addItem(a->icon(), a->value("Name").toString());
+        }
     }
     else
     {
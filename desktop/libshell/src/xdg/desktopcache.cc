@@ -0,0 +1,641 @@
+// Hollywood Shell Library
+// (C) 2024 Originull Software
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include "desktopcache.h"
+#include "desktopcache_p.h"
+#include "desktopentry.h"
+#include "directories.h"
+
+#include <QCoreApplication>
+#include <QDirIterator>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QMutex>
+#include <QSet>
+#include <cstring>
+#include <algorithm>
+#include <sys/stat.h>
+
+static QByteArray lsdcIdentity(const struct stat &st)
+{
+    return QByteArray::number(quint64(st.st_dev)) + ':' +
+           QByteArray::number(quint64(st.st_ino)) + ':' +
+           QByteArray::number(qint64(st.st_mtim.tv_sec)) + '.' +
+           QByteArray::number(qint64(st.st_mtim.tv_nsec)) + ':' +
+           QByteArray::number(qint64(st.st_size));
+}
+
+static QByteArray lsdcIdentity(const QString &path)
+{
+    struct stat st;
+    if(::stat(QFile::encodeName(path).constData(), &st) != 0)
+        return QByteArray();
+    return lsdcIdentity(st);
+}
+
+static quint32 lsdcHash(QStringView s)
+{
+    // FNV-1a over UTF-16 code units
+    quint32 h = 2166136261u;
+    for(const QChar c : s)
+    {
+        h ^= c.unicode();
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static quint32 lsdcBuckets(int count)
+{
+    quint32 buckets = 16;
+    while(buckets < quint32(count) * 2)
+        buckets <<= 1;
+    return buckets;
+}
+
+static quint64 lsdcSourceStamp()
+{
+    // rebuild() walks the whole tree, so every directory mtime (entries
+    // added or removed) and every desktop file's mtime and size (edited
+    // in place) goes into the stamp, along with mimeinfo.cache
+    quint64 h = 14695981039346656037ull;
+    auto mix = [&h](const QByteArray &bytes) {
+        for(char c : bytes)
+        {
+            h ^= quint8(c);
+            h *= 1099511628211ull;
+        }
+    };
+    auto stamp = [](const QFileInfo &fi) {
+        return fi.filePath().toUtf8() + '|' +
+               QByteArray::number(fi.lastModified().toMSecsSinceEpoch()) + '|' +
+               QByteArray::number(fi.isDir() ? 0 : fi.size());
+    };
+    for(auto &dir : LSDesktopCache::sourceDirectories())
+    {
+        QFileInfo mi(QString("%1/%2").arg(dir, MIMEINFO_CACHE));
+        mix(stamp(QFileInfo(dir)));
+        mix(QByteArray::number(mi.exists() ? mi.lastModified().toMSecsSinceEpoch() : 0));
+
+        // readdir order is not stable across filesystems, sort first
+        QList<QByteArray> entries;
+        QDirIterator it(dir, QStringList() << "*.desktop",
+                        QDir::Files | QDir::AllDirs | QDir::NoDotAndDotDot,
+                        QDirIterator::Subdirectories);
+        while(it.hasNext())
+        {
+            it.next();
+            entries.append(stamp(it.fileInfo()));
+        }
+        std::sort(entries.begin(), entries.end());
+        for(auto &entry : entries)
+            mix(entry);
+    }
+    return h;
+}
+
+LSDesktopCachePrivate::LSDesktopCachePrivate(LSDesktopCache *parent)
+    : d(parent)
+    , m_watch(new QFileSystemWatcher(parent)) {}
+
+LSDesktopCachePrivate::~LSDesktopCachePrivate()
+{
+    unmap();
+}
+
+bool LSDesktopCachePrivate::map()
+{
+    unmap();
+    m_identity.clear();
+    m_file.setFileName(LSDesktopCache::cacheFile());
+    if(!m_file.open(QIODevice::ReadOnly))
+        return false;
+
+    // remember exactly what we opened, the path may be replaced meanwhile
+    struct stat st;
+    if(::fstat(m_file.handle(), &st) == 0)
+        m_identity = lsdcIdentity(st);
+
+    m_size = m_file.size();
+    if(m_size < qint64(sizeof(LSDCHeader)))
+    {
+        unmap();
+        return false;
+    }
+
+    m_data = m_file.map(0, m_size);
+    if(!m_data)
+    {
+        unmap();
+        return false;
+    }
+
+    auto header = reinterpret_cast<const LSDCHeader*>(m_data);
+    auto fits = [this](quint32 offset, quint64 bytes) {
+        return quint64(offset) + bytes <= quint64(m_size);
+    };
+    bool ok = memcmp(header->magic, LSDC_MAGIC, 8) == 0 &&
+              header->version == LSDC_VERSION &&
+              fits(header->entryOffset, quint64(header->entryCount) * sizeof(LSDCEntry)) &&
+              fits(header->itemOffset, quint64(header->itemCount) * sizeof(LSDCItem)) &&
+              fits(header->mimeOffset, quint64(header->mimeCount) * sizeof(LSDCMime)) &&
+              fits(header->mimeAppOffset, quint64(header->mimeAppCount) * sizeof(quint32)) &&
+              fits(header->idTable, quint64(header->idBuckets) * sizeof(LSDCSlot)) &&
+              fits(header->pathTable, quint64(header->buckets) * sizeof(LSDCSlot)) &&
+              fits(header->execTable, quint64(header->buckets) * sizeof(LSDCSlot)) &&
+              fits(header->mimeTable, quint64(header->mimeBuckets) * sizeof(LSDCSlot)) &&
+              fits(header->stringOffset, quint64(header->stringSize) * sizeof(char16_t));
+
+    // an out of date cache is worse than none, fall back to the slow path
+    // until the session manager replaces it
+    if(!ok || header->sourceStamp != lsdcSourceStamp())
+    {
+        unmap();
+        return false;
+    }
+
+    m_header = header;
+    return true;
+}
+
+void LSDesktopCachePrivate::unmap()
+{
+    m_header = nullptr;
+    if(m_data)
+        m_file.unmap(const_cast<uchar*>(m_data));
+    m_data = nullptr;
+    m_size = 0;
+    if(m_file.isOpen())
+        m_file.close();
+}
+
+QStringView LSDesktopCachePrivate::string(const LSDCString &s) const
+{
+    if(quint64(s.offset) + s.length > m_header->stringSize)
+        return QStringView();
+
+    auto pool = reinterpret_cast<const char16_t*>(m_data + m_header->stringOffset);
+    return QStringView(pool + s.offset, qsizetype(s.length));
+}
+
+const LSDCEntry *LSDesktopCachePrivate::entry(quint32 index) const
+{
+    if(index >= m_header->entryCount)
+        return nullptr;
+
+    return reinterpret_cast<const LSDCEntry*>(m_data + m_header->entryOffset) + index;
+}
+
+quint32 LSDesktopCachePrivate::probe(quint32 table, quint32 buckets, QStringView key) const
+{
+    if(!m_header || buckets == 0)
+        return 0;
+
+    auto slots = reinterpret_cast<const LSDCSlot*>(m_data + table);
+    quint32 mask = buckets - 1;
+    for(quint32 i = lsdcHash(key) & mask, n = 0; n < buckets; i = (i + 1) & mask, ++n)
+    {
+        if(slots[i].value == 0)
+            return 0;
+
+        if(string(slots[i].key) == key)
+            return slots[i].value;
+    }
+    return 0;
+}
+
+LSDesktopCache::LSDesktopCache(QObject *parent)
+    : QObject(parent)
+    , p(new LSDesktopCachePrivate(this))
+{
+    auto file = cacheFile();
+    QDir().mkpath(QFileInfo(file).absolutePath());
+    // watch the directory too so we notice the cache being created
+    p->m_watch->addPath(QFileInfo(file).absolutePath());
+    if(QFile::exists(file))
+        p->m_watch->addPath(file);
+
+    connect(p->m_watch, &QFileSystemWatcher::fileChanged,
+            this, &LSDesktopCache::cacheFileChanged);
+    connect(p->m_watch, &QFileSystemWatcher::directoryChanged,
+            this, &LSDesktopCache::cacheFileChanged);
+    p->map();
+}
+
+LSDesktopCache *LSDesktopCache::instance()
+{
+    // the first call should come from the GUI thread so the watcher
+    // lives there
+    static QMutex mutex;
+    static LSDesktopCache *cache = nullptr;
+    QMutexLocker locker(&mutex);
+    if(!cache)
+        cache = new LSDesktopCache(qApp);
+
+    return cache;
+}
+
+LSDesktopCache::~LSDesktopCache()
+{
+    delete p;
+}
+
+bool LSDesktopCache::isValid() const
+{
+    QReadLocker locker(&p->m_lock);
+    return p->m_header != nullptr;
+}
+
+QString LSDesktopCache::pathForId(const QString &id) const
+{
+    QReadLocker locker(&p->m_lock);
+    if(!p->m_header)
+        return QString();
+
+    auto e = p->entry(p->probe(p->m_header->idTable, p->m_header->idBuckets, id) - 1);
+    return e ? p->string(e->path).toString() : QString();
+}
+
+QString LSDesktopCache::pathForExec(const QString &exec) const
+{
+    QReadLocker locker(&p->m_lock);
+    if(!p->m_header)
+        return QString();
+
+    auto e = p->entry(p->probe(p->m_header->execTable, p->m_header->buckets, exec) - 1);
+    return e ? p->string(e->path).toString() : QString();
+}
+
+QStringList LSDesktopCache::pathsForMimeType(const QString &mimeType) const
+{
+    QReadLocker locker(&p->m_lock);
+    QStringList list;
+    if(!p->m_header)
+        return list;
+
+    auto index = p->probe(p->m_header->mimeTable, p->m_header->mimeBuckets, mimeType);
+    if(index == 0 || index > p->m_header->mimeCount)
+        return list;
+
+    auto mime = reinterpret_cast<const LSDCMime*>(p->m_data + p->m_header->mimeOffset) + (index - 1);
+    auto apps = reinterpret_cast<const quint32*>(p->m_data + p->m_header->mimeAppOffset);
+    if(quint64(mime->firstApp) + mime->appCount > p->m_header->mimeAppCount)
+        return list;
+
+    for(quint32 i = 0; i < mime->appCount; ++i)
+    {
+        auto e = p->entry(apps[mime->firstApp + i]);
+        if(e)
+            list.append(p->string(e->path).toString());
+    }
+    return list;
+}
+
+QStringList LSDesktopCache::mimeTypes() const
+{
+    QReadLocker locker(&p->m_lock);
+    QStringList list;
+    if(!p->m_header)
+        return list;
+
+    auto mimes = reinterpret_cast<const LSDCMime*>(p->m_data + p->m_header->mimeOffset);
+    for(quint32 i = 0; i < p->m_header->mimeCount; ++i)
+        list.append(p->string(mimes[i].name).toString());
+
+    return list;
+}
+
+QStringList LSDesktopCache::allPaths() const
+{
+    QReadLocker locker(&p->m_lock);
+    QStringList list;
+    if(!p->m_header)
+        return list;
+
+    for(quint32 i = 0; i < p->m_header->entryCount; ++i)
+        list.append(p->string(p->entry(i)->path).toString());
+
+    return list;
+}
+
+bool LSDesktopCache::items(const QString &path, QMap<QString, QVariant> &items) const
+{
+    QReadLocker locker(&p->m_lock);
+    if(!p->m_header)
+        return false;
+
+    auto e = p->entry(p->probe(p->m_header->pathTable, p->m_header->buckets, path) - 1);
+    if(!e || quint64(e->firstItem) + e->itemCount > p->m_header->itemCount)
+        return false;
+
+    auto table = reinterpret_cast<const LSDCItem*>(p->m_data + p->m_header->itemOffset);
+    for(quint32 i = e->firstItem; i < e->firstItem + e->itemCount; ++i)
+        items.insert(p->string(table[i].key).toString(),
+                     QVariant(p->string(table[i].value).toString()));
+
+    return true;
+}
+
+QString LSDesktopCache::value(const QString &path, const QString &key) const
+{
+    QReadLocker locker(&p->m_lock);
+    if(!p->m_header)
+        return QString();
+
+    auto e = p->entry(p->probe(p->m_header->pathTable, p->m_header->buckets, path) - 1);
+    if(!e || quint64(e->firstItem) + e->itemCount > p->m_header->itemCount)
+        return QString();
+
+    // items were written from a QMap so they are sorted by key
+    auto first = reinterpret_cast<const LSDCItem*>(p->m_data + p->m_header->itemOffset) + e->firstItem;
+    auto last = first + e->itemCount;
+    auto it = std::lower_bound(first, last, QStringView(key), [this](const LSDCItem &item, QStringView k) {
+        return p->string(item.key).compare(k) < 0;
+    });
+    if(it == last || p->string(it->key) != key)
+        return QString();
+
+    return p->string(it->value).toString();
+}
+
+QString LSDesktopCache::cacheFile()
+{
+    return QString("%1/hollywood/desktop-entries.cache").arg(LSDirectories::cacheHome(false));
+}
+
+QStringList LSDesktopCache::sourceDirectories()
+{
+    QStringList dataDirs = LSDirectories::dataDirs();
+    dataDirs.prepend(LSDirectories::dataHome(false));
+
+    QStringList dirs;
+    for(auto &dir : dataDirs)
+    {
+        auto apps = QString("%1/applications").arg(dir);
+        if(QFileInfo(apps).isDir() && !dirs.contains(apps))
+            dirs.append(apps);
+    }
+    return dirs;
+}
+
+QStringList LSDesktopCache::watchDirectories()
+{
+    // inotify is not recursive, rebuild() reads subdirectories too
+    QStringList dirs;
+    for(auto &dir : sourceDirectories())
+    {
+        dirs.append(dir);
+        QDirIterator it(dir, QDir::AllDirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+        while(it.hasNext())
+            dirs.append(it.next());
+    }
+    return dirs;
+}
+
+bool LSDesktopCache::isStale()
+{
+    QFile file(cacheFile());
+    if(!file.open(QIODevice::ReadOnly))
+        return true;
+
+    LSDCHeader header;
+    if(file.read(reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header))
+        return true;
+
+    return memcmp(header.magic, LSDC_MAGIC, 8) != 0 ||
+           header.version != LSDC_VERSION ||
+           header.sourceStamp != lsdcSourceStamp();
+}
+
+bool LSDesktopCache::rebuildIfStale()
+{
+    if(!isStale())
+        return true;
+
+    return rebuild();
+}
+
+bool LSDesktopCache::rebuild()
+{
+    struct BuildEntry
+    {
+        QString id;
+        QString path;
+        QString exec;
+        QMap<QString,QVariant> items;
+    };
+
+    auto stamp = lsdcSourceStamp();
+    QList<BuildEntry> entries;
+    QHash<QString,quint32> ids;
+    QHash<QString,quint32> paths;
+
+    // earlier data directories take precedence, as in findDesktopFile
+    for(auto &dir : sourceDirectories())
+    {
+        QDirIterator it(dir, QStringList() << "*.desktop", QDir::Files, QDirIterator::Subdirectories);
+        while(it.hasNext())
+        {
+            auto file = QFileInfo(it.next()).canonicalFilePath();
+            auto id = file.mid(QFileInfo(dir).canonicalFilePath().length() + 1);
+            id.replace(QLatin1Char('/'), QLatin1Char('-'));
+            if(file.isEmpty() || ids.contains(id) || paths.contains(file))
+                continue;
+
+            LSDesktopEntry desktop;
+            if(!desktop.loadFromFile(file))
+                continue;
+
+            BuildEntry be;
+            be.id = id;
+            be.path = file;
+            be.exec = desktop.value(QLatin1String("Exec")).toString();
+            be.items = desktop.items();
+            ids.insert(id, entries.count());
+            paths.insert(file, entries.count());
+            entries.append(be);
+        }
+    }
+
+    // findDesktopFile searches recursively by file name, so a bare
+    // basename resolves to applications in subdirectories too
+    QHash<QString,quint32> aliases = ids;
+    for(quint32 i = 0; i < quint32(entries.count()); ++i)
+    {
+        auto base = QFileInfo(entries[i].path).fileName();
+        if(!aliases.contains(base))
+            aliases.insert(base, i);
+    }
+
+    QMap<QString,QList<quint32>> mimes;
+    auto addMime = [&mimes](const QString &mime, quint32 index) {
+        auto &list = mimes[mime];
+        if(!list.contains(index))
+            list.append(index);
+    };
+    for(auto &dir : sourceDirectories())
+    {
+        auto fileName = QString("%1/%2").arg(dir, MIMEINFO_CACHE);
+        if(!QFile::exists(fileName))
+            continue;
+
+        QSettings settings(fileName, QSettings::IniFormat);
+        settings.beginGroup(QLatin1String("MIME Cache"));
+        for(auto &mime : settings.allKeys())
+        {
+            for(auto &candidate : settings.value(mime).toStringList())
+            {
+                if(aliases.contains(candidate))
+                    addMime(mime, aliases.value(candidate));
+            }
+        }
+    }
+    // catch anything update-desktop-database has not seen yet
+    for(quint32 i = 0; i < quint32(entries.count()); ++i)
+    {
+        auto types = entries[i].items.value(QLatin1String("Desktop Entry/MimeType")).toString();
+        for(auto &mime : types.split(QLatin1Char(';'), Qt::SkipEmptyParts))
+            addMime(mime.trimmed(), i);
+    }
+
+    QString pool;
+    QHash<QString,LSDCString> pooled;
+    auto intern = [&pool, &pooled](const QString &s) {
+        if(pooled.contains(s))
+            return pooled.value(s);
+        LSDCString ref { quint32(pool.size()), quint32(s.size()) };
+        pool.append(s);
+        pooled.insert(s, ref);
+        return ref;
+    };
+
+    QList<LSDCEntry> entryTable;
+    QList<LSDCItem> itemTable;
+    for(auto &be : entries)
+    {
+        LSDCEntry e;
+        e.id = intern(be.id);
+        e.path = intern(be.path);
+        e.exec = intern(be.exec);
+        e.firstItem = itemTable.count();
+        e.itemCount = be.items.count();
+        for(auto it = be.items.constBegin(); it != be.items.constEnd(); ++it)
+            itemTable.append(LSDCItem { intern(it.key()), intern(it.value().toString()) });
+        entryTable.append(e);
+    }
+
+    QList<LSDCMime> mimeTable;
+    QList<quint32> mimeApps;
+    QList<QPair<QString,quint32>> mimeKeys;
+    for(auto it = mimes.constBegin(); it != mimes.constEnd(); ++it)
+    {
+        mimeKeys.append(qMakePair(it.key(), quint32(mimeTable.count())));
+        mimeTable.append(LSDCMime { intern(it.key()), quint32(mimeApps.count()), quint32(it.value().count()) });
+        mimeApps.append(it.value());
+    }
+
+    auto buildTable = [&intern](const QList<QPair<QString,quint32>> &keys, quint32 buckets) {
+        QList<LSDCSlot> table(buckets, LSDCSlot { {0, 0}, 0 });
+        QSet<QString> seen;
+        for(auto &k : keys)
+        {
+            if(k.first.isEmpty() || seen.contains(k.first))
+                continue;
+            seen.insert(k.first);
+            quint32 mask = buckets - 1;
+            quint32 i = lsdcHash(k.first) & mask;
+            while(table[i].value != 0)
+                i = (i + 1) & mask;
+            table[i] = LSDCSlot { intern(k.first), k.second + 1 };
+        }
+        return table;
+    };
+
+    QList<QPair<QString,quint32>> idKeys, pathKeys, execKeys;
+    for(auto it = aliases.constBegin(); it != aliases.constEnd(); ++it)
+        idKeys.append(qMakePair(it.key(), it.value()));
+    for(quint32 i = 0; i < quint32(entries.count()); ++i)
+    {
+        pathKeys.append(qMakePair(entries[i].path, i));
+        execKeys.append(qMakePair(entries[i].exec, i));
+    }
+
+    quint32 idBuckets = lsdcBuckets(idKeys.count());
+    quint32 buckets = lsdcBuckets(entries.count());
+    quint32 mimeBuckets = lsdcBuckets(mimeKeys.count());
+    auto idTable = buildTable(idKeys, idBuckets);
+    auto pathTable = buildTable(pathKeys, buckets);
+    auto execTable = buildTable(execKeys, buckets);
+    auto mimeHash = buildTable(mimeKeys, mimeBuckets);
+
+    LSDCHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, LSDC_MAGIC, 8);
+    header.version = LSDC_VERSION;
+    header.sourceStamp = stamp;
+
+    QByteArray data(sizeof(LSDCHeader), 0);
+    auto append = [&data](const void *src, qsizetype bytes) {
+        while(data.size() % 8)
+            data.append('\0');
+        quint32 offset = data.size();
+        data.append(reinterpret_cast<const char*>(src), bytes);
+        return offset;
+    };
+
+    header.entryCount = entryTable.count();
+    header.entryOffset = append(entryTable.constData(), entryTable.count() * sizeof(LSDCEntry));
+    header.itemCount = itemTable.count();
+    header.itemOffset = append(itemTable.constData(), itemTable.count() * sizeof(LSDCItem));
+    header.mimeCount = mimeTable.count();
+    header.mimeOffset = append(mimeTable.constData(), mimeTable.count() * sizeof(LSDCMime));
+    header.mimeAppCount = mimeApps.count();
+    header.mimeAppOffset = append(mimeApps.constData(), mimeApps.count() * sizeof(quint32));
+    header.idBuckets = idBuckets;
+    header.idTable = append(idTable.constData(), idTable.count() * sizeof(LSDCSlot));
+    header.buckets = buckets;
+    header.pathTable = append(pathTable.constData(), pathTable.count() * sizeof(LSDCSlot));
+    header.execTable = append(execTable.constData(), execTable.count() * sizeof(LSDCSlot));
+    header.mimeBuckets = mimeBuckets;
+    header.mimeTable = append(mimeHash.constData(), mimeHash.count() * sizeof(LSDCSlot));
+    // the tables above intern their keys, so the pool goes last
+    header.stringSize = pool.size();
+    header.stringOffset = append(pool.utf16(), pool.size() * sizeof(char16_t));
+    memcpy(data.data(), &header, sizeof(header));
+
+    QDir().mkpath(QFileInfo(cacheFile()).absolutePath());
+    QSaveFile file(cacheFile());
+    if(!file.open(QIODevice::WriteOnly))
+        return false;
+
+    file.write(data);
+    return file.commit();
+}
+
+void LSDesktopCache::cacheFileChanged()
+{
+    // QSaveFile renames over the old cache so our watch on the file
+    // itself is gone by the time we get here
+    auto file = cacheFile();
+    if(QFile::exists(file) && !p->m_watch->files().contains(file))
+        p->m_watch->addPath(file);
+
+    // the directory is shared with other caches, only a new or replaced
+    // desktop-entries.cache is of interest
+    auto identity = lsdcIdentity(file);
+    {
+        QReadLocker locker(&p->m_lock);
+        if(identity == p->m_identity)
+            return;
+    }
+
+    QWriteLocker locker(&p->m_lock);
+    bool was = p->m_header != nullptr;
+    p->map();
+    locker.unlock();
+
+    if(was || isValid())
+        emit changed();
+}
@@ -1,10 +1,15 @@
 /* This implementation was based upon libqtxdg */
 
 #include "desktopentry.h"
+#include "desktopcache.h"
 #include "directories.h"
 
 #include <QProcess>
 
+#ifdef USE_APK
+#include "packageindex.h"
+#endif
+
 static const QLatin1String onlyShowInKey("OnlyShowIn");
 static const QLatin1String notShowInKey("NotShowIn");
 static const QLatin1String categoriesKey("Categories");
@@ -143,6 +148,28 @@ LSDesktopEntry::LSDesktopEntry(const LSDesktopEntry &copy)
 LSDesktopEntry::~LSDesktopEntry() = default;
 
 bool LSDesktopEntry::load(const QString& fileName)
+{
+    // the session keeps every installed entry parsed in the shared cache
+    QMap<QString, QVariant> cached;
+    auto cache = LSDesktopCache::instance();
+    auto path = fileName.startsWith(QDir::separator()) ? fileName : cache->pathForId(fileName);
+    if (!path.isEmpty() && cache->items(path, cached)) {
+        d->clear();
+        d->m_fileName = path;
+        d->m_items = cached;
+        const QString section = prefix() + QLatin1Char('/');
+        d->m_valid = prefix().isEmpty();
+        for (auto it = cached.constBegin(); !d->m_valid && it != cached.constEnd(); ++it)
+            d->m_valid = it.key().startsWith(section);
+        d->m_valid = d->m_valid && check();
+        d->m_type = d->detectType(this);
+        return isValid();
+    }
+
+    return loadFromFile(fileName);
+}
+
+bool LSDesktopEntry::loadFromFile(const QString &fileName)
 {
     d->clear();
     if (fileName.startsWith(QDir::separator())) { // absolute path
@@ -164,6 +191,11 @@ bool LSDesktopEntry::load(const QString& fileName)
     return isValid();
 }
 
+QMap<QString, QVariant> LSDesktopEntry::items() const
+{
+    return d->m_items;
+}
+
 bool LSDesktopEntry::save(QIODevice *device) const
 {
     QTextStream stream(device);
@@ -249,29 +281,9 @@ bool LSDesktopEntry::checkForApk()
 
     if(d->m_valid && d->m_fileName.startsWith("/usr/share/applications"))
     {
-        QProcess proc;
-        QStringList args;
-        args << "info" << "--who-owns" << d->m_fileName;
-
-        proc.start("/usr/sbin/apk", args);
-        proc.waitForFinished();
-        if(proc.exitCode() != 0)
-        {
-            proc.close();
-            d->m_apk_check = true;
-            return false;
-        }
-        auto data = proc.readAllStandardOutput();
-        proc.close();
-        QString package = QString(data.split(' ').last().trimmed());
-        package.remove('"');
-        auto parts = package.split('-');
-        parts.removeLast(); // package rel
-        parts.removeLast(); //version
-        package = parts.join('-');
-        d->m_apk_package = QString(package);
+        d->m_apk_package = LSPackageIndex::ownerOf(d->m_fileName);
         d->m_apk_check = true;
-        return true;
+        return !d->m_apk_package.isEmpty();
     }
 
     return false;
@@ -554,6 +566,10 @@ QString LSDesktopEntry::findDesktopFile(const QString& dirName, const QString& d
 
 QString LSDesktopEntry::findDesktopFile(const QString& desktopName)
 {
+    auto cached = LSDesktopCache::instance()->pathForId(desktopName);
+    if (!cached.isEmpty())
+        return cached;
+
     QStringList dataDirs = LSDirectories::dataDirs();
     dataDirs.prepend(LSDirectories::dataHome(false));
 
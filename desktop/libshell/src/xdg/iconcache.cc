@@ -0,0 +1,658 @@
+// Hollywood Shell Library
+// (C) 2024 Originull Software
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include "iconcache.h"
+#include "iconcache_p.h"
+#include "directories.h"
+
+#include <QCoreApplication>
+#include <QDirIterator>
+#include <QSaveFile>
+#include <QSettings>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QMutex>
+#include <QDir>
+#include <cstring>
+#include <algorithm>
+
+// QIconLoader prefers a PNG over an SVG in the same directory
+static const char *lsicSuffixes[] = { ".png", ".svg", ".xpm" };
+static const quint32 lsicSuffixCount = sizeof(lsicSuffixes) / sizeof(lsicSuffixes[0]);
+
+static quint32 lsicHash(QStringView s)
+{
+    // FNV-1a over UTF-16 code units
+    quint32 h = 2166136261u;
+    for(const QChar c : s)
+    {
+        h ^= c.unicode();
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static quint32 lsicBuckets(int count)
+{
+    quint32 buckets = 16;
+    while(buckets < quint32(count) * 2)
+        buckets <<= 1;
+    return buckets;
+}
+
+static quint64 lsicStamp(const QStringList &chain, bool deep)
+{
+    // installing icons changes the mtime of the size directory they land
+    // in, the theme directory itself only changes when a package runs
+    // gtk-update-icon-cache or adds a directory, so readers only check
+    // the cheap part
+    quint64 h = 14695981039346656037ull;
+    auto mix = [&h](const QByteArray &bytes) {
+        for(char c : bytes)
+        {
+            h ^= quint8(c);
+            h *= 1099511628211ull;
+        }
+    };
+    auto mixDir = [&mix](const QString &dir) {
+        QFileInfo fi(dir);
+        mix(dir.toUtf8());
+        mix(QByteArray::number(fi.exists() ? fi.lastModified().toMSecsSinceEpoch() : 0));
+    };
+
+    for(auto &path : LSIconCache::searchPaths())
+    {
+        mixDir(path);
+        for(auto &theme : chain)
+        {
+            auto dir = QString("%1/%2").arg(path, theme);
+            if(!QFileInfo(dir).isDir())
+                continue;
+
+            mixDir(dir);
+            mixDir(QString("%1/index.theme").arg(dir));
+            if(!deep)
+                continue;
+
+            QStringList subdirs;
+            QDirIterator it(dir, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+            while(it.hasNext())
+                subdirs.append(it.next());
+            subdirs.sort();
+            for(auto &subdir : subdirs)
+                mixDir(subdir);
+        }
+    }
+    for(auto &path : LSIconCache::fallbackPaths())
+        mixDir(path);
+
+    return h;
+}
+
+namespace {
+struct ThemeDir
+{
+    QString path;
+    LSICDir info;
+};
+
+struct ThemeIndex
+{
+    QStringList contentDirs;
+    QStringList parents;
+    QList<ThemeDir> dirs;
+};
+}
+
+static ThemeIndex lsicReadTheme(const QString &theme)
+{
+    ThemeIndex index;
+    QString indexFile;
+    for(auto &path : LSIconCache::searchPaths())
+    {
+        auto dir = QString("%1/%2").arg(path, theme);
+        if(!QFileInfo(dir).isDir())
+            continue;
+
+        index.contentDirs.append(dir);
+        auto file = QString("%1/index.theme").arg(dir);
+        if(indexFile.isEmpty() && QFile::exists(file))
+            indexFile = file;
+    }
+    if(indexFile.isEmpty())
+        return index;
+
+    QSettings settings(indexFile, QSettings::IniFormat);
+    index.parents = settings.value("Icon Theme/Inherits").toStringList();
+    index.parents.removeAll(QString());
+    // every theme falls back to hicolor, as in QIconTheme
+    if(theme != QLatin1String("hicolor") && !index.parents.contains(QLatin1String("hicolor")))
+        index.parents.append(QLatin1String("hicolor"));
+
+    auto dirs = settings.value("Icon Theme/Directories").toStringList();
+    dirs.append(settings.value("Icon Theme/ScaledDirectories").toStringList());
+    for(auto &dir : dirs)
+    {
+        // section names contain slashes, so QSettings sees them as groups
+        int size = settings.value(QString("%1/Size").arg(dir)).toInt();
+        if(size <= 0 || dir.isEmpty())
+            continue;
+
+        ThemeDir td;
+        td.path = dir;
+        memset(&td.info, 0, sizeof(td.info));
+        td.info.size = size;
+        td.info.minSize = settings.value(QString("%1/MinSize").arg(dir), size).toInt();
+        td.info.maxSize = settings.value(QString("%1/MaxSize").arg(dir), size).toInt();
+        td.info.threshold = settings.value(QString("%1/Threshold").arg(dir), 2).toInt();
+        td.info.scale = qMax(1, settings.value(QString("%1/Scale").arg(dir), 1).toInt());
+        auto type = settings.value(QString("%1/Type").arg(dir)).toString();
+        if(type == QLatin1String("Fixed"))
+            td.info.type = LSIconCache::Fixed;
+        else if(type == QLatin1String("Scalable"))
+            td.info.type = LSIconCache::Scalable;
+        else
+            td.info.type = LSIconCache::Threshold;
+        index.dirs.append(td);
+    }
+    return index;
+}
+
+static void lsicResolveChain(const QString &theme, QStringList &chain, QHash<QString,ThemeIndex> &indexes)
+{
+    // depth first, the order QIconLoader searches parents in
+    if(theme.isEmpty() || chain.contains(theme))
+        return;
+
+    auto index = lsicReadTheme(theme);
+    if(index.contentDirs.isEmpty())
+        return;
+
+    chain.append(theme);
+    indexes.insert(theme, index);
+    for(auto &parent : index.parents)
+        lsicResolveChain(parent, chain, indexes);
+}
+
+LSIconCachePrivate::LSIconCachePrivate(LSIconCache *parent, const QString &theme)
+    : d(parent)
+    , m_theme(theme)
+    , m_watch(new QFileSystemWatcher(parent)) {}
+
+LSIconCachePrivate::~LSIconCachePrivate()
+{
+    unmap();
+}
+
+const LSICHeader *LSIconCachePrivate::validate(const uchar *data, qint64 size)
+{
+    if(!data || size < qint64(sizeof(LSICHeader)))
+        return nullptr;
+
+    auto header = reinterpret_cast<const LSICHeader*>(data);
+    auto fits = [size](quint32 offset, quint64 bytes) {
+        return quint64(offset) + bytes <= quint64(size);
+    };
+    bool ok = memcmp(header->magic, LSIC_MAGIC, 8) == 0 &&
+              header->version == LSIC_VERSION &&
+              fits(header->themeOffset, quint64(header->themeCount) * sizeof(LSICString)) &&
+              fits(header->dirOffset, quint64(header->dirCount) * sizeof(LSICDir)) &&
+              fits(header->iconOffset, quint64(header->iconCount) * sizeof(LSICIcon)) &&
+              fits(header->fileOffset, quint64(header->fileCount) * sizeof(LSICFile)) &&
+              fits(header->iconTable, quint64(header->buckets) * sizeof(LSICSlot)) &&
+              fits(header->stringOffset, quint64(header->stringSize) * sizeof(char16_t));
+
+    return ok ? header : nullptr;
+}
+
+bool LSIconCachePrivate::map()
+{
+    unmap();
+    m_file.setFileName(LSIconCache::cacheFile(m_theme));
+    if(!m_file.open(QIODevice::ReadOnly))
+        return false;
+
+    m_size = m_file.size();
+    m_data = m_file.map(0, m_size);
+    m_header = validate(m_data, m_size);
+    if(!m_header)
+    {
+        unmap();
+        return false;
+    }
+
+    // an out of date cache would hide new themes and icons, fall back to
+    // QIconLoader until the session manager replaces it
+    if(m_header->themeStamp != lsicStamp(chain(), false))
+    {
+        unmap();
+        return false;
+    }
+
+    return true;
+}
+
+void LSIconCachePrivate::unmap()
+{
+    m_header = nullptr;
+    if(m_data)
+        m_file.unmap(const_cast<uchar*>(m_data));
+    m_data = nullptr;
+    m_size = 0;
+    if(m_file.isOpen())
+        m_file.close();
+}
+
+QStringView LSIconCachePrivate::string(const LSICString &s) const
+{
+    if(quint64(s.offset) + s.length > m_header->stringSize)
+        return QStringView();
+
+    auto pool = reinterpret_cast<const char16_t*>(m_data + m_header->stringOffset);
+    return QStringView(pool + s.offset, qsizetype(s.length));
+}
+
+QStringList LSIconCachePrivate::chain() const
+{
+    QStringList list;
+    auto themes = reinterpret_cast<const LSICString*>(m_data + m_header->themeOffset);
+    for(quint32 i = 0; i < m_header->themeCount; ++i)
+        list.append(string(themes[i]).toString());
+
+    return list;
+}
+
+quint32 LSIconCachePrivate::probe(QStringView key) const
+{
+    if(!m_header || m_header->buckets == 0)
+        return 0;
+
+    auto slots = reinterpret_cast<const LSICSlot*>(m_data + m_header->iconTable);
+    quint32 mask = m_header->buckets - 1;
+    for(quint32 i = lsicHash(key) & mask, n = 0; n < m_header->buckets; i = (i + 1) & mask, ++n)
+    {
+        if(slots[i].value == 0)
+            return 0;
+
+        if(string(slots[i].key) == key)
+            return slots[i].value <= m_header->iconCount ? slots[i].value : 0;
+    }
+    return 0;
+}
+
+LSIconCache::LSIconCache(const QString &theme, QObject *parent)
+    : QObject(parent)
+    , p(new LSIconCachePrivate(this, theme))
+{
+    auto file = cacheFile(theme);
+    QDir().mkpath(QFileInfo(file).absolutePath());
+    // watch the directory too so we notice the cache being created
+    p->m_watch->addPath(QFileInfo(file).absolutePath());
+    if(QFile::exists(file))
+        p->m_watch->addPath(file);
+
+    connect(p->m_watch, &QFileSystemWatcher::fileChanged,
+            this, &LSIconCache::cacheFileChanged);
+    connect(p->m_watch, &QFileSystemWatcher::directoryChanged,
+            this, &LSIconCache::cacheFileChanged);
+    p->map();
+    p->m_serial++;
+}
+
+LSIconCache *LSIconCache::forTheme(const QString &theme)
+{
+    // icon engines may ask from any thread, e.g. QFileInfoGatherer, but
+    // the watcher needs the GUI thread's event loop.  a QObject cannot be
+    // parented across threads, so the caches live until exit
+    static QMutex mutex;
+    static QHash<QString,LSIconCache*> caches;
+    QMutexLocker locker(&mutex);
+    auto cache = caches.value(theme);
+    if(!cache)
+    {
+        cache = new LSIconCache(theme);
+        if(qApp)
+            cache->moveToThread(qApp->thread());
+        caches.insert(theme, cache);
+    }
+
+    return cache;
+}
+
+LSIconCache::~LSIconCache()
+{
+    delete p;
+}
+
+bool LSIconCache::isValid() const
+{
+    QReadLocker locker(&p->m_lock);
+    return p->m_header != nullptr;
+}
+
+QString LSIconCache::theme() const
+{
+    return p->m_theme;
+}
+
+quint32 LSIconCache::serial() const
+{
+    QReadLocker locker(&p->m_lock);
+    return p->m_serial;
+}
+
+bool LSIconCache::contains(const QString &name) const
+{
+    QReadLocker locker(&p->m_lock);
+    return p->probe(name) != 0;
+}
+
+QList<LSIconCacheEntry> LSIconCache::entries(const QString &name) const
+{
+    QReadLocker locker(&p->m_lock);
+    QList<LSIconCacheEntry> list;
+    auto index = p->probe(name);
+    if(index == 0)
+        return list;
+
+    auto icon = reinterpret_cast<const LSICIcon*>(p->m_data + p->m_header->iconOffset) + (index - 1);
+    if(quint64(icon->firstFile) + icon->fileCount > p->m_header->fileCount)
+        return list;
+
+    auto files = reinterpret_cast<const LSICFile*>(p->m_data + p->m_header->fileOffset);
+    auto dirs = reinterpret_cast<const LSICDir*>(p->m_data + p->m_header->dirOffset);
+    for(quint32 i = icon->firstFile; i < icon->firstFile + icon->fileCount; ++i)
+    {
+        if(files[i].dir >= p->m_header->dirCount || files[i].suffix >= lsicSuffixCount)
+            continue;
+
+        auto &dir = dirs[files[i].dir];
+        LSIconCacheEntry entry;
+        entry.path = QString("%1/%2%3").arg(p->string(dir.path), name,
+                                            QLatin1String(lsicSuffixes[files[i].suffix]));
+        entry.type = dir.type;
+        entry.size = dir.size;
+        entry.minSize = dir.minSize;
+        entry.maxSize = dir.maxSize;
+        entry.threshold = dir.threshold;
+        entry.scale = dir.scale;
+        list.append(entry);
+    }
+    return list;
+}
+
+QString LSIconCache::cacheFile(const QString &theme)
+{
+    return QString("%1/hollywood/icons/%2.cache").arg(LSDirectories::cacheHome(false), theme);
+}
+
+QStringList LSIconCache::searchPaths()
+{
+    // the same order as the generic unix platform theme
+    QStringList candidates;
+    candidates << QString("%1/.icons").arg(QDir::homePath());
+    candidates << QString("%1/icons").arg(LSDirectories::dataHome(false));
+    for(auto &dir : LSDirectories::dataDirs())
+        candidates << QString("%1/icons").arg(dir);
+
+    QStringList dirs;
+    for(auto &dir : candidates)
+    {
+        if(QFileInfo(dir).isDir() && !dirs.contains(dir))
+            dirs.append(dir);
+    }
+    return dirs;
+}
+
+QStringList LSIconCache::fallbackPaths()
+{
+    QStringList dirs;
+    for(auto &dir : LSDirectories::dataDirs())
+    {
+        auto pixmaps = QString("%1/pixmaps").arg(dir);
+        if(QFileInfo(pixmaps).isDir() && !dirs.contains(pixmaps))
+            dirs.append(pixmaps);
+    }
+    return dirs;
+}
+
+QStringList LSIconCache::watchDirectories(const QString &theme)
+{
+    // inotify is not recursive and icons land in the size and context
+    // directories each index.theme lists
+    QStringList chain;
+    QHash<QString,ThemeIndex> indexes;
+    lsicResolveChain(theme, chain, indexes);
+    lsicResolveChain(QLatin1String("hicolor"), chain, indexes);
+
+    QStringList dirs;
+    for(auto &name : chain)
+    {
+        auto &index = indexes[name];
+        for(auto &content : index.contentDirs)
+        {
+            dirs.append(content);
+            for(auto &td : index.dirs)
+            {
+                auto dir = QString("%1/%2").arg(content, td.path);
+                if(QFileInfo(dir).isDir())
+                    dirs.append(dir);
+            }
+        }
+    }
+    return dirs;
+}
+
+bool LSIconCache::isStale(const QString &theme)
+{
+    QFile file(cacheFile(theme));
+    if(!file.open(QIODevice::ReadOnly))
+        return true;
+
+    auto size = file.size();
+    auto data = file.map(0, size);
+    auto header = LSIconCachePrivate::validate(data, size);
+    if(!header)
+        return true;
+
+    // stamp the chain the cache was built from, a changed Inherits line
+    // shows up as a changed index.theme
+    QStringList chain;
+    auto pool = reinterpret_cast<const char16_t*>(data + header->stringOffset);
+    auto themes = reinterpret_cast<const LSICString*>(data + header->themeOffset);
+    for(quint32 i = 0; i < header->themeCount; ++i)
+    {
+        if(quint64(themes[i].offset) + themes[i].length > header->stringSize)
+            return true;
+        chain.append(QStringView(pool + themes[i].offset, qsizetype(themes[i].length)).toString());
+    }
+
+    return header->themeStamp != lsicStamp(chain, false) ||
+           header->contentStamp != lsicStamp(chain, true);
+}
+
+bool LSIconCache::rebuildIfStale(const QString &theme)
+{
+    if(!isStale(theme))
+        return true;
+
+    return rebuild(theme);
+}
+
+bool LSIconCache::rebuild(const QString &theme)
+{
+    QStringList chain;
+    QHash<QString,ThemeIndex> indexes;
+    lsicResolveChain(theme, chain, indexes);
+    lsicResolveChain(QLatin1String("hicolor"), chain, indexes);
+
+    QList<LSICDir> dirTable;
+    QStringList dirPaths;
+    QHash<QString,QList<LSICFile>> icons;
+    QStringList order;
+
+    auto scan = [&](const QString &path, const LSICDir &info, QHash<QString,QList<LSICFile>> &found) {
+        QDir dir(path);
+        auto files = dir.entryList(QStringList() << "*.png" << "*.svg" << "*.xpm", QDir::Files);
+        if(files.isEmpty())
+            return;
+
+        quint32 dirIndex = dirTable.count();
+        dirTable.append(info);
+        dirPaths.append(path);
+        QHash<QString,quint32> best;
+        for(auto &file : files)
+        {
+            int dot = file.lastIndexOf(QLatin1Char('.'));
+            auto name = file.left(dot);
+            auto ext = file.mid(dot);
+            quint32 suffix = 0;
+            while(suffix < lsicSuffixCount && ext != QLatin1String(lsicSuffixes[suffix]))
+                ++suffix;
+            // themes only ever have PNG and SVG
+            if(suffix >= lsicSuffixCount || (info.type != LSIconCache::Fallback && suffix == 2))
+                continue;
+            if(best.contains(name) && best.value(name) <= suffix)
+                continue;
+            best.insert(name, suffix);
+        }
+        for(auto it = best.constBegin(); it != best.constEnd(); ++it)
+            found[it.key()].append(LSICFile { dirIndex, it.value() });
+    };
+
+    for(auto &name : chain)
+    {
+        auto &index = indexes[name];
+        QHash<QString,QList<LSICFile>> found;
+        for(auto &content : index.contentDirs)
+        {
+            for(auto &td : index.dirs)
+                scan(QString("%1/%2").arg(content, td.path), td.info, found);
+        }
+
+        // the first theme in the chain with an icon of that name wins
+        for(auto it = found.begin(); it != found.end(); ++it)
+        {
+            if(icons.contains(it.key()))
+                continue;
+            std::stable_sort(it->begin(), it->end(), [](const LSICFile &a, const LSICFile &b) {
+                return a.suffix < b.suffix;
+            });
+            icons.insert(it.key(), it.value());
+            order.append(it.key());
+        }
+    }
+
+    // unthemed icons, QIconLoader only looks at these once every theme
+    // has come up empty
+    LSICDir fallback;
+    memset(&fallback, 0, sizeof(fallback));
+    fallback.scale = 1;
+    fallback.type = Fallback;
+    for(auto &path : fallbackPaths())
+    {
+        QHash<QString,QList<LSICFile>> found;
+        scan(path, fallback, found);
+        for(auto it = found.constBegin(); it != found.constEnd(); ++it)
+        {
+            if(icons.contains(it.key()))
+                continue;
+            icons.insert(it.key(), it.value());
+            order.append(it.key());
+        }
+    }
+
+    QString pool;
+    QHash<QString,LSICString> pooled;
+    auto intern = [&pool, &pooled](const QString &s) {
+        if(pooled.contains(s))
+            return pooled.value(s);
+        LSICString ref { quint32(pool.size()), quint32(s.size()) };
+        pool.append(s);
+        pooled.insert(s, ref);
+        return ref;
+    };
+
+    QList<LSICString> themeTable;
+    for(auto &name : chain)
+        themeTable.append(intern(name));
+    for(int i = 0; i < dirTable.count(); ++i)
+        dirTable[i].path = intern(dirPaths[i]);
+
+    QList<LSICIcon> iconTable;
+    QList<LSICFile> fileTable;
+    for(auto &name : order)
+    {
+        auto &files = icons[name];
+        iconTable.append(LSICIcon { intern(name), quint32(fileTable.count()), quint32(files.count()) });
+        fileTable.append(files);
+    }
+
+    quint32 buckets = lsicBuckets(iconTable.count());
+    QList<LSICSlot> slots(buckets, LSICSlot { {0, 0}, 0 });
+    for(quint32 i = 0; i < quint32(order.count()); ++i)
+    {
+        quint32 mask = buckets - 1;
+        quint32 b = lsicHash(order[i]) & mask;
+        while(slots[b].value != 0)
+            b = (b + 1) & mask;
+        slots[b] = LSICSlot { iconTable[i].name, i + 1 };
+    }
+
+    LSICHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, LSIC_MAGIC, 8);
+    header.version = LSIC_VERSION;
+    header.themeStamp = lsicStamp(chain, false);
+    header.contentStamp = lsicStamp(chain, true);
+
+    QByteArray data(sizeof(LSICHeader), 0);
+    auto append = [&data](const void *src, qsizetype bytes) {
+        while(data.size() % 8)
+            data.append('\0');
+        quint32 offset = data.size();
+        data.append(reinterpret_cast<const char*>(src), bytes);
+        return offset;
+    };
+
+    header.themeCount = themeTable.count();
+    header.themeOffset = append(themeTable.constData(), themeTable.count() * sizeof(LSICString));
+    header.dirCount = dirTable.count();
+    header.dirOffset = append(dirTable.constData(), dirTable.count() * sizeof(LSICDir));
+    header.iconCount = iconTable.count();
+    header.iconOffset = append(iconTable.constData(), iconTable.count() * sizeof(LSICIcon));
+    header.fileCount = fileTable.count();
+    header.fileOffset = append(fileTable.constData(), fileTable.count() * sizeof(LSICFile));
+    header.buckets = buckets;
+    header.iconTable = append(slots.constData(), slots.count() * sizeof(LSICSlot));
+    header.stringSize = pool.size();
+    header.stringOffset = append(pool.utf16(), pool.size() * sizeof(char16_t));
+    memcpy(data.data(), &header, sizeof(header));
+
+    QDir().mkpath(QFileInfo(cacheFile(theme)).absolutePath());
+    QSaveFile file(cacheFile(theme));
+    if(!file.open(QIODevice::WriteOnly))
+        return false;
+
+    file.write(data);
+    return file.commit();
+}
+
+void LSIconCache::cacheFileChanged()
+{
+    // QSaveFile renames over the old cache so our watch on the file
+    // itself is gone by the time we get here
+    auto file = cacheFile(p->m_theme);
+    if(QFile::exists(file) && !p->m_watch->files().contains(file))
+        p->m_watch->addPath(file);
+
+    QWriteLocker locker(&p->m_lock);
+    bool was = p->m_header != nullptr;
+    p->map();
+    p->m_serial++;
+    locker.unlock();
+
+    if(was || isValid())
+        emit changed();
+}
@@ -1,6 +1,7 @@
 #include "mimeapps.h"
 #include "mimeapps_p.h"
 #include "desktopentry.h"
+#include "desktopcache.h"
 #include "directories.h"
 
 #include <QByteArray>
@@ -37,6 +38,11 @@ LSMimeApplications::LSMimeApplications(QObject *parent)
     if(file.exists())
         p->m_watch->addPath(file.fileName());
 
+    // pick up the session rebuilding the shared desktop cache
+    connect(LSDesktopCache::instance(), &LSDesktopCache::changed, this, [this]() {
+        if(!p->m_globalMime.isEmpty())
+            processGlobalMimeCache();
+    });
 }
 
 LSMimeApplications::~LSMimeApplications()
@@ -67,9 +73,8 @@ QList<LSDesktopEntry *> LSMimeApplications::apps(const QString &mimeType)
     if (mimeType.isEmpty())
         return QList<LSDesktopEntry *>();
 
-    QList<LSDesktopEntry *> list;
     QMutexLocker locker(&p->m_mutex);
-    return list;
+    return p->m_globalMime.values(mimeType);
 }
 
 QList<LSDesktopEntry *> LSMimeApplications::categoryApps(const QString &category)
@@ -171,7 +176,9 @@ void LSMimeApplications::fileUpdated(const QString &file)
 
 void LSMimeApplications::processGlobalMimeCache()
 {
-    for(auto ls : p->m_globalMime.values())
+    // one entry may serve many mime types
+    const auto old = QSet<LSDesktopEntry*>(p->m_globalMime.cbegin(), p->m_globalMime.cend());
+    for(auto ls : old)
     {
         p->m_desktops.removeOne(ls);
         delete ls;
@@ -179,6 +186,42 @@ void LSMimeApplications::processGlobalMimeCache()
 
     p->m_globalMime.clear();
 
+    auto cache = LSDesktopCache::instance();
+    if(cache->isValid())
+    {
+        // the session has already parsed everything for us, so
+        // keep one entry per application instead of one per type
+        QHash<QString,LSDesktopEntry*> loaded;
+        auto paths = cache->allPaths();
+        for(auto &path : paths)
+        {
+            auto desktop = new LSDesktopEntry();
+            desktop->load(path);
+            loaded.insert(path, desktop);
+        }
+
+        QSet<LSDesktopEntry*> used;
+        for(auto &mime : cache->mimeTypes())
+        {
+            // insert backwards so values() keeps the mimeinfo.cache order
+            const auto ordered = cache->pathsForMimeType(mime);
+            for(auto it = ordered.crbegin(); it != ordered.crend(); ++it)
+            {
+                auto app = loaded.value(*it);
+                if(!app)
+                    continue;
+                p->m_globalMime.insert(mime, app);
+                used.insert(app);
+            }
+        }
+        for(auto desktop : loaded)
+        {
+            if(!used.contains(desktop))
+                delete desktop;
+        }
+        return;
+    }
+
     QString fileName = QString("%1/%2")
             .arg(GLOBAL_APPS_FOLDER)
             .arg(MIMEINFO_CACHE);
@@ -246,6 +289,9 @@ void LSMimeApplications::processDefaults()
 
 LSDesktopEntry *LSMimeApplications::findDesktopForFile(const QString &file)
 {
+    if(p->m_paths.contains(file))
+        return p->m_paths.value(file);
+
     for(auto desktop : p->m_desktops)
     {
         if(desktop == nullptr)
@@ -262,6 +308,14 @@ LSDesktopEntry *LSMimeApplications::findDesktopForExec(const QString &file)
 {
     // this function can pass either a full path or a binary name
     // this will check just for a binary name
+    auto cached = LSDesktopCache::instance()->pathForExec(file);
+    if(!cached.isEmpty())
+    {
+        auto desktop = findDesktopForFile(cached);
+        if(desktop)
+            return desktop;
+    }
+
     for(auto desktop : p->m_desktops)
     {
         if(desktop->value("Exec") == file)
@@ -286,6 +340,24 @@ LSDesktopEntry *LSMimeApplications::findDesktopForExec(const QString &file)
 
 void LSMimeApplications::cacheAllDesktops()
 {
+    auto cache = LSDesktopCache::instance();
+    if(cache->isValid())
+    {
+        for(auto &path : cache->allPaths())
+        {
+            auto entry = new LSDesktopEntry;
+            entry->load(path);
+            if(entry->isValid())
+            {
+                p->m_desktops.append(entry);
+                p->m_paths.insert(path, entry);
+            }
+            else
+                delete entry;
+        }
+        return;
+    }
+
     QStringList dataDirs = LSDirectories::dataDirs();
     dataDirs.prepend(LSDirectories::dataHome(false));
 
@@ -300,7 +372,10 @@ void LSMimeApplications::cacheAllDesktops()
                 auto entry = new LSDesktopEntry;
                 entry->load(file);
                 if(entry->isValid())
+                {
                     p->m_desktops.append(entry);
+                    p->m_paths.insert(entry->fileName(), entry);
+                }
             }
         }
     }
@@ -0,0 +1,15 @@
+include(../../include/global.pri)
+
+QT -= gui widgets
+CONFIG += console
+TARGET = hwstartup-bench
+HEADERS = startupbench.h
+SOURCES = main.cc startupbench.cc
+
+contains( DEFINES, BUILD_HOLLYWOOD )
+{
+    DESTDIR=$${OBJECTS_DIR}../../output/
+    target.path = $$PREFIX/libexec/hollywood/
+}
+
+INSTALLS += target
@@ -0,0 +1,104 @@
+// Hollywood Startup Benchmark
+// SPDX-FileCopyrightText: 2024 Originull Software
+// SPDX-License-Identifier: GPL-3.0-only
+
+// hwstartup-bench: launches applications repeatedly and reports the time
+// from exec to their first painted window as JSON, so runs from different
+// commits can be compared with --compare.
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QTextStream>
+#include <QJsonDocument>
+#include <hollywood/hollywood.h>
+
+#include "startupbench.h"
+
+static QJsonObject readReport(const QString &path)
+{
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly))
+        return QJsonObject();
+    return QJsonDocument::fromJson(file.readAll()).object();
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    a.setApplicationVersion(HOLLYWOOD_OS_VERSION);
+    a.setOrganizationDomain(HOLLYWOOD_OS_DOMAIN);
+    a.setOrganizationName(HOLLYWOOD_OS_ORGNAME);
+    a.setApplicationName("hwstartup-bench");
+
+    QCommandLineParser p;
+    p.setApplicationDescription(QCoreApplication::translate("hwstartup-bench", "Hollywood Application Startup Benchmark"));
+    p.addHelpOption();
+    p.addVersionOption();
+    p.addOptions({
+        {{"a", "app"}, QCoreApplication::translate("hwstartup-bench", "NAME or NAME=PROGRAM [ARGS] to launch (repeatable)"),
+            "app"},
+        {{"n", "runs"}, QCoreApplication::translate("hwstartup-bench", "Launches per application"), "count", "50"},
+        {"timeout", QCoreApplication::translate("hwstartup-bench", "Seconds to wait for a window"), "seconds", "10"},
+        {"platform", QCoreApplication::translate("hwstartup-bench", "QT_QPA_PLATFORM for the applications, eg. offscreen"),
+            "platform"},
+        {"label", QCoreApplication::translate("hwstartup-bench", "Label stored in the report, eg. a commit hash"), "label"},
+        {{"o", "output"}, QCoreApplication::translate("hwstartup-bench", "Write the report to file instead of stdout"), "file"},
+        {"compare", QCoreApplication::translate("hwstartup-bench", "Compare against a previous report"), "file"},
+        {"threshold", QCoreApplication::translate("hwstartup-bench", "Percent change counted as a regression"),
+            "percent", "5"},
+    });
+    p.process(a);
+
+    QTextStream err(stderr);
+
+    QList<StartupApp> apps;
+    for(const QString &spec : p.values("app"))
+    {
+        StartupApp app;
+        if(!StartupApp::parse(spec, &app))
+        {
+            err << "hwstartup-bench: invalid application " << spec << Qt::endl;
+            return 1;
+        }
+        apps.append(app);
+    }
+    if(apps.isEmpty())
+        apps = StartupApp::defaults();
+
+    StartupBench bench;
+    bench.setRuns(qMax(1, p.value("runs").toInt()));
+    bench.setTimeout(qMax(1, p.value("timeout").toInt()) * 1000);
+    bench.setPlatform(p.value("platform"));
+    bench.setLabel(p.value("label"));
+
+    const auto report = bench.run(apps);
+    const auto json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+
+    if(p.isSet("output"))
+    {
+        QFile file(p.value("output"));
+        if(!file.open(QIODevice::WriteOnly|QIODevice::Truncate))
+        {
+            err << "hwstartup-bench: can't write " << file.fileName() << Qt::endl;
+            return 1;
+        }
+        file.write(json);
+    }
+    else
+        QTextStream(stdout) << json;
+
+    if(p.isSet("compare"))
+    {
+        const auto baseline = readReport(p.value("compare"));
+        if(baseline.isEmpty())
+        {
+            err << "hwstartup-bench: can't read " << p.value("compare") << Qt::endl;
+            return 1;
+        }
+        if(!StartupBench::compare(baseline, report, p.value("threshold").toDouble(), err))
+            return 2;
+    }
+
+    return 0;
+}
@@ -0,0 +1,252 @@
+// Hollywood Startup Benchmark
+// SPDX-FileCopyrightText: 2024 Originull Software
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "startupbench.h"
+
+#include <QCoreApplication>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QTextStream>
+#include <QJsonArray>
+#include <QElapsedTimer>
+#include <hollywood/hollywood.h>
+
+#include <algorithm>
+
+bool StartupApp::parse(const QString &spec, StartupApp *out)
+{
+    StartupApp app;
+    auto sep = spec.indexOf('=');
+    app.name = sep < 0 ? spec : spec.left(sep);
+    auto command = QProcess::splitCommand(sep < 0 ? spec : spec.mid(sep + 1));
+    if(app.name.isEmpty() || command.isEmpty())
+        return false;
+
+    // prefer a freshly built binary next to us over the installed one
+    auto program = command.takeFirst();
+    auto local = QString("%1/%2").arg(QCoreApplication::applicationDirPath(), program);
+    if(!program.contains('/') && QFileInfo(local).isExecutable())
+        app.program = local;
+    else
+        app.program = QStandardPaths::findExecutable(program);
+    if(app.program.isEmpty())
+        app.program = program;
+
+    app.args = command;
+    *out = app;
+    return true;
+}
+
+QList<StartupApp> StartupApp::defaults()
+{
+    QList<StartupApp> list;
+    StartupApp app;
+    if(parse("calculator=hwcalc", &app))
+        list.append(app);
+    if(parse("editor=startext", &app))
+        list.append(app);
+    return list;
+}
+
+bool StartupBench::launch(const StartupApp &app, qint64 *launchUs, qint64 *themeUs)
+{
+    auto env = QProcessEnvironment::systemEnvironment();
+    env.insert(HOLLYWOOD_STARTUP_BENCH, "1");
+    if(!m_platform.isEmpty())
+        env.insert("QT_QPA_PLATFORM", m_platform);
+
+    QProcess proc;
+    proc.setProcessEnvironment(env);
+    proc.setProcessChannelMode(QProcess::SeparateChannels);
+    proc.setStandardErrorFile(QProcess::nullDevice());
+    proc.setProgram(app.program);
+    proc.setArguments(app.args);
+
+    QElapsedTimer timer;
+    timer.start();
+    proc.start();
+    if(!proc.waitForStarted(m_timeout))
+        return false;
+
+    bool ready = false;
+    QByteArray buffer;
+    while(!ready && timer.elapsed() < m_timeout)
+    {
+        if(!proc.waitForReadyRead(qMax<qint64>(1, m_timeout - timer.elapsed())))
+            break;
+
+        buffer.append(proc.readAllStandardOutput());
+        int eol;
+        while((eol = buffer.indexOf('\n')) >= 0)
+        {
+            auto line = buffer.left(eol).trimmed();
+            buffer.remove(0, eol + 1);
+            if(!line.startsWith(HOLLYWOOD_STARTUP_READY))
+                continue;
+
+            *launchUs = timer.nsecsElapsed() / 1000;
+            *themeUs = line.mid(qstrlen(HOLLYWOOD_STARTUP_READY)).trimmed().toLongLong();
+            ready = true;
+            break;
+        }
+    }
+
+    // the platform theme quits the application after reporting
+    if(!proc.waitForFinished(ready ? 5000 : 0))
+    {
+        proc.kill();
+        proc.waitForFinished();
+    }
+    return ready;
+}
+
+QJsonObject StartupBench::runApp(const StartupApp &app)
+{
+    QJsonObject result;
+    result.insert("name", app.name);
+    result.insert("program", app.program);
+    result.insert("args", QJsonArray::fromStringList(app.args));
+
+    // the first launch pays for the page cache, keep it out of the
+    // distribution but report it
+    QList<qint64> launches, themes;
+    qint64 cold = -1;
+    int failed = 0;
+    for(int i = 0; i < m_runs + 1; ++i)
+    {
+        qint64 launchUs = 0, themeUs = 0;
+        if(!launch(app, &launchUs, &themeUs))
+        {
+            ++failed;
+            continue;
+        }
+        if(i == 0)
+        {
+            cold = launchUs;
+            continue;
+        }
+        launches.append(launchUs);
+        themes.append(themeUs);
+    }
+
+    result.insert("runs", m_runs);
+    result.insert("failed", failed);
+    result.insert("cold_us", cold < 0 ? QJsonValue() : QJsonValue(cold));
+    result.insert("launch_us", summarize(launches));
+    result.insert("theme_us", summarize(themes));
+    return result;
+}
+
+QJsonObject StartupBench::run(const QList<StartupApp> &apps)
+{
+    QJsonArray results;
+    for(const StartupApp &app : apps)
+    {
+        QTextStream(stderr) << "hwstartup-bench: launching " << app.name
+                            << " " << m_runs << " times" << Qt::endl;
+        results.append(runApp(app));
+    }
+
+    QJsonObject report;
+    report.insert("version", 1);
+    report.insert("label", m_label);
+    report.insert("date", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    report.insert("os_version", HOLLYWOOD_OS_VERSION);
+    report.insert("platform", m_platform);
+    report.insert("apps", results);
+    return report;
+}
+
+QJsonObject StartupBench::summarize(QList<qint64> samples)
+{
+    QJsonObject s;
+    s.insert("count", samples.count());
+    if(samples.isEmpty())
+        return s;
+
+    std::sort(samples.begin(), samples.end());
+    auto pct = [&samples](double p) {
+        return samples.at(qMin<qsizetype>(samples.count() - 1, qsizetype(p * samples.count())));
+    };
+
+    double total = 0;
+    for(auto v : std::as_const(samples))
+        total += v;
+
+    s.insert("mean", total / samples.count());
+    s.insert("min", samples.first());
+    s.insert("p50", pct(0.50));
+    s.insert("p95", pct(0.95));
+    s.insert("max", samples.last());
+    return s;
+}
+
+static double metric(const QJsonObject &app, const QString &path)
+{
+    QJsonValue v = app;
+    for(const QString &key : path.split('.'))
+        v = v.toObject().value(key);
+    return v.isDouble() ? v.toDouble() : -1;
+}
+
+bool StartupBench::compare(const QJsonObject &baseline, const QJsonObject &current,
+                           double threshold, QTextStream &out)
+{
+    static const char *metrics[] = {
+        "launch_us.p50",
+        "launch_us.p95",
+        "theme_us.p50",
+        "cold_us",
+        "failed",
+    };
+
+    QHash<QString, QJsonObject> base;
+    for(const auto &a : baseline.value("apps").toArray())
+        base.insert(a.toObject().value("name").toString(), a.toObject());
+
+    out << "baseline: " << baseline.value("label").toString()
+        << "  current: " << current.value("label").toString() << Qt::endl;
+
+    bool ok = true;
+    for(const auto &v : current.value("apps").toArray())
+    {
+        const auto cur = v.toObject();
+        const auto name = cur.value("name").toString();
+        if(!base.contains(name))
+            continue;
+
+        out << name << Qt::endl;
+        for(auto m : metrics)
+        {
+            const double before = metric(base.value(name), m);
+            const double after = metric(cur, m);
+            if(before < 0 || after < 0)
+                continue;
+
+            QString change;
+            if(before > 0)
+            {
+                const double pct = (after - before) * 100.0 / before;
+                change = QString::asprintf("%+.1f%%", pct);
+                if(pct > threshold)
+                {
+                    change += "  REGRESSION";
+                    ok = false;
+                }
+            }
+            else if(after > 0)
+            {
+                change = "new";
+                ok = false;
+            }
+
+            out << QString("    %1 %2 -> %3  %4")
+                   .arg(QLatin1String(m), -16).arg(before, 10, 'f', 0)
+                   .arg(after, 10, 'f', 0).arg(change) << Qt::endl;
+        }
+    }
+    return ok;
+}
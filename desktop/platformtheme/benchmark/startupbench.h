@@ -0,0 +1,53 @@
+// Hollywood Startup Benchmark
+// SPDX-FileCopyrightText: 2024 Originull Software
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef STARTUPBENCH_H
+#define STARTUPBENCH_H
+
+#include <QString>
+#include <QStringList>
+#include <QJsonObject>
+#include <QList>
+
+class QTextStream;
+
+// An application to launch, written as NAME or NAME=PROGRAM [ARGS...]
+struct StartupApp
+{
+    QString name;
+    QString program;
+    QStringList args;
+
+    static bool parse(const QString &spec, StartupApp *out);
+    static QList<StartupApp> defaults();
+};
+
+// Launches each application repeatedly with HOLLYWOOD_STARTUP_BENCH set;
+// the platform theme prints HOLLYWOOD_STARTUP_READY once the first window
+// is painted and quits, so a run measures exec to first frame.
+class StartupBench
+{
+public:
+    void setRuns(int runs) { m_runs = runs; }
+    void setTimeout(int msecs) { m_timeout = msecs; }
+    void setPlatform(const QString &platform) { m_platform = platform; }
+    void setLabel(const QString &label) { m_label = label; }
+
+    QJsonObject run(const QList<StartupApp> &apps);
+
+    // same rules as hwcomp-bench --compare
+    static bool compare(const QJsonObject &baseline, const QJsonObject &current,
+                        double threshold, QTextStream &out);
+private:
+    QJsonObject runApp(const StartupApp &app);
+    bool launch(const StartupApp &app, qint64 *launchUs, qint64 *themeUs);
+    static QJsonObject summarize(QList<qint64> samples);
+
+    QString m_platform;
+    QString m_label;
+    int m_runs = 50;
+    int m_timeout = 10000;
+};
+
+#endif // STARTUPBENCH_H
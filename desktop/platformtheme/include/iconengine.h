@@ -0,0 +1,45 @@
+#ifndef HWCACHEDICONENGINE_H
+#define HWCACHEDICONENGINE_H
+
+#include <QIconEngine>
+#include <QScopedPointer>
+#include <QHash>
+#include <QIcon>
+#include <iconcache.h>
+
+// Theme icons resolved through the session's LSIconCache.  The entry for a
+// size is chosen the way QIconLoaderEngine does it; loading and drawing
+// the chosen file is left to a plain file QIcon.  When the cache for the
+// current theme is missing or out of date everything is forwarded to a
+// QIconLoaderEngine instead.
+class HWCachedIconEngine : public QIconEngine
+{
+public:
+    explicit HWCachedIconEngine(const QString &iconName);
+    ~HWCachedIconEngine() override;
+
+    QIconEngine *clone() const override;
+    QString key() const override;
+    QString iconName() override;
+    bool isNull() override;
+    QSize actualSize(const QSize &size, QIcon::Mode mode, QIcon::State state) override;
+    QPixmap pixmap(const QSize &size, QIcon::Mode mode, QIcon::State state) override;
+    QPixmap scaledPixmap(const QSize &size, QIcon::Mode mode, QIcon::State state, qreal scale) override;
+    void paint(QPainter *painter, const QRect &rect, QIcon::Mode mode, QIcon::State state) override;
+    QList<QSize> availableSizes(QIcon::Mode mode, QIcon::State state) override;
+private:
+    void ensureLoaded();
+    const LSIconCacheEntry* entryForSize(const QSize &size, int scale = 1) const;
+    QIcon iconForEntry(const LSIconCacheEntry *entry);
+
+    QString m_name;
+    QString m_resolvedName;
+    QString m_theme;
+    quint32 m_serial = 0;
+    bool m_loaded = false;
+    QList<LSIconCacheEntry> m_entries;
+    QHash<QString,QIcon> m_files;
+    QScopedPointer<QIconEngine> m_loader;
+};
+
+#endif // HWCACHEDICONENGINE_H
@@ -9,6 +9,7 @@
 #include <QColor>
 #include <Qt6GSettings/QGSettings>
 #include <QFileSystemWatcher>
+#include <QElapsedTimer>
 #include <qpa/qplatformtheme.h>
 #include <qpa/qplatformthemeplugin.h>
 #include <qnamespace.h>
@@ -71,6 +72,8 @@ public:
     QVariant themeHint(ThemeHint hint) const override;
     QIcon fileIcon(const QFileInfo &fileInfo,
                    QPlatformTheme::IconOptions = { }) const override;
+    QIconEngine *createIconEngine(const QString &iconName) const override;
+    bool eventFilter(QObject *watched, QEvent *event) override;
 public slots:
     void secondInit();
 private:
@@ -82,8 +85,10 @@ private:
     void loadAppearanceSettings();
     void loadInputSettings();
     void loadDesktopFileSettings();
+    bool loadDesktopAccent();
     QStringList dataDirs();
-    QString findDesktopFile();
+    QString findDesktopFile(const QString &id);
+    void reportStartup();
 private slots:
     void appearanceSettingChanged(const QString &key);
     void inputSettingChanged(const QString &key);    
@@ -100,6 +105,7 @@ private:
     QString m_def_font, m_fixed_sys;
     QString m_iconTheme;
     bool m_customAccent = false;
+    bool m_desktopAccentLoaded = false;
     bool m_desktopHasCustomAccent = false;
     QColor m_accentColor;
     QColor m_customAccentColor;
@@ -117,6 +123,10 @@ private:
     bool m_twilightShell = false;
     bool m_customAppearanceMode = false;
     Qt::ColorScheme m_customAppearanceRequest;
+
+    // HOLLYWOOD_STARTUP_BENCH, see platformtheme/benchmark
+    bool m_startupBench = false;
+    QElapsedTimer m_startupTimer;
 };
 
 #endif // PLATFORMTHEME_H
@@ -10,6 +10,7 @@
 #include "platformtheme.h"
 
 #include <QHash>
+#include <QMap>
 #include <QString>
 #include <QWindow>
 
@@ -49,6 +50,11 @@ public:
 Q_SIGNALS:
     void windowChanged(QWindow *newWindow, QWindow *oldWindow);
 
+private Q_SLOTS:
+    void queueLayoutUpdate(uint revision, int parent);
+    void queuePropertiesUpdate(const DBusMenuItemList &updatedProps, const DBusMenuItemKeysList &removedProps);
+    void flushUpdates();
+
 private:
     DBusPlatformMenu *m_menu = nullptr;
     DBusMenuAdaptor *m_menuAdaptor = nullptr;
@@ -56,6 +62,12 @@ private:
     QPointer<QWindow> m_window;
     QString m_objectPath;
     bool m_initted = false;
+    // changes are collected and sent once per event loop turn, so that
+    // rebuilding a menu doesn't send the viewer a signal per action
+    QMap<int, uint> m_pendingLayouts;
+    QMap<int, QVariantMap> m_pendingProperties;
+    QMap<int, QStringList> m_pendingRemoved;
+    bool m_flushQueued = false;
     HollywoodPlatformTheme *m_platformTheme;
     static DBusMenuBar *s_globalMenuBar;
     static QHash<QWindow *, DBusMenuBar *> s_menuBars;
@@ -8,6 +8,7 @@ TEMPLATE = lib
 CONFIG += plugin wayland-scanner
 INCLUDEPATH += include/
 INCLUDEPATH += ../libcommdlg
+INCLUDEPATH += ../libshell/include
 DEFINES -=QT_NO_SIGNALS_SLOTS_KEYWORDS
 
 versionAtLeast(QT_VERSION, 6.0.0) {
@@ -15,12 +16,14 @@ versionAtLeast(QT_VERSION, 6.0.0) {
 } else {
     LIBS += -L../output -lcommdlg5-$${HOLLYWOOD_APIVERSION}
 }
+LIBS += -L../output -lshell-$${HOLLYWOOD_APIVERSION}
 LIBS+= -lQt6GSettings
 
 WAYLANDCLIENTSOURCES += ../display/compositor/protocols/appmenu.xml
 
 SOURCES += \
     src/dialoghelpers.cc \
+    src/iconengine.cc \
     src/platformtheme.cc \
     src/qdbusmenuadaptor.cc \
     src/qdbusmenubar.cc \
@@ -31,6 +34,7 @@ SOURCES += \
 
 HEADERS += \
     include/dialoghelpers.h \
+    include/iconengine.h \
     include/platformtheme.h \
     include/qdbusmenuadaptor_p.h \
     include/qdbusmenubar_p.h \
@@ -0,0 +1,237 @@
+#include "iconengine.h"
+
+#include <QPainter>
+#include <QPaintDevice>
+#include <QtMath>
+#include <climits>
+#include <private/qiconloader_p.h>
+
+static bool directoryMatchesSizeAndScale(const LSIconCacheEntry &entry, int size, int scale)
+{
+    if(entry.scale != scale)
+        return false;
+
+    switch(entry.type)
+    {
+    case LSIconCache::Fixed:
+        return entry.size == size;
+    case LSIconCache::Scalable:
+        return size <= entry.maxSize && size >= entry.minSize;
+    case LSIconCache::Threshold:
+        return size >= entry.size - entry.threshold &&
+               size <= entry.size + entry.threshold;
+    case LSIconCache::Fallback:
+        return true;
+    }
+    return false;
+}
+
+static int directorySizeDistance(const LSIconCacheEntry &entry, int size, int scale)
+{
+    const int scaledSize = size * scale;
+    switch(entry.type)
+    {
+    case LSIconCache::Fixed:
+        return qAbs(entry.size * entry.scale - scaledSize);
+    case LSIconCache::Scalable:
+        if(scaledSize < entry.minSize * entry.scale)
+            return entry.minSize * entry.scale - scaledSize;
+        if(scaledSize > entry.maxSize * entry.scale)
+            return scaledSize - entry.maxSize * entry.scale;
+        return 0;
+    case LSIconCache::Threshold:
+        if(scaledSize < (entry.size - entry.threshold) * entry.scale)
+            return entry.minSize * entry.scale - scaledSize;
+        if(scaledSize > (entry.size + entry.threshold) * entry.scale)
+            return scaledSize - entry.maxSize * entry.scale;
+        return 0;
+    case LSIconCache::Fallback:
+        return 0;
+    }
+    return INT_MAX;
+}
+
+HWCachedIconEngine::HWCachedIconEngine(const QString &iconName)
+    : m_name(iconName)
+{
+}
+
+HWCachedIconEngine::~HWCachedIconEngine()
+{
+}
+
+QIconEngine *HWCachedIconEngine::clone() const
+{
+    return new HWCachedIconEngine(m_name);
+}
+
+QString HWCachedIconEngine::key() const
+{
+    return QLatin1String("HWCachedIconEngine");
+}
+
+void HWCachedIconEngine::ensureLoaded()
+{
+    // the theme follows the appearance setting and the session replaces
+    // the cache when icons are installed, both invalidate what we found
+    auto theme = QIcon::themeName();
+    auto cache = LSIconCache::forTheme(theme);
+    auto serial = cache->serial();
+    if(m_loaded && theme == m_theme && serial == m_serial)
+        return;
+
+    m_loaded = true;
+    m_theme = theme;
+    m_serial = serial;
+    m_entries.clear();
+    m_files.clear();
+    m_resolvedName.clear();
+    m_loader.reset();
+
+    if(!cache->isValid())
+    {
+        m_loader.reset(new QIconLoaderEngine(m_name));
+        return;
+    }
+
+    // like QIconLoader drop dash separated parts until a theme has the
+    // icon, an unthemed pixmap only wins when no theme does
+    auto entries = cache->entries(m_name);
+    auto resolved = m_name;
+    if(entries.isEmpty() || entries.first().type == LSIconCache::Fallback)
+    {
+        auto name = m_name;
+        for(int dash = name.lastIndexOf(QLatin1Char('-')); dash > 0; dash = name.lastIndexOf(QLatin1Char('-')))
+        {
+            name.truncate(dash);
+            auto themed = cache->entries(name);
+            if(!themed.isEmpty() && themed.first().type != LSIconCache::Fallback)
+            {
+                entries = themed;
+                resolved = name;
+                break;
+            }
+        }
+    }
+
+    m_entries = entries;
+    if(!m_entries.isEmpty())
+        m_resolvedName = resolved;
+}
+
+const LSIconCacheEntry *HWCachedIconEngine::entryForSize(const QSize &size, int scale) const
+{
+    const int iconSize = qMin(size.width(), size.height());
+
+    // the entries are sorted so that PNG files come first
+    for(auto &entry : m_entries)
+    {
+        if(directoryMatchesSizeAndScale(entry, iconSize, scale))
+            return &entry;
+    }
+
+    const LSIconCacheEntry *closest = nullptr;
+    int minimal = INT_MAX;
+    for(auto &entry : m_entries)
+    {
+        int distance = directorySizeDistance(entry, iconSize, scale);
+        if(distance < minimal)
+        {
+            minimal = distance;
+            closest = &entry;
+        }
+    }
+    return closest;
+}
+
+QIcon HWCachedIconEngine::iconForEntry(const LSIconCacheEntry *entry)
+{
+    auto it = m_files.constFind(entry->path);
+    if(it != m_files.constEnd())
+        return it.value();
+
+    QIcon icon(entry->path);
+    m_files.insert(entry->path, icon);
+    return icon;
+}
+
+QString HWCachedIconEngine::iconName()
+{
+    ensureLoaded();
+    if(m_loader)
+        return m_loader->iconName();
+
+    return m_resolvedName;
+}
+
+bool HWCachedIconEngine::isNull()
+{
+    ensureLoaded();
+    if(m_loader)
+        return m_loader->isNull();
+
+    return m_entries.isEmpty();
+}
+
+QSize HWCachedIconEngine::actualSize(const QSize &size, QIcon::Mode mode, QIcon::State state)
+{
+    ensureLoaded();
+    if(m_loader)
+        return m_loader->actualSize(size, mode, state);
+
+    auto entry = entryForSize(size);
+    if(!entry)
+        return QSize(0, 0);
+
+    if(entry->type == LSIconCache::Scalable)
+        return size;
+    if(entry->type == LSIconCache::Fallback)
+        return iconForEntry(entry).actualSize(size, mode, state);
+
+    int result = qMin(entry->size * entry->scale, qMin(size.width(), size.height()));
+    return QSize(result, result);
+}
+
+QPixmap HWCachedIconEngine::pixmap(const QSize &size, QIcon::Mode mode, QIcon::State state)
+{
+    return scaledPixmap(size, mode, state, 1.0);
+}
+
+QPixmap HWCachedIconEngine::scaledPixmap(const QSize &size, QIcon::Mode mode, QIcon::State state, qreal scale)
+{
+    ensureLoaded();
+    if(m_loader)
+        return m_loader->scaledPixmap(size, mode, state, scale);
+
+    // size is in device pixels already
+    const int integerScale = qCeil(scale);
+    auto entry = entryForSize(size / integerScale, integerScale);
+    if(!entry)
+        return QPixmap();
+
+    return iconForEntry(entry).pixmap(size, 1.0, mode, state);
+}
+
+void HWCachedIconEngine::paint(QPainter *painter, const QRect &rect, QIcon::Mode mode, QIcon::State state)
+{
+    const qreal dpr = painter->device()->devicePixelRatio();
+    painter->drawPixmap(rect, scaledPixmap(rect.size() * dpr, mode, state, dpr));
+}
+
+QList<QSize> HWCachedIconEngine::availableSizes(QIcon::Mode mode, QIcon::State state)
+{
+    ensureLoaded();
+    if(m_loader)
+        return m_loader->availableSizes(mode, state);
+
+    QList<QSize> sizes;
+    sizes.reserve(m_entries.count());
+    for(auto &entry : m_entries)
+    {
+        if(entry.type == LSIconCache::Fallback)
+            sizes.append(iconForEntry(&entry).availableSizes());
+        else
+            sizes.append(QSize(entry.size, entry.size));
+    }
+    return sizes;
+}
@@ -19,6 +19,10 @@
 #include <hollywood/hollywood.h>
 #include "wayland.h"
 #include "qdbusmenubar_p.h"
+#include "iconengine.h"
+#include <desktopcache.h>
+#include <QWindow>
+#include <stdio.h>
 
 using namespace QtGSettings;
 
@@ -38,6 +42,10 @@ static bool isDBusGlobalMenuAvailable()
 
 HollywoodPlatformTheme::HollywoodPlatformTheme()
 {
+    m_startupBench = qEnvironmentVariableIsSet(HOLLYWOOD_STARTUP_BENCH);
+    if(m_startupBench)
+        m_startupTimer.start();
+
     auto val = qgetenv("HW_TWILIGHT_SHELL");
     if(!val.isEmpty())
     {
@@ -49,7 +57,15 @@ HollywoodPlatformTheme::HollywoodPlatformTheme()
     loadAppearanceSettings();
     m_inputSettings.reset(new QGSettings("org.originull.hollywood.input", "/org/originull/hollywood/input/", this));
     loadInputSettings();
+    // an application that names its desktop file before constructing
+    // QApplication gets its accent into the first and only palette build
+    if(m_customAccent)
+        loadDesktopAccent();
     createPalettes();
+    // open the icon caches here so their watchers are set up on the GUI
+    // thread rather than by whichever thread resolves an icon first
+    LSIconCache::forTheme(QLatin1String(HOLLYWOOD_DEF_ICONTHEME));
+    LSIconCache::forTheme(QLatin1String(HOLLYWOOD_DARK_ICONTHEME));
     QMetaObject::invokeMethod(this, "secondInit", Qt::QueuedConnection);
 }
 
@@ -124,6 +140,11 @@ void HollywoodPlatformTheme::secondInit()
 {
     QCoreApplication::instance()->installEventFilter(this);
 
+    // setDesktopFileName is usually called right after the QApplication
+    // constructor; this runs before the first window is exposed so a
+    // custom accent doesn't cost a second paint
+    loadDesktopFileSettings();
+
     QTimer *timer = new QTimer(this);
       timer->setSingleShot(true);
 
@@ -136,9 +157,6 @@ void HollywoodPlatformTheme::secondInit()
                   QGuiApplication::platformName() == QLatin1String("hollywood"))
                       m_wayland.reset(new WaylandIntegration(this));
 
-              // in this timeout to give time for application to set
-              loadDesktopFileSettings();
-
               connect(m_appearanceSettings.data(), &QGSettings::settingChanged,
                       this, &HollywoodPlatformTheme::appearanceSettingChanged);
               connect(m_inputSettings.data(), &QGSettings::settingChanged,
@@ -390,57 +408,61 @@ void HollywoodPlatformTheme::loadInputSettings()
 
 void HollywoodPlatformTheme::loadDesktopFileSettings()
 {
-    if(!QGuiApplication::desktopFileName().isEmpty())
+    // already part of the palettes from plugin init, or not wanted
+    if(m_desktopAccentLoaded || !m_customAccent)
+        return;
+
+    if(!loadDesktopAccent())
+        return;
+
+    // setPalette notifies every widget itself, nothing else changed
+    createPalettes();
+    auto palette = preferredPalette();
+    if(palette == nullptr)
+        return;
+
+    QGuiApplication::setPalette(*palette);
+    if(auto app = qobject_cast<QApplication *>(QCoreApplication::instance()))
+        QApplication::style()->polish(app);
+}
+
+bool HollywoodPlatformTheme::loadDesktopAccent()
+{
+    auto id = QGuiApplication::desktopFileName();
+    if(id.isEmpty())
+        return false;
+
+    m_desktopAccentLoaded = true;
+    if(!id.endsWith(QLatin1String(".desktop")))
+        id.append(QLatin1String(".desktop"));
+
+    // the session keeps every desktop entry in a shared cache, only parse
+    // the file ourselves when it isn't there
+    QString color;
+    auto cache = LSDesktopCache::instance();
+    if(cache->isValid())
     {
-        auto dt = findDesktopFile();
+        auto path = cache->pathForId(id);
+        if(!path.isEmpty())
+            color = cache->value(path, QLatin1String("Desktop Entry/X-Hollywood-AccentColor"));
+    }
+    else
+    {
+        auto dt = findDesktopFile(id);
         if(!dt.isEmpty())
         {
             QSettings settings(dt, QSettings::IniFormat);
             settings.beginGroup("Desktop Entry");
-            auto color = settings.value("X-Hollywood-AccentColor").toString();
-            if(!color.isEmpty())
-            {
-                QColor test(color);
-                if(test.isValid())
-                {
-                    m_desktopHasCustomAccent = true;
-                    m_customAccentColor = QColor(color);
-                    createPalettes();
-                    auto palette = preferredPalette();
-                    if(auto app = qobject_cast<QGuiApplication *>(QCoreApplication::instance()))
-                    {
-                        if(palette != nullptr)
-                        {
-                            QGuiApplication::setPalette(*palette);
-                        }
-                        const auto windows = QGuiApplication::allWindows();
-                        for(QWindow* const window : windows)
-                        {
-                            QEvent themeEvent(QEvent::ThemeChange);
-                            QGuiApplication::sendEvent(window, &themeEvent);
-                            QEvent styleEvent(QEvent::StyleChange);
-                            QGuiApplication::sendEvent(window, &styleEvent);
-                        }
-                    }
-                    if(auto app = qobject_cast<QApplication *>(QCoreApplication::instance()))
-                    {
-                        if(palette != nullptr)
-                        {
-                            QApplication::style()->polish(app);
-                        }
-                        const auto widgets = QApplication::allWidgets();
-                        for(QWidget* const widget : widgets)
-                        {
-                            QEvent themeEvent(QEvent::ThemeChange);
-                            QGuiApplication::sendEvent(widget, &themeEvent);
-                            QEvent styleEvent(QEvent::StyleChange);
-                            QGuiApplication::sendEvent(widget, &styleEvent);
-                        }
-                    }
-                }
-            }
+            color = settings.value("X-Hollywood-AccentColor").toString();
         }
     }
+
+    QColor accent(color);
+    m_desktopHasCustomAccent = !color.isEmpty() && accent.isValid();
+    if(m_desktopHasCustomAccent)
+        m_customAccentColor = accent;
+
+    return m_desktopHasCustomAccent;
 }
 
 QStringList HollywoodPlatformTheme::dataDirs()
@@ -473,23 +495,41 @@ QStringList HollywoodPlatformTheme::dataDirs()
     return cleaned;
 }
 
-QString HollywoodPlatformTheme::findDesktopFile()
+QString HollywoodPlatformTheme::findDesktopFile(const QString &id)
 {
-    for(auto dirname : dataDirs())
+    for(auto &dirname : dataDirs())
     {
-        QDir dir(QString("%1/applications").arg(dirname));
-        if(dir.exists())
+        auto file = QString("%1/applications/%2").arg(dirname, id);
+        if(QFileInfo::exists(file))
+            return file;
+    }
+
+    return QString();
+}
+
+bool HollywoodPlatformTheme::eventFilter(QObject *watched, QEvent *event)
+{
+    if(m_startupBench && event->type() == QEvent::Expose)
+    {
+        auto window = qobject_cast<QWindow*>(watched);
+        if(window && window->isExposed())
         {
-            auto files = dir.entryList(QStringList() << "*.desktop");
-            for(auto file : files)
-            {
-                if(file == QApplication::desktopFileName() + ".desktop")
-                    return QString(dirname + "/applications/" + file);
-            }
+            // report once the expose has been painted
+            m_startupBench = false;
+            QMetaObject::invokeMethod(this, &HollywoodPlatformTheme::reportStartup, Qt::QueuedConnection);
         }
     }
 
-    return QString();
+    return QObject::eventFilter(watched, event);
+}
+
+void HollywoodPlatformTheme::reportStartup()
+{
+    // read by hwstartup-bench which measures the launch itself, this is
+    // the part spent after the platform theme was created
+    fprintf(stdout, "%s %lld\n", HOLLYWOOD_STARTUP_READY, m_startupTimer.nsecsElapsed() / 1000);
+    fflush(stdout);
+    QCoreApplication::exit(0);
 }
 
 void HollywoodPlatformTheme::appearanceSettingChanged(const QString &key)
@@ -531,6 +571,8 @@ void HollywoodPlatformTheme::appearanceSettingChanged(const QString &key)
     if(key == "allowAccentOverride")
     {
         m_customAccent = m_appearanceSettings->value("allowAccentOverride").toBool();
+        if(m_customAccent && !m_desktopAccentLoaded)
+            loadDesktopAccent();
         if(m_customAccent != old_custom_accent)
             repolish = true;
     }
@@ -735,6 +777,16 @@ QPlatformTheme* HollywoodPlatformThemePlugin::create(const QString &key, const Q
     return nullptr;
 }
 
+QIconEngine *HollywoodPlatformTheme::createIconEngine(const QString &iconName) const
+{
+    // without a cache from the session QIconLoader walks the theme itself
+    auto cache = LSIconCache::forTheme(preferredIcons());
+    if(iconName.isEmpty() || !cache->isValid())
+        return QPlatformTheme::createIconEngine(iconName);
+
+    return new HWCachedIconEngine(iconName);
+}
+
 QIcon HollywoodPlatformTheme::fileIcon(const QFileInfo &fileInfo, QPlatformTheme::IconOptions iconOptions) const
 {
     if((iconOptions & DontUseCustomDirectoryIcons) && fileInfo.isDir())
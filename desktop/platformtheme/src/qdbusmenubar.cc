@@ -6,6 +6,8 @@
 
 #include "qdbusmenubar_p.h"
 
+#include <utility>
+
 QT_BEGIN_NAMESPACE
 
 /* note: do not change these to QStringLiteral;
@@ -21,8 +23,8 @@ DBusMenuBar::DBusMenuBar(HollywoodPlatformTheme *platformTheme)
     , m_platformTheme(platformTheme)
 {
     DBusMenuItem::registerDBusTypes();
-    connect(m_menu, &DBusPlatformMenu::propertiesUpdated, m_menuAdaptor, &DBusMenuAdaptor::ItemsPropertiesUpdated);
-    connect(m_menu, &DBusPlatformMenu::updated, m_menuAdaptor, &DBusMenuAdaptor::LayoutUpdated);
+    connect(m_menu, &DBusPlatformMenu::propertiesUpdated, this, &DBusMenuBar::queuePropertiesUpdate);
+    connect(m_menu, &DBusPlatformMenu::updated, this, &DBusMenuBar::queueLayoutUpdate);
     connect(m_menu, SIGNAL(popupRequested(int, uint)), m_menuAdaptor, SIGNAL(ItemActivationRequested(int, uint)));
 }
 
@@ -73,14 +75,12 @@ void DBusMenuBar::insertMenu(QPlatformMenu *menu, QPlatformMenu *before)
     DBusPlatformMenuItem *menuItem = menuItemForMenu(menu);
     DBusPlatformMenuItem *beforeItem = menuItemForMenu(before);
     m_menu->insertMenuItem(menuItem, beforeItem);
-    m_menu->emitUpdated();
 }
 
 void DBusMenuBar::removeMenu(QPlatformMenu *menu)
 {
     DBusPlatformMenuItem *menuItem = menuItemForMenu(menu);
     m_menu->removeMenuItem(menuItem);
-    m_menu->emitUpdated();
 }
 
 void DBusMenuBar::syncMenu(QPlatformMenu *menu)
@@ -89,6 +89,76 @@ void DBusMenuBar::syncMenu(QPlatformMenu *menu)
     updateMenuItem(menuItem, menu);
 }
 
+void DBusMenuBar::queueLayoutUpdate(uint revision, int parent)
+{
+    // one LayoutUpdated per parent, carrying the newest revision
+    m_pendingLayouts.insert(parent, qMax(revision, m_pendingLayouts.value(parent)));
+    if (!m_flushQueued) {
+        m_flushQueued = true;
+        QMetaObject::invokeMethod(this, &DBusMenuBar::flushUpdates, Qt::QueuedConnection);
+    }
+}
+
+void DBusMenuBar::queuePropertiesUpdate(const DBusMenuItemList &updatedProps, const DBusMenuItemKeysList &removedProps)
+{
+    // later values replace earlier ones, a property set again is no longer removed
+    for (const DBusMenuItem &item : updatedProps) {
+        QVariantMap &props = m_pendingProperties[item.m_id];
+        QStringList &removed = m_pendingRemoved[item.m_id];
+        for (auto it = item.m_properties.constBegin(); it != item.m_properties.constEnd(); ++it) {
+            props.insert(it.key(), it.value());
+            removed.removeAll(it.key());
+        }
+    }
+    for (const DBusMenuItemKeys &keys : removedProps) {
+        QVariantMap &props = m_pendingProperties[keys.id];
+        QStringList &removed = m_pendingRemoved[keys.id];
+        for (const QString &key : keys.properties) {
+            props.remove(key);
+            if (!removed.contains(key))
+                removed.append(key);
+        }
+    }
+    if (!m_flushQueued) {
+        m_flushQueued = true;
+        QMetaObject::invokeMethod(this, &DBusMenuBar::flushUpdates, Qt::QueuedConnection);
+    }
+}
+
+void DBusMenuBar::flushUpdates()
+{
+    m_flushQueued = false;
+
+    // layout first, the viewer applies the properties to what it fetches
+    const auto layouts = std::exchange(m_pendingLayouts, {});
+    for (auto it = layouts.constBegin(); it != layouts.constEnd(); ++it)
+        Q_EMIT m_menuAdaptor->LayoutUpdated(it.value(), it.key());
+
+    DBusMenuItemList updated;
+    DBusMenuItemKeysList removed;
+    for (auto it = m_pendingProperties.constBegin(); it != m_pendingProperties.constEnd(); ++it) {
+        if (it.value().isEmpty())
+            continue;
+        DBusMenuItem item;
+        item.m_id = it.key();
+        item.m_properties = it.value();
+        updated.append(item);
+    }
+    for (auto it = m_pendingRemoved.constBegin(); it != m_pendingRemoved.constEnd(); ++it) {
+        if (it.value().isEmpty())
+            continue;
+        DBusMenuItemKeys keys;
+        keys.id = it.key();
+        keys.properties = it.value();
+        removed.append(keys);
+    }
+    m_pendingProperties.clear();
+    m_pendingRemoved.clear();
+
+    if (!updated.isEmpty() || !removed.isEmpty())
+        Q_EMIT m_menuAdaptor->ItemsPropertiesUpdated(updated, removed);
+}
+
 void DBusMenuBar::handleReparent(QWindow *newParentWindow)
 {
     // if the parent is set to nullptr on our first time around,
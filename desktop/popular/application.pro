@@ -19,6 +19,7 @@ HEADERS += \
     sources/shortcuthandler.h \
     sources/rendertask.h \
     sources/tileitem.h \
+    sources/lazypage.h \
     sources/pageitem.h \
     sources/thumbnailitem.h \
     sources/presentationview.h \
@@ -48,6 +49,7 @@ SOURCES += \
     sources/shortcuthandler.cpp \
     sources/rendertask.cpp \
     sources/tileitem.cpp \
+    sources/lazypage.cpp \
     sources/pageitem.cpp \
     sources/thumbnailitem.cpp \
     sources/presentationview.cpp \
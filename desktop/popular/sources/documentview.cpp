@@ -81,6 +81,7 @@ typedef synctex_node_t synctex_node_p;
 
 #include "settings.h"
 #include "model.h"
+#include "lazypage.h"
 #include "pluginhandler.h"
 #include "shortcuthandler.h"
 #include "thumbnailitem.h"
@@ -676,6 +677,19 @@ void saveExpandedPaths(const QAbstractItemModel* model, QSet< QByteArray >& path
     }
 }
 
+QVector< Model::Page* > modelPages(const QVector< LazyPage* >& pages)
+{
+    QVector< Model::Page* > modelPages;
+    modelPages.reserve(pages.count());
+
+    foreach(LazyPage* page, pages)
+    {
+        modelPages.append(page);
+    }
+
+    return modelPages;
+}
+
 void restoreExpandedPaths(QAbstractItemModel* model, const QSet< QByteArray >& paths, const QModelIndex& index = QModelIndex(), QByteArray path = QByteArray())
 {
     appendToPath(index, path);
@@ -725,10 +739,14 @@ DocumentView::DocumentView(QWidget* parent) : QGraphicsView(parent),
     m_autoRefreshWatcher(0),
     m_autoRefreshTimer(0),
     m_prefetchTimer(0),
+    m_sizeChangedTimer(0),
+    m_pagesSizeChanged(false),
+    m_thumbnailsSizeChanged(false),
     m_document(0),
     m_pages(),
     m_fileInfo(),
     m_wasModified(false),
+    m_loading(false),
     m_currentPage(-1),
     m_firstPage(-1),
     m_past(),
@@ -824,6 +842,14 @@ DocumentView::DocumentView(QWidget* parent) : QGraphicsView(parent),
 
     connect(m_prefetchTimer, SIGNAL(timeout()), SLOT(on_prefetch_timeout()));
 
+    // size changes of pages loaded on demand
+
+    m_sizeChangedTimer = new QTimer(this);
+    m_sizeChangedTimer->setInterval(0);
+    m_sizeChangedTimer->setSingleShot(true);
+
+    connect(m_sizeChangedTimer, SIGNAL(timeout()), SLOT(on_sizeChanged_timeout()));
+
     // settings
 
     m_continuousMode = s_settings->documentView().continuousMode();
@@ -970,15 +996,33 @@ int DocumentView::pageNumberFromLabel(const QString& label) const
         return value;
     }
 
+    // labels are only known for pages which were already loaded
+
     for(int index = 0; index < m_pages.count(); ++index)
     {
-        if(m_pages.at(index)->label() == label)
+        if(m_pages.at(index)->isLoaded() && m_pages.at(index)->label() == label)
         {
             return index + 1;
         }
     }
 
-    return locale().toInt(label);
+    bool ok = false;
+    const int value = locale().toInt(label, &ok);
+
+    if(ok)
+    {
+        return value;
+    }
+
+    for(int index = 0; index < m_pages.count(); ++index)
+    {
+        if(!m_pages.at(index)->isLoaded() && m_pages.at(index)->load() != 0 && m_pages.at(index)->label() == label)
+        {
+            return index + 1;
+        }
+    }
+
+    return 0;
 }
 
 QString DocumentView::title() const
@@ -1372,6 +1416,8 @@ QPair< QString, QString > DocumentView::searchContext(int page, const QRectF& re
         return qMakePair(QString(), QString());
     }
 
+    m_pages.at(page - 1)->load();
+
     // Fetch at most half of a line as centered on the given rectangle as possible.
     const qreal pageWidth = m_pages.at(page - 1)->size().width();
     const qreal width = qMax(rect.width(), pageWidth / qreal(2));
@@ -1459,11 +1505,19 @@ void DocumentView::show()
 
 bool DocumentView::open(const QString& filePath)
 {
+    // Loading spins an event loop, so do not start a second load meanwhile.
+    if(m_loading)
+    {
+        return false;
+    }
+
+    m_loading = true;
     Model::Document* document = PluginHandler::instance()->loadDocument(filePath);
+    m_loading = false;
 
     if(document != 0)
     {
-        QVector< Model::Page* > pages;
+        QVector< LazyPage* > pages;
 
         if(!checkDocument(filePath, document, pages))
         {
@@ -1509,11 +1563,19 @@ bool DocumentView::open(const QString& filePath)
 
 bool DocumentView::refresh()
 {
+    // Loading spins an event loop, so do not start a second load meanwhile.
+    if(m_loading)
+    {
+        return false;
+    }
+
+    m_loading = true;
     Model::Document* document = PluginHandler::instance()->loadDocument(m_fileInfo.filePath());
+    m_loading = false;
 
     if(document != 0)
     {
-        QVector< Model::Page* > pages;
+        QVector< LazyPage* > pages;
 
         if(!checkDocument(m_fileInfo.filePath(), document, pages))
         {
@@ -1734,7 +1796,7 @@ void DocumentView::startSearch(const QString& text, bool matchCase, bool wholeWo
     cancelSearch();
     clearResults();
 
-    m_searchTask->start(m_pages, text, matchCase, wholeWords, m_currentPage, s_settings->documentView().parallelSearchExecution());
+    m_searchTask->start(modelPages(m_pages), text, matchCase, wholeWords, m_currentPage, s_settings->documentView().parallelSearchExecution());
 }
 
 void DocumentView::cancelSearch()
@@ -1884,7 +1946,7 @@ void DocumentView::startPresentation()
 {
     const int screen = s_settings->presentationView().screen();
 
-    PresentationView* presentationView = new PresentationView(m_pages);
+    PresentationView* presentationView = new PresentationView(modelPages(m_pages));
 
 #if QT_VERSION >= QT_VERSION_CHECK(5,0,0)
 
@@ -1965,7 +2027,12 @@ void DocumentView::on_verticalScrollBar_valueChanged()
 
 void DocumentView::on_autoRefresh_timeout()
 {
-    if(m_fileInfo.exists())
+    if(m_loading)
+    {
+        // A load is still in flight, try again once it has finished.
+        m_autoRefreshTimer->start();
+    }
+    else if(m_fileInfo.exists())
     {
         refresh();
     }
@@ -1977,6 +2044,27 @@ void DocumentView::on_autoRefresh_timeout()
     }
 }
 
+void DocumentView::on_sizeChanged_timeout()
+{
+    if(m_pagesSizeChanged)
+    {
+        m_pagesSizeChanged = false;
+
+        qreal left = 0.0, top = 0.0;
+        saveLeftAndTop(left, top);
+
+        prepareScene();
+        prepareView(left, top);
+    }
+
+    if(m_thumbnailsSizeChanged)
+    {
+        m_thumbnailsSizeChanged = false;
+
+        prepareThumbnailsScene();
+    }
+}
+
 void DocumentView::on_prefetch_timeout()
 {
     const QPair< int, int > prefetchRange = m_layout->prefetchRange(m_currentPage, m_pages.count());
@@ -2059,6 +2147,44 @@ void DocumentView::on_thumbnails_cropRectChanged()
     prepareThumbnailsScene();
 }
 
+void DocumentView::on_pages_sizeChanged()
+{
+    // pages loaded together are laid out together
+
+    m_pagesSizeChanged = true;
+
+    if(!m_sizeChangedTimer->isActive())
+    {
+        m_sizeChangedTimer->start();
+    }
+}
+
+void DocumentView::on_thumbnails_sizeChanged()
+{
+    m_thumbnailsSizeChanged = true;
+
+    if(!m_sizeChangedTimer->isActive())
+    {
+        m_sizeChangedTimer->start();
+    }
+}
+
+void DocumentView::on_pages_pageLoaded(int page)
+{
+    if(m_currentPage == page)
+    {
+        emit currentPageChanged(m_currentPage);
+    }
+}
+
+void DocumentView::on_thumbnails_pageLoaded(int page)
+{
+    ThumbnailItem* thumbnailItem = m_thumbnailItems.at(page - 1);
+
+    thumbnailItem->setText(pageLabelFromNumber(page));
+    thumbnailItem->update();
+}
+
 void DocumentView::on_pages_linkClicked(bool newTab, int page, qreal left, qreal top)
 {
     if(newTab)
@@ -2703,7 +2829,9 @@ bool DocumentView::printUsingQt(QPrinter* printer, const PrintOptions& printOpti
 
         painter.save();
 
-        const Model::Page* page = m_pages.at(index);
+        const LazyPage* page = m_pages.at(index);
+
+        page->load();
 
         if(printOptions.fitToPage)
         {
@@ -2755,7 +2883,7 @@ void DocumentView::saveLeftAndTop(qreal& left, qreal& top) const
     top = (topLeft.y() - boundingRect.y()) / boundingRect.height();
 }
 
-bool DocumentView::checkDocument(const QString& filePath, Model::Document* document, QVector< Model::Page* >& pages)
+bool DocumentView::checkDocument(const QString& filePath, Model::Document* document, QVector< LazyPage* >& pages)
 {
     if(document->isLocked())
     {
@@ -2776,20 +2904,26 @@ bool DocumentView::checkDocument(const QString& filePath, Model::Document* docum
         return false;
     }
 
-    pages.reserve(numberOfPages);
+    // Only the first page is loaded here, the others are loaded when they are needed
+    // and use the size of the first page until then.
 
-    for(int index = 0; index < numberOfPages; ++index)
+    Model::Page* firstPage = document->page(0);
+
+    if(firstPage == 0)
     {
-        Model::Page* page = document->page(index);
+        qWarning() << "No page" << 0 << "was found in document at" << filePath;
 
-        if(page == 0)
-        {
-            qWarning() << "No page" << index << "was found in document at" << filePath;
+        return false;
+    }
 
-            return false;
-        }
+    const QSizeF estimatedSize = firstPage->size();
+
+    pages.reserve(numberOfPages);
+    pages.append(new LazyPage(document, 0, estimatedSize, firstPage));
 
-        pages.append(page);
+    for(int index = 1; index < numberOfPages; ++index)
+    {
+        pages.append(new LazyPage(document, index, estimatedSize));
     }
 
     return true;
@@ -2841,11 +2975,15 @@ void DocumentView::adjustScrollBarPolicy()
     }
 }
 
-void DocumentView::prepareDocument(Model::Document* document, const QVector< Model::Page* >& pages)
+void DocumentView::prepareDocument(Model::Document* document, const QVector< LazyPage* >& pages)
 {
     m_prefetchTimer->blockSignals(true);
     m_prefetchTimer->stop();
 
+    m_sizeChangedTimer->stop();
+    m_pagesSizeChanged = false;
+    m_thumbnailsSizeChanged = false;
+
     cancelSearch();
     clearResults();
 
@@ -2913,6 +3051,8 @@ void DocumentView::preparePages()
         m_pageItems.append(page);
 
         connect(page, SIGNAL(cropRectChanged()), SLOT(on_pages_cropRectChanged()));
+        connect(page, SIGNAL(sizeChanged()), SLOT(on_pages_sizeChanged()));
+        connect(page, SIGNAL(pageLoaded(int)), SLOT(on_pages_pageLoaded(int)));
 
         connect(page, SIGNAL(linkClicked(bool,int,qreal,qreal)), SLOT(on_pages_linkClicked(bool,int,qreal,qreal)));
         connect(page, SIGNAL(linkClicked(bool,QString,int)), SLOT(on_pages_linkClicked(bool,QString,int)));
@@ -2941,6 +3081,8 @@ void DocumentView::prepareThumbnails()
         m_thumbnailItems.append(page);
 
         connect(page, SIGNAL(cropRectChanged()), SLOT(on_thumbnails_cropRectChanged()));
+        connect(page, SIGNAL(sizeChanged()), SLOT(on_thumbnails_sizeChanged()));
+        connect(page, SIGNAL(pageLoaded(int)), SLOT(on_thumbnails_pageLoaded(int)));
 
         connect(page, SIGNAL(linkClicked(bool,int,qreal,qreal)), SLOT(on_pages_linkClicked(bool,int,qreal,qreal)));
     }
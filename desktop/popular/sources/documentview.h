@@ -51,6 +51,7 @@ class Document;
 }
 
 class Settings;
+class LazyPage;
 class PageItem;
 class ThumbnailItem;
 class SearchModel;
@@ -258,6 +259,7 @@ protected slots:
 
     void on_autoRefresh_timeout();
     void on_prefetch_timeout();
+    void on_sizeChanged_timeout();
 
     void on_temporaryHighlight_timeout();
 
@@ -267,6 +269,12 @@ protected slots:
     void on_pages_cropRectChanged();
     void on_thumbnails_cropRectChanged();
 
+    void on_pages_sizeChanged();
+    void on_thumbnails_sizeChanged();
+
+    void on_pages_pageLoaded(int page);
+    void on_thumbnails_pageLoaded(int page);
+
     void on_pages_linkClicked(bool newTab, int page, qreal left, qreal top);
     void on_pages_linkClicked(bool newTab, const QString& fileName, int page);
     void on_pages_linkClicked(const QString& url);
@@ -301,11 +309,16 @@ private:
 
     QTimer* m_prefetchTimer;
 
+    QTimer* m_sizeChangedTimer;
+    bool m_pagesSizeChanged;
+    bool m_thumbnailsSizeChanged;
+
     Model::Document* m_document;
-    QVector< Model::Page* > m_pages;
+    QVector< LazyPage* > m_pages;
 
     QFileInfo m_fileInfo;
     bool m_wasModified;
+    bool m_loading;
 
     int m_currentPage;
     int m_firstPage;
@@ -359,7 +372,7 @@ private:
     QScopedPointer< QAbstractItemModel > m_outlineModel;
     QScopedPointer< QAbstractItemModel > m_propertiesModel;
 
-    bool checkDocument(const QString& filePath, Model::Document* document, QVector< Model::Page* >& pages);
+    bool checkDocument(const QString& filePath, Model::Document* document, QVector< LazyPage* >& pages);
 
     void loadDocumentDefaults();
 
@@ -369,7 +382,7 @@ private:
 
     class VerticalScrollBarChangedBlocker;
 
-    void prepareDocument(Model::Document* document, const QVector< Model::Page* >& pages);
+    void prepareDocument(Model::Document* document, const QVector< LazyPage* >& pages);
     void preparePages();
     void prepareThumbnails();
     void prepareBackground();
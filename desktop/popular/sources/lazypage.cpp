@@ -0,0 +1,182 @@
+/*
+
+Copyright 2024 Originull Software
+
+This file is part of qpdfview.
+
+qpdfview is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+qpdfview is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with qpdfview.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "lazypage.h"
+
+#include <QDebug>
+#include <QImage>
+#include <QMutexLocker>
+
+namespace qpdfview
+{
+
+LazyPage::LazyPage(const Model::Document* document, int index, const QSizeF& estimatedSize, Model::Page* page) :
+    m_document(document),
+    m_index(index),
+    m_estimatedSize(estimatedSize),
+    m_mutex(),
+    m_page(page),
+    m_size(),
+    m_loadFailed(false)
+{
+    if(page != 0)
+    {
+        m_size = page->size();
+    }
+}
+
+LazyPage::~LazyPage()
+{
+    delete m_page.loadAcquire();
+}
+
+bool LazyPage::isLoaded() const
+{
+    return m_page.loadAcquire() != 0;
+}
+
+Model::Page* LazyPage::load() const
+{
+    Model::Page* page = m_page.loadAcquire();
+
+    if(page != 0)
+    {
+        return page;
+    }
+
+    QMutexLocker mutexLocker(&m_mutex);
+
+    page = m_page.loadAcquire();
+
+    if(page != 0 || m_loadFailed)
+    {
+        return page;
+    }
+
+    page = m_document->page(m_index);
+
+    if(page == 0)
+    {
+        qWarning() << "No page" << m_index << "could be loaded.";
+
+        m_loadFailed = true;
+        return 0;
+    }
+
+    m_size = page->size();
+    m_page.storeRelease(page);
+
+    return page;
+}
+
+QSizeF LazyPage::size() const
+{
+    return isLoaded() ? m_size : m_estimatedSize;
+}
+
+QImage LazyPage::render(qreal horizontalResolution, qreal verticalResolution, Model::Rotation rotation, QRect boundingRect) const
+{
+    Model::Page* page = load();
+
+    return page != 0 ? page->render(horizontalResolution, verticalResolution, rotation, boundingRect) : QImage();
+}
+
+QString LazyPage::label() const
+{
+    Model::Page* page = m_page.loadAcquire();
+
+    return page != 0 ? page->label() : QString();
+}
+
+QList< Model::Link* > LazyPage::links() const
+{
+    Model::Page* page = load();
+
+    return page != 0 ? page->links() : QList< Model::Link* >();
+}
+
+QString LazyPage::text(const QRectF& rect) const
+{
+    Model::Page* page = load();
+
+    return page != 0 ? page->text(rect) : QString();
+}
+
+QString LazyPage::cachedText(const QRectF& rect) const
+{
+    Model::Page* page = load();
+
+    return page != 0 ? page->cachedText(rect) : QString();
+}
+
+QList< QRectF > LazyPage::search(const QString& text, bool matchCase, bool wholeWords) const
+{
+    Model::Page* page = load();
+
+    return page != 0 ? page->search(text, matchCase, wholeWords) : QList< QRectF >();
+}
+
+QList< Model::Annotation* > LazyPage::annotations() const
+{
+    Model::Page* page = load();
+
+    return page != 0 ? page->annotations() : QList< Model::Annotation* >();
+}
+
+bool LazyPage::canAddAndRemoveAnnotations() const
+{
+    Model::Page* page = load();
+
+    return page != 0 && page->canAddAndRemoveAnnotations();
+}
+
+Model::Annotation* LazyPage::addTextAnnotation(const QRectF& boundary, const QColor& color)
+{
+    Model::Page* page = load();
+
+    return page != 0 ? page->addTextAnnotation(boundary, color) : 0;
+}
+
+Model::Annotation* LazyPage::addHighlightAnnotation(const QRectF& boundary, const QColor& color)
+{
+    Model::Page* page = load();
+
+    return page != 0 ? page->addHighlightAnnotation(boundary, color) : 0;
+}
+
+void LazyPage::removeAnnotation(Model::Annotation* annotation)
+{
+    Model::Page* page = load();
+
+    if(page != 0)
+    {
+        page->removeAnnotation(annotation);
+    }
+}
+
+QList< Model::FormField* > LazyPage::formFields() const
+{
+    Model::Page* page = load();
+
+    return page != 0 ? page->formFields() : QList< Model::FormField* >();
+}
+
+} // qpdfview
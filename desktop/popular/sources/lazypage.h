@@ -0,0 +1,89 @@
+/*
+
+Copyright 2024 Originull Software
+
+This file is part of qpdfview.
+
+qpdfview is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+qpdfview is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with qpdfview.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef LAZYPAGE_H
+#define LAZYPAGE_H
+
+#include <QAtomicPointer>
+#include <QMutex>
+#include <QSizeF>
+
+#include "model.h"
+
+namespace qpdfview
+{
+
+// Stands in for a page of a document which is only loaded from the plug-in
+// when something needs its contents, so that opening a document with many
+// pages does not load all of them. Until then its size is an estimate,
+// usually the size of the first page, and it has no label.
+
+class LazyPage : public Model::Page
+{
+public:
+    LazyPage(const Model::Document* document, int index, const QSizeF& estimatedSize, Model::Page* page = 0);
+    ~LazyPage();
+
+    int index() const { return m_index; }
+
+    bool isLoaded() const;
+    Model::Page* load() const;
+
+    QSizeF size() const;
+
+    QImage render(qreal horizontalResolution, qreal verticalResolution, Model::Rotation rotation, QRect boundingRect) const;
+
+    QString label() const;
+
+    QList< Model::Link* > links() const;
+
+    QString text(const QRectF& rect) const;
+    QString cachedText(const QRectF& rect) const;
+
+    QList< QRectF > search(const QString& text, bool matchCase, bool wholeWords) const;
+
+    QList< Model::Annotation* > annotations() const;
+
+    bool canAddAndRemoveAnnotations() const;
+    Model::Annotation* addTextAnnotation(const QRectF& boundary, const QColor& color);
+    Model::Annotation* addHighlightAnnotation(const QRectF& boundary, const QColor& color);
+    void removeAnnotation(Model::Annotation* annotation);
+
+    QList< Model::FormField* > formFields() const;
+
+private:
+    Q_DISABLE_COPY(LazyPage)
+
+    const Model::Document* m_document;
+    int m_index;
+
+    QSizeF m_estimatedSize;
+
+    mutable QMutex m_mutex;
+    mutable QAtomicPointer< Model::Page > m_page;
+    mutable QSizeF m_size;
+    mutable bool m_loadFailed;
+
+};
+
+} // qpdfview
+
+#endif // LAZYPAGE_H
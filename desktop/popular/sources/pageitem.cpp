@@ -89,6 +89,7 @@ Settings* PageItem::s_settings = 0;
 PageItem::PageItem(Model::Page* page, int index, PaintMode paintMode, QGraphicsItem* parent) : QGraphicsObject(parent),
     m_page(page),
     m_size(page->size()),
+    m_pageLoaded(false),
     m_cropRect(),
     m_index(index),
     m_paintMode(paintMode),
@@ -116,14 +117,6 @@ PageItem::PageItem(Model::Page* page, int index, PaintMode paintMode, QGraphicsI
 
     setFlag(QGraphicsItem::ItemUsesExtendedStyleOption, useTiling());
 
-    if(!useTiling())
-    {
-        m_tileItems.resize(1);
-        m_tileItems.squeeze();
-
-        m_tileItems.replace(0, new TileItem(this));
-    }
-
     prepareGeometry();
 }
 
@@ -168,6 +161,8 @@ QRectF PageItem::boundingRect() const
 
 void PageItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget*)
 {
+    prepareTileItems();
+
     paintPage(painter, option->exposedRect);
 
     paintLinks(painter);
@@ -258,16 +253,9 @@ void PageItem::setRenderParam(const RenderParam& renderParam)
 
 void PageItem::refresh(bool keepObsoletePixmaps, bool dropCachedPixmaps)
 {
-    if(!useTiling())
+    foreach(TileItem* tile, m_tileItems)
     {
-        m_tileItems.first()->refresh(keepObsoletePixmaps);
-    }
-    else
-    {
-        foreach(TileItem* tile, m_tileItems)
-        {
-            tile->refresh(keepObsoletePixmaps);
-        }
+        tile->refresh(keepObsoletePixmaps);
     }
 
     if(!keepObsoletePixmaps)
@@ -287,6 +275,8 @@ void PageItem::refresh(bool keepObsoletePixmaps, bool dropCachedPixmaps)
 
 int PageItem::startRender(bool prefetch)
 {
+    prepareTileItems();
+
     int cost = 0;
 
     if(!useTiling())
@@ -306,6 +296,11 @@ int PageItem::startRender(bool prefetch)
 
 void PageItem::cancelRender()
 {
+    if(m_tileItems.isEmpty())
+    {
+        return;
+    }
+
     if(!useTiling())
     {
         m_tileItems.first()->cancelRender();
@@ -690,9 +685,45 @@ void PageItem::contextMenuEvent(QGraphicsSceneContextMenuEvent* event)
 
 void PageItem::on_loadInteractiveElements_finished()
 {
+    updateSize();
+
     update();
 }
 
+bool PageItem::updateSize()
+{
+    // The page was loaded by a render or by loading its interactive elements,
+    // so its size is now the real one instead of an estimate.
+
+    const QSizeF size = m_page->size();
+    const bool changed = size != m_size;
+
+    if(changed)
+    {
+        refresh(false, true);
+
+        prepareGeometryChange();
+
+        m_size = size;
+
+        prepareGeometry();
+    }
+
+    if(!m_pageLoaded)
+    {
+        m_pageLoaded = true;
+
+        emit pageLoaded(m_index + 1);
+    }
+
+    if(changed)
+    {
+        emit sizeChanged();
+    }
+
+    return changed;
+}
+
 void PageItem::updateCropRect()
 {
     QRectF cropRect;
@@ -1122,7 +1153,10 @@ void PageItem::prepareGeometry()
     m_boundingRect.setHeight(qRound(m_boundingRect.height()));
 
 
-    prepareTiling();
+    if(!m_tileItems.isEmpty())
+    {
+        prepareTiling();
+    }
 
     updateAnnotationOverlay();
     updateFormFieldOverlay();
@@ -1132,6 +1166,14 @@ void PageItem::prepareTiling()
 {
     if(!useTiling())
     {
+        if(m_tileItems.isEmpty())
+        {
+            m_tileItems.resize(1);
+            m_tileItems.squeeze();
+
+            m_tileItems.replace(0, new TileItem(this));
+        }
+
         m_tileItems.first()->setRect(QRect(0, 0, m_boundingRect.width(), m_boundingRect.height()));
 
         return;
@@ -1204,6 +1246,14 @@ void PageItem::prepareTiling()
     }
 }
 
+void PageItem::prepareTileItems()
+{
+    if(m_tileItems.isEmpty())
+    {
+        prepareTiling();
+    }
+}
+
 inline void PageItem::paintPage(QPainter* painter, const QRectF& exposedRect) const
 {
     if(s_settings->pageItem().decoratePages() && !presentationMode())
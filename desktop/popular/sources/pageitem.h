@@ -97,6 +97,9 @@ public:
 
 signals:
     void cropRectChanged();
+    void sizeChanged();
+
+    void pageLoaded(int page);
 
     void linkClicked(bool newTab, int page, qreal left = qQNaN(), qreal top = qQNaN());
     void linkClicked(bool newTab, const QString& fileName, int page);
@@ -148,6 +151,10 @@ private:
     Model::Page* m_page;
     QSizeF m_size;
 
+    bool m_pageLoaded;
+
+    bool updateSize();
+
     QRectF m_cropRect;
 
     void updateCropRect();
@@ -208,10 +215,13 @@ private:
 
     void prepareGeometry();
 
+    // tiles are only created once the page is painted or rendered
+
     QVector< TileItem* > m_tileItems;
     mutable QSet< TileItem* > m_exposedTileItems;
 
     void prepareTiling();
+    void prepareTileItems();
 
     // paint
 
@@ -25,12 +25,15 @@ along with qpdfview.  If not, see <http://www.gnu.org/licenses/>.
 #include <QApplication>
 #include <QDebug>
 #include <QDir>
+#include <QEventLoop>
 #include <QFileInfo>
+#include <QFutureWatcher>
 #include <QImageReader>
 #include <QMessageBox>
 #include <QPluginLoader>
 #include <QProcess>
 #include <QTemporaryFile>
+#include <QtConcurrentRun>
 
 #if QT_VERSION >= QT_VERSION_CHECK(5,0,0)
 
@@ -343,6 +346,29 @@ QString decompressToTemporaryFile(const QString& filePath, const PluginHandler::
     return file.fileName();
 }
 
+Model::Document* loadDocumentUsingPlugin(const Plugin* plugin, const QString& filePath)
+{
+    return plugin->loadDocument(filePath);
+}
+
+// Waits for work done on the thread pool while still letting the user interface paint.
+template< typename T >
+T waitForResult(const QFuture< T >& future)
+{
+    QFutureWatcher< T > watcher;
+    QEventLoop eventLoop;
+
+    QObject::connect(&watcher, SIGNAL(finished()), &eventLoop, SLOT(quit()));
+    watcher.setFuture(future);
+
+    if(!future.isFinished())
+    {
+        eventLoop.exec(QEventLoop::ExcludeUserInputEvents);
+    }
+
+    return future.result();
+}
+
 } // anonymous
 
 namespace qpdfview
@@ -481,7 +507,7 @@ Model::Document* PluginHandler::loadDocument(const QString& filePath)
 
     if(fileType == GZip || fileType == BZip2 || fileType == XZ)
     {
-        adjustedFilePath = decompressToTemporaryFile(filePath, fileType);
+        adjustedFilePath = waitForResult(QtConcurrent::run(decompressToTemporaryFile, filePath, fileType));
 
         if(adjustedFilePath.isEmpty())
         {
@@ -507,7 +533,8 @@ Model::Document* PluginHandler::loadDocument(const QString& filePath)
         return 0;
     }
 
-    return m_plugins.value(fileType)->loadDocument(adjustedFilePath);
+    // Opening very large documents can take a while, so it is done on the thread pool.
+    return waitForResult(QtConcurrent::run(loadDocumentUsingPlugin, m_plugins.value(fileType), adjustedFilePath));
 }
 
 SettingsWidget* PluginHandler::createSettingsWidget(FileType fileType, QWidget* parent)
@@ -369,6 +369,12 @@ void PresentationView::on_pages_cropRectChanged()
     prepareView();
 }
 
+void PresentationView::on_pages_sizeChanged()
+{
+    prepareScene();
+    prepareView();
+}
+
 void PresentationView::on_pages_linkClicked(bool newTab, int page, qreal left, qreal top)
 {
     Q_UNUSED(newTab);
@@ -558,6 +564,7 @@ void PresentationView::preparePages()
         m_pageItems.append(page);
 
         connect(page, SIGNAL(cropRectChanged()), SLOT(on_pages_cropRectChanged()));
+        connect(page, SIGNAL(sizeChanged()), SLOT(on_pages_sizeChanged()));
 
         connect(page, SIGNAL(linkClicked(bool,int,qreal,qreal)), SLOT(on_pages_linkClicked(bool,int,qreal,qreal)));
     }
@@ -93,6 +93,7 @@ protected slots:
     void on_prefetch_timeout();
 
     void on_pages_cropRectChanged();
+    void on_pages_sizeChanged();
 
     void on_pages_linkClicked(bool newTab, int page, qreal left, qreal top);
 
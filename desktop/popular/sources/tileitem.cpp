@@ -205,6 +205,14 @@ void TileItem::on_finished(const RenderParam& renderParam,
                            const QRect& rect, bool prefetch,
                            const QImage& image, const QRectF& cropRect)
 {
+    if(m_page->updateSize())
+    {
+        // rendered using an estimated page size
+
+        on_finishedOrCanceled();
+        return;
+    }
+
     if(m_page->m_renderParam != renderParam || m_rect != rect)
     {
         on_finishedOrCanceled();
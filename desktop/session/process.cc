@@ -4,8 +4,16 @@
 
 #include "process.h"
 #include "session.h"
+#include "startuptrace.h"
 
+#include <hollywood/hollywood.h>
 #include <QLoggingCategory>
+#include <QTimer>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#include <QDBusServiceWatcher>
 
 
 QLoggingCategory lcSessionS("SSM");
@@ -24,12 +32,15 @@ QLoggingCategory lsOther("OTA");
 ManagedProcess::ManagedProcess(Process desired, QObject *parent)
     : QProcess(parent)
     , m_process(desired)
+    , m_readyTimer(new QTimer(this))
 {
-    auto app = processExecutablePath();
-    setProgram(app);
     setProgram(processExecutablePath());
     setArgumentsForProcess();
 
+    m_readyTimer->setSingleShot(true);
+    connect(m_readyTimer, &QTimer::timeout, this, &ManagedProcess::readyTimeout);
+
+    connect(this, &QProcess::started, this, &ManagedProcess::processStarted);
     connect(this, &QProcess::finished, this, &ManagedProcess::processStopped);
     connect(this, &QProcess::errorOccurred, this, &ManagedProcess::processStopped);
     connect(this, &QProcess::readyReadStandardError, this, &ManagedProcess::logStdErr);
@@ -44,6 +55,7 @@ bool ManagedProcess::initialize()
         if(!smApp->useDbus())
         {
             m_ok = true;
+            markReady("not supervised");
             return true;
         }
 
@@ -51,20 +63,20 @@ bool ManagedProcess::initialize()
         {
             m_ok = true;
             logInfo("Not starting a user dbus session as one already exists.");
+            markReady("existing session");
             return true;
         }
     }
 
+    m_ready = false;
+    armReadyCondition();
+    smApp->trace()->begin("launch", name());
     start();
 
-    if(m_process == Compositor)
-        return watchForCompositor();
-
     if(isOpen())
-    {
-        logInfo(QString("started process (pid %1)").arg(processId()));
         return true;
-    }
+
+    m_readyTimer->stop();
     m_fail++;
     return false;
 }
@@ -92,6 +104,91 @@ void ManagedProcess::setAutoRestart(bool restart)
     m_restart = restart;
 }
 
+void ManagedProcess::setReadyCondition(ReadyCondition condition, const QString &dbusName)
+{
+    m_condition = condition;
+    m_dbusName = dbusName;
+}
+
+void ManagedProcess::setReadyTimeout(int msec)
+{
+    m_readyTimeout = msec;
+}
+
+void ManagedProcess::addDependency(ManagedProcess *process)
+{
+    if(!process || m_depends.contains(process))
+        return;
+
+    m_depends.append(process);
+    connect(process, &ManagedProcess::ready, this, &ManagedProcess::dependencyReady);
+}
+
+void ManagedProcess::launchWhenReady()
+{
+    if(dependenciesReady())
+    {
+        initialize();
+        return;
+    }
+
+    if(m_waiting)
+        return;
+
+    m_waiting = true;
+    smApp->trace()->begin("waiting", name());
+}
+
+QString ManagedProcess::name() const
+{
+    switch(m_process)
+    {
+    case DBusSession:
+        return QLatin1String("dbus-session");
+    case Pipewire:
+        return QLatin1String("pipewire");
+    case Wireplumber:
+        return QLatin1String("wireplumber");
+    case PipewirePulse:
+        return QLatin1String("pipewire-pulse");
+    case Compositor:
+        return QLatin1String("compositor");
+    case Elevator:
+        return QLatin1String("elevator");
+    case Stage:
+        return QLatin1String("stage");
+    case NotificationDaemon:
+        return QLatin1String("notificationd");
+    case Shell:
+        return QLatin1String("shellfm");
+    default:
+        return QFileInfo(program()).fileName();
+    }
+}
+
+void ManagedProcess::processStarted()
+{
+    logInfo(QString("started process (pid %1)").arg(processId()));
+    smApp->trace()->end("launch", name(), {{"pid", processId()}});
+
+    switch(m_condition)
+    {
+    case ReadyOnStart:
+        markReady("started");
+        break;
+    case ReadyOnDBusName:
+        // we may have been restarted by the bus before we started watching
+        if(QDBusConnection::sessionBus().interface()->isServiceRegistered(m_dbusName))
+            markReady(QString("owns %1").arg(m_dbusName));
+        break;
+    case ReadyOnWaylandSocket:
+        runtimeDirChanged();
+        break;
+    case ReadyOnFirstFrame:
+        break;
+    }
+}
+
 void ManagedProcess::processStopped()
 {
     if(!m_restart)
@@ -121,6 +218,8 @@ void ManagedProcess::processStopped()
           .arg(QString::number(exitCode()), QString::number(m_fail)));
 
     m_fail++;
+    m_ready = false;
+    armReadyCondition();
     start();
 }
 
@@ -141,6 +240,12 @@ void ManagedProcess::logStdOut()
                disconnect(this, &QProcess::readyReadStandardOutput, this, &ManagedProcess::logStdOut);
             }
         }
+        if(m_condition == ReadyOnFirstFrame &&
+           line.trimmed() == HOLLYWOOD_COMPOSITOR_READY)
+        {
+            markReady("first frame presented");
+            continue;
+        }
         logInfo(QString("%1").arg(line));
     }
 }
@@ -365,35 +470,114 @@ bool ManagedProcess::checkForExistingDBusSession() const
     return false;
 }
 
-bool ManagedProcess::watchForCompositor()
+void ManagedProcess::dependencyReady()
 {
-    if(isOpen())
+    if(!m_waiting || !dependenciesReady())
+        return;
+
+    m_waiting = false;
+    smApp->trace()->end("waiting", name());
+    initialize();
+}
+
+void ManagedProcess::dbusNameRegistered(const QString &service)
+{
+    if(m_condition != ReadyOnDBusName || state() == QProcess::NotRunning)
+        return;
+
+    markReady(QString("owns %1").arg(service));
+}
+
+void ManagedProcess::runtimeDirChanged()
+{
+    if(m_ready || !verifyCompositorSocket())
+        return;
+
+    smApp->trace()->instant("wayland socket", name());
+    if(m_runtimeWatcher)
+        m_runtimeWatcher->removePaths(m_runtimeWatcher->directories());
+
+    if(m_condition == ReadyOnWaylandSocket)
+        markReady(QString("socket %1 available").arg(smApp->expectedCompositorSocket()));
+}
+
+void ManagedProcess::readyTimeout()
+{
+    if(m_ready)
+        return;
+
+    if(m_process == Compositor)
     {
-        logInfo(QString("process started (pid %1) - waiting for wayland socket...")
-                   .arg(processId()));
-        sleep(1);
-        uint i = 1;
-        uint attempts = 10;
-        auto socket = smApp->expectedCompositorSocket();
-        for(i = 1; i <= attempts; ++i)
+        // a compositor without a first frame is still usable if it listens
+        if(verifyCompositorSocket())
         {
-            if(verifyCompositorSocket())
-            {
-                qCInfo(lcCompositor) << QString("Compositor socket %1 available.")
-                           .arg(socket);
-                return true;
-            }
-            else
-            {
-                qCWarning(lcCompositor) << QString("Compositor socket %1 not available (check %2).")
-                           .arg(socket, i);
-            }
-            sleep(2);
+            qCWarning(lcCompositor) << "no frame reported after" << m_readyTimeout << "ms, but the socket is available";
+            markReady("socket available (no frame reported)");
+            return;
         }
-        qCCritical(lcCompositor) << QString("Compositor socket %1 not available after %2 attempts.  Giving up.")
-                   .arg(socket, i--);
+        qCCritical(lcCompositor) << QString("Compositor socket %1 not available after %2 ms.  Giving up.")
+                   .arg(smApp->expectedCompositorSocket(), QString::number(m_readyTimeout));
+        smApp->trace()->end("ready", name(), {{"result", "timeout"}});
+        emit readyTimedOut();
+        return;
     }
-    return false;
+
+    // don't hold the rest of the session hostage to a slow service
+    logInfo(QString("not ready after %1 ms; releasing dependant processes anyway").arg(m_readyTimeout));
+    markReady("timeout");
+}
+
+void ManagedProcess::armReadyCondition()
+{
+    if(m_condition == ReadyOnDBusName && !m_dbusWatcher)
+    {
+        m_dbusWatcher = new QDBusServiceWatcher(m_dbusName, QDBusConnection::sessionBus(),
+                                                QDBusServiceWatcher::WatchForRegistration, this);
+        connect(m_dbusWatcher, &QDBusServiceWatcher::serviceRegistered,
+                this, &ManagedProcess::dbusNameRegistered);
+    }
+
+    if(m_condition == ReadyOnWaylandSocket || m_condition == ReadyOnFirstFrame)
+    {
+        if(!m_runtimeWatcher)
+        {
+            m_runtimeWatcher = new QFileSystemWatcher(this);
+            connect(m_runtimeWatcher, &QFileSystemWatcher::directoryChanged,
+                    this, &ManagedProcess::runtimeDirChanged);
+        }
+        auto dir = QFileInfo(smApp->expectedCompositorSocket()).absolutePath();
+        if(!m_runtimeWatcher->directories().contains(dir))
+            m_runtimeWatcher->addPath(dir);
+    }
+
+    if(m_condition != ReadyOnStart)
+    {
+        smApp->trace()->begin("ready", name());
+        m_readyTimer->start(m_readyTimeout);
+    }
+}
+
+void ManagedProcess::markReady(const QString &reason)
+{
+    if(m_ready)
+        return;
+
+    m_ready = true;
+    m_readyTimer->stop();
+    smApp->trace()->end("ready", name(), {{"reason", reason}});
+    smApp->trace()->instant("ready", name());
+    logInfo(QString("ready (%1)").arg(reason));
+    emit ready();
+}
+
+bool ManagedProcess::dependenciesReady() const
+{
+    for(auto *p : m_depends)
+    {
+        if(!p->isReady())
+            return false;
+    }
+    return true;
 }
 
 bool ManagedProcess::verifyCompositorSocket() const
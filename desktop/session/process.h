@@ -7,6 +7,11 @@
 
 #include <QProcess>
 #include <QObject>
+#include <QList>
+
+class QTimer;
+class QDBusServiceWatcher;
+class QFileSystemWatcher;
 
 class ManagedProcess : public QProcess
 {
@@ -30,31 +35,64 @@ public:
         Stage,
         Shell
     };
+    // what has to happen before dependants of this process may launch
+    enum ReadyCondition
+    {
+        ReadyOnStart,
+        ReadyOnDBusName,
+        ReadyOnWaylandSocket,
+        ReadyOnFirstFrame
+    };
     ManagedProcess(Process desired, QObject *parent = nullptr);
     bool initialize();
     bool deconstruct();
     void setAutoRestart(bool restart);
+    void setReadyCondition(ReadyCondition condition, const QString &dbusName = QString());
+    void setReadyTimeout(int msec);
+    void addDependency(ManagedProcess *process);
+    void launchWhenReady();
+    bool isReady() const { return m_ready; }
+    QString name() const;
 Q_SIGNALS:
     void compositorDied();
     void dbusSessionBusAddressAvailable(const QString &env);
+    void ready();
+    void readyTimedOut();
 private slots:
+    void processStarted();
     void processStopped();
     void logStdOut();
     void logStdErr();
+    void dependencyReady();
+    void dbusNameRegistered(const QString &service);
+    void runtimeDirChanged();
+    void readyTimeout();
 private:
+    void armReadyCondition();
+    void markReady(const QString &reason);
     QString processExecutablePath();
     void setEnvironmentForProcess();
     void setArgumentsForProcess();
     void logInfo(const QString &msg);
     bool checkForExistingDBusSession() const;
     bool verifyCompositorSocket() const;
-    bool watchForCompositor();
+    bool dependenciesReady() const;
 private:
     bool m_init = false;
     bool m_ok = false;
     uint m_fail = 0;
     Process m_process;
     bool m_restart = true;
+
+    ReadyCondition m_condition = ReadyOnStart;
+    QString m_dbusName;
+    int m_readyTimeout = 10000;
+    bool m_ready = false;
+    bool m_waiting = false;
+    QList<ManagedProcess*> m_depends;
+    QTimer *m_readyTimer = nullptr;
+    QDBusServiceWatcher *m_dbusWatcher = nullptr;
+    QFileSystemWatcher *m_runtimeWatcher = nullptr;
 };
 
 #endif // MANAGEDPROCESS_H
@@ -20,12 +20,16 @@
 #include <QMimeType>
 #include <QMimeDatabase>
 #include <desktopentry.h>
+#include <desktopcache.h>
+#include <iconcache.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <QTimer>
+#include <QFileSystemWatcher>
 
 #include "dbus.h"
 #include "process.h"
+#include "startuptrace.h"
 
 #define LOGIND_SERVICE    "org.freedesktop.login1"
 #define LOGIND_PATH       "/org/freedesktop/login1"
@@ -54,6 +58,7 @@ void messageHandler(QtMsgType type, const QMessageLogContext& context, const QSt
 
 SMApplication::SMApplication(int &argc, char **argv)
     : QCoreApplication(argc, argv)
+    , m_trace(new SMStartupTrace(this))
     , m_mime(new LSMimeApplications())
     , m_dbusSessionProcess(new ManagedProcess(ManagedProcess::DBusSession, this))
     , m_compositorProcess(new ManagedProcess(ManagedProcess::Compositor, this))
@@ -103,7 +108,18 @@ SMApplication::SMApplication(int &argc, char **argv)
         qCInfo(lcSession) << "Session started via display manager.";
 
     verifyTrashFolder();
+    m_trace->begin("desktop cache", "session");
+    if(!LSDesktopCache::rebuildIfStale())
+        qCWarning(lcSession) << "Unable to write the desktop entry cache" << LSDesktopCache::cacheFile();
+    m_trace->end("desktop cache", "session");
+    watchApplicationDirectories();
+    m_trace->begin("icon cache", "session");
+    rebuildIconCaches();
+    m_trace->end("icon cache", "session");
+    watchIconDirectories();
+    m_trace->begin("mime cache", "session");
     m_mime->processGlobalMimeCache();
+    m_trace->end("mime cache", "session");
 }
 
 bool SMApplication::startSession()
@@ -136,12 +152,7 @@ bool SMApplication::startSession()
     reloadLocaleSettings();
 
     auto xdg_runtime_sock = QString("%1/hollywood.sock").arg(m_xdg_runtime_dir);
-    QLocalSocket* socket = new QLocalSocket();
-    socket->connectToServer(xdg_runtime_sock);
-    bool b_connected = socket->waitForConnected(500);
-    socket->abort();
-    delete socket;
-    if (b_connected) {
+    if(otherSessionRunning(xdg_runtime_sock)) {
        qCCritical(lcSession) <<  QCoreApplication::translate("Session", "Another Hollywood session is running. This instance is aborting");
        return false;
     }
@@ -155,8 +166,15 @@ bool SMApplication::startSession()
 
     m_dbusSessionProcess->initialize(); */
 
+    setupProcessDependencies();
     connect(m_compositorProcess, &ManagedProcess::compositorDied,
             this, &SMApplication::compositorDied);
+    connect(m_compositorProcess, &ManagedProcess::ready,
+            this, &SMApplication::compositorReady);
+    connect(m_compositorProcess, &ManagedProcess::readyTimedOut,
+            this, &SMApplication::compositorFailed);
+
+    m_trace->begin("login to desktop", "session");
     if(!m_compositorProcess->initialize())
     {
         qCCritical(lcSession) <<  QCoreApplication::translate("Session", "Could not launch the compositor instance. This session can not continue.");
@@ -355,23 +373,60 @@ bool SMApplication::isAsahiKernel() const
     return false;
 }
 
-void SMApplication::startDBusReliantServices()
+void SMApplication::setupProcessDependencies()
 {
-    m_elevatorProcess->initialize();
-    m_stageProcess->initialize();
-    QTimer::singleShot(300, [this](){
-        m_desktopProcess->initialize();
-        m_notificationProcess->initialize();
-        m_sessionStarted = true;
-        qCInfo(lcSession) << "Session Initilaized";
-    });
+    // the compositor reports its first presented frame on stdout; the old
+    // socket polling gave up after 20 seconds so keep that as our ceiling
+    m_compositorProcess->setReadyCondition(ManagedProcess::ReadyOnFirstFrame);
+    m_compositorProcess->setReadyTimeout(20000);
 
+    m_elevatorProcess->addDependency(m_compositorProcess);
+
+    m_stageProcess->setReadyCondition(ManagedProcess::ReadyOnDBusName,
+                                      QLatin1String("com.canonical.AppMenu.Registrar"));
+    m_stageProcess->addDependency(m_compositorProcess);
+
+    m_notificationProcess->setReadyCondition(ManagedProcess::ReadyOnDBusName,
+                                             QLatin1String("org.freedesktop.Notifications"));
+    m_notificationProcess->addDependency(m_compositorProcess);
+
+    // shellfm wants the menu server up before it publishes its menus
+    m_desktopProcess->setReadyCondition(ManagedProcess::ReadyOnDBusName,
+                                        QLatin1String("org.freedesktop.FileManager1"));
+    m_desktopProcess->addDependency(m_stageProcess);
+
+    connect(m_stageProcess, &ManagedProcess::ready, this, &SMApplication::sessionProcessReady);
+    connect(m_desktopProcess, &ManagedProcess::ready, this, &SMApplication::sessionProcessReady);
+    connect(m_notificationProcess, &ManagedProcess::ready, this, &SMApplication::sessionProcessReady);
+}
+
+void SMApplication::startDBusReliantServices()
+{
     m_dbus = new SessionDBus(this);
     QDBusConnection::sessionBus().registerService(QLatin1String(HOLLYWOOD_SESSION_DBUS));
     QDBusConnection::sessionBus().registerObject(QLatin1String(HOLLYWOOD_SESSION_DBUSOBJ), this);
 
-    if(m_mini)
-        QTimer::singleShot(2500, Qt::CoarseTimer, this, &SMApplication::startMiniUtils);
+    // each of these starts as soon as everything it depends on is ready
+    m_elevatorProcess->launchWhenReady();
+    m_stageProcess->launchWhenReady();
+    m_notificationProcess->launchWhenReady();
+    m_desktopProcess->launchWhenReady();
+}
+
+bool SMApplication::otherSessionRunning(const QString &socket) const
+{
+    if(!QFileInfo::exists(socket))
+        return false;
+
+    // connecting to a local socket completes (or is refused) immediately,
+    // so we only need to wait if the listener's backlog is full
+    QLocalSocket probe;
+    probe.connectToServer(socket);
+    bool connected = probe.state() == QLocalSocket::ConnectedState;
+    if(probe.state() == QLocalSocket::ConnectingState)
+        connected = probe.waitForConnected(500);
+    probe.abort();
+    return connected;
 }
 
 bool SMApplication::verifyXdgRuntime()
@@ -484,6 +539,99 @@ void SMApplication::verifyTrashFolder()
     dir.mkpath(xdg_data+"Trash"+"/info");
 }
 
+void SMApplication::watchApplicationDirectories()
+{
+    m_appsWatch = new QFileSystemWatcher(this);
+    m_appsRebuild = new QTimer(this);
+    // package installs touch many files at once, settle before rebuilding
+    m_appsRebuild->setSingleShot(true);
+    m_appsRebuild->setInterval(1000);
+    connect(m_appsRebuild, &QTimer::timeout, this, &SMApplication::rebuildDesktopCache);
+
+    m_appsWatch->addPaths(LSDesktopCache::watchDirectories());
+    for(auto &dir : LSDesktopCache::sourceDirectories())
+    {
+        auto mimeinfo = QString("%1/%2").arg(dir, MIMEINFO_CACHE);
+        if(QFile::exists(mimeinfo))
+            m_appsWatch->addPath(mimeinfo);
+    }
+
+    connect(m_appsWatch, &QFileSystemWatcher::directoryChanged, m_appsRebuild, qOverload<>(&QTimer::start));
+    connect(m_appsWatch, &QFileSystemWatcher::fileChanged, m_appsRebuild, qOverload<>(&QTimer::start));
+}
+
+void SMApplication::rebuildDesktopCache()
+{
+    // pick up new subdirectories, removed ones drop out of the watch
+    // by themselves
+    auto watched = m_appsWatch->directories();
+    for(auto &dir : LSDesktopCache::watchDirectories())
+    {
+        if(!watched.contains(dir))
+            m_appsWatch->addPath(dir);
+    }
+
+    // mimeinfo.cache is replaced rather than rewritten, watch it again
+    for(auto &dir : LSDesktopCache::sourceDirectories())
+    {
+        auto mimeinfo = QString("%1/%2").arg(dir, MIMEINFO_CACHE);
+        if(QFile::exists(mimeinfo) && !m_appsWatch->files().contains(mimeinfo))
+            m_appsWatch->addPath(mimeinfo);
+    }
+
+    qCInfo(lcSession) << "Applications changed, rebuilding desktop entry cache";
+    if(!LSDesktopCache::rebuild())
+        qCWarning(lcSession) << "Unable to write the desktop entry cache" << LSDesktopCache::cacheFile();
+}
+
+QStringList SMApplication::iconThemes() const
+{
+    return QStringList() << HOLLYWOOD_DEF_ICONTHEME << HOLLYWOOD_DARK_ICONTHEME;
+}
+
+void SMApplication::watchIconDirectories()
+{
+    m_iconsWatch = new QFileSystemWatcher(this);
+    m_iconsRebuild = new QTimer(this);
+    m_iconsRebuild->setSingleShot(true);
+    m_iconsRebuild->setInterval(1000);
+    connect(m_iconsRebuild, &QTimer::timeout, this, &SMApplication::rebuildIconCaches);
+
+    // new themes land in the search paths, new icons in the size and
+    // context directories of a theme
+    auto dirs = LSIconCache::searchPaths();
+    for(auto &theme : iconThemes())
+        dirs.append(LSIconCache::watchDirectories(theme));
+    dirs.append(LSIconCache::fallbackPaths());
+    dirs.removeDuplicates();
+    m_iconsWatch->addPaths(dirs);
+
+    connect(m_iconsWatch, &QFileSystemWatcher::directoryChanged, m_iconsRebuild, qOverload<>(&QTimer::start));
+}
+
+void SMApplication::rebuildIconCaches()
+{
+    // a new theme or index.theme can add directories to watch
+    auto watched = m_iconsWatch->directories();
+    for(auto &theme : iconThemes())
+    {
+        for(auto &dir : LSIconCache::watchDirectories(theme))
+        {
+            if(!watched.contains(dir))
+            {
+                m_iconsWatch->addPath(dir);
+                watched.append(dir);
+            }
+        }
+    }
+
+    for(auto &theme : iconThemes())
+    {
+        if(!LSIconCache::rebuildIfStale(theme))
+            qCWarning(lcSession) << "Unable to write the icon cache" << LSIconCache::cacheFile(theme);
+    }
+}
+
 void SMApplication::loadSettings()
 {
     QSettings settings("originull", "hollywood");
@@ -533,7 +681,43 @@ void SMApplication::compositorDied()
     m_desktopProcess->setAutoRestart(false);
     m_userprocs.clear();
     if(m_compositorProcess->initialize())
-        restartCompositorReliantProcesses();
+        m_restartReliant = true;
+}
+
+void SMApplication::compositorReady()
+{
+    if(!m_restartReliant)
+        return;
+
+    m_restartReliant = false;
+    restartCompositorReliantProcesses();
+}
+
+void SMApplication::compositorFailed()
+{
+    qCCritical(lcSession) <<  QCoreApplication::translate("Session", "Could not launch the compositor instance. This session can not continue.");
+    m_trace->save();
+    exit(1);
+}
+
+void SMApplication::sessionProcessReady()
+{
+    if(m_sessionStarted)
+        return;
+
+    if(!m_stageProcess->isReady() ||
+       !m_desktopProcess->isReady() ||
+       !m_notificationProcess->isReady())
+        return;
+
+    m_sessionStarted = true;
+    m_trace->end("login to desktop", "session");
+    qCInfo(lcSession) << "Session Initilaized in" << m_trace->elapsed() << "ms";
+    if(m_trace->save())
+        qCInfo(lcSession) << "Startup trace written to" << m_trace->fileName();
+
+    if(m_mini)
+        startMiniUtils();
 }
 
 void SMApplication::userProcessTerminated(int result)
@@ -613,6 +797,9 @@ int main(int argc, char *argv[])
      g_logfile = QString("%1/hollywood/session-%2.log").arg(xdg,
            QDateTime::currentDateTime().toString("yyyy-MM-dd-hhmm"));
 
+    a.trace()->setFileName(QString("%1/hollywood/session-startup-%2.json").arg(xdg,
+           QDateTime::currentDateTime().toString("yyyy-MM-dd-hhmm")));
+
     qInstallMessageHandler(messageHandler);
 
     if(!a.startSession())
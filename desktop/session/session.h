@@ -21,6 +21,9 @@ class LSMimeApplications;
 class QLocalServer;
 class SessionDBus;
 class ManagedProcess;
+class SMStartupTrace;
+class QFileSystemWatcher;
+class QTimer;
 class LSExecutor;
 class SMApplication : public QCoreApplication
 {
@@ -65,26 +68,42 @@ public:
     bool isAsahiKernel() const;
     bool surviveWaylandCrash() const { return m_wayland_reconnect; }
     bool useDmabuf() const { return m_use_dmabuf; }
+    SMStartupTrace* trace() const { return m_trace; }
 private:
+    void setupProcessDependencies();
     void startDBusReliantServices();
+    bool otherSessionRunning(const QString &socket) const;
     bool verifyXdgRuntime();
     bool stopSession();
     bool callLogindDbus(const QString &command);
     void disconnectProcessWatchers();
     void restartCompositorReliantProcesses();
     void verifyTrashFolder();
+    void watchApplicationDirectories();
+    void watchIconDirectories();
+    QStringList iconThemes() const;
     void loadSettings();
 private slots:
     void startMiniUtils();
+    void compositorReady();
+    void compositorFailed();
+    void sessionProcessReady();
     void compositorDied();
     void userProcessTerminated(int result);
     bool terminateUserProcesses();
     void dbusAvailable(const QString &socket);
     void reloadLocaleSettings();
+    void rebuildDesktopCache();
+    void rebuildIconCaches();
 private:
     QString m_compSocket;
+    SMStartupTrace *m_trace = nullptr;
 
     LSMimeApplications *m_mime = nullptr;
+    QFileSystemWatcher *m_appsWatch = nullptr;
+    QTimer *m_appsRebuild = nullptr;
+    QFileSystemWatcher *m_iconsWatch = nullptr;
+    QTimer *m_iconsRebuild = nullptr;
     ManagedProcess *m_dbusSessionProcess = nullptr;
     ManagedProcess *m_compositorProcess = nullptr;
     ManagedProcess *m_pipewireProcess = nullptr;
@@ -99,6 +118,7 @@ private:
     SessionDBus *m_dbus = nullptr;
     QString m_xdg_runtime_dir;
     bool m_sessionStarted = false;
+    bool m_restartReliant = false;
 
     QByteArray m_dbusSessionVar = "";
     bool m_useDBus = true;
@@ -11,12 +11,14 @@ INCLUDEPATH += ../libshell/include
 INCLUDEPATH += ../include
 SOURCES += \
         process.cc \
-        session.cc
+        session.cc \
+        startuptrace.cc
 
 HEADERS += \
     dbus.h \
     process.h \
-    session.h
+    session.h \
+    startuptrace.h
 
 QMAKE_SUBSTITUTES += hollywood.desktop.in
 desktop.path = $$PREFIX/share/wayland-sessions
@@ -0,0 +1,108 @@
+// Hollywood Session Manager
+// (C) 2021, 2022 Cat Stevenson <cat@originull.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "startuptrace.h"
+
+#include <QCoreApplication>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QLoggingCategory>
+
+extern QLoggingCategory lcSession;
+
+SMStartupTrace::SMStartupTrace(QObject *parent)
+    : QObject(parent)
+    , m_pid(QCoreApplication::applicationPid())
+{
+    m_timer.start();
+}
+
+void SMStartupTrace::setFileName(const QString &file)
+{
+    m_file = file;
+}
+
+void SMStartupTrace::begin(const QString &name, const QString &track)
+{
+    m_open.insert(eventKey(name, track), m_timer.nsecsElapsed() / 1000);
+}
+
+void SMStartupTrace::end(const QString &name, const QString &track, const QVariantMap &args)
+{
+    auto key = eventKey(name, track);
+    if(!m_open.contains(key))
+        return;
+
+    auto start = m_open.take(key);
+    QJsonObject ev;
+    ev.insert("name", name);
+    ev.insert("cat", "session");
+    ev.insert("ph", "X");
+    ev.insert("ts", start);
+    ev.insert("dur", (m_timer.nsecsElapsed() / 1000) - start);
+    ev.insert("pid", m_pid);
+    ev.insert("tid", trackId(track));
+    if(!args.isEmpty())
+        ev.insert("args", QJsonObject::fromVariantMap(args));
+    m_events.append(ev);
+}
+
+void SMStartupTrace::instant(const QString &name, const QString &track, const QVariantMap &args)
+{
+    QJsonObject ev;
+    ev.insert("name", name);
+    ev.insert("cat", "session");
+    ev.insert("ph", "i");
+    ev.insert("s", "t");
+    ev.insert("ts", m_timer.nsecsElapsed() / 1000);
+    ev.insert("pid", m_pid);
+    ev.insert("tid", trackId(track));
+    if(!args.isEmpty())
+        ev.insert("args", QJsonObject::fromVariantMap(args));
+    m_events.append(ev);
+}
+
+bool SMStartupTrace::save()
+{
+    if(m_file.isEmpty())
+        return false;
+
+    QJsonObject root;
+    root.insert("traceEvents", m_events);
+    root.insert("displayTimeUnit", "ms");
+
+    QSaveFile file(m_file);
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        qCWarning(lcSession) << "Unable to write startup trace" << m_file;
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
+
+int SMStartupTrace::trackId(const QString &track)
+{
+    if(m_tracks.contains(track))
+        return m_tracks.value(track);
+
+    // give each track a name so the viewer labels the rows
+    int tid = m_tracks.count() + 1;
+    m_tracks.insert(track, tid);
+
+    QJsonObject meta;
+    meta.insert("name", "thread_name");
+    meta.insert("ph", "M");
+    meta.insert("pid", m_pid);
+    meta.insert("tid", tid);
+    meta.insert("args", QJsonObject{{"name", track}});
+    m_events.append(meta);
+    return tid;
+}
+
+QString SMStartupTrace::eventKey(const QString &name, const QString &track) const
+{
+    return QString("%1/%2").arg(track, name);
+}
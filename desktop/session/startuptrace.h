@@ -0,0 +1,42 @@
+// Hollywood Session Manager
+// (C) 2021, 2022 Cat Stevenson <cat@originull.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SMSTARTUPTRACE_H
+#define SMSTARTUPTRACE_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QHash>
+#include <QVariantMap>
+
+// Records the phases of session startup as Chrome trace events
+// (chrome://tracing, Perfetto) so login-to-desktop time can be measured.
+// Timestamps are relative to the construction of the session manager.
+class SMStartupTrace : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SMStartupTrace(QObject *parent = nullptr);
+    void setFileName(const QString &file);
+    QString fileName() const { return m_file; }
+
+    void begin(const QString &name, const QString &track);
+    void end(const QString &name, const QString &track, const QVariantMap &args = QVariantMap());
+    void instant(const QString &name, const QString &track, const QVariantMap &args = QVariantMap());
+    qint64 elapsed() const { return m_timer.elapsed(); }
+    bool save();
+private:
+    int trackId(const QString &track);
+    QString eventKey(const QString &name, const QString &track) const;
+private:
+    QElapsedTimer m_timer;
+    QString m_file;
+    QJsonArray m_events;
+    QHash<QString,int> m_tracks;
+    QHash<QString,qint64> m_open;
+    qint64 m_pid = 0;
+};
+
+#endif // SMSTARTUPTRACE_H
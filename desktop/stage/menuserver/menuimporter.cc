@@ -0,0 +1,491 @@
+// Hollywood Stage
+// (C) 2022-2024 Originull Software
+// SPDX-License-Identifier: LGPL-2.1-or-later
+
+#include "menuimporter.h"
+
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusMetaType>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QDBusVariant>
+#include <QDateTime>
+#include <QKeySequence>
+#include <QPixmap>
+#include <QIcon>
+#include <QDebug>
+
+#include <utility>
+
+#define DBUSMENU_INTERFACE      "com.canonical.dbusmenu"
+#define DBUSMENU_PROPERTY_ID    "_dbusmenu_id"
+#define DBUSMENU_ICON_NAME      "_dbusmenu_icon_name"
+#define DBUSMENU_ICON_DATA      "_dbusmenu_icon_data"
+
+QDBusArgument &operator<<(QDBusArgument &argument, const MenuLayoutItem &item)
+{
+    argument.beginStructure();
+    argument << item.id << item.properties;
+    argument.beginArray(qMetaTypeId<QDBusVariant>());
+    for(const auto &child : item.children)
+        argument << QDBusVariant(QVariant::fromValue(child));
+    argument.endArray();
+    argument.endStructure();
+    return argument;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &argument, MenuLayoutItem &item)
+{
+    argument.beginStructure();
+    argument >> item.id >> item.properties;
+    argument.beginArray();
+    while(!argument.atEnd())
+    {
+        QDBusVariant variant;
+        argument >> variant;
+        MenuLayoutItem child;
+        qvariant_cast<QDBusArgument>(variant.variant()) >> child;
+        item.children.append(child);
+    }
+    argument.endArray();
+    argument.endStructure();
+    return argument;
+}
+
+QDBusArgument &operator<<(QDBusArgument &argument, const MenuItemProperties &item)
+{
+    argument.beginStructure();
+    argument << item.id << item.properties;
+    argument.endStructure();
+    return argument;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &argument, MenuItemProperties &item)
+{
+    argument.beginStructure();
+    argument >> item.id >> item.properties;
+    argument.endStructure();
+    return argument;
+}
+
+QDBusArgument &operator<<(QDBusArgument &argument, const MenuItemKeys &keys)
+{
+    argument.beginStructure();
+    argument << keys.id << keys.properties;
+    argument.endStructure();
+    return argument;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &argument, MenuItemKeys &keys)
+{
+    argument.beginStructure();
+    argument >> keys.id >> keys.properties;
+    argument.endStructure();
+    return argument;
+}
+
+static void registerMenuTypes()
+{
+    static bool registered = false;
+    if(registered)
+        return;
+
+    registered = true;
+    qDBusRegisterMetaType<MenuLayoutItem>();
+    qDBusRegisterMetaType<MenuItemProperties>();
+    qDBusRegisterMetaType<MenuItemPropertiesList>();
+    qDBusRegisterMetaType<MenuItemKeys>();
+    qDBusRegisterMetaType<MenuItemKeysList>();
+}
+
+// dbusmenu marks mnemonics with _ and escapes it as __
+static QString convertMnemonic(const QString &label)
+{
+    QString text;
+    text.reserve(label.size());
+    for(int i = 0; i < label.size(); ++i)
+    {
+        const QChar c = label.at(i);
+        if(c == QLatin1Char('&'))
+            text.append(QLatin1String("&&"));
+        else if(c == QLatin1Char('_'))
+        {
+            if(i + 1 < label.size() && label.at(i + 1) == QLatin1Char('_'))
+            {
+                text.append(c);
+                ++i;
+            }
+            else
+                text.append(QLatin1Char('&'));
+        }
+        else
+            text.append(c);
+    }
+    return text;
+}
+
+static QKeySequence convertShortcut(const QVariant &value)
+{
+    if(!value.canConvert<QDBusArgument>())
+        return QKeySequence();
+
+    QList<QStringList> sequence;
+    value.value<QDBusArgument>() >> sequence;
+
+    QStringList parts;
+    for(QStringList keys : std::as_const(sequence))
+    {
+        for(QString &key : keys)
+        {
+            if(key == QLatin1String("Control"))
+                key = QLatin1String("Ctrl");
+            else if(key == QLatin1String("Super"))
+                key = QLatin1String("Meta");
+        }
+        parts.append(keys.join(QLatin1Char('+')));
+    }
+    return QKeySequence::fromString(parts.join(QLatin1String(", ")), QKeySequence::PortableText);
+}
+
+static bool isSubmenu(const MenuLayoutItem &item)
+{
+    return item.properties.value(QLatin1String("children-display")).toString() == QLatin1String("submenu") ||
+           !item.children.isEmpty();
+}
+
+MenuImporter::MenuImporter(const QString &service, const QString &path, QObject *parent)
+    : QObject(parent)
+    , m_service(service)
+    , m_path(path)
+    , m_menu(new QMenu)
+{
+    registerMenuTypes();
+
+    auto bus = QDBusConnection::sessionBus();
+    bus.connect(m_service, m_path, DBUSMENU_INTERFACE, QLatin1String("LayoutUpdated"),
+                this, SLOT(layoutUpdated(uint,int)));
+    bus.connect(m_service, m_path, DBUSMENU_INTERFACE, QLatin1String("ItemsPropertiesUpdated"),
+                this, SLOT(itemsPropertiesUpdated(MenuItemPropertiesList,MenuItemKeysList)));
+
+    m_menus.insert(0, m_menu);
+}
+
+MenuImporter::~MenuImporter()
+{
+    delete m_menu;
+}
+
+void MenuImporter::prefetch()
+{
+    layoutUpdated(0, 0);
+}
+
+void MenuImporter::layoutUpdated(uint revision, int parent)
+{
+    // Qt counts revisions per submenu, they don't order anything
+    Q_UNUSED(revision);
+
+    // a parent we never saw sits in a part of the tree that changed,
+    // fetch everything again
+    if(!m_menus.value(parent))
+        parent = 0;
+
+    m_pending.insert(parent);
+    if(!m_fetchQueued)
+    {
+        m_fetchQueued = true;
+        QMetaObject::invokeMethod(this, &MenuImporter::fetchPending, Qt::QueuedConnection);
+    }
+}
+
+void MenuImporter::fetchPending()
+{
+    m_fetchQueued = false;
+
+    auto pending = std::exchange(m_pending, {});
+    if(pending.contains(0))
+        pending = { 0 };
+
+    for(int id : std::as_const(pending))
+    {
+        // skip subtrees that are refetched with one of their parents
+        bool covered = false;
+        QMenu *menu = m_menus.value(id);
+        for(auto m = menu ? qobject_cast<QMenu*>(menu->parent()) : nullptr;
+            m && !covered; m = qobject_cast<QMenu*>(m->parent()))
+            covered = pending.contains(idForMenu(m));
+        if(covered)
+            continue;
+
+        if(m_fetching.contains(id))
+            m_refetch.insert(id);
+        else
+            fetchLayout(id);
+    }
+}
+
+void MenuImporter::fetchLayout(int parent)
+{
+    m_fetching.insert(parent);
+
+    auto msg = QDBusMessage::createMethodCall(m_service, m_path, DBUSMENU_INTERFACE,
+                                              QLatin1String("GetLayout"));
+    msg << parent << -1 << QStringList();
+
+    auto watcher = new QDBusPendingCallWatcher(QDBusConnection::sessionBus().asyncCall(msg), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, parent](QDBusPendingCallWatcher *call)
+    {
+        call->deleteLater();
+        m_fetching.remove(parent);
+
+        QDBusPendingReply<uint, MenuLayoutItem> reply = *call;
+        if(reply.isError())
+            qWarning() << "MenuImporter: GetLayout failed for" << m_service << m_path << reply.error().message();
+        else
+            layoutReceived(parent, reply.argumentAt<1>());
+
+        // changed again while we were waiting
+        if(m_refetch.remove(parent))
+            layoutUpdated(0, parent);
+    });
+}
+
+void MenuImporter::layoutReceived(int parent, const MenuLayoutItem &layout)
+{
+    QMenu *menu = m_menus.value(parent);
+    if(!menu)
+        return;
+
+    if(menu != m_menu)
+        applyProperties(menu->menuAction(), layout.properties, true);
+
+    bool changed = syncMenu(menu, layout);
+    if(menu == m_menu && (changed || !m_ready))
+    {
+        m_ready = true;
+        emit menuUpdated();
+    }
+}
+
+bool MenuImporter::syncMenu(QMenu *menu, const MenuLayoutItem &layout)
+{
+    // keep the actions we already have, an open menu or the menu bar
+    // holding them doesn't notice anything but the changed properties
+    QHash<int, QAction*> existing;
+    for(auto action : menu->actions())
+        existing.insert(action->property(DBUSMENU_PROPERTY_ID).toInt(), action);
+
+    bool changed = false;
+    QList<QAction*> actions;
+    actions.reserve(layout.children.size());
+    for(const auto &item : layout.children)
+    {
+        QAction *action = existing.take(item.id);
+        if(action && (QMenu::menuInAction(action) != nullptr) != isSubmenu(item))
+        {
+            menu->removeAction(action);
+            removeAction(action);
+            action = nullptr;
+        }
+
+        if(action)
+            applyProperties(action, item.properties, true);
+        else
+        {
+            action = createAction(item, menu);
+            changed = true;
+        }
+
+        if(auto submenu = QMenu::menuInAction(action))
+            syncMenu(submenu, item);
+        actions.append(action);
+    }
+
+    for(auto action : std::as_const(existing))
+    {
+        menu->removeAction(action);
+        removeAction(action);
+        changed = true;
+    }
+
+    if(menu->actions() != actions)
+    {
+        for(auto action : menu->actions())
+            menu->removeAction(action);
+        menu->addActions(actions);
+        changed = true;
+    }
+    return changed;
+}
+
+QAction* MenuImporter::createAction(const MenuLayoutItem &item, QMenu *parent)
+{
+    QAction *action = nullptr;
+    if(isSubmenu(item))
+    {
+        auto submenu = new QMenu(parent);
+        connect(submenu, &QMenu::aboutToShow, this, &MenuImporter::menuAboutToShow);
+        connect(submenu, &QMenu::aboutToHide, this, &MenuImporter::menuAboutToHide);
+        m_menus.insert(item.id, submenu);
+        action = submenu->menuAction();
+    }
+    else
+    {
+        action = new QAction(parent);
+        connect(action, &QAction::triggered, this, [this, id = item.id]() {
+            sendEvent(id, QLatin1String("clicked"));
+        });
+    }
+
+    action->setProperty(DBUSMENU_PROPERTY_ID, item.id);
+    applyProperties(action, item.properties, true);
+    m_actions.insert(item.id, action);
+    return action;
+}
+
+void MenuImporter::removeAction(QAction *action)
+{
+    m_actions.remove(action->property(DBUSMENU_PROPERTY_ID).toInt());
+    if(auto submenu = QMenu::menuInAction(action))
+    {
+        forgetMenu(submenu);
+        submenu->deleteLater();
+    }
+    else
+        action->deleteLater();
+}
+
+void MenuImporter::forgetMenu(QMenu *menu)
+{
+    m_menus.remove(idForMenu(menu));
+    for(auto action : menu->actions())
+    {
+        m_actions.remove(action->property(DBUSMENU_PROPERTY_ID).toInt());
+        if(auto submenu = QMenu::menuInAction(action))
+            forgetMenu(submenu);
+    }
+}
+
+void MenuImporter::itemsPropertiesUpdated(const MenuItemPropertiesList &updated, const MenuItemKeysList &removed)
+{
+    for(const auto &item : updated)
+    {
+        if(auto action = m_actions.value(item.id))
+            applyProperties(action, item.properties, false);
+    }
+
+    for(const auto &keys : removed)
+    {
+        auto action = m_actions.value(keys.id);
+        if(!action)
+            continue;
+        for(const auto &key : keys.properties)
+            applyProperty(action, key, QVariant());
+    }
+}
+
+void MenuImporter::applyProperties(QAction *action, const QVariantMap &properties, bool all)
+{
+    // toggle-type has to be set before toggle-state
+    static const char *keys[] = {
+        "type",
+        "label",
+        "enabled",
+        "visible",
+        "icon-name",
+        "icon-data",
+        "toggle-type",
+        "toggle-state",
+        "shortcut",
+    };
+
+    for(auto key : keys)
+    {
+        const QString name = QLatin1String(key);
+        if(all || properties.contains(name))
+            applyProperty(action, name, properties.value(name));
+    }
+}
+
+// an invalid value resets the property to the dbusmenu default
+void MenuImporter::applyProperty(QAction *action, const QString &key, const QVariant &value)
+{
+    if(key == QLatin1String("type"))
+        action->setSeparator(value.toString() == QLatin1String("separator"));
+    else if(key == QLatin1String("label"))
+        action->setText(convertMnemonic(value.toString()));
+    else if(key == QLatin1String("enabled"))
+        action->setEnabled(!value.isValid() || value.toBool());
+    else if(key == QLatin1String("visible"))
+        action->setVisible(!value.isValid() || value.toBool());
+    else if(key == QLatin1String("toggle-type"))
+        action->setCheckable(!value.toString().isEmpty());
+    else if(key == QLatin1String("toggle-state"))
+        action->setChecked(value.toInt() == 1);
+    else if(key == QLatin1String("shortcut"))
+        action->setShortcut(convertShortcut(value));
+    else if(key == QLatin1String("icon-name") || key == QLatin1String("icon-data"))
+    {
+        action->setProperty(key == QLatin1String("icon-name") ? DBUSMENU_ICON_NAME : DBUSMENU_ICON_DATA, value);
+
+        QIcon icon;
+        const auto data = action->property(DBUSMENU_ICON_DATA).toByteArray();
+        if(!data.isEmpty())
+        {
+            QPixmap pixmap;
+            if(pixmap.loadFromData(data, "PNG"))
+                icon = QIcon(pixmap);
+        }
+        const auto name = action->property(DBUSMENU_ICON_NAME).toString();
+        if(!name.isEmpty())
+            icon = QIcon::fromTheme(name, icon);
+        action->setIcon(icon);
+    }
+}
+
+int MenuImporter::idForMenu(QMenu *menu) const
+{
+    if(menu == m_menu)
+        return 0;
+    return menu->menuAction()->property(DBUSMENU_PROPERTY_ID).toInt();
+}
+
+void MenuImporter::menuAboutToShow()
+{
+    auto menu = qobject_cast<QMenu*>(sender());
+    if(!menu)
+        return;
+
+    // the menu is already filled, only refetch it when the application
+    // says it changed something on the way
+    const int id = idForMenu(menu);
+    auto msg = QDBusMessage::createMethodCall(m_service, m_path, DBUSMENU_INTERFACE,
+                                              QLatin1String("AboutToShow"));
+    msg << id;
+    auto watcher = new QDBusPendingCallWatcher(QDBusConnection::sessionBus().asyncCall(msg), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, id](QDBusPendingCallWatcher *call)
+    {
+        call->deleteLater();
+        QDBusPendingReply<bool> reply = *call;
+        if(!reply.isError() && reply.value())
+            layoutUpdated(0, id);
+    });
+
+    sendEvent(id, QLatin1String("opened"));
+}
+
+void MenuImporter::menuAboutToHide()
+{
+    if(auto menu = qobject_cast<QMenu*>(sender()))
+        sendEvent(idForMenu(menu), QLatin1String("closed"));
+}
+
+void MenuImporter::sendEvent(int id, const QString &event)
+{
+    auto msg = QDBusMessage::createMethodCall(m_service, m_path, DBUSMENU_INTERFACE,
+                                              QLatin1String("Event"));
+    msg << id << event << QVariant::fromValue(QDBusVariant(QString()))
+        << uint(QDateTime::currentSecsSinceEpoch());
+    QDBusConnection::sessionBus().send(msg);
+}
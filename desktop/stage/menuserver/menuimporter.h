@@ -0,0 +1,107 @@
+// Hollywood Stage
+// (C) 2022-2024 Originull Software
+// SPDX-License-Identifier: LGPL-2.1-or-later
+
+#ifndef MENUIMPORTER_H
+#define MENUIMPORTER_H
+
+#include <QObject>
+#include <QMenu>
+#include <QHash>
+#include <QSet>
+#include <QPointer>
+#include <QDBusArgument>
+
+// com.canonical.dbusmenu wire types
+struct MenuLayoutItem
+{
+    int id = 0;
+    QVariantMap properties;
+    QList<MenuLayoutItem> children;
+};
+
+struct MenuItemProperties
+{
+    int id = 0;
+    QVariantMap properties;
+};
+typedef QList<MenuItemProperties> MenuItemPropertiesList;
+
+struct MenuItemKeys
+{
+    int id = 0;
+    QStringList properties;
+};
+typedef QList<MenuItemKeys> MenuItemKeysList;
+
+QDBusArgument &operator<<(QDBusArgument &argument, const MenuLayoutItem &item);
+const QDBusArgument &operator>>(const QDBusArgument &argument, MenuLayoutItem &item);
+QDBusArgument &operator<<(QDBusArgument &argument, const MenuItemProperties &item);
+const QDBusArgument &operator>>(const QDBusArgument &argument, MenuItemProperties &item);
+QDBusArgument &operator<<(QDBusArgument &argument, const MenuItemKeys &keys);
+const QDBusArgument &operator>>(const QDBusArgument &argument, MenuItemKeys &keys);
+
+Q_DECLARE_METATYPE(MenuLayoutItem)
+Q_DECLARE_METATYPE(MenuItemProperties)
+Q_DECLARE_METATYPE(MenuItemKeys)
+Q_DECLARE_METATYPE(MenuItemPropertiesList)
+Q_DECLARE_METATYPE(MenuItemKeysList)
+
+// Mirrors an application's exported dbusmenu into a QMenu.  Unlike
+// DBusMenuImporter the whole tree is fetched up front with one GetLayout
+// call, property changes are applied to the existing actions and layout
+// changes only refetch the subtree that changed.  Opening a menu never
+// waits on the application: AboutToShow and the events are sent async.
+class MenuImporter : public QObject
+{
+    Q_OBJECT
+public:
+    MenuImporter(const QString &service, const QString &path, QObject *parent = nullptr);
+    ~MenuImporter() override;
+
+    QString service() const { return m_service; }
+    QString path() const { return m_path; }
+    // the top level menu, its submenus are the menu bar entries
+    QMenu* menu() const { return m_menu; }
+    // true once the first layout arrived
+    bool isReady() const { return m_ready; }
+public slots:
+    // fetch the complete layout again in the background
+    void prefetch();
+signals:
+    // the top level entries changed and the menu bar should be rebuilt
+    void menuUpdated();
+private slots:
+    void layoutUpdated(uint revision, int parent);
+    void itemsPropertiesUpdated(const MenuItemPropertiesList &updated, const MenuItemKeysList &removed);
+    void fetchPending();
+private:
+    void fetchLayout(int parent);
+    void layoutReceived(int parent, const MenuLayoutItem &layout);
+    bool syncMenu(QMenu *menu, const MenuLayoutItem &layout);
+    QAction* createAction(const MenuLayoutItem &item, QMenu *parent);
+    void removeAction(QAction *action);
+    void forgetMenu(QMenu *menu);
+    void applyProperties(QAction *action, const QVariantMap &properties, bool all);
+    void applyProperty(QAction *action, const QString &key, const QVariant &value);
+    int idForMenu(QMenu *menu) const;
+    void menuAboutToShow();
+    void menuAboutToHide();
+    void sendEvent(int id, const QString &event);
+
+    QString m_service;
+    QString m_path;
+    QMenu *m_menu = nullptr;
+    bool m_ready = false;
+
+    QHash<int, QPointer<QAction>> m_actions;
+    QHash<int, QPointer<QMenu>> m_menus;
+
+    // LayoutUpdated bursts are fetched once, with one call per subtree
+    QSet<int> m_pending;
+    QSet<int> m_fetching;
+    QSet<int> m_refetch;
+    bool m_fetchQueued = false;
+};
+
+#endif // MENUIMPORTER_H
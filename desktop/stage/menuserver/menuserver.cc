@@ -99,14 +99,10 @@ void MenuServer::cleanMenu()
 {
     for(auto a : m_menuBar->actions())
     {
+        // the menus stay connected to their importer, which keeps them
+        // current while the window is in the background
         if(a->data() != 9195521)
-        {
-            auto m = QMenu::menuInAction(a);
-            auto c= m_connections.value(m);
-            disconnect(m, &QMenu::triggered, nullptr, nullptr);
-            disconnect(m, &QMenu::aboutToShow, nullptr, nullptr);
             m_menuBar->removeAction(a);
-        }
     }
 }
 
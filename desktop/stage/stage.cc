@@ -20,7 +20,7 @@
 #include <desktopentry.h>
 #include <QDBusInterface>
 #include <QIcon>
-#include <dbusmenuimporter.h>
+#include <algorithm>
 #include <sys/types.h>
 #include <pwd.h>
 #include <unistd.h>
@@ -31,6 +31,9 @@
 #define TERMINULL_APP       "org.originull.terminull.desktop"
 #define ABOUT_APP           "org.originull.about.desktop"
 
+// menus kept around for windows that aren't active
+#define STAGE_MENU_CACHE    8
+
 StageApplication::StageApplication(int &argc, char **argv, bool mini = false)
     : QApplication(argc, argv)
     , m_cfgwatch(new QFileSystemWatcher(this))
@@ -52,6 +55,7 @@ StageApplication::StageApplication(int &argc, char **argv, bool mini = false)
     if(!m_mini)
     {
         m_wndmgr = new PlasmaWindowManagement();
+        m_thumbnails = new WindowThumbnailManager();
         m_notifier = new NotifierHost();
         m_host = new StageHost(primaryScreen());
         m_clock = new StageClock();
@@ -66,6 +70,11 @@ StageApplication::StageApplication(int &argc, char **argv, bool mini = false)
     connect(m_protocol, &HWPrivateWaylandProtocol::activeChanged,
             this, &StageApplication::privateProtocolReady);
 
+    m_menuViewWatcher->setConnection(QDBusConnection::sessionBus());
+    m_menuViewWatcher->setWatchMode(QDBusServiceWatcher::WatchForUnregistration);
+    connect(m_menuViewWatcher, &QDBusServiceWatcher::serviceUnregistered,
+            this, &StageApplication::menuServiceUnregistered);
+
     createSystemContextMenu();
 
     if(!m_mini)
@@ -512,39 +521,86 @@ void StageApplication::menuChanged(const QString &serviceName, const QString &ob
     if(!m_southern)
         return;
 
-    if (m_serviceName == serviceName && m_menuObjectPath == objectPath)
-    {
-        if (m_importer)
-            QMetaObject::invokeMethod(m_importer, "updateMenu", Qt::QueuedConnection);
-
-        return;
-    }
     if(serviceName.isEmpty() || objectPath.isEmpty())
     {
         //todo: generic menu
         return;
     }
 
+    // a window we saw before brings its menus along, they are refreshed in
+    // the background so the first click doesn't wait for the application
+    auto importer = getImporter(serviceName, objectPath);
+    importer->prefetch();
+    if(importer == m_importer)
+        return;
+
     m_serviceName = serviceName;
-    m_menuViewWatcher->setWatchedServices(QStringList({serviceName}));
     m_menuObjectPath = objectPath;
 
-    if(m_importer != nullptr)
-        m_importer->deleteLater();
-
-    m_importer = new DBusMenuImporter(serviceName, objectPath, m_menu->menuBar());
-    QMetaObject::invokeMethod(m_importer, "updateMenu", Qt::QueuedConnection);
+    if(m_importer)
+        disconnect(m_importer.data(), &MenuImporter::menuUpdated, this, nullptr);
 
-    connect(m_importer.data(), &DBusMenuImporter::menuUpdated, this, [=]()
+    m_importer = importer;
+    connect(importer, &MenuImporter::menuUpdated, this, [this, importer]()
     {
-        QMenu *menu = m_importer->menu();
-        // filter out a submenu
-        if(!m_importer->menu() || m_importer->menu() != menu)
-            return;
-
-        m_menubar = m_importer->menu();
+        m_menubar = importer->menu();
         m_menu->installMenu(m_menubar);
     });
+
+    if(importer->isReady())
+    {
+        m_menubar = importer->menu();
+        m_menu->installMenu(m_menubar);
+    }
+}
+
+void StageApplication::menuServiceUnregistered(const QString &serviceName)
+{
+    m_menuViewWatcher->removeWatchedService(serviceName);
+    const auto importers = m_importers;
+    for(auto importer : importers)
+    {
+        if(importer->service() != serviceName)
+            continue;
+
+        m_importers.removeOne(importer);
+        if(importer == m_importer)
+        {
+            m_menu->cleanMenu();
+            m_serviceName.clear();
+            m_menuObjectPath.clear();
+        }
+        importer->deleteLater();
+    }
+}
+
+MenuImporter *StageApplication::getImporter(const QString &service, const QString &path)
+{
+    for(int i = 0; i < m_importers.count(); ++i)
+    {
+        auto importer = m_importers.at(i);
+        if(importer->service() == service && importer->path() == path)
+        {
+            m_importers.move(i, 0);
+            return importer;
+        }
+    }
+
+    auto importer = new MenuImporter(service, path, this);
+    m_importers.prepend(importer);
+    m_menuViewWatcher->addWatchedService(service);
+
+    while(m_importers.count() > STAGE_MENU_CACHE)
+    {
+        auto old = m_importers.takeLast();
+        bool shared = std::any_of(m_importers.cbegin(), m_importers.cend(), [old](MenuImporter *i) {
+            return i->service() == old->service();
+        });
+        if(!shared)
+            m_menuViewWatcher->removeWatchedService(old->service());
+        old->deleteLater();
+    }
+    return importer;
 }
 
 void StageApplication::createStatusButton(StatusNotifierButton *btn)
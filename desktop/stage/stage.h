@@ -14,16 +14,17 @@
 #include <QDBusObjectPath>
 #include <QPointer>
 #include <hollywood/layershellinterface.h>
-#include <dbusmenuimporter.h>
+
+#include "menuserver/menuimporter.h"
 
 class HWPrivateWaylandProtocol;
 class PlasmaWindowManagement;
 class PlasmaWindow;
+class WindowThumbnailManager;
 class StageHost;
 class MenuServer;
 class LSDesktopEntry;
 class QDBusServiceWatcher;
-class DBusMenuImporter;
 class MenuRegistrarImporter;
 class OriginullMenuServerClient;
 class NotifierHost;
@@ -44,8 +45,9 @@ public:
     bool callSessionDBus(const QString &exec);
     bool displayManagerStart() { return m_started_dm; }
     QMenu* systemMenu() { return m_context; }
-    DBusMenuImporter* importer() { return qobject_cast<DBusMenuImporter*>(m_importer.data()); }
+    MenuImporter* importer() { return m_importer; }
     PlasmaWindowManagement* windowManager() { return m_wndmgr; }
+    WindowThumbnailManager* thumbnailManager() { return m_thumbnails; }
     void playBell();
     HWPrivateWaylandProtocol* privateProtocol() { return m_protocol; }
     bool isSouthernMode() const { return m_southern; }
@@ -66,6 +68,7 @@ private slots:
     void setupPrivateProtocolResponder();
     void configChanged();
     void menuChanged(const QString &serviceName, const QString &objectPath);
+    void menuServiceUnregistered(const QString &serviceName);
     void createStatusButton(StatusNotifierButton *btn);
     void statusButtonRemoved(StatusNotifierButton *btn);
 signals:
@@ -79,13 +82,14 @@ private:
     void destroyMenuServer();
     void moveToStage();
     void moveToMenubar();
-    DBusMenuImporter *getImporter(const QString &service, const QString &path);
+    MenuImporter *getImporter(const QString &service, const QString &path);
 private:
-    friend class DBusMenuImporter;
     QString m_configfile;
     QFileSystemWatcher *m_cfgwatch = nullptr;
     // The global plasma window wayland protocol
     PlasmaWindowManagement *m_wndmgr = nullptr;
+    // Live window thumbnails for the task list
+    WindowThumbnailManager *m_thumbnails = nullptr;
     // Notification Icon List
     QList<StatusNotifierButton*> m_traybtns;
     // The primary screen stage
@@ -95,7 +99,9 @@ private:
     QDBusServiceWatcher *m_menuViewWatcher;
     HWPrivateWaylandProtocol *m_protocol = nullptr;
     MenuRegistrarImporter* m_menuImporter = nullptr;
-    QPointer<DBusMenuImporter> m_importer;
+    QPointer<MenuImporter> m_importer;
+    // menus of recently active windows, most recent first
+    QList<MenuImporter*> m_importers;
     QString m_serviceName;
     QString m_menuObjectPath;
     OriginullMenuServerClient *m_ms = nullptr;
@@ -16,6 +16,7 @@ CONFIG(release): LIBS += -ldbusmenu-qt6 -L/usr/lib/qt6/plugins/wayland-shell-int
 
 WAYLANDCLIENTSOURCES += ../display/compositor/protocols/originull-privateapi.xml
 WAYLANDCLIENTSOURCES += ../display/compositor/protocols/plasma-window-management.xml
+WAYLANDCLIENTSOURCES += ../display/compositor/protocols/originull-thumbnail.xml
 
 
 CONFIG += c++11
@@ -25,6 +26,7 @@ SOURCES += \
     stage.cc \
     taskview/appbutton.cc \
     battery.cc \
+    menuserver/menuimporter.cc \
     menuserver/menuregistrarimporter.cc \
     menuserver/utils.cc \
     menuserver/menuserver.cc \
@@ -32,6 +34,7 @@ SOURCES += \
     stagehost.cc \
     statusnotifier/dbustypes.cc \
     statusnotifier/sniasync.cc \
+    statusnotifier/sniiconcache.cc \
     statusnotifier/statusnotifierbutton.cc \
     statusnotifier/statusnotifieriteminterface.cc \
     statusnotifier/statusnotifierproxy.cc \
@@ -41,12 +44,14 @@ SOURCES += \
     taskview/stagetasklist.cc \
     ../shared/upower.cc \
     taskview/windowlist.cc \
+    taskview/windowpreview.cc \
     wndmgmt.cc
 
 HEADERS += \
     stage.h \
     taskview/appbutton.h \
     battery.h \
+    menuserver/menuimporter.h \
     menuserver/menuregistrarimporter.h \
     menuserver/utils.h \
     menuserver/menuserver.h \
@@ -54,6 +59,7 @@ HEADERS += \
     stagehost.h \
     statusnotifier/dbustypes.h \
     statusnotifier/sniasync.h \
+    statusnotifier/sniiconcache.h \
     statusnotifier/statusnotifierbutton.h \
     statusnotifier/statusnotifieriteminterface.h \
     statusnotifier/statusnotifierproxy.h \
@@ -64,6 +70,7 @@ HEADERS += \
     ../shared/upower.h \
     taskview/taskview.h \
     taskview/windowlist.h \
+    taskview/windowpreview.h \
     wndmgmt.h
 
 # Default rules for deployment.
@@ -0,0 +1,167 @@
+// Hollywood Stage
+// (C) 2024 Originull Software
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "sniiconcache.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileSystemWatcher>
+#include <QCryptographicHash>
+#include <QImage>
+#include <QPixmap>
+#include <QtEndian>
+
+// a few items with a handful of states or animation frames each
+static const int NamedIconCost = 128;
+static const int PixmapIconCost = 128;
+
+static const char *IconExtensions[] = { ".png", ".svg", ".xpm" };
+
+SniIconCache *SniIconCache::instance()
+{
+    static SniIconCache *cache = new SniIconCache(qApp);
+    return cache;
+}
+
+SniIconCache::SniIconCache(QObject *parent)
+    : QObject(parent)
+    , m_watcher(new QFileSystemWatcher(this))
+    , m_named(NamedIconCost)
+    , m_pixmaps(PixmapIconCost)
+{
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, &SniIconCache::directoryChanged);
+}
+
+void SniIconCache::indexDirectory(ThemePathIndex &index, const QString &dir)
+{
+    QDir d(dir);
+    const auto files = d.entryList(QDir::Files | QDir::NoDotAndDotDot);
+    for(auto &file : files)
+        index.files[file].append(d.filePath(file));
+    index.directories.append(dir);
+}
+
+const SniIconCache::ThemePathIndex &SniIconCache::index(const QString &themePath)
+{
+    auto it = m_indexes.find(themePath);
+    if(it != m_indexes.end())
+        return it.value();
+
+    ThemePathIndex index;
+    QDir themeDir(themePath);
+    if(!themePath.isEmpty() && themeDir.exists())
+    {
+        indexDirectory(index, themeDir.absolutePath());
+        if(themeDir.cd(QStringLiteral("hicolor")) ||
+           (themeDir.cd(QStringLiteral("icons")) && themeDir.cd(QStringLiteral("hicolor"))))
+        {
+            index.directories.append(themeDir.absolutePath());
+            const QStringList sizes = themeDir.entryList(QDir::AllDirs | QDir::NoDotAndDotDot);
+            for(const QString &size : sizes)
+            {
+                QDir sizeDir(themeDir.filePath(size));
+                index.directories.append(sizeDir.absolutePath());
+                const QStringList contexts = sizeDir.entryList(QDir::AllDirs | QDir::NoDotAndDotDot);
+                for(const QString &context : contexts)
+                    indexDirectory(index, sizeDir.filePath(context));
+            }
+        }
+
+        for(auto &dir : std::as_const(index.directories))
+            m_watched.insert(dir, themePath);
+        m_watcher->addPaths(index.directories);
+    }
+
+    return m_indexes.insert(themePath, index).value();
+}
+
+void SniIconCache::directoryChanged(const QString &path)
+{
+    const QString themePath = m_watched.value(path);
+    auto it = m_indexes.find(themePath);
+    if(it == m_indexes.end())
+        return;
+
+    // rebuilt on the next lookup
+    for(auto &dir : std::as_const(it->directories))
+        m_watched.remove(dir);
+    m_watcher->removePaths(it->directories);
+    m_indexes.erase(it);
+
+    const auto keys = m_named.keys();
+    const QString prefix = themePath + QLatin1Char('\n');
+    for(auto &key : keys)
+    {
+        if(key.startsWith(prefix))
+            m_named.remove(key);
+    }
+}
+
+QIcon SniIconCache::iconForName(const QString &name, const QString &themePath)
+{
+    QIcon icon = QIcon::fromTheme(name);
+    if(!icon.isNull())
+        return icon;
+
+    const QString key = themePath + QLatin1Char('\n') + name;
+    if(auto cached = m_named.object(key))
+        return *cached;
+
+    const auto &idx = index(themePath);
+    const bool hasExtension = name.endsWith(QStringLiteral(".png"))
+                              || name.endsWith(QStringLiteral(".svg"))
+                              || name.endsWith(QStringLiteral(".xpm"));
+    if(hasExtension)
+    {
+        for(auto &path : idx.files.value(name))
+            icon.addFile(path);
+    }
+    else
+    {
+        for(auto ext : IconExtensions)
+        {
+            for(auto &path : idx.files.value(name + QLatin1String(ext)))
+                icon.addFile(path);
+        }
+    }
+
+    m_named.insert(key, new QIcon(icon));
+    return icon;
+}
+
+QIcon SniIconCache::iconForPixmaps(const IconPixmapList &pixmaps)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for(auto &pixmap : pixmaps)
+    {
+        const int size[2] = { pixmap.width, pixmap.height };
+        hash.addData(QByteArrayView(reinterpret_cast<const char*>(size), sizeof(size)));
+        hash.addData(pixmap.bytes);
+    }
+    const QByteArray key = hash.result();
+    if(auto cached = m_pixmaps.object(key))
+        return *cached;
+
+    QIcon icon;
+    for(auto &pixmap : pixmaps)
+    {
+        if(pixmap.bytes.isNull() || pixmap.width <= 0 || pixmap.height <= 0 ||
+           pixmap.bytes.size() < qsizetype(pixmap.width) * pixmap.height * 4)
+            continue;
+
+        // the item sends ARGB32 in network byte order
+        QImage image(pixmap.width, pixmap.height, QImage::Format_ARGB32);
+        const uchar *src = reinterpret_cast<const uchar*>(pixmap.bytes.constData());
+        for(int y = 0; y < pixmap.height; y++)
+        {
+            auto dest = reinterpret_cast<quint32*>(image.scanLine(y));
+            for(int x = 0; x < pixmap.width; x++, src += 4)
+                dest[x] = qFromBigEndian<quint32>(src);
+        }
+        icon.addPixmap(QPixmap::fromImage(image));
+    }
+
+    m_pixmaps.insert(key, new QIcon(icon));
+    return icon;
+}
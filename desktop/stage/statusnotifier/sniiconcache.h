@@ -0,0 +1,52 @@
+// Hollywood Stage
+// (C) 2024 Originull Software
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QCache>
+#include <QIcon>
+
+#include "dbustypes.h"
+
+class QFileSystemWatcher;
+// Icons for StatusNotifier items, shared by all buttons. Named icons that
+// aren't in the icon theme are looked up in an index of the item's
+// IconThemePath, built once per path and dropped when a watched directory
+// changes. Pixmap icons are keyed by a hash of their bytes, so an item
+// cycling through animation frames gets the same QIcon back instead of a
+// fresh conversion every time.
+class SniIconCache : public QObject
+{
+    Q_OBJECT
+public:
+    static SniIconCache* instance();
+
+    QIcon iconForName(const QString &name, const QString &themePath);
+    QIcon iconForPixmaps(const IconPixmapList &pixmaps);
+
+private slots:
+    void directoryChanged(const QString &path);
+
+private:
+    explicit SniIconCache(QObject *parent = nullptr);
+
+    struct ThemePathIndex
+    {
+        // file name, extension included, to every path carrying it
+        QHash<QString, QStringList> files;
+        QStringList directories;
+    };
+
+    const ThemePathIndex& index(const QString &themePath);
+    void indexDirectory(ThemePathIndex &index, const QString &dir);
+
+    QFileSystemWatcher *m_watcher = nullptr;
+    QHash<QString, ThemePathIndex> m_indexes;
+    // watched directory to the theme path it belongs to
+    QHash<QString, QString> m_watched;
+    QCache<QString, QIcon> m_named;
+    QCache<QByteArray, QIcon> m_pixmaps;
+};
@@ -28,10 +28,9 @@
 
 #include "statusnotifierbutton.h"
 
-#include <QDir>
-#include <QFile>
 #include <dbusmenuimporter.h>
 #include "sniasync.h"
+#include "sniiconcache.h"
 #include "stagehost.h"
 
 namespace
@@ -112,6 +111,11 @@ StatusNotifierButton::StatusNotifierButton(QString service, QString objectPath,
         hide();
         Q_EMIT attentionChanged();
     });
+
+    // one fetch per frame however often the item signals
+    mRefetchTimer.setSingleShot(true);
+    mRefetchTimer.setInterval(16);
+    connect(&mRefetchTimer, &QTimer::timeout, this, &StatusNotifierButton::fetchPendingIcons);
 }
 
 StatusNotifierButton::~StatusNotifierButton()
@@ -124,26 +128,43 @@ void StatusNotifierButton::newIcon()
     if (!icon().isNull() && icon().name() != QLatin1String("application-x-executable"))
         onNeedingAttention();
 
-    interface->propertyGetAsync(QLatin1String("IconThemePath"), [this] (QString value) {
-        refetchIcon(Passive, value);
-    });
+    scheduleRefetch(Passive);
 }
 
 void StatusNotifierButton::newOverlayIcon()
 {
     onNeedingAttention();
 
-    interface->propertyGetAsync(QLatin1String("IconThemePath"), [this] (QString value) {
-        refetchIcon(Active, value);
-    });
+    scheduleRefetch(Active);
 }
 
 void StatusNotifierButton::newAttentionIcon()
 {
     onNeedingAttention();
 
-    interface->propertyGetAsync(QLatin1String("IconThemePath"), [this] (QString value) {
-        refetchIcon(NeedsAttention, value);
+    scheduleRefetch(NeedsAttention);
+}
+
+void StatusNotifierButton::scheduleRefetch(Status status)
+{
+    mPendingIcons |= 1 << status;
+    if (!mRefetchTimer.isActive())
+        mRefetchTimer.start();
+}
+
+void StatusNotifierButton::fetchPendingIcons()
+{
+    const int pending = mPendingIcons;
+    mPendingIcons = 0;
+    if (!pending)
+        return;
+
+    interface->propertyGetAsync(QLatin1String("IconThemePath"), [this, pending] (QString value) {
+        for (Status status : {Passive, Active, NeedsAttention})
+        {
+            if (pending & (1 << status))
+                refetchIcon(status, value);
+        }
     });
 }
 
@@ -169,58 +190,7 @@ void StatusNotifierButton::refetchIcon(Status status, const QString& themePath)
     interface->propertyGetAsync(nameProperty, [this, status, pixmapProperty, themePath] (QString iconName) {
         if (!iconName.isEmpty())
         {
-            QIcon nextIcon = QIcon::fromTheme(iconName);
-            if (nextIcon.isNull())
-            {
-                QDir themeDir(themePath);
-                if (themeDir.exists())
-                {
-                    bool hasExtension = iconName.endsWith(QStringLiteral(".png"))
-                                        || iconName.endsWith(QStringLiteral(".svg"))
-                                        || iconName.endsWith(QStringLiteral(".xpm"));
-                    if (hasExtension)
-                    { // extension is included
-                        if (themeDir.exists(iconName))
-                            nextIcon.addFile(themeDir.filePath(iconName));
-                    }
-                    else
-                    {
-                        if (themeDir.exists(iconName + QStringLiteral(".png")))
-                            nextIcon.addFile(themeDir.filePath(iconName + QStringLiteral(".png")));
-                        if (themeDir.exists(iconName + QStringLiteral(".svg")))
-                            nextIcon.addFile(themeDir.filePath(iconName + QStringLiteral(".svg")));
-                        if (themeDir.exists(iconName + QStringLiteral(".xpm")))
-                            nextIcon.addFile(themeDir.filePath(iconName + QStringLiteral(".xpm")));
-                    }
-
-                    if (themeDir.cd(QStringLiteral("hicolor")) || (themeDir.cd(QStringLiteral("icons")) && themeDir.cd(QStringLiteral("hicolor"))))
-                    {
-                        const QStringList sizes = themeDir.entryList(QDir::AllDirs | QDir::NoDotAndDotDot);
-                        for (const QString &dir : sizes)
-                        {
-                            const QStringList dirs = QDir(themeDir.filePath(dir)).entryList(QDir::AllDirs | QDir::NoDotAndDotDot);
-                            for (const QString &innerDir : dirs)
-                            {
-                                QString path = themeDir.absolutePath() + QLatin1Char('/') + dir + QLatin1Char('/') + innerDir + QLatin1Char('/') + iconName;
-                                if (hasExtension)
-                                { // extension is included
-                                    if (QFile::exists(path))
-                                        nextIcon.addFile(path);
-                                }
-                                else
-                                {
-                                    if (QFile::exists(path + QStringLiteral(".png")))
-                                        nextIcon.addFile(path + QStringLiteral(".png"));
-                                    if (QFile::exists(path + QStringLiteral(".svg")))
-                                        nextIcon.addFile(path + QStringLiteral(".svg"));
-                                    if (QFile::exists(path + QStringLiteral(".xpm")))
-                                        nextIcon.addFile(path + QStringLiteral(".xpm"));
-                                }
-                            }
-                        }
-                    }
-                }
-            }
+            QIcon nextIcon = SniIconCache::instance()->iconForName(iconName, themePath);
 
             switch (status)
             {
@@ -243,23 +213,7 @@ void StatusNotifierButton::refetchIcon(Status status, const QString& themePath)
                 if (iconPixmaps.empty())
                     return;
 
-                QIcon nextIcon;
-
-                for (IconPixmap iconPixmap: iconPixmaps)
-                {
-                    if (!iconPixmap.bytes.isNull())
-                    {
-                        QImage image((uchar*) iconPixmap.bytes.data(), iconPixmap.width,
-                                     iconPixmap.height, QImage::Format_ARGB32);
-
-                        const uchar *end = image.constBits() + image.sizeInBytes();
-                        uchar *dest = reinterpret_cast<uchar*>(iconPixmap.bytes.data());
-                        for (const uchar *src = image.constBits(); src < end; src += 4, dest += 4)
-                            qToUnaligned(qToBigEndian<quint32>(qFromUnaligned<quint32>(src)), dest);
-
-                        nextIcon.addPixmap(QPixmap::fromImage(image));
-                    }
-                }
+                QIcon nextIcon = SniIconCache::instance()->iconForPixmaps(iconPixmaps);
 
                 switch (status)
                 {
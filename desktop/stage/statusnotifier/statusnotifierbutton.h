@@ -70,8 +70,12 @@ public slots:
     void newToolTip();
     void newStatus(QString status);
 
+private slots:
+    void fetchPendingIcons();
+
 private:
     void onNeedingAttention();
+    void scheduleRefetch(Status status);
 
     SniAsync *interface;
     QMenu *mMenu;
@@ -82,6 +86,9 @@ private:
     QString mTitle;
     bool mAutoHide;
     QTimer mHideTimer;
+    // coalesces NewIcon bursts from animating items
+    QTimer mRefetchTimer;
+    int mPendingIcons = 0;
 
 protected:
     void contextMenuEvent(QContextMenuEvent * event);
@@ -931,6 +931,7 @@ bool StageTaskList::event(QEvent *event)
     case QEvent::HoverEnter: {
         QHoverEvent *he = static_cast<QHoverEvent *>(event);
         m_mousePosition = he->position().toPoint();
+        const int oldHover = m_hoverIndex;
 
         if (!m_hoverRect.contains(m_mousePosition)) {
             if (m_hoverRect.isValid())
@@ -943,15 +944,20 @@ bool StageTaskList::event(QEvent *event)
                 m_hoverRect = QRect();
             }
         }
+        if (m_hoverIndex != oldHover)
+            emit tabHovered(validIndex(m_hoverIndex) ? m_hoverIndex : -1);
         return true;
     }
     case QEvent::HoverLeave: {
         m_mousePosition = {-1, -1};
         if (m_hoverRect.isValid())
             update(m_hoverRect);
+        const bool wasHovering = validIndex(m_hoverIndex);
         m_hoverIndex = -1;
         m_hoverRect = QRect();
         m_accumulatedAngleDelta = QPoint();
+        if (wasHovering)
+            emit tabHovered(-1);
         return true;
     }
     case QEvent::ToolTip:
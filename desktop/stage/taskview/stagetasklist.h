@@ -146,6 +146,7 @@ Q_SIGNALS:
     void tabMoved(int from, int to);
     void tabBarClicked(int index);
     void tabBarDoubleClicked(int index);
+    void tabHovered(int index);
 
 protected:
     virtual QSize tabSizeHint(int index) const;
@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
 #include "windowlist.h"
+#include "windowpreview.h"
 #include "wndmgmt.h"
 #include "stage.h"
 
@@ -66,6 +67,7 @@ s*/
 
 WindowTaskList::WindowTaskList(QWidget *parent)
     : StageTaskList(parent)
+    , m_preview(new WindowPreview(this))
 {
     // see if we have any windows to create
     // (this would be if we change from app->window at runtime
@@ -87,6 +89,11 @@ WindowTaskList::WindowTaskList(QWidget *parent)
     }
 
     connect(this, &WindowTaskList::tabBarClicked, this, &WindowTaskList::tabClicked);
+
+    m_previewTimer.setSingleShot(true);
+    m_previewTimer.setInterval(400);
+    connect(&m_previewTimer, &QTimer::timeout, this, &WindowTaskList::showPreview);
+    connect(this, &WindowTaskList::tabHovered, this, &WindowTaskList::hoverChanged);
 }
 
 WindowTaskList::~WindowTaskList()
@@ -195,6 +202,8 @@ void WindowTaskList::plasmaWindowClosed()
         disconnect(sndr, &PlasmaWindow::deactivated,
                 this, &WindowTaskList::deactivated);
         m_connectedWindows.removeOne(sndr);
+        if(m_preview->uuid() == sndr->uuid())
+            m_preview->hide();
         removeTab(tabId);
     }
 }
@@ -234,6 +243,9 @@ void WindowTaskList::deactivated()
 
 void WindowTaskList::tabClicked(int index)
 {
+    m_previewTimer.stop();
+    m_preview->hide();
+
     auto uuid = tabData(index).toUuid();
     if(!uuid.isNull())
     {
@@ -243,6 +255,38 @@ void WindowTaskList::tabClicked(int index)
     }
 }
 
+void WindowTaskList::hoverChanged(int index)
+{
+    m_previewIndex = index;
+    if(index < 0)
+    {
+        m_previewTimer.stop();
+        m_preview->hide();
+        return;
+    }
+
+    // moving along the list keeps the preview open
+    if(m_preview->isVisible())
+        showPreview();
+    else
+        m_previewTimer.start();
+}
+
+void WindowTaskList::showPreview()
+{
+    if(m_previewIndex < 0 || m_previewIndex >= count())
+        return;
+
+    auto uuid = tabData(m_previewIndex).toUuid();
+    auto wnd = manager()->windowByUUID(uuid);
+    if(!wnd)
+        return;
+
+    QRect tab = tabRect(m_previewIndex);
+    m_preview->showForWindow(uuid, wnd->windowTitle(),
+                             QRect(mapToGlobal(tab.topLeft()), tab.size()));
+}
+
 PlasmaWindowManagement *WindowTaskList::manager()
 {
     return StageApplication::instance()->windowManager();
@@ -5,8 +5,11 @@
 #pragma once
 #include "stagetasklist.h"
 
+#include <QTimer>
+
 class PlasmaWindowManagement;
 class PlasmaWindow;
+class WindowPreview;
 class WindowTaskList : public StageTaskList
 {
     Q_OBJECT
@@ -28,9 +31,14 @@ private slots:
     void deactivated();
 
     void tabClicked(int index);
+    void hoverChanged(int index);
+    void showPreview();
 private:
     PlasmaWindowManagement* manager();
     int findTabByUuid(const QUuid &uuid) const;
 private:
     QList<PlasmaWindow*> m_connectedWindows;
+    WindowPreview *m_preview = nullptr;
+    QTimer m_previewTimer;
+    int m_previewIndex = -1;
 };
@@ -0,0 +1,109 @@
+// Hollywood Stage
+// (C) 2024 Originull Software
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "windowpreview.h"
+#include "wndmgmt.h"
+#include "stage.h"
+
+#include <QPainter>
+#include <QScreen>
+#include <QGuiApplication>
+
+// the thumbnail area, in device independent pixels
+static const QSize PreviewSize(240, 150);
+static const int PreviewMargin = 8;
+
+WindowPreview::WindowPreview(QWidget *parent)
+    : QWidget(parent, Qt::ToolTip | Qt::FramelessWindowHint)
+{
+}
+
+void WindowPreview::showForWindow(const QUuid &uuid, const QString &title, const QRect &anchor)
+{
+    m_title = title;
+    if(uuid != m_uuid || !m_thumbnail)
+    {
+        releaseThumbnail();
+        m_uuid = uuid;
+        m_image = QImage();
+
+        auto manager = StageApplication::instance()->thumbnailManager();
+        if(manager)
+        {
+            const qreal dpr = devicePixelRatioF();
+            m_thumbnail = manager->createThumbnail(uuid, PreviewSize * dpr, this);
+            if(m_thumbnail)
+                connect(m_thumbnail, &WindowThumbnail::updated,
+                        this, &WindowPreview::thumbnailUpdated);
+        }
+    }
+
+    const int titleHeight = fontMetrics().height() + PreviewMargin;
+    setFixedSize(PreviewSize.width() + PreviewMargin * 2,
+                 PreviewSize.height() + PreviewMargin * 2 + titleHeight);
+
+    // open away from the stage, below a top stage and above a bottom one
+    QPoint pos(anchor.center().x() - width() / 2, anchor.bottom() + 1);
+    QScreen *scr = QGuiApplication::screenAt(anchor.center());
+    if(scr)
+    {
+        const QRect avail = scr->geometry();
+        if(pos.y() + height() > avail.bottom())
+            pos.setY(anchor.top() - height());
+        pos.setX(qBound(avail.left(), pos.x(), avail.right() - width()));
+    }
+    move(pos);
+    show();
+    update();
+}
+
+void WindowPreview::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    QPainter p(this);
+    p.fillRect(rect(), palette().color(QPalette::ToolTipBase));
+    p.setPen(palette().color(QPalette::Dark));
+    p.drawRect(rect().adjusted(0, 0, -1, -1));
+
+    const QRect area(PreviewMargin, PreviewMargin, PreviewSize.width(), PreviewSize.height());
+    if(!m_image.isNull())
+    {
+        // the thumbnail is in buffer pixels, keep it crisp on hidpi
+        QSizeF logical = QSizeF(m_image.size()) / m_image.devicePixelRatio();
+        QSizeF fit = logical.scaled(area.size(), Qt::KeepAspectRatio).boundedTo(logical);
+        QRectF target(QPointF(0, 0), fit);
+        target.moveCenter(QRectF(area).center());
+        p.setRenderHint(QPainter::SmoothPixmapTransform);
+        p.drawImage(target, m_image);
+    }
+
+    QRect titleRect(PreviewMargin, area.bottom() + PreviewMargin,
+                    area.width(), fontMetrics().height());
+    p.setPen(palette().color(QPalette::ToolTipText));
+    p.drawText(titleRect, Qt::AlignCenter,
+               fontMetrics().elidedText(m_title, Qt::ElideRight, titleRect.width()));
+}
+
+void WindowPreview::hideEvent(QHideEvent *event)
+{
+    releaseThumbnail();
+    m_image = QImage();
+    QWidget::hideEvent(event);
+}
+
+void WindowPreview::thumbnailUpdated()
+{
+    if(!m_thumbnail)
+        return;
+
+    m_image = m_thumbnail->image();
+    m_image.setDevicePixelRatio(devicePixelRatioF());
+    update();
+}
+
+void WindowPreview::releaseThumbnail()
+{
+    delete m_thumbnail;
+    m_thumbnail = nullptr;
+}
@@ -0,0 +1,34 @@
+// Hollywood Stage
+// (C) 2024 Originull Software
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <QWidget>
+#include <QUuid>
+#include <QImage>
+
+class WindowThumbnail;
+// Hover preview of a window in the task list. The live thumbnail only
+// exists while the preview is shown, so hidden previews cost nothing.
+class WindowPreview : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit WindowPreview(QWidget *parent = nullptr);
+    QUuid uuid() const { return m_uuid; }
+    // anchor is the hovered tab in global coordinates
+    void showForWindow(const QUuid &uuid, const QString &title, const QRect &anchor);
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+private slots:
+    void thumbnailUpdated();
+private:
+    void releaseThumbnail();
+
+    WindowThumbnail *m_thumbnail = nullptr;
+    QUuid m_uuid;
+    QString m_title;
+    QImage m_image;
+};
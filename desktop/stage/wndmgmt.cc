@@ -9,9 +9,14 @@
 #include <qplatformdefs.h>
 #include <cerrno>
 #include <QtWaylandClient>
+#include <QtWaylandClient/private/qwaylandintegration_p.h>
+#include <QtWaylandClient/private/qwaylanddisplay_p.h>
+#include <QtWaylandClient/private/qwaylandshmbackingstore_p.h>
+#include <wayland-client-protocol.h>
 
 #define PWM_PROTO_VERSION       15
 #define PW_PROTO_VERSION        16
+#define THUMB_PROTO_VERSION     1
 
 PlasmaWindowManagement::PlasmaWindowManagement()
     : QWaylandClientExtensionTemplate(PWM_PROTO_VERSION) {}
@@ -226,3 +231,71 @@ void PlasmaWindow::org_kde_plasma_window_unmapped()
     Q_EMIT windowClosed();
 }
 
+
+WindowThumbnailManager::WindowThumbnailManager()
+    : QWaylandClientExtensionTemplate(THUMB_PROTO_VERSION) {}
+
+WindowThumbnail *WindowThumbnailManager::createThumbnail(const QUuid &uuid, const QSize &maxSize, QObject *parent)
+{
+    if(!isActive())
+        return nullptr;
+
+    auto wl = get_thumbnail(uuid.toString(QUuid::WithoutBraces), maxSize.width(), maxSize.height());
+    return new WindowThumbnail(wl, parent);
+}
+
+WindowThumbnail::WindowThumbnail(struct ::org_originull_thumbnail *thumbnail, QObject *parent)
+    : QObject(parent)
+    , QtWayland::org_originull_thumbnail(thumbnail)
+{
+}
+
+WindowThumbnail::~WindowThumbnail()
+{
+    destroy();
+    delete m_buffer;
+}
+
+void WindowThumbnail::capture()
+{
+    if(m_buffer)
+        QtWayland::org_originull_thumbnail::capture(m_buffer->buffer());
+}
+
+void WindowThumbnail::org_originull_thumbnail_buffer(uint32_t format, int32_t width, int32_t height, int32_t stride)
+{
+    delete m_buffer;
+    m_buffer = nullptr;
+
+    QSize size(width, height);
+    if(format != WL_SHM_FORMAT_ARGB8888 || size.isEmpty())
+        return;
+
+    auto display = QtWaylandClient::QWaylandIntegration::instance()->display();
+    m_buffer = new QtWaylandClient::QWaylandShmBuffer(display, size, QImage::Format_ARGB32_Premultiplied);
+    if(m_buffer->image()->bytesPerLine() != stride)
+    {
+        qWarning() << "WindowThumbnail: unexpected stride" << stride;
+        delete m_buffer;
+        m_buffer = nullptr;
+        return;
+    }
+    capture();
+}
+
+void WindowThumbnail::org_originull_thumbnail_ready()
+{
+    if(!m_buffer)
+        return;
+
+    // take a copy so the next capture can be answered into the same buffer
+    m_image = m_buffer->image()->copy();
+    emit updated();
+    capture();
+}
+
+void WindowThumbnail::org_originull_thumbnail_failed()
+{
+    // a size change is followed by a new buffer event, anything else
+    // means the window is gone
+}
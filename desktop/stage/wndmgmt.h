@@ -6,9 +6,15 @@
 
 #include <QUuid>
 #include <QIcon>
+#include <QImage>
 
 #include <QtWaylandClient/QWaylandClientExtension>
 #include "qwayland-plasma-window-management.h"
+#include "qwayland-originull-thumbnail.h"
+
+namespace QtWaylandClient {
+class QWaylandShmBuffer;
+}
 
 class PlasmaWindow;
 class PlasmaWindowManagement : public QWaylandClientExtensionTemplate<PlasmaWindowManagement>
@@ -81,3 +87,37 @@ protected:
 
     PlasmaWindowManagement *m_parent = nullptr;
 };
+
+class WindowThumbnail;
+class WindowThumbnailManager : public QWaylandClientExtensionTemplate<WindowThumbnailManager>
+        , public QtWayland::org_originull_thumbnail_manager
+{
+    Q_OBJECT
+public:
+    WindowThumbnailManager();
+    // maxSize is in buffer pixels; returns nullptr without compositor support
+    WindowThumbnail* createThumbnail(const QUuid &uuid, const QSize &maxSize, QObject *parent = nullptr);
+};
+
+// Keeps one capture outstanding at all times, the compositor answers it
+// whenever the window has changed.
+class WindowThumbnail : public QObject
+        , public QtWayland::org_originull_thumbnail
+{
+    Q_OBJECT
+public:
+    ~WindowThumbnail();
+    QImage image() const { return m_image; }
+Q_SIGNALS:
+    void updated();
+protected:
+    friend class WindowThumbnailManager;
+    WindowThumbnail(struct ::org_originull_thumbnail *thumbnail, QObject *parent);
+    void org_originull_thumbnail_buffer(uint32_t format, int32_t width, int32_t height, int32_t stride) override;
+    void org_originull_thumbnail_ready() override;
+    void org_originull_thumbnail_failed() override;
+private:
+    void capture();
+    QtWaylandClient::QWaylandShmBuffer *m_buffer = nullptr;
+    QImage m_image;
+};
@@ -14,6 +14,7 @@
 #include <QCategoryAxis>
 
 #include "window.h"
+#include "timeseries.h"
 
 class ChartObject : public QObject
 {
@@ -29,29 +30,36 @@ public:
 
     QChart* chart();
     void updateXAxis(const QString &speed);
-    void pushSample(float value);
     void setChartAccentColor(const QColor &color);
-    void pushMemory(qulonglong total, qulonglong free, qulonglong avail, qulonglong buffers, qulonglong cache);
-    void pushDiskStat(qulonglong read, qulonglong write);
-protected:
-    static const int samples = 60;
+    // RAM stacks the second series on top of the first, CPU has no second
+    void setSeries(TimeSeries *primary, TimeSeries *secondary = nullptr);
+    void setTier(TimeSeries::Tier tier);
+public slots:
+    // takes the mask from StatPoller::sampled
+    void samplesAvailable(int tiers);
 private:
+    void reload();
+    void scrollTo(quint64 total);
+    void updateXLabels();
     void updateDiskCeiling();
     void setIOColors();
     void setupRAMColors();
 private:
     QCategoryAxis *m_x = nullptr;
+    QValueAxis *m_xvalues = nullptr; // hidden, scrolls with the samples
     QValueAxis *m_y = nullptr;
     QValueAxis *m_y2 = nullptr; // used for RAM, disk IO, network IO
 
     ChartType m_type = CPU;
     QChart *m_chart = nullptr;
-    QVector<QPointF> m_values;
-    QVector<QPointF> m_values2;
     QAreaSeries *m_series = nullptr;
     QAreaSeries *m_series2 = nullptr;
 
-    qulonglong m_disk_ceiling;
+    TimeSeries *m_primary = nullptr;
+    TimeSeries *m_secondary = nullptr;
+    TimeSeries::Tier m_tier = TimeSeries::Recent;
+    // RAM is sampled in KiB but shown in GiB
+    float m_scale = 1;
 
     QString m_currentXString;
 };
@@ -21,6 +21,8 @@
 #include <QToolButton>
 #include <QActionGroup>
 
+#include "timeseries.h"
+
 class GPUGauge;
 class StatPoller;
 class ChartObject;
@@ -28,7 +30,7 @@ class CPUOverview : public QWidget
 {
     Q_OBJECT
 public:
-    explicit CPUOverview(QWidget *parent = nullptr);
+    explicit CPUOverview(StatPoller *stats, QWidget *parent = nullptr);
 
     struct CpuID {
         uint processor = 0;
@@ -51,13 +53,11 @@ public:
     };
 
 public slots:
-    void poll();
     void setGraphPollTimeTitle(const QString &title);
+    void setHistoryTier(TimeSeries::Tier tier);
 signals:
 protected:
     void changeEvent(QEvent *event);
-private slots:
-    void cpuAverageAvailable(float data);
 
 private:
     void setupGovernorGraph();
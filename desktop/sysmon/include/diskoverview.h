@@ -17,27 +17,24 @@
 #include <QToolButton>
 #include <QActionGroup>
 
+#include "timeseries.h"
+
 class ChartObject;
 class StatPoller;
 class DiskOverview : public QWidget
 {
     Q_OBJECT
 public:
-    explicit DiskOverview(QWidget *parent = nullptr);
+    explicit DiskOverview(StatPoller *stats, QWidget *parent = nullptr);
 public slots:
-    void poll();
     void setGraphPollTimeTitle(const QString &title);
-private slots:
-    void diskDataAvailable(qulonglong read, qulonglong write);
+    void setHistoryTier(TimeSeries::Tier tier);
 private:
     QString findRootDisk();
-    uint findDiskSectorSize(const QString &disk);
 private:
     ChartObject *m_diskchart = nullptr;
     StatPoller *m_poll = nullptr;
 
-    uint m_disk_block_size = 512;
-
     QVBoxLayout *vl_main;
     QHBoxLayout *hl_top_main;
     QLabel *m_icon;
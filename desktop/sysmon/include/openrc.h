@@ -3,56 +3,85 @@
 
 #include <QObject>
 #include <QMap>
+#include <QHash>
 
 // TODO: path scanning? eventually we are removing the /usr split
 // ala fedora & others so these will change to /usr/bin/....
 #define OPENRC_STATUS_BINARY        "/bin/rc-status"
 #define OPENRC_SERVICE_BINARY       "/sbin/rc-service"
 
-class QProcess;
+// OpenRC keeps its service state as symlinks in these, one directory
+// per state, named after the service
+#define OPENRC_RUNTIME_DIR          "/run/openrc"
+#define OPENRC_RUNLEVEL_DIR         "/etc/runlevels"
+#define OPENRC_INITD_DIR            "/etc/init.d"
+
 class OpenRCMonitor;
 class OpenRCProcess : public QObject
 {
     Q_OBJECT
+public:
+    enum State {
+        Stopped,
+        Started,
+        Starting,
+        Stopping,
+        Inactive,
+        Failed
+    };
 protected:
     friend class OpenRCMonitor;
     explicit OpenRCProcess(const QString &proc, QObject *parent = nullptr);
-    void setStarted(const bool st);
-    void addRunlevel(const QString &rl);
-private slots:
-    void readProcData();
+    void setState(State state) { m_state = state; }
+    void setRunlevels(const QStringList &rl) { m_runlevels = rl; }
+    void readInitScript();
 public:
     QStringList runlevels() { return m_runlevels; }
+    State state() const { return m_state; }
     QString status() const;
     QString name() const;
     QString description() const;
 private:
-    bool m_started = false;
-    QProcess *m_proc = nullptr;
+    State m_state = Stopped;
     QString m_name;
     QString m_description;
     QString m_initpath;
     QList<QString> m_runlevels;
-    QMap<QString,QString> m_extracmds;
-    QMap<QString,QString> m_extracmds_started;
+    QList<QString> m_extracmds;
+    QList<QString> m_extracmds_started;
 };
 
 class OpenRCServiceModel;
-class QProcess;
+class QSocketNotifier;
+// Reads the service table straight from OpenRC's runtime state and
+// follows it with inotify, so watching services never forks. rc-service
+// is only run to start or stop a service.
 class OpenRCMonitor : public QObject
 {
     Q_OBJECT
 public:
     explicit OpenRCMonitor(QObject *parent = nullptr);
+    ~OpenRCMonitor();
     static bool systemHasOpenRCInit();
     OpenRCServiceModel* model();
+    // command is start, stop or restart; needs authentication
+    void controlService(const QString &name, const QString &command);
 public slots:
     void refreshStatus();
 private slots:
-    void processFinished();
+    void readEvents();
 private:
     friend class OpenRCServiceModel;
-    QProcess *m_statmon = nullptr;
+    void setupWatches();
+    void addWatch(const QString &path);
+    void updateService(const QString &name);
+    bool readState(const QString &name, OpenRCProcess::State &state, QStringList &runlevels) const;
+
+    int m_inotify = -1;
+    QSocketNotifier *m_notifier = nullptr;
+    // watch descriptor to the directory it watches
+    QHash<int,QString> m_watches;
+    QStringList m_runlevelNames;
     QMap<QString,OpenRCProcess*> m_processlist;
     OpenRCServiceModel *m_model = nullptr;
 };
@@ -42,11 +42,20 @@ public:
     void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
     QVariant valueForIndex(const ColumnItem item, const QModelIndex &index) const;
     void update();
+    OpenRCProcess* processForIndex(const QModelIndex &index) const;
 protected:
     friend class OpenRCMonitor;
     explicit OpenRCServiceModel(OpenRCMonitor *monitor, QObject *parent = nullptr);
+    // the monitor changes its list between these two
+    void beginUpdate();
+    void endUpdate();
+    void serviceAdded(OpenRCProcess *proc);
+    void serviceChanged(OpenRCProcess *proc);
+    void serviceRemoved(OpenRCProcess *proc);
 private:
     OpenRCServiceModelObject *itemForIndex(const QModelIndex &index) const;
+    int rowForProcess(OpenRCProcess *proc) const;
+    void rebuild();
 private:
     OpenRCServiceModelObject m_root;
     OpenRCMonitor *m_monitor;
@@ -16,6 +16,8 @@
 #include <QStandardItem>
 #include <QFile>
 
+#include "timeseries.h"
+
 class SelectorWidget : public QListView
 {
 public:
@@ -24,6 +26,7 @@ protected:
     void keyPressEvent(QKeyEvent *e) override;
 };
 
+class StatPoller;
 class DiskOverview;
 class RAMOverview;
 class CPUOverview;
@@ -34,6 +37,7 @@ public:
     explicit OverviewWidget(QWidget *parent = nullptr);
     void poll();
     void setGraphPollTimeTitle(const QString &title);
+    void setHistoryTier(TimeSeries::Tier tier);
 signals:
 private slots:
     void selectionActivated(const QModelIndex &newIdx, const QModelIndex &old);
@@ -57,6 +61,7 @@ private:
     QSplitter *m_splitter;
     SelectorWidget *m_selection;
     QStandardItemModel *m_selmodel;
+    StatPoller *m_stats;
     CPUOverview *m_cpuoverview;
     RAMOverview *m_ramoverview;
     DiskOverview *m_diskoverview;
@@ -0,0 +1,47 @@
+// Hollywood System Monitor
+// (C) 2024 Originull Software
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef PROCEVENTS_H
+#define PROCEVENTS_H
+
+#include <QObject>
+#include <sys/types.h>
+
+class QSocketNotifier;
+
+// Process lifecycle events from the kernel's proc connector. Listening
+// needs CAP_NET_ADMIN, create() returns nullptr when the socket can't be
+// bound and failed() is emitted if the kernel refuses the subscription,
+// in both cases the caller keeps scanning /proc. Only whole processes are
+// reported, threads are filtered out.
+class ProcEvents : public QObject
+{
+    Q_OBJECT
+public:
+    static ProcEvents* create(QObject *parent = nullptr);
+    ~ProcEvents();
+
+    // the kernel acknowledged the subscription, events are complete
+    bool isActive() const { return m_active; }
+signals:
+    void activated();
+    void failed();
+    void started(pid_t pid);
+    // exec or a comm change
+    void renamed(pid_t pid);
+    void exited(pid_t pid);
+    // the receive buffer overflowed and events were lost
+    void overrun();
+private slots:
+    void readEvents();
+private:
+    explicit ProcEvents(int fd, QObject *parent);
+    void shutdown();
+
+    int m_fd = -1;
+    QSocketNotifier *m_notifier = nullptr;
+    bool m_active = false;
+};
+
+#endif // PROCEVENTS_H
@@ -6,7 +6,9 @@
 #include <QString>
 #include <QByteArray>
 #include <QHash>
-#include <QRegularExpression>
+#include <QFutureWatcher>
+
+#include "procfssampler.h"
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -16,6 +18,7 @@
 
 class LSDesktopEntry;
 class LSMimeApplications;
+class ProcEvents;
 class LSProcessItem
 {
 public:
@@ -42,15 +45,15 @@ protected:
     qulonglong cutime= 0;
     qulonglong cstime= 0;
     qulonglong starttime= 0;
+    float cpu = 0;
     ProcessState state;
     QString processName;
     QString commandLine;
-    QString tty;
+    int tty = 0;
     LSDesktopEntry* desktopEntry = nullptr;
     int priority= 0;
     int nice= 0;
-    bool process();
-    void secondProcess();
+    void update(const ProcessSample &sample);
     friend class LSProcfsModel;
 };
 
@@ -83,6 +86,7 @@ public:
     };
 
     explicit LSProcfsModel(QObject *parent = nullptr);
+    ~LSProcfsModel();
     QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
     QModelIndex parent(const QModelIndex &child) const override;
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
@@ -95,12 +99,20 @@ public:
 public slots:
     void reload();
 private slots:
+    void snapshotReady();
+    void processStarted(pid_t pid);
+    void processRenamed(pid_t pid);
+    void processExited(pid_t pid);
+    void processEvents();
 private:
     LSProcessItem *itemForIndex(const QModelIndex &index) const;
 signals:
     void polled();
 private:
-    void clearStale();
+    void startPass(bool partial);
+    void applySnapshot(const ProcfsSnapshot &snapshot);
+    void removeStale();
+    LSDesktopEntry* desktopForCommandLine(const QString &commandLine);
     void setupTimer();
     QString cpuPercent(LSProcessItem* item) const;
     void poll();
@@ -115,8 +127,17 @@ private:
     ModelMode m_mode = FlatMode;
     ColumnItem m_sort = ProcessId;
     QList<LSProcessItem*> m_flat;
-    QList<pid_t> m_flatpids;
     QHash<uint,LSProcessItem*> m_byid;
+    // desktop entries by executable, including misses
+    QHash<QString,LSDesktopEntry*> m_desktops;
+    ProcfsSampler m_sampler;
+    QFutureWatcher<ProcfsSnapshot> m_watcher;
+    // optional, without it every pass lists /proc
+    ProcEvents *m_events = nullptr;
+    ProcfsEvents m_pending;
+    QTimer *m_eventTimer = nullptr;
+    bool m_rescan = true;
+    bool m_stale = false;
     QList<ColumnItem> m_visibleColumnOrder;
     QMap<uid_t,QString> m_usercache;
     ulong m_clockticks;
@@ -0,0 +1,106 @@
+// Hollywood System Monitor
+// (C) 2024 Originull Software
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef PROCFSSAMPLER_H
+#define PROCFSSAMPLER_H
+
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QElapsedTimer>
+
+#include <sys/types.h>
+#include <dirent.h>
+
+struct ProcessSample
+{
+    pid_t pid = 0;
+    pid_t ppid = 0;
+    uid_t uid = 0;
+    char state = '?';
+    int tty = 0;
+    int priority = 0;
+    int nice = 0;
+    qulonglong rss = 0;
+    qulonglong vsize = 0;
+    qulonglong shmem = 0;
+    qulonglong threads = 0;
+    qulonglong utime = 0;
+    qulonglong stime = 0;
+    qulonglong cutime = 0;
+    qulonglong cstime = 0;
+    qulonglong starttime = 0;
+    // share of one CPU since the previous sample, in percent
+    float cpu = 0;
+    QString name;
+    QString commandLine;
+};
+
+// One pass over /proc. The lists are implicitly shared, so a snapshot can
+// be handed from the sampling thread to the model without copying.
+struct ProcfsSnapshot
+{
+    QList<ProcessSample> processes;
+    QList<pid_t> removed;
+    // only the processes named by the events, not the whole table
+    bool partial = false;
+};
+
+// What the proc connector reported since the last pass. Without a working
+// event source every pass rescans /proc.
+struct ProcfsEvents
+{
+    QList<pid_t> started;
+    QList<pid_t> exited;
+    QList<pid_t> renamed;
+    // sample only started and renamed processes
+    bool partial = false;
+    // list /proc instead of trusting the events
+    bool rescan = true;
+};
+
+// Reads the process table off the GUI thread. Every known process keeps its
+// /proc/<pid> directory open, so a sample is an openat() and one read of
+// stat and statm, parsed in place without allocating. A directory that
+// outlives its process fails with ESRCH, which also catches reused PIDs.
+// With events, /proc isn't listed at all and only live PIDs are read.
+// Not thread safe: only one sample() may run at a time.
+class ProcfsSampler
+{
+public:
+    ProcfsSampler();
+    ~ProcfsSampler();
+
+    ProcfsSnapshot sample(const ProcfsEvents &events = ProcfsEvents());
+
+private:
+    struct Tracked
+    {
+        int dirfd = -1;
+        quint64 generation = 0;
+        qulonglong ticks = 0;
+        qint64 sampled = -1;
+        bool reported = false;
+        char comm[64] = {};
+        ProcessSample sample;
+    };
+
+    QHash<pid_t, Tracked>::iterator track(pid_t pid, const char *name);
+    void rescan(ProcfsSnapshot &snapshot, qint64 now);
+    void refresh(pid_t pid, ProcfsSnapshot &snapshot, qint64 now);
+    bool readProcess(pid_t pid, Tracked &tracked, qint64 now);
+    int readFile(pid_t pid, int dirfd, const char *name, char *buf, int size) const;
+    void readCommandLine(pid_t pid, Tracked &tracked) const;
+    void release(Tracked &tracked);
+
+    QHash<pid_t, Tracked> m_tracked;
+    QElapsedTimer m_clock;
+    quint64 m_generation = 0;
+    DIR *m_proc = nullptr;
+    int m_openDirs = 0;
+    int m_dirBudget = 0;
+    long m_clockticks = 100;
+};
+
+#endif // PROCFSSAMPLER_H
@@ -17,20 +17,20 @@
 #include <QToolButton>
 #include <QActionGroup>
 
+#include "timeseries.h"
+
 class ChartObject;
 class StatPoller;
 class RAMOverview : public QWidget
 {
     Q_OBJECT
 public:
-    explicit RAMOverview(QWidget *parent = nullptr);
+    explicit RAMOverview(StatPoller *stats, QWidget *parent = nullptr);
 public slots:
-    void poll();
     void setGraphPollTimeTitle(const QString &title);
+    void setHistoryTier(TimeSeries::Tier tier);
 protected:
     void changeEvent(QEvent *event);
-private slots:
-    void ramDataAvailable(qulonglong total, qulonglong free, qulonglong avail, qulonglong buf, qulonglong cache);
 private:
     ChartObject *m_ramchart = nullptr;
     StatPoller *m_poll = nullptr;
@@ -1,42 +1,93 @@
 #ifndef STATPOLLER_H
 #define STATPOLLER_H
 
-#include <QThread>
 #include <QObject>
-#include <QFile>
-#include <QDebug>
-#include <QTimer>
+#include <QHash>
+#include <QList>
+#include <QByteArray>
+#include <QElapsedTimer>
 
+#include "timeseries.h"
+
+// Samples the system wide counters into a TimeSeries per metric:
+//   cpu, cpu0..cpuN             busy percent
+//   memory.used, memory.cache   KiB, cache includes buffers
+//   swap.used                   KiB
+//   disk.<dev>.read/.write      KiB/s, every block device
+//   net.<if>.rx/.tx             KiB/s, every interface
+//   pressure.cpu/.memory/.io    percent of time stalled, when PSI exists
+// The proc files stay open and are reread in place, a poll allocates
+// nothing once every device has been seen.
 class StatPoller : public QObject
 {
     Q_OBJECT
 public:
-    enum PollType {
-        CPU,
-        Memory,
-        Disk,
-        Network
-    };
-    explicit StatPoller(PollType type, QObject *parent = nullptr);
+    explicit StatPoller(QObject *parent = nullptr);
     ~StatPoller();
-    void setDiskToMonitor(const QString &disk);
+
+    // the series exists from the first call on, even before it has samples
+    TimeSeries* series(const QString &key);
+    QList<QString> keys() const { return m_series.keys(); }
+    int cpuCount() const { return m_cpus.count() - 1; }
 signals:
-    void ramDataAvailable(qulonglong, qulonglong, qulonglong, qulonglong, qulonglong);
-    void swapDataAvailable(qulonglong, qulonglong, qulonglong);
-    void cpuAverageAvailable(float data);
-    void diskDataAvailable(qulonglong,qulonglong);
+    // mask of the TimeSeries tiers that gained a point
+    void sampled(int tiers);
 public slots:
     void poll();
 private:
-    QString m_disk;
-    QFile *m_file = nullptr;
-    PollType m_type;
-    QTimer *m_timer = nullptr;
-    uint m_cpu_previdle = 0;
-    uint m_cpu_prevtotal = 0;
-
-    qulonglong m_disk_read_sector = 0;
-    qulonglong m_disk_write_sector = 0;
+    struct Cpu
+    {
+        qulonglong busy = 0;
+        qulonglong total = 0;
+        TimeSeries *series = nullptr;
+    };
+
+    // a disk or an interface, counters in bytes
+    struct Device
+    {
+        QByteArray name;
+        qulonglong in = 0;
+        qulonglong out = 0;
+        bool seen = false;
+        TimeSeries *inSeries = nullptr;
+        TimeSeries *outSeries = nullptr;
+    };
+
+    struct Pressure
+    {
+        int fd = -1;
+        qulonglong total = 0;
+        bool seen = false;
+        TimeSeries *series = nullptr;
+    };
+
+    int readFile(int fd);
+    int pollCpu(qint64 now);
+    int pollMemory(qint64 now);
+    int pollDisks(qint64 now, qint64 interval);
+    int pollNetwork(qint64 now, qint64 interval);
+    int pollPressure(Pressure &pressure, qint64 now, qint64 interval);
+    Device& device(QList<Device> &devices, int index, const char *name, int len,
+                   const char *in, const char *out);
+    int updateDevice(Device &dev, qulonglong in, qulonglong out, qint64 now, qint64 interval);
+
+    QHash<QString, TimeSeries*> m_series;
+    QByteArray m_buffer;
+    QElapsedTimer m_clock;
+    qint64 m_last = -1;
+
+    int m_stat = -1;
+    int m_meminfo = -1;
+    int m_diskstats = -1;
+    int m_netdev = -1;
+    Pressure m_pressure[3];
+
+    QList<Cpu> m_cpus;
+    QList<Device> m_disks;
+    QList<Device> m_nics;
+    TimeSeries *m_memUsed = nullptr;
+    TimeSeries *m_memCache = nullptr;
+    TimeSeries *m_swapUsed = nullptr;
 };
 
 #endif // STATPOLLER_H
@@ -0,0 +1,62 @@
+// Hollywood System Monitor
+// (C) 2024 Originull Software
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef TIMESERIES_H
+#define TIMESERIES_H
+
+#include <QtGlobal>
+#include <QList>
+
+// A fixed amount of history for one metric. Every sample lands in the
+// Recent ring as is, and is averaged into one minute and fifteen minute
+// buckets for the Hour and Day rings, so an hour or a day of history costs
+// no more memory or CPU than the last minute. Nothing allocates after
+// construction.
+class TimeSeries
+{
+public:
+    enum Tier {
+        Recent,  // the last 60 samples
+        Hour,    // 60 one minute averages
+        Day,     // 96 fifteen minute averages
+        TierCount
+    };
+
+    TimeSeries();
+
+    // returns a mask of (1 << Tier) for the tiers that gained a point
+    int append(qint64 msecs, float value);
+
+    int capacity(Tier tier) const;
+    int count(Tier tier) const;
+    // oldest first
+    float at(Tier tier, int index) const;
+    float last(Tier tier) const;
+    float maximum(Tier tier) const;
+    // how many points the tier has ever taken, a monotonic x coordinate
+    quint64 total(Tier tier) const;
+
+private:
+    struct Ring
+    {
+        QList<float> values;
+        int head = 0;
+        int count = 0;
+        quint64 total = 0;
+
+        void push(float value);
+    };
+
+    struct Bucket
+    {
+        qint64 index = -1;
+        double sum = 0;
+        int samples = 0;
+    };
+
+    Ring m_rings[TierCount];
+    Bucket m_buckets[TierCount];
+};
+
+#endif // TIMESERIES_H
@@ -46,6 +46,7 @@ private slots:
     void triggerView();
     void updateSpeedChanged();
     void updatePauseTriggered();
+    void historyChanged();
     void about();
     void termProcess();
     void forceTermProcess();
@@ -55,6 +56,7 @@ private slots:
     void processRowChanged(const QModelIndex &current, const QModelIndex &previous);
     void processContextMenuRequested(const QPoint &pos);
     void processItemActivated(const QModelIndex &index);
+    void serviceContextMenuRequested(const QPoint &pos);
 private:
     void updateSpeedOnGraphs();
 private:
@@ -81,6 +83,10 @@ private:
     QAction *m_unormal = nullptr;
     QAction *m_pause = nullptr;
 
+    QAction *m_hminute = nullptr;
+    QAction *m_hhour = nullptr;
+    QAction *m_hday = nullptr;
+
     QList<QAction*> m_selectedProcessActions;
 
     QMenu *m_procContext = nullptr;
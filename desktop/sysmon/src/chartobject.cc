@@ -8,24 +8,23 @@ ChartObject::ChartObject(ChartType type, QObject *parent, qulonglong ramsize)
     : QObject(parent),
       m_type(type),
       m_chart(new QChart(0)),
-      m_series(new QAreaSeries(new QLineSeries(this), new QLineSeries(this)))
+      m_series(new QAreaSeries(new QLineSeries(this)))
 {
     m_chart->setAnimationOptions(QChart::NoAnimation);
     m_chart->setBackgroundVisible(false);
     m_chart->setMargins(QMargins(0,0,0,0));
     m_x = new QCategoryAxis(this);
-    m_x->setMin(0);
-    m_x->setMax(60);
     m_x->setReverse(true);
     m_x->setLabelsVisible(true);
     m_x->setLabelsPosition(QCategoryAxis::AxisLabelsPositionOnValue);
-    m_x->append(tr("Now"),1);
-    m_x->append(tr("60 Seconds"),59);
     m_currentXString = tr("60 Seconds");
 
+    // the series move along this one as samples come in, so appending a
+    // point never rewrites the ones already plotted
+    m_xvalues = new QValueAxis(this);
+    m_xvalues->setVisible(false);
 
     m_series->upperSeries()->setUseOpenGL(true);
-    m_series->lowerSeries()->setUseOpenGL(true);
 
     m_y = new QValueAxis(this);
     float gib = (float)ramsize/1024;
@@ -39,8 +38,9 @@ ChartObject::ChartObject(ChartType type, QObject *parent, qulonglong ramsize)
     {
         m_series->setName(tr("Application"));
 
-        // we get sent MiB so convert to GiB
+        // we get sent KiB so convert to GiB
         gib = gib/1024;
+        m_scale = 1.0f/1024/1024;
         m_y->setRange(0,gib);
         m_y->setMax(gib);
         m_y->setLabelFormat("%.2f");
@@ -49,6 +49,7 @@ ChartObject::ChartObject(ChartType type, QObject *parent, qulonglong ramsize)
         m_y2->setRange(0,gib);
         m_y2->setMax(gib);
         m_y2->setLabelFormat("%.2f");
+        // buffers/cache sit on top of the application memory
         m_series2 = new QAreaSeries(new QLineSeries(this), new QLineSeries(this));
         m_series2->upperSeries()->setUseOpenGL(true);
         m_series2->lowerSeries()->setUseOpenGL(true);
@@ -59,20 +60,21 @@ ChartObject::ChartObject(ChartType type, QObject *parent, qulonglong ramsize)
     if(type == Disk)
     {
         m_y->setRange(0,100);
-        m_y->setLabelFormat("%i KB");
+        m_y->setLabelFormat("%i KB/s");
         m_y2 = new QValueAxis(this);
         m_y2->setRange(0,100);
-        m_y2->setLabelFormat("%i KB");
-        m_series2 = new QAreaSeries(new QLineSeries(this), new QLineSeries(this));
+        m_y2->setLabelFormat("%i KB/s");
+        m_series2 = new QAreaSeries(new QLineSeries(this));
         m_series2->upperSeries()->setUseOpenGL(true);
-        m_series2->lowerSeries()->setUseOpenGL(true);
         setIOColors();
         m_series->setName(tr("Disk Read"));
         m_series2->setName(tr("Disk Write"));
         m_y->applyNiceNumbers();
+        m_y2->applyNiceNumbers();
     }
 
     m_chart->addAxis(m_x, Qt::AlignBottom);
+    m_chart->addAxis(m_xvalues, Qt::AlignBottom);
     m_chart->addAxis(m_y, Qt::AlignLeft);
     if(type == Disk || type == RAM)
     {
@@ -82,64 +84,18 @@ ChartObject::ChartObject(ChartType type, QObject *parent, qulonglong ramsize)
     m_chart->legend()->hide();
     m_series->setPointsVisible(false);
 
-    // clear our our sample vector
-    // it is so ghetto that we have to init random
-    // values but qt charts hates it otherwise
-    if (m_values.isEmpty())
-    {
-        m_values.reserve(samples);
-        for (int i = 0; i < samples; ++i)
-        {
-            if(type == RAM)
-            {
-                float r = static_cast<float>(rand()) / static_cast<float>(RAND_MAX/gib);
-                m_values.append(QPointF((float)i, r));
-            }
-            else
-                m_values.append(QPoint(i, rand()%100));
-        }
-    }
-    m_series->upperSeries()->append(m_values);
-    m_series->lowerSeries()->append(m_values);
     m_chart->addSeries(m_series);
-    for(int i = 0; i < samples; ++i)
-        m_values[i].setY(0);
-    m_series->upperSeries()->replace(m_values);
-    m_series->lowerSeries()->replace(m_values);
-
-    if(type == Disk)
+    m_series->attachAxis(m_xvalues);
+    m_series->attachAxis(m_y);
+    if(m_series2)
     {
-        m_values2.reserve(samples);
-        for (int i = 0; i < samples; ++i)
-            m_values2.append(QPoint(i, rand()%100));
-
-        m_series2->upperSeries()->append(m_values2);
-        m_series2->lowerSeries()->append(m_values2);
         m_chart->addSeries(m_series2);
-        for(int i = 0; i < samples; ++i)
-            m_values2[i].setY(0);
-        m_series2->lowerSeries()->replace(m_values2);
-        m_series2->upperSeries()->replace(m_values2);
-        m_y2->applyNiceNumbers();
+        m_series2->attachAxis(m_xvalues);
+        m_series2->attachAxis(m_y2);
     }
 
-    if(type == RAM)
-    {
-        m_values2.reserve(samples);
-        for (int i = 0; i < samples; ++i)
-        {
-            float r = static_cast<float>(rand()) / static_cast<float>(RAND_MAX/gib);
-            m_values2.append(QPointF((float)i, r));
-        }
-
-        m_series2->upperSeries()->append(m_values2);
-        m_series2->lowerSeries()->append(m_values2);
-        m_chart->addSeries(m_series2);
-        for(int i = 0; i < samples; ++i)
-            m_values2[i].setY(0);
-        m_series2->lowerSeries()->replace(m_values2);
-        m_series2->upperSeries()->replace(m_values2);
-   }
+    updateXLabels();
+    scrollTo(0);
 
     m_chart->legend()->setVisible(true);
     m_chart->legend()->setAlignment(Qt::AlignBottom);
@@ -152,95 +108,155 @@ QChart *ChartObject::chart()
 
 void ChartObject::updateXAxis(const QString &speed)
 {
-    m_x->replaceLabel(m_currentXString, speed);
     m_currentXString = speed;
+    if(m_tier == TimeSeries::Recent)
+        updateXLabels();
 }
 
-void ChartObject::pushSample(float value)
+void ChartObject::updateXLabels()
 {
-    for(int i = 0; i < samples; ++i)
-        m_values[i].setX(i-1);
-    m_values.removeFirst();
-    m_values.append(QPoint(samples,value));
-    m_series->upperSeries()->replace(m_values);
-    m_chart->update();
+    const auto labels = m_x->categoriesLabels();
+    for(auto &label : labels)
+        m_x->remove(label);
+
+    QString span = m_currentXString;
+    if(m_tier == TimeSeries::Hour)
+        span = tr("1 Hour");
+    else if(m_tier == TimeSeries::Day)
+        span = tr("24 Hours");
+
+    const int capacity = m_primary ? m_primary->capacity(m_tier) : 60;
+    m_x->setMin(0);
+    m_x->setMax(capacity);
+    m_x->append(tr("Now"),1);
+    m_x->append(span,capacity-1);
 }
 
-void ChartObject::setChartAccentColor(const QColor &color)
+void ChartObject::setSeries(TimeSeries *primary, TimeSeries *secondary)
 {
-    QColor darkerColor(color.darker(135));
-    m_series->setBorderColor(darkerColor);
-    QLinearGradient g(QPointF(0,0), QPointF(0,1));
-    g.setColorAt(0.0, color);
-    g.setColorAt(1.0, color.lighter(120));
-    g.setCoordinateMode(QGradient::ObjectBoundingMode);
-    m_series->setBrush(g);
+    m_primary = primary;
+    m_secondary = secondary;
+    updateXLabels();
+    reload();
 }
 
-void ChartObject::pushMemory(qulonglong total, qulonglong free, qulonglong avail, qulonglong buffers, qulonglong cache)
+void ChartObject::setTier(TimeSeries::Tier tier)
 {
-    Q_UNUSED(avail);
-    // this comes to us in KiB
-    float mem = (float)(total-free-buffers-cache);
-    mem = mem/1024/1024;
-    float buffers2 = (float)buffers/1024/1024;
-    float cache2 = (float)cache/1024/1024;
-    for(int i = 0; i < samples; ++i)
-    {
-        m_values[i].setX(i-1);
-        m_values2[i].setX(i-1);
-    }
-    m_values.removeFirst();
-    m_values2.removeFirst();
-    m_values.append(QPointF(samples,mem));
-    m_values2.append(QPointF(samples,mem+buffers2+cache2));
+    if(m_tier == tier)
+        return;
 
-    m_series->upperSeries()->replace(m_values);
-    m_series2->lowerSeries()->replace(m_values);
-    m_series2->upperSeries()->replace(m_values2);
+    m_tier = tier;
+    updateXLabels();
+    reload();
+}
 
-    m_chart->update();
+void ChartObject::scrollTo(quint64 total)
+{
+    // the newest point sits at the right edge, Now
+    const int capacity = m_primary ? m_primary->capacity(m_tier) : 60;
+    m_xvalues->setRange(qreal(total) - capacity, qreal(total));
 }
 
-void ChartObject::pushDiskStat(qulonglong read, qulonglong write)
+void ChartObject::reload()
 {
-    // axis m_y is read m_y2 is write
-    // this comes to us in bytes
-    for(int i = 0; i < samples; ++i)
+    // only on a tier switch, samplesAvailable() appends from then on
+    QList<QPointF> upper, upper2, lower2;
+    if(m_primary)
     {
-        m_values[i].setX(i-1);
-        m_values2[i].setX(i-1);
+        const int count = m_primary->count(m_tier);
+        const qreal first = qreal(m_primary->total(m_tier)) - count + 1;
+        upper.reserve(count);
+        for(int i = 0; i < count; ++i)
+            upper.append(QPointF(first + i, m_primary->at(m_tier, i) * m_scale));
     }
-    m_values.removeFirst();
-    m_values2.removeFirst();
-    m_values.append(QPointF(samples,read));
-    m_values2.append(QPointF(samples,write));
-    m_series->upperSeries()->replace(m_values);
-    m_series2->upperSeries()->replace(m_values2);
-    updateDiskCeiling();
+    if(m_secondary && m_series2)
+    {
+        const int count = m_secondary->count(m_tier);
+        const qreal first = qreal(m_secondary->total(m_tier)) - count + 1;
+        upper2.reserve(count);
+        for(int i = 0; i < count; ++i)
+        {
+            float y = m_secondary->at(m_tier, i) * m_scale;
+            if(m_type == RAM)
+            {
+                // both series are sampled together so the points line up
+                float base = upper.value(i).y();
+                lower2.append(QPointF(first + i, base));
+                y += base;
+            }
+            upper2.append(QPointF(first + i, y));
+        }
+    }
+
+    m_series->upperSeries()->replace(upper);
+    if(m_series2)
+    {
+        m_series2->upperSeries()->replace(upper2);
+        if(m_series2->lowerSeries())
+            m_series2->lowerSeries()->replace(lower2);
+    }
+
+    scrollTo(m_primary ? m_primary->total(m_tier) : 0);
+    if(m_type == Disk)
+        updateDiskCeiling();
     m_chart->update();
 }
 
-void ChartObject::updateDiskCeiling()
+void ChartObject::samplesAvailable(int tiers)
 {
-    // working in KiB
-    uint min_disk_ceiling = 50;
-    uint top_write = 0;
-    uint top_read = 0;
+    if(!m_primary || !(tiers & (1 << m_tier)) || m_primary->count(m_tier) == 0)
+        return;
+
+    const int capacity = m_primary->capacity(m_tier);
+    const quint64 total = m_primary->total(m_tier);
+    const float y = m_primary->last(m_tier) * m_scale;
+
+    auto append = [capacity](QLineSeries *series, const QPointF &point) {
+        series->append(point);
+        if(series->count() > capacity)
+            series->remove(0);
+    };
 
-    for(int i = 0; i < samples; ++i)
+    append(m_series->upperSeries(), QPointF(total, y));
+    if(m_secondary && m_series2 && m_secondary->count(m_tier) > 0)
     {
-        if(m_values[i].y() > top_read)
-            top_read = m_values[i].y();
-        if(m_values2[i].y() > top_write)
-            top_write = m_values2[i].y();
+        float y2 = m_secondary->last(m_tier) * m_scale;
+        if(m_type == RAM)
+        {
+            append(m_series2->lowerSeries(), QPointF(total, y));
+            y2 += y;
+        }
+        append(m_series2->upperSeries(), QPointF(total, y2));
     }
 
-    uint top_max = qMax(top_write, top_read);
+    scrollTo(total);
+    if(m_type == Disk)
+        updateDiskCeiling();
+}
+
+void ChartObject::setChartAccentColor(const QColor &color)
+{
+    QColor darkerColor(color.darker(135));
+    m_series->setBorderColor(darkerColor);
+    QLinearGradient g(QPointF(0,0), QPointF(0,1));
+    g.setColorAt(0.0, color);
+    g.setColorAt(1.0, color.lighter(120));
+    g.setCoordinateMode(QGradient::ObjectBoundingMode);
+    m_series->setBrush(g);
+}
+
+void ChartObject::updateDiskCeiling()
+{
+    // working in KiB/s
+    const float min_disk_ceiling = 50;
+    float top_max = 0;
+    if(m_primary)
+        top_max = m_primary->maximum(m_tier);
+    if(m_secondary)
+        top_max = qMax(top_max, m_secondary->maximum(m_tier));
 
     // give a 10% buffer on the top of the max space
-    uint top_ten = top_max * 10 / 100;
-    uint val = qMax(top_max+top_ten, min_disk_ceiling);
+    uint val = qMax(top_max * 1.1f, min_disk_ceiling);
 
     m_y->setRange(0,val);
     m_y->setMax(val);
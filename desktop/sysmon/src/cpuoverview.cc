@@ -16,10 +16,10 @@
 #include <cpuid.h>
 #endif
 
-CPUOverview::CPUOverview(QWidget *parent)
+CPUOverview::CPUOverview(StatPoller *stats, QWidget *parent)
     : QWidget(parent),
       m_cpuchart(new ChartObject(ChartObject::CPU, this)),
-      m_poll(new StatPoller(StatPoller::CPU, this)),
+      m_poll(stats),
       vl_main(new QVBoxLayout(this)),
       hl_top_main(new QHBoxLayout),
       m_icon(new QLabel(this)),
@@ -117,7 +117,8 @@ CPUOverview::CPUOverview(QWidget *parent)
     m_vm->setText(tr("Virtual Machine:"));
     m_caches->setText(tr("L1 Cache:"));
 
-    connect(m_poll, &StatPoller::cpuAverageAvailable, this, &CPUOverview::cpuAverageAvailable);
+    m_cpuchart->setSeries(m_poll->series(QStringLiteral("cpu")));
+    connect(m_poll, &StatPoller::sampled, m_cpuchart, &ChartObject::samplesAvailable);
     getCpuidInfo();
 
     QList<QByteArray> socketid;
@@ -200,14 +201,14 @@ CPUOverview::CPUOverview(QWidget *parent)
         m_cpuchart->setChartAccentColor(color);
 }
 
-void CPUOverview::poll()
+void CPUOverview::setGraphPollTimeTitle(const QString &title)
 {
-    m_poll->poll();
+    m_cpuchart->updateXAxis(title);
 }
 
-void CPUOverview::setGraphPollTimeTitle(const QString &title)
+void CPUOverview::setHistoryTier(TimeSeries::Tier tier)
 {
-    m_cpuchart->updateXAxis(title);
+    m_cpuchart->setTier(tier);
 }
 
 void CPUOverview::changeEvent(QEvent *event)
@@ -224,11 +225,6 @@ void CPUOverview::changeEvent(QEvent *event)
     QWidget::changeEvent(event);
 }
 
-void CPUOverview::cpuAverageAvailable(float data)
-{
-    m_cpuchart->pushSample(data);
-}
-
 void CPUOverview::setupGovernorGraph()
 {
     m_speed->setVisible(true);
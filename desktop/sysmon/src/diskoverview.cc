@@ -6,8 +6,9 @@
 #include <QSettings>
 #include <hollywood/hollywood.h>
 
-DiskOverview::DiskOverview(QWidget *parent)
+DiskOverview::DiskOverview(StatPoller *stats, QWidget *parent)
     : QWidget{parent}
+    , m_poll(stats)
     , vl_main(new QVBoxLayout(this))
     , hl_top_main(new QHBoxLayout)
     , m_icon(new QLabel(this))
@@ -18,7 +19,6 @@ DiskOverview::DiskOverview(QWidget *parent)
     , hl_top_graphs(new QHBoxLayout)
 {
     m_diskchart = new ChartObject(ChartObject::Disk, this, 1000);
-    m_poll = new StatPoller(StatPoller::Disk, this);
     m_chart = new QChartView(m_diskchart->chart(), this);
     vl_main->setSpacing(0);
     vl_main->setContentsMargins(2, 2, 2, 2);
@@ -62,14 +62,9 @@ DiskOverview::DiskOverview(QWidget *parent)
     else
         mydisk = mydisk.remove(mydisk.length()-1, 1);
 
-    m_poll->setDiskToMonitor(mydisk);
-    m_disk_block_size = findDiskSectorSize(mydisk);
-    connect(m_poll, &StatPoller::diskDataAvailable, this, &DiskOverview::diskDataAvailable);
-}
-
-void DiskOverview::poll()
-{
-    m_poll->poll();
+    m_diskchart->setSeries(m_poll->series(QString("disk.%1.read").arg(mydisk)),
+                           m_poll->series(QString("disk.%1.write").arg(mydisk)));
+    connect(m_poll, &StatPoller::sampled, m_diskchart, &ChartObject::samplesAvailable);
 }
 
 void DiskOverview::setGraphPollTimeTitle(const QString &title)
@@ -77,13 +72,9 @@ void DiskOverview::setGraphPollTimeTitle(const QString &title)
     m_diskchart->updateXAxis(title);
 }
 
-void DiskOverview::diskDataAvailable(qulonglong read, qulonglong write)
+void DiskOverview::setHistoryTier(TimeSeries::Tier tier)
 {
-    // this is all in bytes
-    auto read_sz = read*m_disk_block_size;
-    auto write_sz = write*m_disk_block_size;
-
-    m_diskchart->pushDiskStat(read_sz/1024, write_sz/1024);
+    m_diskchart->setTier(tier);
 }
 
 QString DiskOverview::findRootDisk()
@@ -111,16 +102,3 @@ QString DiskOverview::findRootDisk()
     }
     return QString();
 }
-
-uint DiskOverview::findDiskSectorSize(const QString &disk)
-{
-    QFile f(QString("/sys/block/%1/queue/logical_block_size").arg(disk));
-    if(f.open(QFile::ReadOnly))
-    {
-        QString d(f.readAll());
-        f.close();
-        return d.trimmed().toUInt();
-    }
-    // Hasty Default
-    return 512;
-}
@@ -1,39 +1,58 @@
 #include "openrc.h"
 
 #include <QFile>
+#include <QDir>
 #include <QProcess>
 #include <QDebug>
 #include <QVector>
 #include <QSettings>
+#include <QSocketNotifier>
+#include <QSet>
 #include "openrcmodel.h"
 
-OpenRCProcess::OpenRCProcess(const QString &proc, QObject *parent)
-    : QObject(parent)
-    , m_proc(new QProcess(this))
-    , m_name(proc)
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+// checked in this order, a service is in at most one of the first four
+static const struct {
+    const char *dir;
+    OpenRCProcess::State state;
+} StateDirs[] = {
+    { "stopping", OpenRCProcess::Stopping },
+    { "starting", OpenRCProcess::Starting },
+    { "inactive", OpenRCProcess::Inactive },
+    { "started", OpenRCProcess::Started },
+    { "failed", OpenRCProcess::Failed }
+};
+
+static bool linkExists(const QString &path)
 {
-    connect(m_proc, &QProcess::finished, this, &OpenRCProcess::readProcData);
-    m_proc->setProgram(OPENRC_SERVICE_BINARY);
-    m_proc->setArguments(QStringList() << "-r" << proc);
-    m_proc->start(QProcess::ReadOnly);
+    struct stat st;
+    return lstat(QFile::encodeName(path).constData(), &st) == 0;
 }
 
-void OpenRCProcess::setStarted(const bool st)
+// value of a name="value" line of an init script
+static QString scriptValue(const QByteArray &line)
 {
-    m_started = st;
+    auto value = line.mid(line.indexOf('=') + 1).trimmed();
+    if(value.length() >= 2 && (value.startsWith('"') || value.startsWith('\'')))
+        value = value.mid(1, value.length() - 2);
+    return QString::fromUtf8(value);
 }
 
-void OpenRCProcess::addRunlevel(const QString &rl)
+OpenRCProcess::OpenRCProcess(const QString &proc, QObject *parent)
+    : QObject(parent)
+    , m_name(proc)
+    , m_initpath(QString(OPENRC_INITD_DIR "/%1").arg(proc))
 {
-    m_runlevels.append(rl);
+    readInitScript();
 }
 
-void OpenRCProcess::readProcData()
+void OpenRCProcess::readInitScript()
 {
-    m_initpath = m_proc->readAllStandardOutput().trimmed();
-    qDebug() << m_initpath;
-    m_proc->deleteLater();
-
     QFile file(m_initpath);
     if(file.open(QFile::ReadOnly))
     {
@@ -41,56 +60,39 @@ void OpenRCProcess::readProcData()
         file.close();
 
         bool has_desc = false;
-        bool has_ec = false;
-        bool has_ecs = false;
-
-        QList<QByteArray> cmds;
-        QList<QByteArray> cmds_started;
-
-        for(auto line : data)
+        for(auto &line : data)
         {
             if(line.startsWith("description=") && !has_desc)
             {
-                auto desc = line.split('=');
-                desc.removeFirst();
-                auto line = desc.join('=');
-                line = line.remove(0, 1); // remove first "
-                line = line.remove(line.length()-1, 1); // remove last "
-                m_description = line;
+                m_description = scriptValue(line);
                 has_desc = true;
             }
             if(line.startsWith("extra_commands="))
-            {
-                auto desc = line.split('=');
-                desc.removeFirst();
-                auto line = desc.join('=');
-                line = line.remove(0, 1); // remove first "
-                line = line.remove(line.length()-1, 1); // remove last "
-
-                cmds = line.split(' ');
-                has_ec = true;
-            }
+                m_extracmds = scriptValue(line).split(' ', Qt::SkipEmptyParts);
             if(line.startsWith("extra_started_commands="))
-            {
-                auto desc = line.split('=');
-                desc.removeFirst();
-                auto line = desc.join('=');
-                line = line.remove(0, 1); // remove first "
-                line = line.remove(line.length()-1, 1); // remove last "
-
-                cmds_started = line.split(' ');
-                has_ecs = true;
-            }
+                m_extracmds_started = scriptValue(line).split(' ', Qt::SkipEmptyParts);
         }
     }
 }
 
 QString OpenRCProcess::status() const
 {
-    if(m_started)
+    switch(m_state)
+    {
+    case Started:
         return tr("Started");
-    else
+    case Starting:
+        return tr("Starting");
+    case Stopping:
+        return tr("Stopping");
+    case Inactive:
+        return tr("Inactive");
+    case Failed:
+        return tr("Failed");
+    case Stopped:
+    default:
         return tr("Stopped");
+    }
 }
 
 QString OpenRCProcess::name() const
@@ -104,16 +106,26 @@ QString OpenRCProcess::description() const
 }
 
 OpenRCMonitor::OpenRCMonitor(QObject *parent)
-    : QObject(parent),
-      m_statmon(new QProcess(this))
-{
-    m_statmon->setProgram(OPENRC_STATUS_BINARY);
-    // openrc-status -ivf ini # gets an INI style output of
-    // openrc service status
-    m_statmon->setArguments(QStringList() << "-avf" << "ini");
-    connect(m_statmon, &QProcess::finished, this, &OpenRCMonitor::processFinished);
-    refreshStatus();
+    : QObject(parent)
+{
     m_model = new OpenRCServiceModel(this);
+
+    m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(m_inotify < 0)
+        qDebug() << "OpenRCMonitor: inotify unavailable:" << strerror(errno);
+    else
+    {
+        m_notifier = new QSocketNotifier(m_inotify, QSocketNotifier::Read, this);
+        connect(m_notifier, &QSocketNotifier::activated, this, &OpenRCMonitor::readEvents);
+    }
+
+    refreshStatus();
+}
+
+OpenRCMonitor::~OpenRCMonitor()
+{
+    if(m_inotify >= 0)
+        close(m_inotify);
 }
 
 bool OpenRCMonitor::systemHasOpenRCInit()
@@ -122,7 +134,7 @@ bool OpenRCMonitor::systemHasOpenRCInit()
     if(!file.exists())
         return false;
 
-    return true;
+    return QDir(OPENRC_RUNTIME_DIR).exists();
 }
 
 OpenRCServiceModel *OpenRCMonitor::model()
@@ -130,40 +142,213 @@ OpenRCServiceModel *OpenRCMonitor::model()
     return m_model;
 }
 
+void OpenRCMonitor::controlService(const QString &name, const QString &command)
+{
+    // the state change itself comes back through inotify
+    QStringList args;
+    args << QLatin1String(OPENRC_SERVICE_BINARY) << name << command;
+    if(!QProcess::startDetached(QLatin1String("pkexec"), args))
+        qDebug() << "OpenRCMonitor: can't run" << OPENRC_SERVICE_BINARY << name << command;
+}
+
+void OpenRCMonitor::addWatch(const QString &path)
+{
+    if(m_inotify < 0)
+        return;
+
+    int wd = inotify_add_watch(m_inotify, QFile::encodeName(path).constData(),
+                               IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR);
+    if(wd >= 0)
+        m_watches.insert(wd, path);
+}
+
+void OpenRCMonitor::setupWatches()
+{
+    for(auto it = m_watches.cbegin(); it != m_watches.cend(); ++it)
+        inotify_rm_watch(m_inotify, it.key());
+    m_watches.clear();
+
+    for(auto &state : StateDirs)
+        addWatch(QString(OPENRC_RUNTIME_DIR "/%1").arg(QLatin1String(state.dir)));
+    addWatch(QStringLiteral(OPENRC_RUNTIME_DIR "/hotplugged"));
+
+    // the runlevel directory itself, for runlevels coming and going
+    addWatch(QStringLiteral(OPENRC_RUNLEVEL_DIR));
+    for(auto &rl : std::as_const(m_runlevelNames))
+        addWatch(QString(OPENRC_RUNLEVEL_DIR "/%1").arg(rl));
+}
+
+bool OpenRCMonitor::readState(const QString &name, OpenRCProcess::State &state, QStringList &runlevels) const
+{
+    state = OpenRCProcess::Stopped;
+    for(auto &dir : StateDirs)
+    {
+        if(linkExists(QString(OPENRC_RUNTIME_DIR "/%1/%2").arg(QLatin1String(dir.dir), name)))
+        {
+            state = dir.state;
+            break;
+        }
+    }
+
+    runlevels.clear();
+    for(auto &rl : m_runlevelNames)
+    {
+        if(linkExists(QString(OPENRC_RUNLEVEL_DIR "/%1/%2").arg(rl, name)))
+            runlevels.append(rl);
+    }
+    if(linkExists(QString(OPENRC_RUNTIME_DIR "/hotplugged/%1").arg(name)))
+        runlevels.append(QLatin1String("hotplugged"));
+    if(runlevels.isEmpty() && state != OpenRCProcess::Stopped)
+        runlevels.append(QLatin1String("manual"));
+
+    // what rc-status -a would list
+    return !runlevels.isEmpty();
+}
+
 void OpenRCMonitor::refreshStatus()
 {
-    m_statmon->start();
+    m_runlevelNames = QDir(OPENRC_RUNLEVEL_DIR).entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+    setupWatches();
+    m_model->beginUpdate();
+
+    // everything in a runlevel or in any state
+    QSet<QString> names;
+    for(auto &rl : std::as_const(m_runlevelNames))
+    {
+        const auto entries = QDir(QString(OPENRC_RUNLEVEL_DIR "/%1").arg(rl)).entryList(QDir::AllEntries | QDir::System | QDir::NoDotAndDotDot);
+        for(auto &entry : entries)
+            names.insert(entry);
+    }
+    for(auto &dir : StateDirs)
+    {
+        const auto entries = QDir(QString(OPENRC_RUNTIME_DIR "/%1").arg(QLatin1String(dir.dir))).entryList(QDir::AllEntries | QDir::System | QDir::NoDotAndDotDot);
+        for(auto &entry : entries)
+            names.insert(entry);
+    }
+    const auto hotplugged = QDir(QStringLiteral(OPENRC_RUNTIME_DIR "/hotplugged")).entryList(QDir::AllEntries | QDir::System | QDir::NoDotAndDotDot);
+    for(auto &entry : hotplugged)
+        names.insert(entry);
+
+    for(auto it = m_processlist.begin(); it != m_processlist.end();)
+    {
+        if(!names.contains(it.key()))
+        {
+            delete it.value();
+            it = m_processlist.erase(it);
+        }
+        else
+            ++it;
+    }
+
+    for(auto &name : std::as_const(names))
+    {
+        OpenRCProcess::State state;
+        QStringList runlevels;
+        if(!readState(name, state, runlevels))
+        {
+            delete m_processlist.take(name);
+            continue;
+        }
+
+        auto p = m_processlist.value(name);
+        if(!p)
+        {
+            p = new OpenRCProcess(name, this);
+            m_processlist.insert(name, p);
+        }
+        p->setState(state);
+        p->setRunlevels(runlevels);
+    }
+
+    m_model->endUpdate();
+}
+
+void OpenRCMonitor::updateService(const QString &name)
+{
+    OpenRCProcess::State state;
+    QStringList runlevels;
+    bool listed = readState(name, state, runlevels);
+
+    auto p = m_processlist.value(name);
+    if(!listed)
+    {
+        if(p)
+        {
+            m_model->serviceRemoved(p);
+            m_processlist.remove(name);
+            delete p;
+        }
+        return;
+    }
+
+    if(!p)
+    {
+        p = new OpenRCProcess(name, this);
+        p->setState(state);
+        p->setRunlevels(runlevels);
+        m_processlist.insert(name, p);
+        m_model->serviceAdded(p);
+        return;
+    }
+
+    if(p->state() == state && p->runlevels() == runlevels)
+        return;
+
+    p->setState(state);
+    p->setRunlevels(runlevels);
+    m_model->serviceChanged(p);
 }
 
-void OpenRCMonitor::processFinished()
+void OpenRCMonitor::readEvents()
 {
-    auto dt = m_statmon->readAll().split('\n');
-    QByteArray currentGroup = "";
+    alignas(struct inotify_event) char buf[4096];
+    // a start or stop moves a link through several directories, look at
+    // each service once per batch
+    QStringList changed;
+    bool rescan = false;
+
+    for(;;)
+    {
+        ssize_t len = read(m_inotify, buf, sizeof(buf));
+        if(len <= 0)
+            break;
+
+        for(char *ptr = buf; ptr < buf + len;)
+        {
+            auto ev = reinterpret_cast<struct inotify_event*>(ptr);
+            ptr += sizeof(struct inotify_event) + ev->len;
 
-   for(int i = 0; i < dt.count(); i++)
-   {
-       auto line = dt[i];
-       if(line.startsWith('['))
-           currentGroup = line.remove(0,1).remove(line.length()-1,1);
-       else if(line.contains('='))
-       {
-            auto key = line.split('=').first().trimmed();
-            auto valList = line.split('=');
-            valList.removeFirst();
-            auto val = valList.join('=').trimmed();
-            if(!m_processlist.contains(key))
+            if(ev->mask & IN_Q_OVERFLOW)
             {
-                auto *p = new OpenRCProcess(key, this);
-                p->addRunlevel(currentGroup);
-                m_processlist.insert(key,p);
-                if(val == QByteArray("stopped"))
-                    p->setStarted(false);
-                else
-                    p->setStarted(true);
+                rescan = true;
+                continue;
             }
-            else
-                m_processlist.value(key)->addRunlevel(currentGroup);
-       }
-   }
-   m_model->update();
+            if(ev->mask & IN_IGNORED)
+            {
+                m_watches.remove(ev->wd);
+                continue;
+            }
+            if(ev->len == 0)
+                continue;
+
+            if(m_watches.value(ev->wd) == QLatin1String(OPENRC_RUNLEVEL_DIR))
+            {
+                rescan = true;
+                continue;
+            }
+
+            const QString name = QFile::decodeName(ev->name);
+            if(!changed.contains(name))
+                changed.append(name);
+        }
+    }
+
+    if(rescan)
+    {
+        refreshStatus();
+        return;
+    }
+
+    for(auto &name : std::as_const(changed))
+        updateService(name);
 }
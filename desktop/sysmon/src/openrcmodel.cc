@@ -21,9 +21,7 @@ OpenRCServiceModel::OpenRCServiceModel(OpenRCMonitor *monitor, QObject *parent)
     m_visibleColumnOrder.append(ColumnItem::Runlevels);
     m_visibleColumnOrder.append(ColumnItem::Description);
 
-    m_sorted.clear();
-    for(auto p : m_monitor->m_processlist)
-        m_sorted.append(new OpenRCServiceModelObject(p));
+    rebuild();
 }
 
 QModelIndex OpenRCServiceModel::index(int row, int column, const QModelIndex &parent) const
@@ -34,7 +32,7 @@ QModelIndex OpenRCServiceModel::index(int row, int column, const QModelIndex &pa
     if (row < 0 || column < 0 || row >= rowCount(parent) || column >= columnCount(parent))
         return QModelIndex();
 
-    if(row > m_monitor->m_processlist.count()-1)
+    if(row > m_sorted.count()-1)
         return QModelIndex();
 
     return createIndex(row, column, m_sorted[row]);
@@ -108,14 +106,16 @@ QVariant OpenRCServiceModel::headerData(int section, Qt::Orientation orientation
 
 void OpenRCServiceModel::sort(int column, Qt::SortOrder order)
 {
-    qDebug() << "sorting!";
+    // the monitor keeps its services sorted by name
     Q_UNUSED(column);
     Q_UNUSED(order);
-    for(auto i : m_sorted)
-        delete i;
+}
 
+void OpenRCServiceModel::rebuild()
+{
+    qDeleteAll(m_sorted);
     m_sorted.clear();
-    for(auto p : m_monitor->m_processlist)
+    for(auto p : std::as_const(m_monitor->m_processlist))
         m_sorted.append(new OpenRCServiceModelObject(p));
 }
 
@@ -147,7 +147,68 @@ QVariant OpenRCServiceModel::valueForIndex(const ColumnItem item, const QModelIn
 
 void OpenRCServiceModel::update()
 {
-    sort(0);
+    beginUpdate();
+    endUpdate();
+}
+
+void OpenRCServiceModel::beginUpdate()
+{
+    beginResetModel();
+}
+
+void OpenRCServiceModel::endUpdate()
+{
+    rebuild();
+    endResetModel();
+}
+
+int OpenRCServiceModel::rowForProcess(OpenRCProcess *proc) const
+{
+    for(int i = 0; i < m_sorted.count(); i++)
+    {
+        if(m_sorted[i]->m_proc == proc)
+            return i;
+    }
+    return -1;
+}
+
+void OpenRCServiceModel::serviceAdded(OpenRCProcess *proc)
+{
+    // keep the name order of the monitor's map
+    int row = 0;
+    while(row < m_sorted.count() && m_sorted[row]->m_proc->name() < proc->name())
+        row++;
+
+    beginInsertRows(QModelIndex(), row, row);
+    m_sorted.insert(row, new OpenRCServiceModelObject(proc));
+    endInsertRows();
+}
+
+void OpenRCServiceModel::serviceChanged(OpenRCProcess *proc)
+{
+    int row = rowForProcess(proc);
+    if(row < 0)
+        return;
+
+    emit dataChanged(index(row, 0), index(row, columnCount() - 1));
+}
+
+void OpenRCServiceModel::serviceRemoved(OpenRCProcess *proc)
+{
+    int row = rowForProcess(proc);
+    if(row < 0)
+        return;
+
+    beginRemoveRows(QModelIndex(), row, row);
+    delete m_sorted.takeAt(row);
+    endRemoveRows();
+}
+
+OpenRCProcess *OpenRCServiceModel::processForIndex(const QModelIndex &index) const
+{
+    if(!index.isValid() || index.row() >= m_sorted.count())
+        return nullptr;
+    return m_sorted[index.row()]->m_proc;
 }
 
 OpenRCServiceModelObject *OpenRCServiceModel::itemForIndex(const QModelIndex &index) const
@@ -3,6 +3,7 @@
 #include "cpuoverview.h"
 #include "ramoverview.h"
 #include "diskoverview.h"
+#include "statpoller.h"
 #include <unistd.h>
 #include <sys/utsname.h>
 
@@ -23,9 +24,10 @@ OverviewWidget::OverviewWidget(QWidget *parent)
       m_splitter(new QSplitter(this)),
       m_selection(new SelectorWidget(m_splitter)),
       m_selmodel(new QStandardItemModel(this)),
-      m_cpuoverview(new CPUOverview(m_splitter)),
-      m_ramoverview(new RAMOverview(this)),
-      m_diskoverview(new DiskOverview(this)),
+      m_stats(new StatPoller(this)),
+      m_cpuoverview(new CPUOverview(m_stats, m_splitter)),
+      m_ramoverview(new RAMOverview(m_stats, this)),
+      m_diskoverview(new DiskOverview(m_stats, this)),
       m_cpu(new QStandardItem(tr("CPU"))),
       m_ram(new QStandardItem(tr("Memory"))),
       m_disk(new QStandardItem(tr("Disk"))),
@@ -104,9 +106,7 @@ OverviewWidget::OverviewWidget(QWidget *parent)
 
 void OverviewWidget::poll()
 {
-    m_cpuoverview->poll();
-    m_ramoverview->poll();
-    m_diskoverview->poll();
+    m_stats->poll();
 }
 
 void OverviewWidget::setGraphPollTimeTitle(const QString &title)
@@ -116,6 +116,13 @@ void OverviewWidget::setGraphPollTimeTitle(const QString &title)
     m_diskoverview->setGraphPollTimeTitle(title);
 }
 
+void OverviewWidget::setHistoryTier(TimeSeries::Tier tier)
+{
+    m_cpuoverview->setHistoryTier(tier);
+    m_ramoverview->setHistoryTier(tier);
+    m_diskoverview->setHistoryTier(tier);
+}
+
 void OverviewWidget::selectionActivated(const QModelIndex &newIdx, const QModelIndex &old)
 {
     Q_UNUSED(old);
@@ -0,0 +1,173 @@
+// Hollywood System Monitor
+// (C) 2024 Originull Software
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "procevents.h"
+
+#include <QSocketNotifier>
+#include <QDebug>
+
+#include <sys/socket.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <linux/netlink.h>
+#include <linux/connector.h>
+#include <linux/cn_proc.h>
+
+// a fork storm shouldn't overflow us while the GUI thread is busy
+static const int ReceiveBufferSize = 1024 * 1024;
+
+// the event values are ABI, newer kernel headers moved their enum out of
+// struct proc_event so don't depend on either spelling
+enum : quint32 {
+    EventNone = 0x00000000,
+    EventFork = 0x00000001,
+    EventExec = 0x00000002,
+    EventComm = 0x00000200,
+    EventExit = 0x80000000
+};
+
+ProcEvents *ProcEvents::create(QObject *parent)
+{
+    int fd = socket(PF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+    if(fd < 0)
+        return nullptr;
+
+    struct sockaddr_nl addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = CN_IDX_PROC;
+    if(bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0)
+    {
+        // EPERM without CAP_NET_ADMIN, that's the common case
+        if(errno != EPERM)
+            qDebug() << "ProcEvents: can't bind proc connector:" << strerror(errno);
+        close(fd);
+        return nullptr;
+    }
+
+    int size = ReceiveBufferSize;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+
+    alignas(struct nlmsghdr) char buf[NLMSG_SPACE(sizeof(struct cn_msg) + sizeof(enum proc_cn_mcast_op))];
+    memset(buf, 0, sizeof(buf));
+    auto hdr = reinterpret_cast<struct nlmsghdr*>(buf);
+    hdr->nlmsg_len = NLMSG_LENGTH(sizeof(struct cn_msg) + sizeof(enum proc_cn_mcast_op));
+    hdr->nlmsg_type = NLMSG_DONE;
+    hdr->nlmsg_pid = getpid();
+
+    auto msg = static_cast<struct cn_msg*>(NLMSG_DATA(hdr));
+    msg->id.idx = CN_IDX_PROC;
+    msg->id.val = CN_VAL_PROC;
+    msg->len = sizeof(enum proc_cn_mcast_op);
+    enum proc_cn_mcast_op op = PROC_CN_MCAST_LISTEN;
+    memcpy(msg->data, &op, sizeof(op));
+
+    if(send(fd, buf, hdr->nlmsg_len, 0) < 0)
+    {
+        qDebug() << "ProcEvents: can't subscribe to proc connector:" << strerror(errno);
+        close(fd);
+        return nullptr;
+    }
+
+    return new ProcEvents(fd, parent);
+}
+
+ProcEvents::ProcEvents(int fd, QObject *parent)
+    : QObject(parent)
+    , m_fd(fd)
+    , m_notifier(new QSocketNotifier(fd, QSocketNotifier::Read, this))
+{
+    connect(m_notifier, &QSocketNotifier::activated, this, &ProcEvents::readEvents);
+}
+
+ProcEvents::~ProcEvents()
+{
+    shutdown();
+}
+
+void ProcEvents::shutdown()
+{
+    if(m_fd < 0)
+        return;
+
+    m_notifier->setEnabled(false);
+    close(m_fd);
+    m_fd = -1;
+    m_active = false;
+}
+
+void ProcEvents::readEvents()
+{
+    alignas(struct nlmsghdr) char buf[8192];
+    while(m_fd >= 0)
+    {
+        ssize_t len = recv(m_fd, buf, sizeof(buf), 0);
+        if(len < 0)
+        {
+            if(errno == ENOBUFS)
+            {
+                emit overrun();
+                continue;
+            }
+            if(errno != EAGAIN && errno != EINTR)
+                qDebug() << "ProcEvents: receive failed:" << strerror(errno);
+            return;
+        }
+        if(len == 0)
+            return;
+
+        for(auto hdr = reinterpret_cast<struct nlmsghdr*>(buf); NLMSG_OK(hdr, len);
+            hdr = NLMSG_NEXT(hdr, len))
+        {
+            if(hdr->nlmsg_type == NLMSG_NOOP || hdr->nlmsg_type == NLMSG_ERROR)
+                continue;
+            if(hdr->nlmsg_type == NLMSG_OVERRUN)
+            {
+                emit overrun();
+                continue;
+            }
+
+            auto msg = static_cast<struct cn_msg*>(NLMSG_DATA(hdr));
+            if(msg->id.idx != CN_IDX_PROC || msg->id.val != CN_VAL_PROC)
+                continue;
+
+            auto ev = reinterpret_cast<struct proc_event*>(msg->data);
+            switch(quint32(ev->what))
+            {
+            case EventNone:
+                // the acknowledgement of our subscription
+                if(m_active)
+                    break;
+                if(ev->event_data.ack.err != 0)
+                {
+                    qDebug() << "ProcEvents: subscription refused:" << strerror(ev->event_data.ack.err);
+                    shutdown();
+                    emit failed();
+                    return;
+                }
+                m_active = true;
+                emit activated();
+                break;
+            case EventFork:
+                if(ev->event_data.fork.child_pid == ev->event_data.fork.child_tgid)
+                    emit started(ev->event_data.fork.child_tgid);
+                break;
+            case EventExec:
+                emit renamed(ev->event_data.exec.process_tgid);
+                break;
+            case EventComm:
+                if(ev->event_data.comm.process_pid == ev->event_data.comm.process_tgid)
+                    emit renamed(ev->event_data.comm.process_tgid);
+                break;
+            case EventExit:
+                if(ev->event_data.exit.process_pid == ev->event_data.exit.process_tgid)
+                    emit exited(ev->event_data.exit.process_tgid);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+}
@@ -1,19 +1,53 @@
 #include "procfsmodel.h"
+#include "procevents.h"
 #include <mimeapps.h>
 #include <desktopentry.h>
+#include <QtConcurrent>
+
+// process events are batched for this long before the table follows them
+static const int EventLatency = 50;
 
 LSProcfsModel::LSProcfsModel(QObject *parent)
     : QAbstractTableModel(parent),
       m_timer(new QTimer(this)),
+      m_events(ProcEvents::create(this)),
+      m_eventTimer(new QTimer(this)),
       m_mime(new LSMimeApplications(this))
 {
     m_mime->cacheAllDesktops();
     m_clockticks = sysconf(_SC_CLK_TCK);
     m_pagesize = sysconf(_SC_PAGESIZE);
     createDefaultColumnOrder();
+    connect(&m_watcher, &QFutureWatcher<ProcfsSnapshot>::finished,
+            this, &LSProcfsModel::snapshotReady);
+
+    m_eventTimer->setSingleShot(true);
+    m_eventTimer->setInterval(EventLatency);
+    connect(m_eventTimer, &QTimer::timeout, this, &LSProcfsModel::processEvents);
+    if(m_events)
+    {
+        connect(m_events, &ProcEvents::started, this, &LSProcfsModel::processStarted);
+        connect(m_events, &ProcEvents::renamed, this, &LSProcfsModel::processRenamed);
+        connect(m_events, &ProcEvents::exited, this, &LSProcfsModel::processExited);
+        // whatever started before the subscription took needs one more scan
+        connect(m_events, &ProcEvents::activated, this, [this]() { m_rescan = true; });
+        connect(m_events, &ProcEvents::overrun, this, [this]() { m_rescan = true; });
+        connect(m_events, &ProcEvents::failed, this, [this]() {
+            m_events->deleteLater();
+            m_events = nullptr;
+        });
+    }
+
     reload();
 }
 
+LSProcfsModel::~LSProcfsModel()
+{
+    // the sampler is ours, don't let a pass outlive it
+    m_watcher.waitForFinished();
+    qDeleteAll(m_flat);
+}
+
 QModelIndex LSProcfsModel::index(int row, int column, const QModelIndex &parent) const
 {
     if (row < 0 || column < 0 || row >= rowCount(parent) || column >= columnCount(parent))
@@ -35,7 +69,7 @@ int LSProcfsModel::rowCount(const QModelIndex &parent) const
 {
     Q_UNUSED(parent);
     if(m_mode == FlatMode)
-        return m_byid.count();
+        return m_flat.count();
 
     return 0;
 }
@@ -188,96 +222,164 @@ LSProcessItem *LSProcfsModel::itemForIndex(const QModelIndex &index) const
     return item;
 }
 
-void LSProcfsModel::clearStale()
+QString LSProcfsModel::cpuPercent(LSProcessItem *item) const
 {
-    bool removed = false;
-    for(auto item : m_byid)
+    return QString("%1%").arg(item->cpu, 0, 'f', 1);
+}
+
+void LSProcfsModel::poll()
+{
+    // a slow pass just drops the next tick instead of queueing up
+    if(m_watcher.isRunning())
+        return;
+
+    startPass(false);
+}
+
+void LSProcfsModel::startPass(bool partial)
+{
+    ProcfsEvents events = m_pending;
+    m_pending = ProcfsEvents();
+    events.partial = partial;
+    events.rescan = m_rescan || !m_events || !m_events->isActive();
+    m_rescan = false;
+
+    m_watcher.setFuture(QtConcurrent::run([this, events]() {
+        return m_sampler.sample(events);
+    }));
+}
+
+void LSProcfsModel::snapshotReady()
+{
+    applySnapshot(m_watcher.result());
+    m_initial = true;
+    emit polled();
+
+    // events that came in during the pass
+    if(!m_pending.started.isEmpty() || !m_pending.renamed.isEmpty() || !m_pending.exited.isEmpty())
+        m_eventTimer->start();
+}
+
+void LSProcfsModel::processStarted(pid_t pid)
+{
+    m_pending.started.append(pid);
+    if(!m_eventTimer->isActive())
+        m_eventTimer->start();
+}
+
+void LSProcfsModel::processRenamed(pid_t pid)
+{
+    m_pending.renamed.append(pid);
+    if(!m_eventTimer->isActive())
+        m_eventTimer->start();
+}
+
+void LSProcfsModel::processExited(pid_t pid)
+{
+    // the row goes right away, the sampler only has to let go of it
+    m_pending.exited.append(pid);
+    if(auto item = m_byid.take(pid))
     {
-        if(!QFile::exists(QString("/proc/%1/stat").arg(item->pid)))
-        {
-            uint pid = item->pid;
-            int pos = m_flat.indexOf(item);
-            beginRemoveRows(QModelIndex(), pos, pos);
-            m_byid.remove(pid);
-            delete item;
-            removed = true;
-        }
+        item->valid = false;
+        m_stale = true;
     }
-    if(removed)
-        endRemoveRows();
+    if(!m_eventTimer->isActive())
+        m_eventTimer->start();
 }
 
-QString LSProcfsModel::cpuPercent(LSProcessItem *item) const
+void LSProcfsModel::processEvents()
 {
-    struct sysinfo s_info;
-    if(sysinfo(&s_info) != 0)
-        return QString("NaN");
+    removeStale();
+    if(m_watcher.isRunning())
+        return;
+
+    // only new and renamed processes are read, the regular pass does
+    // everything else
+    if(!m_pending.started.isEmpty() || !m_pending.renamed.isEmpty() || !m_pending.exited.isEmpty())
+        startPass(true);
+}
 
-    ulong uptime = s_info.uptime;
-    ulong total_time = (item->utime + item->stime) / m_clockticks;
-    ulong seconds = uptime - (item->starttime / m_clockticks);
+void LSProcfsModel::removeStale()
+{
+    if(!m_stale)
+        return;
 
-    float percent = 100*((total_time/m_clockticks)/seconds);
-    return QString("%1%").arg(percent);
+    // drop the processes that are gone, one range of rows at a time
+    for(int row = m_flat.count()-1; row >= 0; row--)
+    {
+        if(m_flat[row]->valid)
+            continue;
+
+        int first = row;
+        while(first > 0 && !m_flat[first-1]->valid)
+            first--;
+
+        beginRemoveRows({}, first, row);
+        for(int i = first; i <= row; i++)
+            delete m_flat[i];
+        m_flat.remove(first, row - first + 1);
+        endRemoveRows();
+        row = first;
+    }
+    m_stale = false;
 }
 
-void LSProcfsModel::poll()
+void LSProcfsModel::applySnapshot(const ProcfsSnapshot &snapshot)
 {
-    auto oldpids = m_flatpids;
-    QList<pid_t> newpids;
-    QDir dir("/proc");
-    dir.setFilter(QDir::AllDirs|QDir::NoDotAndDotDot);
-    dir.setSorting(QDir::NoSort);
-    for(QString i : dir.entryList())
+    for(auto pid : snapshot.removed)
     {
-        bool ok;
-        uint pid = QVariant(i).toUInt(&ok);
-        if(ok)
+        if(auto item = m_byid.take(pid))
         {
-            int row = m_flatpids.indexOf(pid);
-            newpids.append(pid);
-            if(row >= 0)
+            item->valid = false;
+            m_stale = true;
+        }
+    }
+    removeStale();
+
+    // update what we know in place and collect the newcomers
+    const int existing = m_flat.count();
+    QList<LSProcessItem*> added;
+    for(const auto &sample : snapshot.processes)
+    {
+        if(auto item = m_byid.value(sample.pid))
+        {
+            item->update(sample);
+            if(snapshot.partial)
             {
-                // existing process let's update it
-                m_flat[row]->process();
+                int row = m_flat.indexOf(item);
                 emit dataChanged(index(row, 0), index(row, columnCount()-1));
             }
-            else
-            {
-                // new PID let's insert a row
-                auto *proc = new LSProcessItem(pid);
-                proc->process();
-                QString process(proc->commandLine);
-                auto keys = process.split(" ");
-                proc->desktopEntry = m_mime->findDesktopForExec(keys[0]);
-                if(!m_byid.contains(pid))
-                    m_byid.insert(pid, proc);
-
-                beginInsertRows({}, m_flat.count()-1, m_flat.count()-1);
-                m_flat.append(proc);
-                m_flatpids.append(pid);
-                endInsertRows();
-            }
+            continue;
         }
+
+        auto *proc = new LSProcessItem(sample.pid);
+        proc->update(sample);
+        proc->desktopEntry = desktopForCommandLine(proc->commandLine);
+        m_byid.insert(sample.pid, proc);
+        added.append(proc);
     }
 
-    // loop through our old PID list to purge
-    for(auto &mp : oldpids)
+    if(existing > 0 && !snapshot.partial)
+        emit dataChanged(index(0, 0), index(existing-1, columnCount()-1));
+
+    if(!added.isEmpty())
     {
-        if(!newpids.contains(mp))
-        {
-            int row = m_flatpids.indexOf(mp);
-            beginRemoveRows({}, row, row);
-            auto ls = m_flat.at(row);
-            m_flat.removeAt(row);
-            m_flatpids.removeAt(row);
-            delete ls;
-            endRemoveRows();
-        }
+        beginInsertRows({}, existing, existing + added.count() - 1);
+        m_flat.append(added);
+        endInsertRows();
     }
+}
 
-    m_initial = true;
-    emit polled();
+LSDesktopEntry *LSProcfsModel::desktopForCommandLine(const QString &commandLine)
+{
+    const QString exec = commandLine.section(' ', 0, 0);
+    auto it = m_desktops.constFind(exec);
+    if(it != m_desktops.constEnd())
+        return it.value();
+
+    auto desktop = m_mime->findDesktopForExec(exec);
+    m_desktops.insert(exec, desktop);
+    return desktop;
 }
 
 void LSProcfsModel::sortItems()
@@ -366,31 +468,9 @@ LSProcessItem::LSProcessItem(uint pid)
     this->pid = pid;
 }
 
-bool LSProcessItem::process()
+void LSProcessItem::update(const ProcessSample &sample)
 {
-    QString fn = QString("/proc/%1/stat").arg(pid);
-    if(!QFile::exists(fn))
-        return false;
-
-    QFile file(fn);
-    file.open(QFile::ReadOnly);
-    QString data = QString(file.readAll());
-    file.close();
-
-    struct stat statinfo;
-    stat(fn.toUtf8().data(), &statinfo);
-
-    // Filter out our title from stat data
-    QRegularExpression regex("\\((.*)\\)");
-    QRegularExpressionMatch cap = regex.match(data);
-    if(cap.hasMatch() && cap.capturedTexts().count() == 2)
-        processName = cap.capturedTexts().at(1);
-
-    QStringList filteredData = data.remove(cap.capturedTexts().at(1)).split(" ");
-    filteredData.removeFirst(); // process id
-    filteredData.removeFirst(); // () (empty where processName was)
-
-    switch(filteredData[0].toUtf8()[0])
+    switch(sample.state)
     {
     case 'R':
         state = LSProcessItem::PROC_RUNNING;
@@ -412,40 +492,24 @@ bool LSProcessItem::process()
         break;
     }
 
-    QFile mfile(QString("/proc/%1/statm").arg(pid));
-    mfile.open(QFile::ReadOnly);
-    QString mdata = QString(mfile.readAll());
-    mfile.close();
-    auto mFilteredData = mdata.split(' ');
-
-
-    ppid = filteredData[1].toUInt();
-    tty = filteredData[4];
-
-    utime = filteredData[11].toInt();
-    stime = filteredData[12].toInt();
-    cutime = filteredData[13].toInt();
-    cstime = filteredData[14].toInt();
-
-    priority = filteredData[15].toInt();
-    nice = filteredData[16].toInt();
-    threads = filteredData[17].toULongLong();
-    starttime = filteredData[19].toULongLong();
-    vsize = filteredData[20].toULongLong();
-    rss = filteredData[21].toULongLong();
-    shmem = mFilteredData[2].toULongLong();
-    user = statinfo.st_uid;
-
-    QFile cmdline(QString("/proc/%1/cmdline").arg(pid));
-    cmdline.open(QFile::ReadOnly);
-    commandLine = cmdline.readAll().replace('\0', ' ').trimmed();
-    cmdline.close();
+    ppid = sample.ppid;
+    user = sample.uid;
+    tty = sample.tty;
+    utime = sample.utime;
+    stime = sample.stime;
+    cutime = sample.cutime;
+    cstime = sample.cstime;
+    priority = sample.priority;
+    nice = sample.nice;
+    threads = sample.threads;
+    starttime = sample.starttime;
+    vsize = sample.vsize;
+    rss = sample.rss;
+    shmem = sample.shmem;
+    cpu = sample.cpu;
+
+    // implicitly shared with the sample, no copy unless it changed
+    processName = sample.name;
+    commandLine = sample.commandLine;
     valid = true;
-
-    return valid;
-}
-
-void LSProcessItem::secondProcess()
-{
-
 }
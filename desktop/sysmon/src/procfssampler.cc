@@ -0,0 +1,348 @@
+// Hollywood System Monitor
+// (C) 2024 Originull Software
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "procfssampler.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+
+// descriptors left for everything else in the process
+static const int ReservedDescriptors = 128;
+
+// parses the next space separated integer of a stat line
+static long long nextNumber(const char *&p, const char *end)
+{
+    while(p < end && *p == ' ')
+        p++;
+
+    bool negative = false;
+    if(p < end && *p == '-')
+    {
+        negative = true;
+        p++;
+    }
+
+    long long value = 0;
+    while(p < end && *p >= '0' && *p <= '9')
+        value = value * 10 + (*p++ - '0');
+
+    return negative ? -value : value;
+}
+
+ProcfsSampler::ProcfsSampler()
+{
+    m_clockticks = sysconf(_SC_CLK_TCK);
+    m_proc = opendir("/proc");
+
+    // a few thousand processes don't fit the usual soft limit of 1024, use
+    // what we are allowed to and read the rest by path
+    struct rlimit limit;
+    if(getrlimit(RLIMIT_NOFILE, &limit) == 0)
+    {
+        if(limit.rlim_cur < limit.rlim_max)
+        {
+            limit.rlim_cur = limit.rlim_max;
+            setrlimit(RLIMIT_NOFILE, &limit);
+            getrlimit(RLIMIT_NOFILE, &limit);
+        }
+        if(limit.rlim_cur == RLIM_INFINITY || limit.rlim_cur > 65536)
+            limit.rlim_cur = 65536;
+        m_dirBudget = qMax(0, int(limit.rlim_cur) - ReservedDescriptors);
+    }
+
+    m_clock.start();
+}
+
+ProcfsSampler::~ProcfsSampler()
+{
+    for(auto &tracked : m_tracked)
+        release(tracked);
+
+    if(m_proc)
+        closedir(m_proc);
+}
+
+void ProcfsSampler::release(Tracked &tracked)
+{
+    if(tracked.dirfd < 0)
+        return;
+
+    close(tracked.dirfd);
+    tracked.dirfd = -1;
+    m_openDirs--;
+}
+
+int ProcfsSampler::readFile(pid_t pid, int dirfd, const char *name, char *buf, int size) const
+{
+    int fd;
+    if(dirfd >= 0)
+        fd = openat(dirfd, name, O_RDONLY | O_CLOEXEC);
+    else
+    {
+        char path[64];
+        snprintf(path, sizeof(path), "/proc/%d/%s", pid, name);
+        fd = open(path, O_RDONLY | O_CLOEXEC);
+    }
+
+    if(fd < 0)
+        return -1;
+
+    int len = 0;
+    while(len < size)
+    {
+        ssize_t n = read(fd, buf + len, size - len);
+        if(n < 0)
+        {
+            len = -1;
+            break;
+        }
+        if(n == 0)
+            break;
+        len += n;
+    }
+
+    close(fd);
+    return len;
+}
+
+void ProcfsSampler::readCommandLine(pid_t pid, Tracked &tracked) const
+{
+    char buf[4096];
+    int len = readFile(pid, tracked.dirfd, "cmdline", buf, sizeof(buf));
+    if(len <= 0)
+    {
+        // kernel threads and zombies
+        tracked.sample.commandLine.clear();
+        return;
+    }
+
+    while(len > 0 && (buf[len-1] == '\0' || buf[len-1] == ' '))
+        len--;
+    for(int i = 0; i < len; i++)
+    {
+        if(buf[i] == '\0')
+            buf[i] = ' ';
+    }
+
+    tracked.sample.commandLine = QString::fromUtf8(buf, len);
+}
+
+bool ProcfsSampler::readProcess(pid_t pid, Tracked &tracked, qint64 now)
+{
+    char buf[1024];
+    int len = readFile(pid, tracked.dirfd, "stat", buf, sizeof(buf));
+    if(len <= 0)
+        return false;
+
+    // the name may itself contain spaces and parentheses
+    const char *end = buf + len;
+    const char *open = static_cast<const char*>(memchr(buf, '(', len));
+    const char *close = static_cast<const char*>(memrchr(buf, ')', len));
+    if(!open || !close || close < open)
+        return false;
+
+    ProcessSample &s = tracked.sample;
+    const size_t commLen = qMin<size_t>(close - open - 1, sizeof(tracked.comm) - 1);
+    if(strncmp(tracked.comm, open + 1, commLen) != 0 || tracked.comm[commLen] != '\0')
+    {
+        // new process or it has exec'd since the last pass
+        memcpy(tracked.comm, open + 1, commLen);
+        tracked.comm[commLen] = '\0';
+        s.name = QString::fromUtf8(tracked.comm, commLen);
+        readCommandLine(pid, tracked);
+    }
+
+    const char *p = close + 1;
+    while(p < end && *p == ' ')
+        p++;
+    s.state = p < end ? *p++ : '?';
+
+    // fields 4 to 24 of proc(5), ppid to rss
+    long long f[25];
+    for(int i = 4; i <= 24; i++)
+        f[i] = nextNumber(p, end);
+
+    s.ppid = f[4];
+    s.tty = f[7];
+    s.utime = f[14];
+    s.stime = f[15];
+    s.cutime = f[16];
+    s.cstime = f[17];
+    s.priority = f[18];
+    s.nice = f[19];
+    s.threads = f[20];
+    s.starttime = f[22];
+    s.vsize = f[23];
+    s.rss = f[24];
+
+    len = readFile(pid, tracked.dirfd, "statm", buf, sizeof(buf));
+    if(len > 0)
+    {
+        p = buf;
+        nextNumber(p, buf + len); // size
+        nextNumber(p, buf + len); // resident
+        s.shmem = nextNumber(p, buf + len);
+    }
+
+    // partial passes read some processes more often, keep the interval
+    // per process
+    const qulonglong ticks = s.utime + s.stime;
+    const qint64 interval = now - tracked.sampled;
+    if(tracked.sampled >= 0 && interval > 0 && ticks >= tracked.ticks)
+        s.cpu = (ticks - tracked.ticks) * 100000.0f / (interval * m_clockticks);
+    else if(tracked.sampled < 0)
+        s.cpu = 0;
+    tracked.ticks = ticks;
+    tracked.sampled = now;
+
+    return true;
+}
+
+QHash<pid_t, ProcfsSampler::Tracked>::iterator ProcfsSampler::track(pid_t pid, const char *name)
+{
+    Tracked tracked;
+    tracked.sample.pid = pid;
+    if(m_openDirs < m_dirBudget)
+    {
+        tracked.dirfd = openat(dirfd(m_proc), name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if(tracked.dirfd >= 0)
+            m_openDirs++;
+    }
+
+    struct stat st;
+    if(tracked.dirfd >= 0 ? fstat(tracked.dirfd, &st) == 0
+                          : fstatat(dirfd(m_proc), name, &st, 0) == 0)
+        tracked.sample.uid = st.st_uid;
+
+    return m_tracked.insert(pid, tracked);
+}
+
+void ProcfsSampler::refresh(pid_t pid, ProcfsSnapshot &snapshot, qint64 now)
+{
+    auto it = m_tracked.find(pid);
+    if(it == m_tracked.end())
+        return;
+
+    if(!readProcess(pid, *it, now))
+    {
+        // gone, or the PID was reused behind our directory; a new
+        // process is picked up fresh on the next pass
+        if(it->reported)
+            snapshot.removed.append(pid);
+        release(*it);
+        m_tracked.erase(it);
+        return;
+    }
+
+    it->generation = m_generation;
+    it->reported = true;
+    snapshot.processes.append(it->sample);
+}
+
+void ProcfsSampler::rescan(ProcfsSnapshot &snapshot, qint64 now)
+{
+    rewinddir(m_proc);
+    while(struct dirent *entry = readdir(m_proc))
+    {
+        pid_t pid = 0;
+        for(const char *c = entry->d_name; *c; c++)
+        {
+            if(*c < '0' || *c > '9')
+            {
+                pid = 0;
+                break;
+            }
+            pid = pid * 10 + (*c - '0');
+        }
+        if(pid <= 0)
+            continue;
+
+        if(!m_tracked.contains(pid))
+            track(pid, entry->d_name);
+        refresh(pid, snapshot, now);
+    }
+}
+
+ProcfsSnapshot ProcfsSampler::sample(const ProcfsEvents &events)
+{
+    ProcfsSnapshot snapshot;
+    if(!m_proc)
+        return snapshot;
+
+    const quint64 generation = ++m_generation;
+    const qint64 now = m_clock.elapsed();
+
+    for(auto pid : events.exited)
+    {
+        auto it = m_tracked.find(pid);
+        if(it == m_tracked.end())
+            continue;
+        if(it->reported)
+            snapshot.removed.append(pid);
+        release(*it);
+        m_tracked.erase(it);
+    }
+
+    // exec and comm changes, read the name and command line again
+    for(auto pid : events.renamed)
+    {
+        auto it = m_tracked.find(pid);
+        if(it != m_tracked.end())
+            it->comm[0] = '\0';
+    }
+
+    if(events.rescan)
+    {
+        snapshot.processes.reserve(m_tracked.size() + 16);
+        rescan(snapshot, now);
+    }
+    else
+    {
+        char name[16];
+        for(auto pid : events.started)
+        {
+            if(m_tracked.contains(pid))
+                continue;
+            snprintf(name, sizeof(name), "%d", pid);
+            track(pid, name);
+        }
+
+        if(events.partial)
+        {
+            snapshot.partial = true;
+            for(auto pid : events.started)
+                refresh(pid, snapshot, now);
+            for(auto pid : events.renamed)
+            {
+                if(!events.started.contains(pid))
+                    refresh(pid, snapshot, now);
+            }
+            return snapshot;
+        }
+
+        snapshot.processes.reserve(m_tracked.size());
+        const auto pids = m_tracked.keys();
+        for(auto pid : pids)
+            refresh(pid, snapshot, now);
+    }
+
+    for(auto it = m_tracked.begin(); it != m_tracked.end();)
+    {
+        if(it->generation != generation)
+        {
+            if(it->reported)
+                snapshot.removed.append(it.key());
+            release(*it);
+            it = m_tracked.erase(it);
+        }
+        else
+            ++it;
+    }
+
+    return snapshot;
+}
@@ -6,8 +6,9 @@
 #include <QSettings>
 #include <hollywood/hollywood.h>
 
-RAMOverview::RAMOverview(QWidget *parent)
+RAMOverview::RAMOverview(StatPoller *stats, QWidget *parent)
     : QWidget{parent}
+    , m_poll(stats)
     , vl_main(new QVBoxLayout(this))
     , hl_top_main(new QHBoxLayout)
     , m_icon(new QLabel(this))
@@ -25,7 +26,6 @@ RAMOverview::RAMOverview(QWidget *parent)
 
 
     m_ramchart = new ChartObject(ChartObject::RAM, this, mt_total);
-    m_poll = new StatPoller(StatPoller::Memory, this);
     m_chart = new QChartView(m_ramchart->chart(), this);
     vl_main->setSpacing(0);
     vl_main->setContentsMargins(2, 2, 2, 2);
@@ -68,17 +68,19 @@ RAMOverview::RAMOverview(QWidget *parent)
     if(color.isValid())
         m_ramchart->setChartAccentColor(color);
 
-    connect(m_poll, &StatPoller::ramDataAvailable, this, &RAMOverview::ramDataAvailable);
+    m_ramchart->setSeries(m_poll->series(QStringLiteral("memory.used")),
+                          m_poll->series(QStringLiteral("memory.cache")));
+    connect(m_poll, &StatPoller::sampled, m_ramchart, &ChartObject::samplesAvailable);
 }
 
-void RAMOverview::poll()
+void RAMOverview::setGraphPollTimeTitle(const QString &title)
 {
-    m_poll->poll();
+    m_ramchart->updateXAxis(title);
 }
 
-void RAMOverview::setGraphPollTimeTitle(const QString &title)
+void RAMOverview::setHistoryTier(TimeSeries::Tier tier)
 {
-    m_ramchart->updateXAxis(title);
+    m_ramchart->setTier(tier);
 }
 
 void RAMOverview::changeEvent(QEvent *event)
@@ -94,8 +96,3 @@ void RAMOverview::changeEvent(QEvent *event)
     }
     QWidget::changeEvent(event);
 }
-
-void RAMOverview::ramDataAvailable(qulonglong total, qulonglong free, qulonglong avail, qulonglong buf, qulonglong cache)
-{
-    m_ramchart->pushMemory(total,free,avail,buf,cache);
-}
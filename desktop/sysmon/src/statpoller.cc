@@ -1,146 +1,353 @@
 #include "statpoller.h"
 
-#include <QVariant>
+#include <QDebug>
 
-StatPoller::StatPoller(PollType type, QObject *parent)
-    : QObject(parent),
-      m_file(new QFile(this)),
-      m_type(type)
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+
+static const char *PressureFiles[] = {
+    "/proc/pressure/cpu",
+    "/proc/pressure/memory",
+    "/proc/pressure/io"
+};
+static const char *PressureKeys[] = {
+    "pressure.cpu",
+    "pressure.memory",
+    "pressure.io"
+};
+
+// /proc/diskstats counts 512 byte sectors whatever the device uses
+static const int SectorSize = 512;
+
+static int openProc(const char *path)
 {
-    if(m_type == CPU)
-        m_file->setFileName("/proc/stat");
-    if(m_type == Memory)
-        m_file->setFileName("/proc/meminfo");
-    if(m_type == Disk)
-        m_file->setFileName("/proc/diskstats");
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+        qDebug() << "StatPoller: can't open" << path << strerror(errno);
+    return fd;
 }
 
-StatPoller::~StatPoller()
+static void skipSpaces(const char *&p, const char *end)
 {
-    if(m_file)
-    {
-        if(m_file->isOpen())
-            m_file->close();
+    while(p < end && (*p == ' ' || *p == '\t'))
+        p++;
+}
+
+static qulonglong nextNumber(const char *&p, const char *end)
+{
+    skipSpaces(p, end);
+    qulonglong value = 0;
+    while(p < end && *p >= '0' && *p <= '9')
+        value = value * 10 + (*p++ - '0');
+    return value;
+}
+
+static const char *nextLine(const char *p, const char *end)
+{
+    const char *nl = static_cast<const char*>(memchr(p, '\n', end - p));
+    return nl ? nl + 1 : end;
+}
+
+StatPoller::StatPoller(QObject *parent)
+    : QObject(parent)
+{
+    m_stat = openProc("/proc/stat");
+    m_meminfo = openProc("/proc/meminfo");
+    m_diskstats = openProc("/proc/diskstats");
+    m_netdev = openProc("/proc/net/dev");
 
-        delete m_file;
+    for(int i = 0; i < 3; i++)
+    {
+        // PSI is optional in the kernel config, don't complain about it
+        m_pressure[i].fd = open(PressureFiles[i], O_RDONLY | O_CLOEXEC);
+        if(m_pressure[i].fd >= 0)
+            m_pressure[i].series = series(QString::fromLatin1(PressureKeys[i]));
     }
+
+    m_memUsed = series(QStringLiteral("memory.used"));
+    m_memCache = series(QStringLiteral("memory.cache"));
+    m_swapUsed = series(QStringLiteral("swap.used"));
+
+    m_buffer.resize(16384);
+    m_clock.start();
 }
 
-void StatPoller::setDiskToMonitor(const QString &disk)
+StatPoller::~StatPoller()
 {
-    m_disk = disk;
+    for(int fd : {m_stat, m_meminfo, m_diskstats, m_netdev})
+    {
+        if(fd >= 0)
+            close(fd);
+    }
+    for(auto &pressure : m_pressure)
+    {
+        if(pressure.fd >= 0)
+            close(pressure.fd);
+    }
+    qDeleteAll(m_series);
+}
 
-    qDebug() << "disk set to" << disk;
+TimeSeries *StatPoller::series(const QString &key)
+{
+    auto it = m_series.find(key);
+    if(it == m_series.end())
+        it = m_series.insert(key, new TimeSeries);
+    return it.value();
 }
 
-void StatPoller::poll()
+int StatPoller::readFile(int fd)
 {
-    if(m_type == CPU)
+    if(fd < 0)
+        return -1;
+
+    // procfs regenerates the contents on a read from offset 0
+    int len = 0;
+    for(;;)
     {
-        m_file->open(QFile::ReadOnly);
-        auto cpudata = m_file->readLine().simplified().split(' ').mid(1);
-        int wait = cpudata[3].toInt();
-        int total = 0;
-        for(auto &time : cpudata)
-            total += time.toInt();
-
-        auto cpu = (1 - (1.0*wait-m_cpu_previdle)
-                    / (total-m_cpu_prevtotal)) * 100.0;
-
-        emit cpuAverageAvailable(cpu);
-
-        m_cpu_previdle = wait;
-        m_cpu_prevtotal = total;
-        m_file->close();
-        return;
+        ssize_t n = pread(fd, m_buffer.data() + len, m_buffer.size() - len, len);
+        if(n < 0)
+            return -1;
+        if(n == 0)
+            break;
+        len += n;
+        if(len == m_buffer.size())
+            m_buffer.resize(m_buffer.size() * 2);
     }
-    if(m_type == Memory)
+    return len;
+}
+
+void StatPoller::poll()
+{
+    const qint64 now = m_clock.elapsed();
+    const qint64 interval = m_last < 0 ? 0 : now - m_last;
+    m_last = now;
+
+    int tiers = 0;
+    tiers |= pollCpu(now);
+    tiers |= pollMemory(now);
+    tiers |= pollDisks(now, interval);
+    tiers |= pollNetwork(now, interval);
+    for(auto &pressure : m_pressure)
+        tiers |= pollPressure(pressure, now, interval);
+
+    emit sampled(tiers);
+}
+
+int StatPoller::pollCpu(qint64 now)
+{
+    int len = readFile(m_stat);
+    if(len <= 0)
+        return 0;
+
+    int tiers = 0;
+    const char *end = m_buffer.constData() + len;
+    for(const char *p = m_buffer.constData(); p < end; p = nextLine(p, end))
     {
-        qulonglong mem_total = 0;
-        qulonglong mem_free = 0;
-        qulonglong mem_avail = 0;
-        qulonglong buffers = 0;
-        qulonglong cached = 0;
-        qulonglong swcached = 0;
-
-        qulonglong swaptotal = 0;
-        qulonglong swapfree = 0;
-        if(m_file->open(QFile::ReadOnly))
-        {
-            m_file->seek(0);
-            int count = 0;
-            for(;;)
-            {
-                auto ln = m_file->readLine();
-                auto pc = ln.split(':');
-
-                // done reading file here
-                if(pc.first() == "Slab")
-                    break;
-
-                count++;
-                if(count > 50)
-                    break;
-
-                auto f = pc.first();
-                auto val = pc.last().trimmed().split(' ').first(); // remove the kB
-
-                if(f == "MemTotal")
-                    mem_total = QVariant(val).toULongLong();
-                if(f == "MemFree")
-                    mem_free = QVariant(val).toULongLong();
-                if(f == "MemAvailable")
-                    mem_avail = QVariant(val).toULongLong();
-                if(f == "Buffers")
-                    buffers = QVariant(val).toULongLong();
-                if(f == "Cached")
-                    cached = QVariant(val).toULongLong();
-                if(f == "SwapCached")
-                    swcached = QVariant(val).toULongLong();
-                if(f == "SwapTotal")
-                    swaptotal = QVariant(val).toULongLong();
-                if(f == "SwapFree")
-                    swapfree = QVariant(val).toULongLong();
+        // the cpu lines come first
+        if(end - p < 4 || strncmp(p, "cpu", 3) != 0)
+            break;
 
-            }
-            Q_EMIT ramDataAvailable(mem_total, mem_free, mem_avail, buffers, cached);
-            Q_EMIT swapDataAvailable(swaptotal, swapfree, swcached);
-            m_file->close();
+        p += 3;
+        int index = 0;
+        if(*p != ' ')
+            index = nextNumber(p, end) + 1;
+
+        while(m_cpus.count() <= index)
+        {
+            const int n = m_cpus.count();
+            Cpu cpu;
+            cpu.series = series(n == 0 ? QStringLiteral("cpu")
+                                       : QStringLiteral("cpu%1").arg(n - 1));
+            m_cpus.append(cpu);
         }
+
+        // user nice system idle iowait irq softirq steal, guest time is
+        // already part of user
+        qulonglong f[8];
+        for(auto &v : f)
+            v = nextNumber(p, end);
+        qulonglong total = 0;
+        for(auto v : f)
+            total += v;
+        const qulonglong busy = total - f[3] - f[4];
+
+        Cpu &cpu = m_cpus[index];
+        if(cpu.total > 0 && total > cpu.total && busy >= cpu.busy)
+            tiers |= cpu.series->append(now, (busy - cpu.busy) * 100.0f / (total - cpu.total));
+        cpu.busy = busy;
+        cpu.total = total;
     }
-    if(m_type == Disk)
+
+    return tiers;
+}
+
+int StatPoller::pollMemory(qint64 now)
+{
+    int len = readFile(m_meminfo);
+    if(len <= 0)
+        return 0;
+
+    qulonglong total = 0, free = 0, buffers = 0, cached = 0;
+    qulonglong swaptotal = 0, swapfree = 0;
+    struct { const char *key; qulonglong *value; } fields[] = {
+        { "MemTotal:", &total },
+        { "MemFree:", &free },
+        { "Buffers:", &buffers },
+        { "Cached:", &cached },
+        { "SwapTotal:", &swaptotal },
+        { "SwapFree:", &swapfree }
+    };
+
+    const char *end = m_buffer.constData() + len;
+    for(const char *p = m_buffer.constData(); p < end; p = nextLine(p, end))
     {
-        if(m_file->open(QFile::ReadOnly))
+        for(auto &field : fields)
         {
-            m_file->seek(0);
-            int count = 0;
-            for(;;)
+            const size_t keylen = strlen(field.key);
+            if(size_t(end - p) > keylen && strncmp(p, field.key, keylen) == 0)
             {
-                auto line = QString(m_file->readLine());
-                if(!line.contains(m_disk))
-                    continue;
-
-                auto idx = line.indexOf(m_disk);
-                line.remove(0, idx);
-                line = line.trimmed();
-                auto lp = line.split(' ');
-                auto sectorr = QString(lp[3]).toULongLong();
-                auto sectorw = QString(lp[7]).toULongLong();
-                if(m_disk_read_sector != 0 && m_disk_write_sector != 0)
-                {
-                    auto read = sectorr-m_disk_read_sector;
-                    auto write = sectorw-m_disk_write_sector;
-                    Q_EMIT diskDataAvailable(read,write);
-
-                }
-                m_disk_read_sector = sectorr;
-                m_disk_write_sector = sectorw;
+                const char *v = p + keylen;
+                *field.value = nextNumber(v, end);
                 break;
-                count++;
-                if(count > 50)
-                    break;
             }
-            m_file->close();
         }
     }
+
+    const qulonglong used = total - free - buffers - cached;
+    int tiers = 0;
+    tiers |= m_memUsed->append(now, used);
+    tiers |= m_memCache->append(now, buffers + cached);
+    tiers |= m_swapUsed->append(now, swaptotal - swapfree);
+    return tiers;
+}
+
+StatPoller::Device &StatPoller::device(QList<Device> &devices, int index,
+                                       const char *name, int len,
+                                       const char *in, const char *out)
+{
+    // the kernel lists devices in the same order every time
+    if(index < devices.count() && devices[index].name.size() == len
+            && memcmp(devices[index].name.constData(), name, len) == 0)
+        return devices[index];
+
+    for(auto &dev : devices)
+    {
+        if(dev.name.size() == len && memcmp(dev.name.constData(), name, len) == 0)
+            return dev;
+    }
+
+    Device dev;
+    dev.name = QByteArray(name, len);
+    const QString base = QString::fromLatin1(dev.name);
+    dev.inSeries = series(QString::fromLatin1(in).arg(base));
+    dev.outSeries = series(QString::fromLatin1(out).arg(base));
+    devices.append(dev);
+    return devices.last();
+}
+
+int StatPoller::updateDevice(Device &dev, qulonglong in, qulonglong out, qint64 now, qint64 interval)
+{
+    int tiers = 0;
+    // the first sample only sets the baseline, a counter going backwards
+    // means the device was removed and added again
+    if(interval > 0 && dev.seen && in >= dev.in && out >= dev.out)
+    {
+        tiers |= dev.inSeries->append(now, (in - dev.in) / 1.024f / interval);
+        tiers |= dev.outSeries->append(now, (out - dev.out) / 1.024f / interval);
+    }
+    dev.in = in;
+    dev.out = out;
+    dev.seen = true;
+    return tiers;
+}
+
+int StatPoller::pollDisks(qint64 now, qint64 interval)
+{
+    int len = readFile(m_diskstats);
+    if(len <= 0)
+        return 0;
+
+    int tiers = 0;
+    int index = 0;
+    const char *end = m_buffer.constData() + len;
+    for(const char *p = m_buffer.constData(); p < end; p = nextLine(p, end))
+    {
+        // major minor name reads merged sectors time writes merged sectors
+        nextNumber(p, end);
+        nextNumber(p, end);
+        skipSpaces(p, end);
+        const char *name = p;
+        while(p < end && *p != ' ' && *p != '\n')
+            p++;
+        const int namelen = p - name;
+        if(namelen == 0)
+            continue;
+
+        qulonglong f[7];
+        for(auto &v : f)
+            v = nextNumber(p, end);
+
+        Device &dev = device(m_disks, index++, name, namelen, "disk.%1.read", "disk.%1.write");
+        tiers |= updateDevice(dev, f[2] * SectorSize, f[6] * SectorSize, now, interval);
+    }
+
+    return tiers;
+}
+
+int StatPoller::pollNetwork(qint64 now, qint64 interval)
+{
+    int len = readFile(m_netdev);
+    if(len <= 0)
+        return 0;
+
+    int tiers = 0;
+    int index = 0;
+    const char *end = m_buffer.constData() + len;
+    for(const char *p = m_buffer.constData(); p < end; p = nextLine(p, end))
+    {
+        // two header lines, then "name: rx_bytes 7 more rx fields tx_bytes"
+        const char *eol = nextLine(p, end);
+        const char *colon = static_cast<const char*>(memchr(p, ':', eol - p));
+        if(!colon)
+            continue;
+
+        skipSpaces(p, colon);
+        const char *name = p;
+        const int namelen = colon - name;
+        p = colon + 1;
+
+        qulonglong f[9];
+        for(auto &v : f)
+            v = nextNumber(p, eol);
+
+        Device &dev = device(m_nics, index++, name, namelen, "net.%1.rx", "net.%1.tx");
+        tiers |= updateDevice(dev, f[0], f[8], now, interval);
+    }
+
+    return tiers;
+}
+
+int StatPoller::pollPressure(Pressure &pressure, qint64 now, qint64 interval)
+{
+    int len = readFile(pressure.fd);
+    if(len <= 0)
+        return 0;
+
+    // "some avg10=0.00 avg60=0.00 avg300=0.00 total=123", stall time in usec
+    const char *end = nextLine(m_buffer.constData(), m_buffer.constData() + len);
+    const char *p = static_cast<const char*>(memmem(m_buffer.constData(), end - m_buffer.constData(),
+                                                    "total=", 6));
+    if(!p)
+        return 0;
+    p += 6;
+    const qulonglong total = nextNumber(p, end);
+
+    int tiers = 0;
+    if(interval > 0 && pressure.seen && total >= pressure.total)
+        tiers = pressure.series->append(now, qMin(100.0f, (total - pressure.total) / 10.0f / interval));
+    pressure.total = total;
+    pressure.seen = true;
+    return tiers;
 }
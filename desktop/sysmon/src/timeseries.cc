@@ -0,0 +1,91 @@
+// Hollywood System Monitor
+// (C) 2024 Originull Software
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "timeseries.h"
+
+static const int TierCapacity[TimeSeries::TierCount] = { 60, 60, 96 };
+// the span averaged into one point, Recent takes every sample
+static const qint64 TierBucket[TimeSeries::TierCount] = { 0, 60 * 1000, 15 * 60 * 1000 };
+
+void TimeSeries::Ring::push(float value)
+{
+    values[head] = value;
+    head = (head + 1) % values.size();
+    if(count < values.size())
+        count++;
+    total++;
+}
+
+TimeSeries::TimeSeries()
+{
+    for(int i = 0; i < TierCount; i++)
+        m_rings[i].values.resize(TierCapacity[i]);
+}
+
+int TimeSeries::append(qint64 msecs, float value)
+{
+    m_rings[Recent].push(value);
+    int changed = 1 << Recent;
+
+    for(int i = Hour; i < TierCount; i++)
+    {
+        Bucket &bucket = m_buckets[i];
+        const qint64 index = msecs / TierBucket[i];
+        if(bucket.index != index)
+        {
+            // the previous bucket is complete
+            if(bucket.samples > 0)
+            {
+                m_rings[i].push(bucket.sum / bucket.samples);
+                changed |= 1 << i;
+            }
+            bucket.index = index;
+            bucket.sum = 0;
+            bucket.samples = 0;
+        }
+        bucket.sum += value;
+        bucket.samples++;
+    }
+
+    return changed;
+}
+
+int TimeSeries::capacity(Tier tier) const
+{
+    return m_rings[tier].values.size();
+}
+
+int TimeSeries::count(Tier tier) const
+{
+    return m_rings[tier].count;
+}
+
+float TimeSeries::at(Tier tier, int index) const
+{
+    const Ring &ring = m_rings[tier];
+    if(index < 0 || index >= ring.count)
+        return 0;
+
+    const int size = ring.values.size();
+    return ring.values[(ring.head - ring.count + index + size) % size];
+}
+
+float TimeSeries::last(Tier tier) const
+{
+    return at(tier, m_rings[tier].count - 1);
+}
+
+float TimeSeries::maximum(Tier tier) const
+{
+    const Ring &ring = m_rings[tier];
+    float top = 0;
+    for(int i = 0; i < ring.count; i++)
+        top = qMax(top, ring.values[i]);
+    return top;
+}
+
+quint64 TimeSeries::total(Tier tier) const
+{
+    return m_rings[tier].total;
+}
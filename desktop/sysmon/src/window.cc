@@ -130,6 +130,9 @@ SysmonWindow::SysmonWindow(QWidget *parent)
         m_services->setEnabled(true);
         m_serviceview->setModel(m_svcmonitor->model());
         m_serviceview->setRootIsDecorated(false);
+        m_serviceview->setContextMenuPolicy(Qt::CustomContextMenu);
+        connect(m_serviceview, &QTreeView::customContextMenuRequested,
+                this, &SysmonWindow::serviceContextMenuRequested);
     }
 
     m_logview = m_toolbar->addAction(tr("&Logs"));
@@ -176,6 +179,24 @@ SysmonWindow::SysmonWindow(QWidget *parent)
     speeds->addAction(m_uslow);
     speeds->addAction(m_unormal);
 
+    auto history = view->addMenu(tr("Graph &History"));
+    m_hminute = history->addAction(tr("Last &Minute"));
+    m_hhour = history->addAction(tr("Last &Hour"));
+    m_hday = history->addAction(tr("Last &Day"));
+    m_hminute->setCheckable(true);
+    m_hhour->setCheckable(true);
+    m_hday->setCheckable(true);
+    m_hminute->setChecked(true);
+
+    connect(m_hminute, &QAction::triggered, this, &SysmonWindow::historyChanged);
+    connect(m_hhour, &QAction::triggered, this, &SysmonWindow::historyChanged);
+    connect(m_hday, &QAction::triggered, this, &SysmonWindow::historyChanged);
+
+    auto ranges = new QActionGroup(this);
+    ranges->addAction(m_hminute);
+    ranges->addAction(m_hhour);
+    ranges->addAction(m_hday);
+
     m_pause = view->addAction(tr("Pause &Updates"));
     m_pause->setCheckable(true);
     m_pause->setIcon(QIcon::fromTheme("media-playback-pause"));
@@ -385,6 +406,21 @@ void SysmonWindow::updatePauseTriggered()
     }
 }
 
+void SysmonWindow::historyChanged()
+{
+    auto action = qobject_cast<QAction*>(sender());
+    Q_ASSERT(action);
+
+    // the history keeps filling either way, this only picks what is shown
+    TimeSeries::Tier tier = TimeSeries::Recent;
+    if(action == m_hhour)
+        tier = TimeSeries::Hour;
+    else if(action == m_hday)
+        tier = TimeSeries::Day;
+
+    m_overview->setHistoryTier(tier);
+}
+
 void SysmonWindow::about()
 {
     auto about = new HWAboutDialog(this);
@@ -465,6 +501,33 @@ void SysmonWindow::processContextMenuRequested(const QPoint &pos)
     m_procContext->popup(mapToGlobal(pos));
 }
 
+void SysmonWindow::serviceContextMenuRequested(const QPoint &pos)
+{
+    auto proc = m_svcmonitor->model()->processForIndex(m_serviceview->indexAt(pos));
+    if(!proc)
+        return;
+
+    const QString name = proc->name();
+    const bool running = proc->state() != OpenRCProcess::Stopped &&
+                         proc->state() != OpenRCProcess::Failed;
+
+    QMenu menu(this);
+    auto start = menu.addAction(QIcon::fromTheme("media-playback-start"), tr("&Start"));
+    auto stop = menu.addAction(QIcon::fromTheme("media-playback-stop"), tr("S&top"));
+    auto restart = menu.addAction(QIcon::fromTheme("view-refresh"), tr("&Restart"));
+    start->setEnabled(!running);
+    stop->setEnabled(running);
+    restart->setEnabled(running);
+
+    auto chosen = menu.exec(m_serviceview->viewport()->mapToGlobal(pos));
+    if(chosen == start)
+        m_svcmonitor->controlService(name, QLatin1String("start"));
+    else if(chosen == stop)
+        m_svcmonitor->controlService(name, QLatin1String("stop"));
+    else if(chosen == restart)
+        m_svcmonitor->controlService(name, QLatin1String("restart"));
+}
+
 void SysmonWindow::processItemActivated(const QModelIndex &index)
 {
     pid_t pid = m_model->pidForIndex(index);
@@ -1,6 +1,6 @@
 include(../include/global.pri)
 
-QT       += core gui widgets charts
+QT       += core gui widgets charts concurrent
 
 INCLUDEPATH += include/
 INCLUDEPATH += ../libshell/include
@@ -21,10 +21,13 @@ SOURCES += \
     src/openrc.cc \
     src/openrcmodel.cc \
     src/overview.cc \
+    src/procevents.cc \
     src/procfsmodel.cc \
+    src/procfssampler.cc \
     src/ramoverview.cc \
     src/diskoverview.cc \
     src/statpoller.cc \
+    src/timeseries.cc \
     src/window.cc
 
 HEADERS += \
@@ -39,10 +42,13 @@ HEADERS += \
     include/openrc.h \
     include/openrcmodel.h \
     include/overview.h \
+    include/procevents.h \
     include/procfsmodel.h \
+    include/procfssampler.h \
     include/ramoverview.h \
     include/diskoverview.h \
     include/statpoller.h \
+    include/timeseries.h \
     include/window.h
 
 LIBS += -L../libshell -L../output -lshell-$${HOLLYWOOD_APIVERSION}
@@ -10,6 +10,7 @@ SUBDIRS = \
     libcommdlg \
     libpavu \
     platformtheme \
+    platformtheme/benchmark \
     editor \
     display \
     elevator \
@@ -11,11 +11,16 @@
 #include <QProcess>
 #include <QDir>
 #include <QDebug>
+#include <QTimer>
+
+// output usually comes in bursts, look at the foreground group once per burst
+static const int ForegroundCheckDelay = 150;
 
 TerminalHost::TerminalHost(TerminalProfile *profile, QWidget *parent)
     : QObject(parent),
       m_widget(new QTermWidget(0)),
-      m_profile(profile)
+      m_profile(profile),
+      m_foreground(new QTimer(this))
 {
     srand(time(nullptr));
     m_id  = QByteArray(".")
@@ -35,6 +40,11 @@ TerminalHost::TerminalHost(TerminalProfile *profile, QWidget *parent)
     connect(m_widget, &QTermWidget::finished, this, &TerminalHost::terminalFinished);
     connect(m_widget, &QTermWidget::titleChanged, this, &TerminalHost::terminalTitleChanged);
     connect(m_widget, &QTermWidget::copyAvailable, this, &TerminalHost::copyAvailable);
+    connect(m_widget, &QTermWidget::receivedData, this, &TerminalHost::ptyActivity);
+
+    m_foreground->setSingleShot(true);
+    m_foreground->setInterval(ForegroundCheckDelay);
+    connect(m_foreground, &QTimer::timeout, this, &TerminalHost::checkForeground);
     m_widget->startShellProgram();
 }
 
@@ -132,42 +142,6 @@ QString TerminalHost::getCwd()
     return QString();
 }
 
-QString TerminalHost::getProcessLoop(uint pid)
-{
-    QDir dir(QString("/proc/%1/task/").arg(pid));
-    if(dir.exists())
-    {
-        // shell is running
-        auto tids = dir.entryList(QDir::Dirs|QDir::NoDotAndDotDot);
-        bool haschild = false;
-        uint lastchild = 0;
-        for(auto tid : tids)
-        {
-            QFile file(QString("/proc/%1/task/%2/children").arg(m_widget->getShellPID()).arg(tid));
-            if(file.open(QFile::ReadOnly))
-            {
-                auto cpids = file.readAll().split(' ');
-                file.close();
-                for(auto cpid : cpids)
-                {
-                    if(QFile::exists(QString("/proc/%1/stat").arg(QString(cpid))))
-                    {
-                        haschild = true;
-                        lastchild = cpid.toUInt();
-                    }
-                }
-
-            }
-        }
-
-        if(haschild)
-            return getProcessLoop(lastchild);
-        else
-            return getProcessName(pid);
-    }
-    return QString(tr("Invalid"));
-}
-
 QString TerminalHost::getProcessName(uint pid)
 {
     QFile file(QString("/proc/%1/stat").arg(pid));
@@ -182,6 +156,47 @@ QString TerminalHost::getProcessName(uint pid)
     return QString();
 }
 
+void TerminalHost::ptyActivity()
+{
+    // a job starting or finishing writes to the terminal, the shell
+    // prompt at the very least
+    if(!m_foreground->isActive())
+        m_foreground->start();
+}
+
+void TerminalHost::checkForeground()
+{
+    const pid_t shell = m_widget->getShellPID();
+    // tcgetpgrp() on the pty master, the slave only answers for the
+    // process it is the controlling terminal of
+    pid_t pgid = m_widget->getForegroundProcessId();
+    if(pgid <= 0)
+        pgid = shell;
+
+    if(pgid == m_pgid)
+        return;
+
+    // the first lookup comes from building a title, don't recurse into it
+    const bool known = m_pgid >= 0;
+    m_pgid = pgid;
+    m_pgidName = pgid > 0 ? getProcessName(pgid) : QString();
+
+    if(known && (m_profile->tabTitleFlags() & TerminalProfile::ActiveProcessNameTab ||
+       m_profile->windowTitleFlags() & TerminalProfile::ActiveProcessName))
+        emit titleChanged();
+}
+
+QString TerminalHost::foregroundProcessName()
+{
+    if(m_pgid < 0)
+        checkForeground();
+
+    if(m_pgid <= 0)
+        return QString(tr("Invalid"));
+
+    return m_pgidName;
+}
+
 void TerminalHost::copyAvailable(bool canCopy)
 {
     qDebug() << "canCopy";
@@ -226,42 +241,15 @@ bool TerminalHost::canClose()
 
 bool TerminalHost::hasBlockingTasks()
 {
-    QDir dir(QString("/proc/%1/task/").arg(m_widget->getShellPID()));
-    if(dir.exists())
-    {
-        // shell is running
-        auto tids = dir.entryList(QDir::Dirs|QDir::NoDotAndDotDot);
-        for(auto tid : tids)
-        {
-            QFile file(QString("/proc/%1/task/%2/children").arg(m_widget->getShellPID()).arg(tid));
-            if(file.open(QFile::ReadOnly))
-            {
-                auto cpids = file.readAll().split(' ');
-                file.close();
-                for(auto cpid : cpids)
-                {
-                    if(QFile::exists(QString("/proc/%1/stat").arg(QString(cpid))))
-                    {
-                        QFile procstat(QString("/proc/%1/stat").arg(QString(cpid)));
-                        file.open(QFile::ReadOnly);
-                        auto statdata = file.readAll();
-                        file.close();
-                        if(statdata.isEmpty())
-                            continue;
-
-                        auto split = statdata.split(' ');
-                        file.close();
-                        auto exe = split[1].remove(0,1);
-                        exe = exe.remove(exe.length()-1,1);
-                        if(!m_profile->closeConsentExceptions().contains(exe))
-                            return true;
-                    }
-                }
-            }
-        }
-    }
+    // a single syscall, the name only gets read if the group changed
+    // since the last pty activity
+    checkForeground();
+
+    const pid_t shell = m_widget->getShellPID();
+    if(m_pgid <= 0 || m_pgid == shell)
+        return false;
 
-    return false;
+    return !m_profile->closeConsentExceptions().contains(m_pgidName);
 }
 
 QString TerminalHost::tabTitle()
@@ -282,7 +270,7 @@ QString TerminalHost::tabTitle()
 
     auto procname = QString();
     if(tflags & TerminalProfile::ActiveProcessNameTab)
-        procname = getProcessLoop(m_widget->getShellPID());
+        procname = foregroundProcessName();
 
     // figure out our tab title
     /*if(tflags & TerminalProfile::WorkingDirDocumentTab)
@@ -322,7 +310,7 @@ QString TerminalHost::windowTitle()
     auto procname = QString();
     if(wflags & TerminalProfile::ActiveProcessName)
     {
-        procname = getProcessLoop(m_widget->getShellPID());
+        procname = foregroundProcessName();
         wndtitle.append(procname);
     }
     // figure out our tab title
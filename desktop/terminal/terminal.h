@@ -2,7 +2,9 @@
 #define TERMINALHOST_H
 
 #include <QObject>
+#include <sys/types.h>
 
+class QTimer;
 class QTermWidget;
 class TerminalProfile;
 class TerminalHost : public QObject
@@ -32,14 +34,22 @@ private slots:
     void profileChanged();
     void terminalFinished();
     QString getCwd();
-    QString getProcessLoop(uint pid);
     QString getProcessName(uint pid);
     void copyAvailable(bool canCopy);
+    void ptyActivity();
+    void checkForeground();
+private:
+    QString foregroundProcessName();
 private:
     QByteArray m_id;
     QTermWidget *m_widget;
     TerminalProfile *m_profile;
     bool m_copy = false;
+    // the foreground process group of the pty and its name, the name is
+    // only read from /proc when the group changes
+    pid_t m_pgid = -1;
+    QString m_pgidName;
+    QTimer *m_foreground = nullptr;
 };
 
 #endif // TERMINALHOST_H